@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Fast AES-128 driver for the native platform. Uses AES-NI when
+ *         the host CPU supports it and T-tables otherwise, and caches
+ *         the expanded key of the last few keys in use.
+ */
+
+#include "contiki.h"
+#include "native-aes-128.h"
+#include <string.h>
+
+#if NATIVE_AES_128_AESNI && (defined(__x86_64__) || defined(__i386__))
+#define WITH_AESNI 1
+#include <wmmintrin.h>
+#else
+#define WITH_AESNI 0
+#endif
+/*---------------------------------------------------------------------------*/
+struct key_schedule {
+  uint8_t key[AES_128_KEY_LENGTH];
+  uint8_t bytes[11][AES_128_BLOCK_SIZE];   /* Round keys, as used by AES-NI */
+  uint32_t words[44];                      /* Same, big-endian words */
+  unsigned long last_used;
+};
+
+static struct key_schedule cache[NATIVE_AES_128_KEY_CACHE_SIZE];
+static struct key_schedule *current;
+static unsigned long use_count;
+static struct native_aes_128_stats stats;
+
+static uint8_t sbox[256];
+static uint32_t te[4][256];
+static uint8_t initialized;
+#if WITH_AESNI
+static uint8_t use_aesni;
+#endif /* WITH_AESNI */
+
+#define GET32(p) (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | \
+                  ((uint32_t)(p)[2] << 8) | (uint32_t)(p)[3])
+#define PUT32(p, v) do { (p)[0] = (v) >> 24; (p)[1] = (v) >> 16; \
+                         (p)[2] = (v) >> 8; (p)[3] = (v); } while(0)
+#define ROTL8(x, n) ((uint8_t)(((x) << (n)) | ((x) >> (8 - (n)))))
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+/*---------------------------------------------------------------------------*/
+static uint8_t
+galois_mul2(uint8_t value)
+{
+  return (value << 1) ^ ((value >> 7) * 0x1b);
+}
+/*---------------------------------------------------------------------------*/
+/* Builds the S-box and the T-tables, and picks an implementation */
+static void
+init(void)
+{
+  uint8_t p = 1;
+  uint8_t q = 1;
+  uint8_t s;
+  int i;
+
+  /* p runs through all non-zero elements of GF(2^8), q is its inverse */
+  do {
+    p = p ^ galois_mul2(p);
+    q ^= q << 1;
+    q ^= q << 2;
+    q ^= q << 4;
+    if(q & 0x80) {
+      q ^= 0x09;
+    }
+    sbox[p] = q ^ ROTL8(q, 1) ^ ROTL8(q, 2) ^ ROTL8(q, 3) ^ ROTL8(q, 4) ^ 0x63;
+  } while(p != 1);
+  sbox[0] = 0x63;
+
+  /* Each T-table entry combines SubBytes and one MixColumns column */
+  for(i = 0; i < 256; i++) {
+    s = sbox[i];
+    te[0][i] = ((uint32_t)galois_mul2(s) << 24) | ((uint32_t)s << 16) |
+      ((uint32_t)s << 8) | (uint32_t)(galois_mul2(s) ^ s);
+    te[1][i] = ROTR32(te[0][i], 8);
+    te[2][i] = ROTR32(te[0][i], 16);
+    te[3][i] = ROTR32(te[0][i], 24);
+  }
+
+#if WITH_AESNI
+  use_aesni = __builtin_cpu_supports("aes") != 0;
+#endif /* WITH_AESNI */
+  initialized = 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+expand_key(struct key_schedule *ks, const uint8_t *key)
+{
+  uint8_t (*rk)[AES_128_BLOCK_SIZE] = ks->bytes;
+  uint8_t rcon = 0x01;
+  int i;
+  int j;
+
+  memcpy(ks->key, key, AES_128_KEY_LENGTH);
+  memcpy(rk[0], key, AES_128_KEY_LENGTH);
+  for(i = 1; i <= 10; i++) {
+    rk[i][0] = sbox[rk[i - 1][13]] ^ rk[i - 1][0] ^ rcon;
+    rk[i][1] = sbox[rk[i - 1][14]] ^ rk[i - 1][1];
+    rk[i][2] = sbox[rk[i - 1][15]] ^ rk[i - 1][2];
+    rk[i][3] = sbox[rk[i - 1][12]] ^ rk[i - 1][3];
+    for(j = 4; j < AES_128_BLOCK_SIZE; j++) {
+      rk[i][j] = rk[i - 1][j] ^ rk[i][j - 4];
+    }
+    rcon = galois_mul2(rcon);
+  }
+  for(i = 0; i < 44; i++) {
+    ks->words[i] = GET32(&rk[i / 4][(i % 4) * 4]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_key(const uint8_t *key)
+{
+  struct key_schedule *victim;
+  int i;
+
+  if(!initialized) {
+    init();
+  }
+
+  use_count++;
+  if(current != NULL && !memcmp(current->key, key, AES_128_KEY_LENGTH)) {
+    current->last_used = use_count;
+    stats.key_hits++;
+    return;
+  }
+
+  victim = &cache[0];
+  for(i = 0; i < NATIVE_AES_128_KEY_CACHE_SIZE; i++) {
+    if(cache[i].last_used != 0 &&
+       !memcmp(cache[i].key, key, AES_128_KEY_LENGTH)) {
+      current = &cache[i];
+      current->last_used = use_count;
+      stats.key_hits++;
+      return;
+    }
+    if(cache[i].last_used < victim->last_used) {
+      victim = &cache[i];
+    }
+  }
+
+  /* Not cached: replace the least recently used entry */
+  expand_key(victim, key);
+  victim->last_used = use_count;
+  current = victim;
+  stats.key_misses++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+encrypt_ttable(uint8_t *state)
+{
+  const uint32_t *rk = current->words;
+  uint32_t s0, s1, s2, s3;
+  uint32_t t0, t1, t2, t3;
+  int round;
+
+  s0 = GET32(state) ^ rk[0];
+  s1 = GET32(state + 4) ^ rk[1];
+  s2 = GET32(state + 8) ^ rk[2];
+  s3 = GET32(state + 12) ^ rk[3];
+
+  for(round = 1; round < 10; round++) {
+    rk += 4;
+    t0 = te[0][s0 >> 24] ^ te[1][(s1 >> 16) & 0xff] ^
+      te[2][(s2 >> 8) & 0xff] ^ te[3][s3 & 0xff] ^ rk[0];
+    t1 = te[0][s1 >> 24] ^ te[1][(s2 >> 16) & 0xff] ^
+      te[2][(s3 >> 8) & 0xff] ^ te[3][s0 & 0xff] ^ rk[1];
+    t2 = te[0][s2 >> 24] ^ te[1][(s3 >> 16) & 0xff] ^
+      te[2][(s0 >> 8) & 0xff] ^ te[3][s1 & 0xff] ^ rk[2];
+    t3 = te[0][s3 >> 24] ^ te[1][(s0 >> 16) & 0xff] ^
+      te[2][(s1 >> 8) & 0xff] ^ te[3][s2 & 0xff] ^ rk[3];
+    s0 = t0;
+    s1 = t1;
+    s2 = t2;
+    s3 = t3;
+  }
+
+  /* Last round: no MixColumns */
+  rk += 4;
+  t0 = ((uint32_t)sbox[s0 >> 24] << 24) ^
+    ((uint32_t)sbox[(s1 >> 16) & 0xff] << 16) ^
+    ((uint32_t)sbox[(s2 >> 8) & 0xff] << 8) ^ sbox[s3 & 0xff] ^ rk[0];
+  t1 = ((uint32_t)sbox[s1 >> 24] << 24) ^
+    ((uint32_t)sbox[(s2 >> 16) & 0xff] << 16) ^
+    ((uint32_t)sbox[(s3 >> 8) & 0xff] << 8) ^ sbox[s0 & 0xff] ^ rk[1];
+  t2 = ((uint32_t)sbox[s2 >> 24] << 24) ^
+    ((uint32_t)sbox[(s3 >> 16) & 0xff] << 16) ^
+    ((uint32_t)sbox[(s0 >> 8) & 0xff] << 8) ^ sbox[s1 & 0xff] ^ rk[2];
+  t3 = ((uint32_t)sbox[s3 >> 24] << 24) ^
+    ((uint32_t)sbox[(s0 >> 16) & 0xff] << 16) ^
+    ((uint32_t)sbox[(s1 >> 8) & 0xff] << 8) ^ sbox[s2 & 0xff] ^ rk[3];
+  PUT32(state, t0);
+  PUT32(state + 4, t1);
+  PUT32(state + 8, t2);
+  PUT32(state + 12, t3);
+}
+/*---------------------------------------------------------------------------*/
+#if WITH_AESNI
+__attribute__((target("aes,sse2")))
+static void
+encrypt_aesni(uint8_t *state)
+{
+  const __m128i *rk = (const __m128i *)current->bytes;
+  __m128i m;
+  int round;
+
+  m = _mm_xor_si128(_mm_loadu_si128((const __m128i *)state),
+                    _mm_loadu_si128(&rk[0]));
+  for(round = 1; round < 10; round++) {
+    m = _mm_aesenc_si128(m, _mm_loadu_si128(&rk[round]));
+  }
+  m = _mm_aesenclast_si128(m, _mm_loadu_si128(&rk[10]));
+  _mm_storeu_si128((__m128i *)state, m);
+}
+#endif /* WITH_AESNI */
+/*---------------------------------------------------------------------------*/
+static void
+encrypt(uint8_t *state)
+{
+  static const uint8_t zero_key[AES_128_KEY_LENGTH];
+
+  if(current == NULL) {
+    /* Same as the software driver: all-zero key until one is set */
+    set_key(zero_key);
+  }
+#if WITH_AESNI
+  if(use_aesni) {
+    encrypt_aesni(state);
+    return;
+  }
+#endif /* WITH_AESNI */
+  encrypt_ttable(state);
+}
+/*---------------------------------------------------------------------------*/
+const char *
+native_aes_128_impl(void)
+{
+  if(!initialized) {
+    init();
+  }
+#if WITH_AESNI
+  if(use_aesni) {
+    return "aes-ni";
+  }
+#endif /* WITH_AESNI */
+  return "t-table";
+}
+/*---------------------------------------------------------------------------*/
+const struct native_aes_128_stats *
+native_aes_128_get_stats(void)
+{
+  return &stats;
+}
+/*---------------------------------------------------------------------------*/
+const struct aes_128_driver native_aes_128_driver = {
+  set_key,
+  encrypt
+};
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Fast AES-128 driver for the native platform
+ */
+
+#ifndef NATIVE_AES_128_H_
+#define NATIVE_AES_128_H_
+
+#include "lib/aes-128.h"
+
+/* Number of expanded keys kept around, so that switching between link
+ * keys does not redo the key schedule */
+#ifdef NATIVE_AES_128_CONF_KEY_CACHE_SIZE
+#define NATIVE_AES_128_KEY_CACHE_SIZE NATIVE_AES_128_CONF_KEY_CACHE_SIZE
+#else /* NATIVE_AES_128_CONF_KEY_CACHE_SIZE */
+#define NATIVE_AES_128_KEY_CACHE_SIZE 4
+#endif /* NATIVE_AES_128_CONF_KEY_CACHE_SIZE */
+
+/* Use the AES-NI instructions when the host CPU has them. Otherwise, or
+ * when disabled, fall back to a T-table implementation. */
+#ifdef NATIVE_AES_128_CONF_AESNI
+#define NATIVE_AES_128_AESNI NATIVE_AES_128_CONF_AESNI
+#else /* NATIVE_AES_128_CONF_AESNI */
+#define NATIVE_AES_128_AESNI 1
+#endif /* NATIVE_AES_128_CONF_AESNI */
+
+/** Key schedule cache counters */
+struct native_aes_128_stats {
+  unsigned long key_hits;
+  unsigned long key_misses;
+};
+
+extern const struct aes_128_driver native_aes_128_driver;
+
+/** Name of the implementation in use: "aes-ni" or "t-table" */
+const char *native_aes_128_impl(void);
+const struct native_aes_128_stats *native_aes_128_get_stats(void);
+
+#endif /* NATIVE_AES_128_H_ */
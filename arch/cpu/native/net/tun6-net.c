@@ -35,6 +35,7 @@
 
 #include "net/ipv6/uip.h"
 #include "net/ipv6/uip-ds6.h"
+#include "tun6-net.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
@@ -58,6 +59,54 @@
 #ifdef linux
 #include <linux/if.h>
 #include <linux/if_tun.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <arpa/inet.h>
+#endif
+
+/*
+ * Maximum number of packets read from the tun device per wakeup. Reading
+ * stops earlier as soon as the device has been drained.
+ */
+#ifdef TUN6_NET_CONF_READ_BATCH
+#define TUN6_NET_READ_BATCH TUN6_NET_CONF_READ_BATCH
+#else
+#define TUN6_NET_READ_BATCH 32
+#endif
+
+/*
+ * Number of packets buffered when the tun device cannot accept more
+ * output. They are written out in one go once the device is writable.
+ */
+#ifdef TUN6_NET_CONF_TX_QUEUE_LEN
+#define TUN6_NET_TX_QUEUE_LEN TUN6_NET_CONF_TX_QUEUE_LEN
+#else
+#define TUN6_NET_TX_QUEUE_LEN 8
+#endif
+
+/*
+ * Number of tun queues to open (Linux IFF_MULTI_QUEUE). With more than one
+ * queue, the kernel spreads outgoing flows over the queues and all of them
+ * are drained on each wakeup.
+ */
+#ifdef TUN6_NET_CONF_QUEUES
+#define TUN6_NET_QUEUES TUN6_NET_CONF_QUEUES
+#else
+#define TUN6_NET_QUEUES 1
+#endif
+
+/*
+ * Configure the interface through rtnetlink and ioctl() rather than by
+ * running ifconfig (Linux only).
+ */
+#ifdef TUN6_NET_CONF_NETLINK
+#define TUN6_NET_NETLINK TUN6_NET_CONF_NETLINK
+#else
+#define TUN6_NET_NETLINK 0
+#endif
+
+#if !defined(linux) && (TUN6_NET_QUEUES > 1 || TUN6_NET_NETLINK)
+#error "TUN6_NET_CONF_QUEUES and TUN6_NET_CONF_NETLINK are Linux only"
 #endif
 
 #include <err.h>
@@ -69,8 +118,20 @@ static const char *config_ipaddr = "fd00::1/64";
 static char config_tundev[64] = "tun0";
 
 
+static struct tun6_net_stats stats;
+
 #ifndef __CYGWIN__
-static int tunfd = -1;
+static int tunfds[TUN6_NET_QUEUES] = { [0 ... TUN6_NET_QUEUES - 1] = -1 };
+/* Output always goes through the first queue */
+#define tunfd tunfds[0]
+
+/* Packets waiting for the tun device to become writable */
+static struct {
+  uint16_t len;
+  uint8_t data[UIP_BUFSIZE];
+} tx_queue[TUN6_NET_TX_QUEUE_LEN];
+static uint8_t tx_head;
+static uint8_t tx_count;
 
 static int set_fd(fd_set *rset, fd_set *wset);
 static void handle_fd(fd_set *rset, fd_set *wset);
@@ -80,6 +141,7 @@ static const struct select_callback tun_select_callback = {
 };
 #endif /* __CYGWIN__ */
 
+#if !TUN6_NET_NETLINK
 static int ssystem(const char *fmt, ...)
      __attribute__((__format__ (__printf__, 1, 2)));
 static int
@@ -97,11 +159,131 @@ static ssystem(const char *fmt, ...)
   fflush(stdout);
   return system(cmd);
 }
+#endif /* !TUN6_NET_NETLINK */
+
+/*---------------------------------------------------------------------------*/
+#if TUN6_NET_NETLINK
+/* Bring the link up or down and return its interface index */
+static int
+set_link_up(const char *tundev, int up)
+{
+  struct ifreq ifr;
+  int ifindex;
+  int fd;
 
+  fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if(fd < 0) {
+    err(1, "socket");
+  }
+
+  memset(&ifr, 0, sizeof(ifr));
+  strncpy(ifr.ifr_name, tundev, IFNAMSIZ - 1);
+  if(ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+    err(1, "SIOCGIFINDEX %s", tundev);
+  }
+  ifindex = ifr.ifr_ifindex;
+
+  if(ioctl(fd, SIOCGIFFLAGS, &ifr) < 0) {
+    err(1, "SIOCGIFFLAGS %s", tundev);
+  }
+  if(up) {
+    ifr.ifr_flags |= IFF_UP | IFF_RUNNING;
+  } else {
+    ifr.ifr_flags &= ~IFF_UP;
+  }
+  if(ioctl(fd, SIOCSIFFLAGS, &ifr) < 0) {
+    err(1, "SIOCSIFFLAGS %s", tundev);
+  }
+  close(fd);
+  return ifindex;
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_address(int ifindex, const char *tundev, const char *ipaddr)
+{
+  struct {
+    struct nlmsghdr nh;
+    struct ifaddrmsg ifa;
+    char attrbuf[64];
+  } req;
+  struct {
+    struct nlmsghdr nh;
+    struct nlmsgerr err;
+  } ack;
+  struct sockaddr_nl sa;
+  struct rtattr *rta;
+  struct in6_addr addr;
+  char buf[INET6_ADDRSTRLEN];
+  const char *slash;
+  int prefixlen = 128;
+  int fd;
+
+  /* Split "addr/prefixlen" */
+  slash = strchr(ipaddr, '/');
+  if(slash != NULL) {
+    prefixlen = atoi(slash + 1);
+    snprintf(buf, sizeof(buf), "%.*s", (int)(slash - ipaddr), ipaddr);
+  } else {
+    snprintf(buf, sizeof(buf), "%s", ipaddr);
+  }
+  if(inet_pton(AF_INET6, buf, &addr) != 1) {
+    errx(1, "invalid IPv6 address ``%s''", ipaddr);
+  }
+
+  memset(&req, 0, sizeof(req));
+  req.nh.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifaddrmsg));
+  req.nh.nlmsg_type = RTM_NEWADDR;
+  req.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_CREATE | NLM_F_REPLACE | NLM_F_ACK;
+  req.nh.nlmsg_seq = 1;
+  req.ifa.ifa_family = AF_INET6;
+  req.ifa.ifa_prefixlen = prefixlen;
+  req.ifa.ifa_scope = RT_SCOPE_UNIVERSE;
+  req.ifa.ifa_index = ifindex;
+
+  rta = (struct rtattr *)((char *)&req + NLMSG_ALIGN(req.nh.nlmsg_len));
+  rta->rta_type = IFA_LOCAL;
+  rta->rta_len = RTA_LENGTH(sizeof(addr));
+  memcpy(RTA_DATA(rta), &addr, sizeof(addr));
+  req.nh.nlmsg_len = NLMSG_ALIGN(req.nh.nlmsg_len) + RTA_ALIGN(rta->rta_len);
+
+  rta = (struct rtattr *)((char *)&req + NLMSG_ALIGN(req.nh.nlmsg_len));
+  rta->rta_type = IFA_ADDRESS;
+  rta->rta_len = RTA_LENGTH(sizeof(addr));
+  memcpy(RTA_DATA(rta), &addr, sizeof(addr));
+  req.nh.nlmsg_len = NLMSG_ALIGN(req.nh.nlmsg_len) + RTA_ALIGN(rta->rta_len);
+
+  fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+  if(fd < 0) {
+    err(1, "netlink socket");
+  }
+
+  memset(&sa, 0, sizeof(sa));
+  sa.nl_family = AF_NETLINK;
+  if(sendto(fd, &req, req.nh.nlmsg_len, 0,
+            (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+    err(1, "RTM_NEWADDR");
+  }
+
+  if(recv(fd, &ack, sizeof(ack), 0) < 0) {
+    err(1, "RTM_NEWADDR ack");
+  }
+  if(ack.nh.nlmsg_type == NLMSG_ERROR && ack.err.error != 0) {
+    errno = -ack.err.error;
+    err(1, "RTM_NEWADDR %s on %s", ipaddr, tundev);
+  }
+  close(fd);
+
+  LOG_INFO("Added %s to %s\n", ipaddr, tundev);
+}
+#endif /* TUN6_NET_NETLINK */
 /*---------------------------------------------------------------------------*/
 static void
 cleanup(void)
 {
+#if TUN6_NET_NETLINK
+  /* Routes through the interface go away along with it */
+  set_link_up(config_tundev, 0);
+#else /* TUN6_NET_NETLINK */
   ssystem("ifconfig %s down", config_tundev);
 #ifndef linux
   ssystem("sysctl -w net.ipv6.conf.all.forwarding=1");
@@ -110,6 +292,7 @@ cleanup(void)
 	  " | awk '{ if ($2 == \"%s\") print \"route delete -net \"$1; }'"
 	  " | sh",
 	  config_tundev);
+#endif /* TUN6_NET_NETLINK */
 }
 
 /*---------------------------------------------------------------------------*/
@@ -124,6 +307,9 @@ sigcleanup(int signo)
 static void
 ifconf(const char *tundev, const char *ipaddr)
 {
+#if TUN6_NET_NETLINK
+  add_address(set_link_up(tundev, 1), tundev, ipaddr);
+#else /* TUN6_NET_NETLINK */
 #ifdef linux
   ssystem("ifconfig %s inet `hostname` up", tundev);
   ssystem("ifconfig %s add %s", tundev, ipaddr);
@@ -137,6 +323,7 @@ ifconf(const char *tundev, const char *ipaddr)
 
   /* Print the configuration to the console. */
   ssystem("ifconfig %s\n", tundev);
+#endif /* TUN6_NET_NETLINK */
 }
 /*---------------------------------------------------------------------------*/
 #ifdef linux
@@ -155,8 +342,12 @@ tun_alloc(char *dev)
 
   /* Flags: IFF_TUN   - TUN device (no Ethernet headers)
    *        IFF_NO_PI - Do not provide packet information
+   *        IFF_MULTI_QUEUE - Attach one more queue to the same device
    */
   ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+#if TUN6_NET_QUEUES > 1
+  ifr.ifr_flags |= IFF_MULTI_QUEUE;
+#endif /* TUN6_NET_QUEUES > 1 */
   if(*dev != 0) {
     strncpy(ifr.ifr_name, dev, IFNAMSIZ);
   }
@@ -204,6 +395,8 @@ tun_init()
 static void
 tun_init()
 {
+  int i;
+
   setvbuf(stdout, NULL, _IOLBF, 0); /* Line buffered output. */
 
   LOG_INFO("Initializing tun interface\n");
@@ -215,9 +408,23 @@ tun_init()
     return;
   }
 
-  LOG_INFO("Tun open:%d\n", tunfd);
+  /* Attach the additional queues to the device we just got */
+  for(i = 1; i < TUN6_NET_QUEUES; i++) {
+    tunfds[i] = tun_alloc(config_tundev);
+    if(tunfds[i] == -1) {
+      LOG_WARN("Failed to open tun queue %d, using %d queue(s)\n", i, i);
+      break;
+    }
+  }
 
-  select_set_callback(tunfd, &tun_select_callback);
+  for(i = 0; i < TUN6_NET_QUEUES && tunfds[i] != -1; i++) {
+    /* Non-blocking, so that each wakeup can drain the device */
+    if(fcntl(tunfds[i], F_SETFL, fcntl(tunfds[i], F_GETFL) | O_NONBLOCK) == -1) {
+      err(1, "fcntl");
+    }
+    LOG_INFO("Tun open:%d\n", tunfds[i]);
+    select_set_callback(tunfds[i], &tun_select_callback);
+  }
 
   fprintf(stderr, "opened %s device ``/dev/%s''\n",
           "tun", config_tundev);
@@ -230,28 +437,92 @@ tun_init()
 }
 
 /*---------------------------------------------------------------------------*/
+/* Returns 1 if the packet was queued, 0 if it was dropped */
 static int
-tun_output(uint8_t *data, int len)
+tx_enqueue(const uint8_t *data, int len)
 {
-  /* fprintf(stderr, "*** Writing to tun...%d\n", len); */
-  if(tunfd != -1 && write(tunfd, data, len) != len) {
-    err(1, "serial_to_tun: write");
-    return -1;
+  uint8_t i;
+
+  if(tx_count >= TUN6_NET_TX_QUEUE_LEN || len > UIP_BUFSIZE) {
+    stats.tx_dropped++;
+    return 0;
   }
-  return 0;
+  i = (tx_head + tx_count) % TUN6_NET_TX_QUEUE_LEN;
+  memcpy(tx_queue[i].data, data, len);
+  tx_queue[i].len = len;
+  tx_count++;
+  return 1;
 }
 /*---------------------------------------------------------------------------*/
+/*
+ * Write one packet to the tun device. Returns 0 if the device would block,
+ * 1 if the packet was written. A tun device takes a packet whole or not at
+ * all, so a short write is fatal just like a write error.
+ */
 static int
-tun_input(unsigned char *data, int maxlen)
+tun_write(const uint8_t *data, int len)
 {
-  int size;
+  ssize_t ret;
 
+  ret = write(tunfd, data, len);
+  if(ret == len) {
+    return 1;
+  }
+  if(ret < 0) {
+    if(errno == EAGAIN || errno == EWOULDBLOCK) {
+      return 0;
+    }
+    err(1, "serial_to_tun: write");
+  }
+  errx(1, "serial_to_tun: short write (%d of %d bytes)", (int)ret, len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+tx_flush(void)
+{
+  while(tx_count > 0) {
+    if(!tun_write(tx_queue[tx_head].data, tx_queue[tx_head].len)) {
+      return;
+    }
+    stats.tx_packets++;
+    stats.tx_bytes += tx_queue[tx_head].len;
+    tx_head = (tx_head + 1) % TUN6_NET_TX_QUEUE_LEN;
+    tx_count--;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Returns 1 if the packet was written or queued, 0 if it was dropped */
+static int
+tun_output(uint8_t *data, int len)
+{
+  /* fprintf(stderr, "*** Writing to tun...%d\n", len); */
   if(tunfd == -1) {
-    /* tun is not open */
     return 0;
   }
 
-  if((size = read(tunfd, data, maxlen)) == -1) {
+  /* Keep the packet order if the device is already backed up */
+  if(tx_count > 0) {
+    return tx_enqueue(data, len);
+  }
+
+  if(!tun_write(data, len)) {
+    return tx_enqueue(data, len);
+  }
+  stats.tx_packets++;
+  stats.tx_bytes += len;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+tun_input(int fd, unsigned char *data, int maxlen)
+{
+  int size;
+
+  if((size = read(fd, data, maxlen)) == -1) {
+    if(errno == EAGAIN || errno == EWOULDBLOCK) {
+      /* Drained */
+      return 0;
+    }
     err(1, "tun_input: read");
   }
   return size;
@@ -274,11 +545,18 @@ output(const linkaddr_t *localdest)
 static int
 set_fd(fd_set *rset, fd_set *wset)
 {
+  int i;
+
   if(tunfd == -1) {
     return 0;
   }
 
-  FD_SET(tunfd, rset);
+  for(i = 0; i < TUN6_NET_QUEUES && tunfds[i] != -1; i++) {
+    FD_SET(tunfds[i], rset);
+  }
+  if(tx_count > 0) {
+    FD_SET(tunfd, wset);
+  }
   return 1;
 }
 
@@ -288,6 +566,8 @@ static void
 handle_fd(fd_set *rset, fd_set *wset)
 {
   int size;
+  int batch;
+  int i;
 
   if(tunfd == -1) {
     /* tun is not open */
@@ -296,11 +576,35 @@ handle_fd(fd_set *rset, fd_set *wset)
 
   LOG_INFO("Tun6-handle FD\n");
 
-  if(FD_ISSET(tunfd, rset)) {
-    size = tun_input(uip_buf, sizeof(uip_buf));
-    LOG_DBG("TUN data incoming read:%d\n", size);
-    uip_len = size;
-    tcpip_input();
+  if(FD_ISSET(tunfd, wset)) {
+    tx_flush();
+    FD_CLR(tunfd, wset);
+  }
+
+  for(i = 0; i < TUN6_NET_QUEUES && tunfds[i] != -1; i++) {
+    if(!FD_ISSET(tunfds[i], rset)) {
+      continue;
+    }
+    /*
+     * The same callback is registered for every queue: clear the bit so
+     * that a queue is only drained once per wakeup.
+     */
+    FD_CLR(tunfds[i], rset);
+
+    for(batch = 0; batch < TUN6_NET_READ_BATCH; batch++) {
+      size = tun_input(tunfds[i], uip_buf, sizeof(uip_buf));
+      LOG_DBG("TUN data incoming read:%d\n", size);
+      if(size <= 0) {
+        break;
+      }
+      stats.rx_packets++;
+      stats.rx_bytes += size;
+      uip_len = size;
+      tcpip_input();
+    }
+    if(batch > 0) {
+      stats.rx_batches++;
+    }
   }
 }
 #endif /*  __CYGWIN_ */
@@ -312,6 +616,13 @@ static void input(void)
 }
 
 
+/*---------------------------------------------------------------------------*/
+const struct tun6_net_stats *
+tun6_net_get_stats(void)
+{
+  return &stats;
+}
+/*---------------------------------------------------------------------------*/
 const struct network_driver tun6_net_driver ={
   "tun6",
   tun_init,
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014, Hasso-Plattner-Institut.
+ * Copyright (c) 2011, Swedish Institute of Computer Science.
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -25,56 +25,31 @@
  * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
  * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
- *
- * This file is part of the Contiki operating system.
- *
  */
 
 /**
  * \file
- *         Interface to anti-replay mechanisms.
- * \author
- *         Konrad Krentz <konrad.krentz@gmail.com>
- */
-
-/**
- * \addtogroup llsec802154
- * @{
+ *         Network driver for the native platform's tun interface
  */
 
-#ifndef ANTI_REPLAY_H
-#define ANTI_REPLAY_H
+#ifndef TUN6_NET_H_
+#define TUN6_NET_H_
 
 #include "contiki.h"
 
-struct anti_replay_info {
-  uint32_t last_broadcast_counter;
-  uint32_t last_unicast_counter;
+/** Per-direction packet and byte counters of the tun interface */
+struct tun6_net_stats {
+  unsigned long rx_packets;
+  unsigned long rx_bytes;
+  unsigned long rx_batches;  /**< Wakeups that read at least one packet */
+  unsigned long tx_packets;
+  unsigned long tx_bytes;
+  unsigned long tx_dropped;  /**< Output dropped because the queue was full */
 };
 
 /**
- * \brief Sets the frame counter packetbuf attributes.
- */
-void anti_replay_set_counter(void);
-
-/**
- * \brief Gets the frame counter from packetbuf.
+ * \brief Get the tun interface counters
  */
-uint32_t anti_replay_get_counter(void);
-
-/**
- * \brief Initializes the anti-replay information about the sender
- * \param info Anti-replay information about the sender
- */
-void anti_replay_init_info(struct anti_replay_info *info);
-
-/**
- * \brief               Checks if received frame was replayed
- * \param info          Anti-replay information about the sender
- * \retval 0            <-> received frame was not replayed
- */
-int anti_replay_was_replayed(struct anti_replay_info *info);
-
-#endif /* ANTI_REPLAY_H */
+const struct tun6_net_stats *tun6_net_get_stats(void);
 
-/** @} */
+#endif /* TUN6_NET_H_ */
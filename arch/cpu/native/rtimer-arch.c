@@ -55,6 +55,49 @@
 #endif
 
 /*---------------------------------------------------------------------------*/
+#if NATIVE_CONF_VIRTUAL_TIME
+/*
+ * With virtual time there are no signals: the scheduled rtimer is only
+ * recorded here and fired by the platform main loop once the virtual clock
+ * has reached it.
+ */
+static rtimer_clock_t next_rtimer;
+static int rtimer_scheduled;
+/*---------------------------------------------------------------------------*/
+void
+rtimer_arch_init(void)
+{
+  rtimer_scheduled = 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_arch_schedule(rtimer_clock_t t)
+{
+  PRINTF("rtimer_arch_schedule time %"PRIu32" (virtual)\n", (uint32_t)t);
+  next_rtimer = t;
+  rtimer_scheduled = 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+rtimer_arch_next_expiration(rtimer_clock_t *t)
+{
+  if(rtimer_scheduled) {
+    *t = next_rtimer;
+  }
+  return rtimer_scheduled;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_arch_run_expired(void)
+{
+  if(rtimer_scheduled && !RTIMER_CLOCK_LT(RTIMER_NOW(), next_rtimer)) {
+    /* rtimer_run_next() may schedule the next rtimer */
+    rtimer_scheduled = 0;
+    rtimer_run_next();
+  }
+}
+/*---------------------------------------------------------------------------*/
+#else /* NATIVE_CONF_VIRTUAL_TIME */
 static void
 interrupt(int sig)
 {
@@ -89,4 +132,5 @@ rtimer_arch_schedule(rtimer_clock_t t)
   setitimer(ITIMER_REAL, &val, NULL);
 #endif /* !_WIN32 */
 }
+#endif /* NATIVE_CONF_VIRTUAL_TIME */
 /*---------------------------------------------------------------------------*/
@@ -46,4 +46,18 @@
 
 #define rtimer_arch_now() clock_time()
 
+#if NATIVE_CONF_VIRTUAL_TIME
+/**
+ * \brief Get the expiration time of the scheduled rtimer, if any
+ * \param t Set to the expiration time when an rtimer is scheduled
+ * \return Non-zero if an rtimer is scheduled
+ */
+int rtimer_arch_next_expiration(rtimer_clock_t *t);
+
+/**
+ * \brief Run the scheduled rtimer if the virtual clock has reached it
+ */
+void rtimer_arch_run_expired(void);
+#endif /* NATIVE_CONF_VIRTUAL_TIME */
+
 #endif /* RTIMER_ARCH_H_ */
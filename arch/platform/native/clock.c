@@ -42,6 +42,35 @@
 #include <sys/time.h>
 
 /*---------------------------------------------------------------------------*/
+#if NATIVE_CONF_VIRTUAL_TIME
+/*
+ * In virtual time mode the clock is a plain counter that is moved forward
+ * by the platform main loop (see platform_main_loop()).
+ */
+static clock_time_t virtual_time;
+/*---------------------------------------------------------------------------*/
+void
+clock_set_virtual_time(clock_time_t t)
+{
+  /* Never go backwards */
+  if((long)(t - virtual_time) > 0) {
+    virtual_time = t;
+  }
+}
+/*---------------------------------------------------------------------------*/
+clock_time_t
+clock_time(void)
+{
+  return virtual_time;
+}
+/*---------------------------------------------------------------------------*/
+unsigned long
+clock_seconds(void)
+{
+  return virtual_time / CLOCK_SECOND;
+}
+/*---------------------------------------------------------------------------*/
+#else /* NATIVE_CONF_VIRTUAL_TIME */
 typedef struct clock_timespec_s {
   time_t  tv_sec;
   long  tv_nsec;
@@ -86,6 +115,7 @@ clock_seconds(void)
 
   return ts.tv_sec;
 }
+#endif /* NATIVE_CONF_VIRTUAL_TIME */
 /*---------------------------------------------------------------------------*/
 void
 clock_delay(unsigned int d)
@@ -51,6 +51,14 @@ struct select_callback {
 };
 int select_set_callback(int fd, const struct select_callback *callback);
 
+/* Main loop statistics, to compare the select and epoll backends */
+struct select_stats {
+  unsigned long wakeups;       /* Returns from select()/epoll_wait() */
+  unsigned long timer_wakeups; /* Wakeups due to a timeout only */
+  unsigned long fd_events;     /* Calls to select_callback handle_fd() */
+};
+const struct select_stats *select_get_stats(void);
+
 #define CC_CONF_REGISTER_ARGS          1
 #define CC_CONF_FUNCTION_POINTER_ARGS  1
 #define CC_CONF_VA_ARGS                1
@@ -96,12 +104,40 @@ typedef unsigned int uip_stats_t;
 
 #endif /* NETSTACK_CONF_WITH_IPV6 */
 
+/* AES-NI or T-table AES with a key schedule cache */
+#ifndef AES_128_CONF
+#define AES_128_CONF native_aes_128_driver
+#endif /* AES_128_CONF */
+
+/* ROM is not a concern here: parse 802.15.4 headers via lookup table */
+#ifndef FRAME802154_CONF_LAYOUT_TABLE
+#define FRAME802154_CONF_LAYOUT_TABLE 1
+#endif /* FRAME802154_CONF_LAYOUT_TABLE */
+
+/* Slice-by-8 CRC16, its 4 KiB of tables are cheap here */
+#ifndef CRC16_CONF_SLICES
+#define CRC16_CONF_SLICES 8
+#endif /* CRC16_CONF_SLICES */
+
 #include <ctype.h>
 
 typedef unsigned long clock_time_t;
 
 #define CLOCK_CONF_SECOND 1000
 
+/*
+ * Run on virtual (discrete-event) time instead of the host's monotonic
+ * clock. Time only advances when the system is idle, and then jumps
+ * straight to the next pending etimer or rtimer deadline.
+ */
+#ifndef NATIVE_CONF_VIRTUAL_TIME
+#define NATIVE_CONF_VIRTUAL_TIME 0
+#endif
+
+#if NATIVE_CONF_VIRTUAL_TIME
+void clock_set_virtual_time(clock_time_t t);
+#endif /* NATIVE_CONF_VIRTUAL_TIME */
+
 #define LOG_CONF_ENABLED 1
 
 #define PLATFORM_SUPPORTS_BUTTON_HAL 1
@@ -47,12 +47,14 @@
 #include <unistd.h>
 #include <sys/select.h>
 #include <errno.h>
+#include <err.h>
 
 #ifdef __CYGWIN__
 #include "net/wpcap-drv.h"
 #endif /* __CYGWIN__ */
 
 #include "contiki.h"
+
 #include "net/netstack.h"
 
 #include "dev/serial-line.h"
@@ -82,7 +84,7 @@
 
 /*
  * Defines the maximum number of file descriptors monitored by the platform
- * main loop.
+ * main loop (select backend only, the epoll backend has no such limit).
  */
 #ifdef SELECT_CONF_MAX
 #define SELECT_MAX SELECT_CONF_MAX
@@ -108,11 +110,77 @@
 #else
 #define SELECT_STDIN 1
 #endif
+
+/*
+ * Use epoll(7) instead of select(2) to wait for file descriptors (Linux
+ * only). When idle, the loop then sleeps on a timerfd armed for the next
+ * etimer deadline rather than waking up every SELECT_TIMEOUT.
+ */
+#ifdef SELECT_CONF_EPOLL
+#define SELECT_EPOLL SELECT_CONF_EPOLL
+#else
+#define SELECT_EPOLL 0
+#endif
+
+#if SELECT_EPOLL
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include "lib/list.h"
+#endif /* SELECT_EPOLL */
+
+/*
+ * Upper bound (in clock ticks) on how long the epoll backend sleeps when
+ * no etimer is pending. This also bounds the latency of set_fd() callbacks
+ * whose interest depends on something other than an etimer.
+ */
+#ifdef SELECT_CONF_EPOLL_MAX_SLEEP
+#define SELECT_EPOLL_MAX_SLEEP SELECT_CONF_EPOLL_MAX_SLEEP
+#else
+#define SELECT_EPOLL_MAX_SLEEP CLOCK_SECOND
+#endif
+
+/*
+ * Maximum number of ready file descriptors handled per epoll_wait() call.
+ */
+#ifdef SELECT_CONF_EPOLL_EVENTS
+#define SELECT_EPOLL_EVENTS SELECT_CONF_EPOLL_EVENTS
+#else
+#define SELECT_EPOLL_EVENTS 16
+#endif
 /** @} */
 /*---------------------------------------------------------------------------*/
 
+static struct select_stats select_stats;
+
+#if SELECT_EPOLL
+/*
+ * One registration per monitored descriptor. Registrations are kept in a
+ * list rather than indexed by fd, so the backend is only bounded by
+ * FD_SETSIZE, which the fd_set based select_callback API imposes.
+ */
+struct epoll_reg {
+  struct epoll_reg *next;
+  const struct select_callback *callback;
+  int fd;
+  /* The events the descriptor is currently registered for (0 = none) */
+  uint32_t interest;
+  /*
+   * Descriptors epoll cannot monitor (e.g. regular files or /dev/null as
+   * stdin). Like select() does, we consider them always ready.
+   */
+  uint8_t unpollable;
+};
+LIST(registrations);
+
+static int epoll_fd = -1;
+static int timer_fd = -1;
+static clock_time_t timer_deadline;
+static int timer_armed;
+#else /* SELECT_EPOLL */
 static const struct select_callback *select_callback[SELECT_MAX];
 static int select_max = 0;
+#endif /* SELECT_EPOLL */
 
 #ifdef PLATFORM_CONF_MAC_ADDR
 static uint8_t mac_addr[] = PLATFORM_CONF_MAC_ADDR;
@@ -120,6 +188,172 @@ static uint8_t mac_addr[] = PLATFORM_CONF_MAC_ADDR;
 static uint8_t mac_addr[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
 #endif /* PLATFORM_CONF_MAC_ADDR */
 
+/*---------------------------------------------------------------------------*/
+#if SELECT_EPOLL
+static void
+epoll_init(void)
+{
+  struct epoll_event ev;
+
+  if(epoll_fd >= 0) {
+    return;
+  }
+
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if(epoll_fd < 0) {
+    err(1, "epoll_create1");
+  }
+
+  timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if(timer_fd < 0) {
+    err(1, "timerfd_create");
+  }
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.ptr = NULL;
+  if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev) < 0) {
+    err(1, "epoll_ctl");
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+epoll_ctl_reg(int op, struct epoll_reg *reg, uint32_t events)
+{
+  struct epoll_event ev;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = events;
+  ev.data.ptr = reg;
+  return epoll_ctl(epoll_fd, op, reg->fd, &ev);
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Bring the kernel interest set of a descriptor in line with events. The
+ * cached interest always mirrors what the kernel holds, so a descriptor
+ * closed and reopened behind our back (ENOENT on MOD, EEXIST on ADD) is
+ * re-synchronized instead of drifting.
+ */
+static void
+epoll_update(struct epoll_reg *reg, uint32_t events)
+{
+  int ret;
+
+  if(reg->interest == events) {
+    return;
+  }
+
+  if(reg->unpollable) {
+    reg->interest = events;
+    reg->unpollable = events != 0;
+    return;
+  }
+
+  if(events == 0) {
+    /* ENOENT/EBADF: the descriptor was closed, the kernel already forgot it */
+    epoll_ctl_reg(EPOLL_CTL_DEL, reg, 0);
+    reg->interest = 0;
+    return;
+  }
+
+  if(reg->interest == 0) {
+    ret = epoll_ctl_reg(EPOLL_CTL_ADD, reg, events);
+    if(ret < 0 && errno == EEXIST) {
+      ret = epoll_ctl_reg(EPOLL_CTL_MOD, reg, events);
+    }
+  } else {
+    ret = epoll_ctl_reg(EPOLL_CTL_MOD, reg, events);
+    if(ret < 0 && errno == ENOENT) {
+      ret = epoll_ctl_reg(EPOLL_CTL_ADD, reg, events);
+    }
+  }
+
+  if(ret < 0) {
+    if(errno == EPERM) {
+      reg->unpollable = 1;
+      reg->interest = events;
+    } else {
+      /* Neither ADD nor MOD took effect: nothing is registered any more */
+      perror("epoll_ctl");
+      epoll_ctl_reg(EPOLL_CTL_DEL, reg, 0);
+      reg->interest = 0;
+    }
+    return;
+  }
+  reg->interest = events;
+}
+/*---------------------------------------------------------------------------*/
+static struct epoll_reg *
+epoll_reg_find(int fd)
+{
+  struct epoll_reg *reg;
+
+  for(reg = list_head(registrations); reg != NULL; reg = reg->next) {
+    if(reg->fd == fd) {
+      return reg;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Registrations removed by select_set_callback() are freed here, outside of
+ * the dispatch loop, since pending epoll events may still point to them.
+ */
+static void
+epoll_reg_purge(void)
+{
+  struct epoll_reg *reg;
+  struct epoll_reg *next;
+
+  for(reg = list_head(registrations); reg != NULL; reg = next) {
+    next = reg->next;
+    if(reg->callback == NULL) {
+      list_remove(registrations, reg);
+      free(reg);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+select_set_callback(int fd, const struct select_callback *callback)
+{
+  struct epoll_reg *reg;
+
+  if(fd < 0 || fd >= FD_SETSIZE) {
+    return 0;
+  }
+
+  /* Check that the callback functions are set */
+  if(callback != NULL &&
+     (callback->set_fd == NULL || callback->handle_fd == NULL)) {
+    callback = NULL;
+  }
+
+  reg = epoll_reg_find(fd);
+  if(callback == NULL) {
+    if(reg != NULL) {
+      reg->callback = NULL;
+      if(epoll_fd >= 0) {
+        epoll_update(reg, 0);
+      }
+      reg->unpollable = 0;
+    }
+    return 1;
+  }
+
+  if(reg == NULL) {
+    reg = calloc(1, sizeof(*reg));
+    if(reg == NULL) {
+      return 0;
+    }
+    reg->fd = fd;
+    list_add(registrations, reg);
+  }
+  reg->callback = callback;
+  return 1;
+}
+#else /* SELECT_EPOLL */
 /*---------------------------------------------------------------------------*/
 int
 select_set_callback(int fd, const struct select_callback *callback)
@@ -152,6 +386,7 @@ select_set_callback(int fd, const struct select_callback *callback)
   }
   return 0;
 }
+#endif /* SELECT_EPOLL */
 /*---------------------------------------------------------------------------*/
 #if SELECT_STDIN
 static int
@@ -264,9 +499,11 @@ platform_init_stage_two()
   set_lladdr();
   serial_line_init();
 
+#if SELECT_STDIN
   if (NULL == input_handler) {
     native_uart_set_input(serial_line_input_byte);
   }
+#endif /* SELECT_STDIN */
 
 }
 /*---------------------------------------------------------------------------*/
@@ -286,6 +523,231 @@ platform_init_stage_three()
   setvbuf(stdout, (char *)NULL, _IONBF, 0);
 }
 /*---------------------------------------------------------------------------*/
+#if NATIVE_CONF_VIRTUAL_TIME
+/*
+ * Find the earliest pending etimer or rtimer deadline. Returns 0 if there
+ * is nothing scheduled, in which case only external I/O can wake us up.
+ */
+static int
+next_virtual_deadline(clock_time_t *deadline)
+{
+  rtimer_clock_t rt;
+  clock_time_t t;
+  int found = 0;
+
+  if(etimer_pending()) {
+    *deadline = etimer_next_expiration_time();
+    found = 1;
+  }
+
+  if(rtimer_arch_next_expiration(&rt)) {
+    t = clock_time() + (clock_time_t)RTIMER_CLOCK_DIFF(rt, RTIMER_NOW());
+    if(!found || (long)(t - *deadline) < 0) {
+      *deadline = t;
+      found = 1;
+    }
+  }
+
+  return found;
+}
+#endif /* NATIVE_CONF_VIRTUAL_TIME */
+/*---------------------------------------------------------------------------*/
+/*
+ * How long the main loop may wait for file descriptors to become ready:
+ * only poll them, sleep until something happens (bounded by the backend's
+ * idle timeout), or block until external I/O arrives.
+ */
+#define WAIT_POLL  0
+#define WAIT_IDLE  1
+#define WAIT_BLOCK 2
+/*---------------------------------------------------------------------------*/
+#if SELECT_EPOLL
+static void
+arm_timer(void)
+{
+  struct itimerspec its;
+  clock_time_t deadline;
+  clock_time_t now = clock_time();
+
+  /* Never sleep longer than SELECT_EPOLL_MAX_SLEEP */
+  deadline = now + SELECT_EPOLL_MAX_SLEEP;
+  if(etimer_pending() &&
+     (long)(etimer_next_expiration_time() - deadline) < 0) {
+    deadline = etimer_next_expiration_time();
+  }
+
+  if(timer_armed && deadline == timer_deadline) {
+    return;
+  }
+
+  /* clock_time() is CLOCK_MONOTONIC, so the deadline can be used as is */
+  memset(&its, 0, sizeof(its));
+  its.it_value.tv_sec = deadline / CLOCK_SECOND;
+  its.it_value.tv_nsec = (deadline % CLOCK_SECOND) * (1000000000 / CLOCK_SECOND);
+  if(its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0) {
+    /* An all-zero value would disarm the timer */
+    its.it_value.tv_nsec = 1;
+  }
+  if(timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL) < 0) {
+    perror("timerfd_settime");
+    return;
+  }
+  timer_deadline = deadline;
+  timer_armed = 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wait_fds(int how)
+{
+  struct epoll_event events[SELECT_EPOLL_EVENTS];
+  struct epoll_reg *reg;
+  fd_set fdr;
+  fd_set fdw;
+  uint64_t expirations;
+  int always_ready = 0;
+  int timeout;
+  int n;
+  int i;
+
+  epoll_init();
+  epoll_reg_purge();
+
+  /* Refresh the interest set; epoll_ctl() is only called on changes */
+  FD_ZERO(&fdr);
+  FD_ZERO(&fdw);
+  for(reg = list_head(registrations); reg != NULL; reg = reg->next) {
+    if(reg->callback->set_fd(&fdr, &fdw)) {
+      epoll_update(reg, (FD_ISSET(reg->fd, &fdr) ? EPOLLIN : 0) |
+                   (FD_ISSET(reg->fd, &fdw) ? EPOLLOUT : 0));
+    } else {
+      epoll_update(reg, 0);
+    }
+    always_ready |= reg->unpollable;
+  }
+
+  if(always_ready) {
+    how = WAIT_POLL;
+  }
+
+  if(how == WAIT_IDLE) {
+    arm_timer();
+    timeout = -1;
+  } else {
+    timeout = how == WAIT_BLOCK ? -1 : 0;
+  }
+
+  n = epoll_wait(epoll_fd, events, SELECT_EPOLL_EVENTS, timeout);
+  select_stats.wakeups++;
+  if(n < 0) {
+    if(errno != EINTR) {
+      perror("epoll_wait");
+    }
+    return;
+  }
+
+  FD_ZERO(&fdr);
+  FD_ZERO(&fdw);
+  for(i = 0; i < n; i++) {
+    reg = events[i].data.ptr;
+    if(reg == NULL) {
+      if(read(timer_fd, &expirations, sizeof(expirations)) > 0) {
+        select_stats.timer_wakeups++;
+      }
+      timer_armed = 0;
+      continue;
+    }
+    /* Report errors and hangups as readable so that the handler sees them */
+    if(events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+      FD_SET(reg->fd, &fdr);
+    }
+    if(events[i].events & EPOLLOUT) {
+      FD_SET(reg->fd, &fdw);
+    }
+  }
+
+  if(always_ready) {
+    for(reg = list_head(registrations); reg != NULL; reg = reg->next) {
+      if(reg->unpollable) {
+        if(reg->interest & EPOLLIN) {
+          FD_SET(reg->fd, &fdr);
+        }
+        if(reg->interest & EPOLLOUT) {
+          FD_SET(reg->fd, &fdw);
+        }
+      }
+    }
+  }
+
+  /*
+   * Only dispatch to the descriptors that are actually ready. A handler
+   * may unregister any descriptor; its registration then stays allocated
+   * with a NULL callback until the next epoll_reg_purge().
+   */
+  for(i = 0; i < n; i++) {
+    reg = events[i].data.ptr;
+    if(reg != NULL && reg->callback != NULL) {
+      select_stats.fd_events++;
+      reg->callback->handle_fd(&fdr, &fdw);
+    }
+  }
+  if(always_ready) {
+    for(reg = list_head(registrations); reg != NULL; reg = reg->next) {
+      if(reg->unpollable && reg->callback != NULL) {
+        select_stats.fd_events++;
+        reg->callback->handle_fd(&fdr, &fdw);
+      }
+    }
+  }
+}
+#else /* SELECT_EPOLL */
+static void
+wait_fds(int how)
+{
+  fd_set fdr;
+  fd_set fdw;
+  int maxfd;
+  int i;
+  int retval;
+  struct timeval tv;
+
+  tv.tv_sec = 0;
+  tv.tv_usec = how == WAIT_IDLE ? SELECT_TIMEOUT : (how == WAIT_POLL ? 1 : 0);
+
+  FD_ZERO(&fdr);
+  FD_ZERO(&fdw);
+  maxfd = 0;
+  for(i = 0; i <= select_max; i++) {
+    if(select_callback[i] != NULL && select_callback[i]->set_fd(&fdr, &fdw)) {
+      maxfd = i;
+    }
+  }
+
+  retval = select(maxfd + 1, &fdr, &fdw, NULL, how == WAIT_BLOCK ? NULL : &tv);
+  select_stats.wakeups++;
+  if(retval < 0) {
+    if(errno != EINTR) {
+      perror("select");
+    }
+  } else if(retval > 0) {
+    /* timeout => retval == 0 */
+    for(i = 0; i <= maxfd; i++) {
+      if(select_callback[i] != NULL) {
+        select_stats.fd_events++;
+        select_callback[i]->handle_fd(&fdr, &fdw);
+      }
+    }
+  } else {
+    select_stats.timer_wakeups++;
+  }
+}
+#endif /* SELECT_EPOLL */
+/*---------------------------------------------------------------------------*/
+const struct select_stats *
+select_get_stats(void)
+{
+  return &select_stats;
+}
+/*---------------------------------------------------------------------------*/
 void
 platform_main_loop()
 {
@@ -293,40 +755,36 @@ platform_main_loop()
   select_set_callback(STDIN_FILENO, &stdin_fd);
 #endif /* SELECT_STDIN */
   while(1) {
-    fd_set fdr;
-    fd_set fdw;
-    int maxfd;
-    int i;
     int retval;
-    struct timeval tv;
+#if NATIVE_CONF_VIRTUAL_TIME
+    clock_time_t deadline = 0;
+    int how;
+#endif /* NATIVE_CONF_VIRTUAL_TIME */
 
     retval = process_run();
 
-    tv.tv_sec = 0;
-    tv.tv_usec = retval ? 1 : SELECT_TIMEOUT;
-
-    FD_ZERO(&fdr);
-    FD_ZERO(&fdw);
-    maxfd = 0;
-    for(i = 0; i <= select_max; i++) {
-      if(select_callback[i] != NULL && select_callback[i]->set_fd(&fdr, &fdw)) {
-        maxfd = i;
-      }
+#if NATIVE_CONF_VIRTUAL_TIME
+    rtimer_arch_run_expired();
+
+    /*
+     * Time does not pass while we wait: just poll the file descriptors
+     * unless nothing at all is scheduled, in which case we block until
+     * some external input arrives.
+     */
+    how = WAIT_POLL;
+    if(!retval && !next_virtual_deadline(&deadline)) {
+      how = WAIT_BLOCK;
     }
+    wait_fds(how);
 
-    retval = select(maxfd + 1, &fdr, &fdw, NULL, &tv);
-    if(retval < 0) {
-      if(errno != EINTR) {
-        perror("select");
-      }
-    } else if(retval > 0) {
-      /* timeout => retval == 0 */
-      for(i = 0; i <= maxfd; i++) {
-        if(select_callback[i] != NULL) {
-          select_callback[i]->handle_fd(&fdr, &fdw);
-        }
-      }
+    if(!retval && how == WAIT_POLL && process_nevents() == 0) {
+      /* Nothing to do until the next deadline: jump straight to it */
+      clock_set_virtual_time(deadline);
+      rtimer_arch_run_expired();
     }
+#else /* NATIVE_CONF_VIRTUAL_TIME */
+    wait_fds(retval ? WAIT_POLL : WAIT_IDLE);
+#endif /* NATIVE_CONF_VIRTUAL_TIME */
 
     etimer_request_poll();
   }
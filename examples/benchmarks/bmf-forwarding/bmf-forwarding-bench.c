@@ -0,0 +1,414 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Transmissions and delivery of BMF compared with SMRF in a
+ *         1000-node network
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-sr.h"
+#include "net/ipv6/multicast/uip-mcast6.h"
+#include "net/routing/routing.h"
+#include "net/routing/rpl-classic/rpl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/*---------------------------------------------------------------------------*/
+#define NODES          1000
+#define DEGREE         12    /* Average number of radio neighbours */
+#define TRIALS         20
+#define GROUPS_MAX     8
+#define PAYLOAD_LEN    32
+#define LIFETIME       3600
+
+/* A node of the simulated network, node 0 is the root */
+struct node {
+  double x, y;
+  int parent;
+  int hops;
+  int children;
+  uip_ip6addr_t addr;
+  uint32_t groups;    /* Groups the node is a member of */
+  uint32_t routes;    /* Groups in the SMRF routing table */
+};
+
+static struct node nodes[NODES];
+static int order[NODES];  /* Breadth-first, parents before children */
+static int reachable;
+static int routers;       /* Nodes with children, the root included */
+static int depth;
+static uip_ip6addr_t groups[GROUPS_MAX];
+static uint32_t rng = 1;
+static unsigned long errors;
+/*---------------------------------------------------------------------------*/
+PROCESS(bmf_forwarding_bench_process, "BMF forwarding benchmark");
+AUTOSTART_PROCESSES(&bmf_forwarding_bench_process);
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, unsigned long ops, double seconds)
+{
+  printf("%-40s %8.1f us/datagram\n", name, seconds * 1e6 / ops);
+}
+/*---------------------------------------------------------------------------*/
+static void
+check(int condition, const char *what)
+{
+  if(!condition) {
+    printf("FAIL: %s\n", what);
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+rand32(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+/*---------------------------------------------------------------------------*/
+static int
+in_range(int a, int b)
+{
+  double dx = nodes[a].x - nodes[b].x;
+  double dy = nodes[a].y - nodes[b].y;
+
+  /* A disc that holds DEGREE nodes on average */
+  return dx * dx + dy * dy < DEGREE / (3.14159 * NODES);
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Nodes spread uniformly over a unit square, the root in the middle.
+ * Every node picks a random preferred parent among its neighbours one hop
+ * closer to the root, and advertises it to the root in a non-storing DAO.
+ */
+static void
+topology_build(void)
+{
+  rpl_dag_t *dag = rpl_get_any_dag();
+  int head, tail, i, j, candidates;
+
+  for(i = 0; i < NODES; i++) {
+    nodes[i].x = i == 0 ? 0.5 : (rand32() % 100000) / 100000.0;
+    nodes[i].y = i == 0 ? 0.5 : (rand32() % 100000) / 100000.0;
+    nodes[i].parent = -1;
+    nodes[i].hops = -1;
+    uip_ip6addr(&nodes[i].addr, 0xfd00, 0, 0, 0, 0x0a00, 0, 0, i);
+  }
+  uip_ipaddr_copy(&nodes[0].addr, &dag->dag_id);
+  nodes[0].hops = 0;
+
+  order[0] = 0;
+  for(head = 0, tail = 1; head < tail; head++) {
+    i = order[head];
+    for(j = 0; j < NODES; j++) {
+      if(nodes[j].hops < 0 &&
+         in_range(i, j)) {
+        nodes[j].hops = nodes[i].hops + 1;
+        order[tail++] = j;
+      }
+    }
+  }
+  reachable = tail;
+
+  for(head = 1; head < reachable; head++) {
+    i = order[head];
+    candidates = 0;
+    for(j = 0; j < NODES; j++) {
+      if(nodes[j].hops == nodes[i].hops - 1 &&
+         in_range(i, j) &&
+         rand32() % ++candidates == 0) {
+        nodes[i].parent = j;
+      }
+    }
+    if(nodes[nodes[i].parent].children++ == 0) {
+      routers++;
+    }
+    if(nodes[i].hops > depth) {
+      depth = nodes[i].hops;
+    }
+    check(uip_sr_update_node(dag, &nodes[i].addr,
+                             &nodes[nodes[i].parent].addr,
+                             UIP_SR_INFINITE_LIFETIME) != NULL,
+          "link added to the source routing graph");
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+members_set(int count, int group_count)
+{
+  int g, m, i;
+
+  for(i = 0; i < NODES; i++) {
+    nodes[i].groups = 0;
+  }
+  for(g = 0; g < group_count; g++) {
+    for(m = 0; m < count; m++) {
+      do {
+        i = order[1 + rand32() % (reachable - 1)];
+      } while(nodes[i].groups & (1UL << g));
+      nodes[i].groups |= 1UL << g;
+      check(bmf_member_update(&groups[g], &nodes[i].addr, LIFETIME),
+            "membership added");
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+members_clear(int group_count)
+{
+  int g, i;
+
+  for(i = 1; i < NODES; i++) {
+    for(g = 0; g < group_count; g++) {
+      if(nodes[i].groups & (1UL << g)) {
+        bmf_member_update(&groups[g], &nodes[i].addr, 0);
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * SMRF in MOP 3: every router stores the groups its children advertise,
+ * in a table of 'routes' entries, and advertises what it stored.
+ */
+static void
+smrf_tables(int routes)
+{
+  uint32_t wanted;
+  int i, n, p;
+
+  for(i = 0; i < NODES; i++) {
+    nodes[i].routes = 0;
+  }
+  /* Children before parents, groups that do not fit are lost */
+  for(i = reachable - 1; i > 0; i--) {
+    n = order[i];
+    p = nodes[n].parent;
+    wanted = (nodes[n].groups | nodes[n].routes) & ~nodes[p].routes;
+    for(; wanted != 0; wanted &= wanted - 1) {
+      if(__builtin_popcount(nodes[p].routes) < routes) {
+        nodes[p].routes |= wanted & -wanted;
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* A datagram from the root to group g, as the root's application sends it */
+static void
+datagram_out(int g)
+{
+  memset(uip_buf, 0, UIP_IPUDPH_LEN + PAYLOAD_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &nodes[0].addr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &groups[g]);
+  UIP_UDP_BUF->srcport = UIP_UDP_BUF->destport = UIP_HTONS(0x3333);
+  UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + PAYLOAD_LEN);
+  uip_len = UIP_IPUDPH_LEN + PAYLOAD_LEN;
+  uip_ext_len = 0;
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+  UIP_MCAST6.out();
+}
+/*---------------------------------------------------------------------------*/
+struct result {
+  unsigned long members;
+  unsigned long forwarders;   /* Routers on the paths to the members */
+  unsigned long smrf_tx;
+  unsigned long smrf_delivered;
+  unsigned long bmf_tx;
+  unsigned long bmf_delivered;
+  unsigned long bmf_header;
+  unsigned long flood_tx;
+};
+/*---------------------------------------------------------------------------*/
+/*
+ * Follow one datagram down the tree. A node accepts it only from its
+ * preferred parent and forwards it with a single broadcast.
+ */
+static void
+datagram_follow(int g, struct result *r)
+{
+  static uint8_t bmf_tx[NODES], smrf_tx[NODES], on_path[NODES];
+  int i, n, p;
+
+  memset(on_path, 0, sizeof(on_path));
+  for(i = 1; i < reachable; i++) {
+    n = order[i];
+    if(nodes[n].groups & (1UL << g)) {
+      r->members++;
+      for(p = nodes[n].parent; p != 0 && !on_path[p]; p = nodes[p].parent) {
+        on_path[p] = 1;
+        r->forwarders++;
+      }
+    }
+  }
+
+  bmf_tx[0] = smrf_tx[0] = 1;
+  r->bmf_tx++;
+  r->smrf_tx++;
+  r->bmf_header += uip_len - (UIP_IPUDPH_LEN + PAYLOAD_LEN);
+  for(i = 1; i < reachable; i++) {
+    n = order[i];
+    p = nodes[n].parent;
+    bmf_tx[n] = smrf_tx[n] = 0;
+
+    if(bmf_tx[p]) {
+      if(nodes[n].groups & (1UL << g)) {
+        r->bmf_delivered++;
+      }
+      if(bmf_filter_match(&nodes[n].addr)) {
+        bmf_tx[n] = 1;
+        r->bmf_tx++;
+        r->bmf_header += uip_len - (UIP_IPUDPH_LEN + PAYLOAD_LEN);
+      } else if(on_path[n]) {
+        check(0, "no false negatives");
+      }
+    }
+    if(smrf_tx[p]) {
+      if(nodes[n].groups & (1UL << g)) {
+        r->smrf_delivered++;
+      }
+      if(nodes[n].routes & (1UL << g)) {
+        smrf_tx[n] = 1;
+        r->smrf_tx++;
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+scenario(int members, int group_count, int routes)
+{
+  static struct result r;
+  int t, g;
+
+  memset(&r, 0, sizeof(r));
+  for(t = 0; t < TRIALS; t++) {
+    members_set(members, group_count);
+    smrf_tables(routes);
+    for(g = 0; g < group_count; g++) {
+      datagram_out(g);
+      check(uip_len > 0 && UIP_IP_BUF->proto == UIP_PROTO_HBHO,
+            "BMF option added at the root");
+      datagram_follow(g, &r);
+    }
+    members_clear(group_count);
+  }
+  r.flood_tx = (unsigned long)TRIALS * group_count * routers;
+
+  printf("%4d  %6d  %6d  %9.1f  %7.1f %6.1f%%  %7.1f %6.1f%% %5.1f  %7.1f\n",
+         members, group_count, routes,
+         (double)r.forwarders / (TRIALS * group_count) + 1,
+         (double)r.smrf_tx / (TRIALS * group_count),
+         100.0 * r.smrf_delivered / r.members,
+         (double)r.bmf_tx / (TRIALS * group_count),
+         100.0 * r.bmf_delivered / r.members,
+         (double)r.bmf_header / r.bmf_tx,
+         (double)r.flood_tx / (TRIALS * group_count));
+
+  check(r.bmf_delivered == r.members, "BMF delivers to every member");
+  check(r.bmf_tx >= r.forwarders + TRIALS * group_count,
+        "BMF transmits on every path");
+  if(routes >= group_count) {
+    check(r.smrf_delivered == r.members, "SMRF delivers with room for all");
+    check(r.smrf_tx == r.forwarders + TRIALS * group_count,
+          "SMRF transmits only on the paths");
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(bmf_forwarding_bench_process, ev, data)
+{
+  static int g;
+  static unsigned long ops;
+  static double t;
+  static const int sizes[] = { 5, 20, 50, 100, 200 };
+
+  PROCESS_BEGIN();
+
+  NETSTACK_ROUTING.root_set_prefix(NULL, NULL);
+  NETSTACK_ROUTING.root_start();
+  check(NETSTACK_ROUTING.node_is_root(), "root started");
+
+  for(g = 0; g < GROUPS_MAX; g++) {
+    uip_ip6addr(&groups[g], 0xff1e, 0, 0, 0, 0, 0, 0x89, 0xabc0 + g);
+  }
+
+  topology_build();
+  printf("%d nodes, %d reachable, %d routers, depth %d\n",
+         NODES, reachable, routers, depth);
+  check(uip_sr_num_nodes() == reachable, "every node in the graph");
+
+  /* No members: the root does not send */
+  datagram_out(0);
+  check(uip_len == 0, "datagram to a group without members dropped");
+
+  printf("\nTransmissions per datagram and delivery ratio, %d trials\n",
+         TRIALS);
+  printf("memb  groups  routes  min tx     SMRF tx  deliv    BMF tx  deliv   hdr  all-routers tx\n");
+  for(g = 0; g < sizeof(sizes) / sizeof(sizes[0]); g++) {
+    scenario(sizes[g], 1, 1);
+  }
+  scenario(20, GROUPS_MAX, 1);
+  scenario(20, GROUPS_MAX, 4);
+  scenario(20, GROUPS_MAX, GROUPS_MAX);
+  printf("\n");
+
+  /* Root: one filter per datagram */
+  members_set(50, 1);
+  t = now();
+  for(ops = 0; ops < 2000; ops++) {
+    datagram_out(0);
+  }
+  report("root, filter for 50 members", ops, now() - t);
+  members_clear(1);
+
+  printf("errors: %lu\n", errors);
+  exit(errors == 0 ? 0 : 1);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Throughput benchmark for AES-128 and CCM*
+ */
+
+#include "contiki.h"
+#include "lib/aes-128.h"
+#include "lib/ccm-star.h"
+#include "lib/random.h"
+#include "native-aes-128.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/*---------------------------------------------------------------------------*/
+#define ROUNDS     200000
+#define A_LEN      21  /* 802.15.4 header with aux security header */
+#define M_LEN      100 /* Rest of a full frame, after a 4-byte MIC */
+#define MIC_LEN    4
+/*---------------------------------------------------------------------------*/
+/* RFC 3610, packet vector #1 */
+static const uint8_t rfc3610_key[16] = {
+  0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7,
+  0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf
+};
+static const uint8_t rfc3610_nonce[13] = {
+  0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5
+};
+static const uint8_t rfc3610_ciphertext[23 + 8] = {
+  0x58, 0x8c, 0x97, 0x9a, 0x61, 0xc6, 0x63, 0xd2,
+  0xf0, 0x66, 0xd0, 0xc2, 0xc0, 0xf9, 0x89, 0x80,
+  0x6d, 0x5f, 0x6b, 0x61, 0xda, 0xc3, 0x84,
+  /* MIC */
+  0x17, 0xe8, 0xd1, 0x2c, 0xfd, 0xf9, 0x26, 0xe0
+};
+
+static const uint8_t keys[2][16] = {
+  { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f },
+  { 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f }
+};
+
+/* The portable software driver from os/lib/aes-128.c */
+extern const struct aes_128_driver aes_128_driver;
+
+static unsigned long errors;
+/*---------------------------------------------------------------------------*/
+PROCESS(ccm_star_bench_process, "CCM* benchmark");
+AUTOSTART_PROCESSES(&ccm_star_bench_process);
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, const char *impl, unsigned long bytes,
+       unsigned long ops, double seconds)
+{
+  printf("%-22s %-8s %8.1f MB/s %8.1f ns/op\n", name, impl,
+         bytes / seconds / 1e6, seconds * 1e9 / ops);
+}
+/*---------------------------------------------------------------------------*/
+/* The two-pass CCM* (CBC-MAC, then CTR) that ccm-star.c used to have */
+static void
+ref_ctr_step(const struct aes_128_driver *aes, const uint8_t *nonce,
+             uint8_t pos, uint8_t *m, uint8_t m_len, uint8_t counter)
+{
+  uint8_t a[AES_128_BLOCK_SIZE];
+  uint8_t i;
+
+  a[0] = 1;
+  memcpy(a + 1, nonce, CCM_STAR_NONCE_LENGTH);
+  a[14] = 0;
+  a[15] = counter;
+  aes->encrypt(a);
+  for(i = 0; (pos + i < m_len) && (i < AES_128_BLOCK_SIZE); i++) {
+    m[pos + i] ^= a[i];
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+ref_aead(const struct aes_128_driver *aes, const uint8_t *nonce,
+         uint8_t *m, uint8_t m_len, const uint8_t *a, uint8_t a_len,
+         uint8_t *result, uint8_t mic_len, int forward)
+{
+  uint8_t x[AES_128_BLOCK_SIZE];
+  uint16_t pos;
+  uint8_t i;
+
+  if(!forward) {
+    for(pos = 0, i = 1; pos < m_len; pos += AES_128_BLOCK_SIZE, i++) {
+      ref_ctr_step(aes, nonce, pos, m, m_len, i);
+    }
+  }
+
+  x[0] = (a_len ? (1u << 6) : 0) | (((mic_len - 2u) >> 1) << 3) | 1u;
+  memcpy(x + 1, nonce, CCM_STAR_NONCE_LENGTH);
+  x[14] = 0;
+  x[15] = m_len;
+  aes->encrypt(x);
+  if(a_len) {
+    x[1] ^= a_len;
+    for(i = 2; (i - 2 < a_len) && (i < AES_128_BLOCK_SIZE); i++) {
+      x[i] ^= a[i - 2];
+    }
+    aes->encrypt(x);
+    for(pos = 14; pos < a_len; pos += AES_128_BLOCK_SIZE) {
+      for(i = 0; (pos + i < a_len) && (i < AES_128_BLOCK_SIZE); i++) {
+        x[i] ^= a[pos + i];
+      }
+      aes->encrypt(x);
+    }
+  }
+  for(pos = 0; pos < m_len; pos += AES_128_BLOCK_SIZE) {
+    for(i = 0; (pos + i < m_len) && (i < AES_128_BLOCK_SIZE); i++) {
+      x[i] ^= m[pos + i];
+    }
+    aes->encrypt(x);
+  }
+  ref_ctr_step(aes, nonce, 0, x, AES_128_BLOCK_SIZE, 0);
+  memcpy(result, x, mic_len);
+
+  if(forward) {
+    for(pos = 0, i = 1; pos < m_len; pos += AES_128_BLOCK_SIZE, i++) {
+      ref_ctr_step(aes, nonce, pos, m, m_len, i);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t long_a[255];
+static uint8_t long_m1[255];
+static uint8_t long_m2[255];
+/*---------------------------------------------------------------------------*/
+static void
+check_vectors(void)
+{
+  uint8_t packet[8 + 23 + 8];
+  uint8_t plain[M_LEN];
+  uint8_t m1[M_LEN];
+  uint8_t m2[M_LEN];
+  uint8_t mic1[MIC_LEN];
+  uint8_t mic2[MIC_LEN];
+  int i;
+
+  /* Known answer, through the configured CCM* and AES drivers */
+  for(i = 0; i < 8 + 23; i++) {
+    packet[i] = i;
+  }
+  CCM_STAR.set_key(rfc3610_key);
+  CCM_STAR.aead(rfc3610_nonce, packet + 8, 23, packet, 8,
+                packet + 8 + 23, 8, 1);
+  if(memcmp(packet + 8, rfc3610_ciphertext, sizeof(rfc3610_ciphertext))) {
+    printf("RFC 3610 vector #1: mismatch\n");
+    errors++;
+  }
+
+  /* Fused and two-pass CCM* agree, in both directions */
+  for(i = 0; i < M_LEN; i++) {
+    plain[i] = random_rand();
+  }
+  memcpy(m1, plain, M_LEN);
+  memcpy(m2, plain, M_LEN);
+  aes_128_driver.set_key(keys[0]);
+  CCM_STAR.set_key(keys[0]);
+  ref_aead(&aes_128_driver, rfc3610_nonce, m1, M_LEN, plain, A_LEN,
+           mic1, MIC_LEN, 1);
+  CCM_STAR.aead(rfc3610_nonce, m2, M_LEN, plain, A_LEN, mic2, MIC_LEN, 1);
+  if(memcmp(m1, m2, M_LEN) || memcmp(mic1, mic2, MIC_LEN)) {
+    printf("encryption: mismatch\n");
+    errors++;
+  }
+  CCM_STAR.aead(rfc3610_nonce, m2, M_LEN, plain, A_LEN, mic2, MIC_LEN, 0);
+  if(memcmp(m2, plain, M_LEN) || memcmp(mic1, mic2, MIC_LEN)) {
+    printf("decryption: mismatch\n");
+    errors++;
+  }
+
+  /* The longest data and message, whose last block ends past 255 */
+  for(i = 0; i < sizeof(long_a); i++) {
+    long_a[i] = random_rand();
+    long_m1[i] = long_m2[i] = random_rand();
+  }
+  ref_aead(&aes_128_driver, rfc3610_nonce, long_m1, sizeof(long_m1),
+           long_a, sizeof(long_a), mic1, MIC_LEN, 1);
+  CCM_STAR.aead(rfc3610_nonce, long_m2, sizeof(long_m2), long_a,
+                sizeof(long_a), mic2, MIC_LEN, 1);
+  if(memcmp(long_m1, long_m2, sizeof(long_m1)) ||
+     memcmp(mic1, mic2, MIC_LEN)) {
+    printf("255-byte data and message: mismatch\n");
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_aes(const struct aes_128_driver *aes, const char *impl)
+{
+  uint8_t block[AES_128_BLOCK_SIZE] = { 0 };
+  double t;
+  int r;
+
+  aes->set_key(keys[0]);
+  t = now();
+  for(r = 0; r < ROUNDS * 10; r++) {
+    aes->encrypt(block);
+  }
+  report("AES-128 block", impl, ROUNDS * 10 * AES_128_BLOCK_SIZE,
+         ROUNDS * 10, now() - t);
+
+  /* e.g. TSCH alternating between EB and data keys */
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    aes->set_key(keys[r & 1]);
+    aes->encrypt(block);
+  }
+  report("key switch + block", impl, ROUNDS * AES_128_BLOCK_SIZE,
+         ROUNDS, now() - t);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_ccm(void)
+{
+  uint8_t frame[A_LEN + M_LEN];
+  uint8_t mic[MIC_LEN];
+  double t;
+  int r;
+
+  memset(frame, 0x5a, sizeof(frame));
+
+  aes_128_driver.set_key(keys[0]);
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    ref_aead(&aes_128_driver, rfc3610_nonce, frame + A_LEN, M_LEN,
+             frame, A_LEN, mic, MIC_LEN, r & 1);
+  }
+  report("CCM*, two-pass", "soft", ROUNDS * M_LEN, ROUNDS, now() - t);
+
+  AES_128.set_key(keys[0]);
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    ref_aead(&AES_128, rfc3610_nonce, frame + A_LEN, M_LEN,
+             frame, A_LEN, mic, MIC_LEN, r & 1);
+  }
+  report("CCM*, two-pass", native_aes_128_impl(), ROUNDS * M_LEN, ROUNDS,
+         now() - t);
+
+  CCM_STAR.set_key(keys[0]);
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    CCM_STAR.aead(rfc3610_nonce, frame + A_LEN, M_LEN,
+                  frame, A_LEN, mic, MIC_LEN, r & 1);
+  }
+  report("CCM*, fused", native_aes_128_impl(), ROUNDS * M_LEN, ROUNDS,
+         now() - t);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(ccm_star_bench_process, ev, data)
+{
+  const struct native_aes_128_stats *stats;
+
+  PROCESS_BEGIN();
+
+  check_vectors();
+  bench_aes(&aes_128_driver, "soft");
+  bench_aes(&AES_128, native_aes_128_impl());
+  bench_ccm();
+
+  stats = native_aes_128_get_stats();
+  printf("key schedule cache: %lu hits, %lu misses\n",
+         stats->key_hits, stats->key_misses);
+  printf("errors: %lu\n", errors);
+  exit(errors == 0 ? 0 : 1);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
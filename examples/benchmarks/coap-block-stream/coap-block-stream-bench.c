@@ -0,0 +1,412 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Benchmark and checks for streaming blockwise transfers
+ */
+
+#include "contiki.h"
+#include "coap-engine.h"
+#include "coap-block1.h"
+#include "coap-block-stream.h"
+#include "cfs/cfs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/*---------------------------------------------------------------------------*/
+#define TRANSFER_SIZE (256 * 1024UL)
+#define TOKEN_LEN     2
+#define BUFFER_SIZE   (COAP_MAX_HEADER_SIZE + COAP_MAX_BLOCK_SIZE + 1)
+#define UPLOAD_FILE   "coap-block-stream.bin"
+
+static const uint8_t token[TOKEN_LEN] = { 0x5e, 0x11 };
+static uint8_t reference[TRANSFER_SIZE];
+static uint8_t received[TRANSFER_SIZE];
+static uint8_t upload[TRANSFER_SIZE];
+static uint8_t request_buffer[BUFFER_SIZE];
+static uint8_t payload_buffer[COAP_MAX_BLOCK_SIZE];
+static coap_message_t request[1];
+static coap_message_t response[1];
+static coap_block_source_t log_source;
+static coap_block_source_t log_source2;
+static coap_block_source_t region_source;
+static coap_block_sink_t region_sink;
+static coap_block_sink_t file_sink;
+static unsigned long generator_restarts;
+static unsigned long errors;
+/*---------------------------------------------------------------------------*/
+PROCESS(coap_block_stream_bench_process, "CoAP block stream benchmark");
+AUTOSTART_PROCESSES(&coap_block_stream_bench_process);
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, unsigned long blocks, double seconds)
+{
+  printf("%-40s %6lu blocks %9.1f us/block %8.1f MB/s\n", name, blocks,
+         seconds * 1e6 / blocks, TRANSFER_SIZE / seconds / 1e6);
+}
+/*---------------------------------------------------------------------------*/
+static void
+check(int condition, const char *what)
+{
+  if(!condition) {
+    printf("FAIL: %s\n", what);
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+peer(coap_endpoint_t *ep, uint16_t n)
+{
+  memset(ep, 0, sizeof(*ep));
+  uip_ip6addr(&ep->ipaddr, 0xfd00, 0, 0, 0, 0, 0, 0, n);
+  ep->port = UIP_HTONS(COAP_DEFAULT_PORT);
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * A log rendered line by line: state[0] is the entry, state[1] the
+ * position in its line.
+ */
+static int
+log_read(const coap_block_source_t *source, coap_block_cursor_t *cursor,
+         uint8_t *buffer, uint16_t len)
+{
+  char line[48];
+  int line_len;
+  uint16_t n;
+
+  if(cursor->offset == 0 && cursor->state[0] == 0 && cursor->state[1] == 0) {
+    generator_restarts++;
+  }
+  if(cursor->offset >= source->size) {
+    return 0;
+  }
+  line_len = snprintf(line, sizeof(line), "%06lu t=%lu temp=%u.%u\n",
+                      (unsigned long)cursor->state[0],
+                      (unsigned long)cursor->state[0] * 37,
+                      (unsigned)(18 + cursor->state[0] % 9),
+                      (unsigned)(cursor->state[0] % 10));
+  n = MIN(len, line_len - cursor->state[1]);
+  n = MIN(n, source->size - cursor->offset);
+  memcpy(buffer, line + cursor->state[1], n);
+  cursor->offset += n;
+  cursor->state[1] += n;
+  if(cursor->state[1] == line_len) {
+    cursor->state[0]++;
+    cursor->state[1] = 0;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_request(const coap_endpoint_t *ep, uint8_t code, uint32_t block_option,
+             unsigned int block_number, const uint8_t *payload, uint16_t len)
+{
+  coap_writer_t w;
+  size_t message_len;
+
+  coap_writer_init(&w, request_buffer, BUFFER_SIZE - 1, COAP_TYPE_CON, code,
+                   0x1234, token, TOKEN_LEN);
+  coap_writer_add_string_option(&w, COAP_OPTION_URI_PATH, "log", 3, '/');
+  if(block_number) {
+    coap_writer_add_int_option(&w, block_number, block_option);
+  }
+  message_len = coap_writer_finish(&w, payload, len);
+  check(coap_parse_message(request, request_buffer, message_len) == NO_ERROR,
+        "request parsed");
+  coap_set_src_endpoint(request, ep);
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, 0x1234);
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+block_option(uint32_t num, uint8_t more, uint16_t size)
+{
+  uint8_t szx = 0;
+
+  while((16 << szx) < size) {
+    szx++;
+  }
+  return num << 4 | (more ? 0x08 : 0) | szx;
+}
+/*---------------------------------------------------------------------------*/
+/* One Block2 GET through the stream engine, as a resource handler would */
+static int
+get_block(const coap_endpoint_t *ep, const coap_block_source_t *source,
+          uint32_t num, uint16_t size, uint8_t *more)
+{
+  int32_t offset = num * size;
+  int n;
+
+  make_request(ep, COAP_GET, block_option(num, 0, size), COAP_OPTION_BLOCK2,
+               NULL, 0);
+  coap_status_code = NO_ERROR;
+  n = coap_block_stream_get(source, request, response, payload_buffer, size,
+                            &offset);
+  if(n < 0) {
+    *more = 0;
+    return -1;
+  }
+  memcpy(received + num * size, response->payload, response->payload_len);
+  *more = offset != -1;
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/* What an offset-driven handler does: render everything up to the block */
+static int
+get_block_regenerated(const coap_block_source_t *source, uint32_t num,
+                      uint16_t size, uint8_t *more)
+{
+  coap_block_cursor_t cursor;
+  uint32_t offset = num * size;
+  int n = 0;
+
+  memset(&cursor, 0, sizeof(cursor));
+  while(cursor.offset < offset) {
+    source->read(source, &cursor, payload_buffer,
+                 MIN(size, offset - cursor.offset));
+  }
+  while(n < size && (size_t)cursor.offset < source->size) {
+    n += source->read(source, &cursor, payload_buffer + n, size - n);
+  }
+  memcpy(received + offset, payload_buffer, n);
+  *more = cursor.offset < source->size;
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_block2(void)
+{
+  coap_endpoint_t ep;
+  unsigned long blocks;
+  uint32_t num;
+  uint8_t more;
+  double start;
+  uint16_t size;
+
+  peer(&ep, 1);
+  for(size = 64; size <= COAP_MAX_BLOCK_SIZE; size *= 4) {
+    char name[48];
+
+    memset(received, 0, sizeof(received));
+    generator_restarts = 0;
+    start = now();
+    num = 0;
+    do {
+      check(get_block(&ep, &log_source, num++, size, &more) >= 0, "GET block");
+    } while(more);
+    snprintf(name, sizeof(name), "Block2 %u, generator with cursor", size);
+    report(name, num, now() - start);
+    check(memcmp(received, reference, TRANSFER_SIZE) == 0, "generated log");
+    check(generator_restarts == 1, "generator ran once");
+  }
+
+  memset(received, 0, sizeof(received));
+  start = now();
+  for(blocks = 0; get_block_regenerated(&log_source, blocks, 1024, &more) > 0
+      && more; blocks++);
+  report("Block2 1024, regenerated per block", blocks + 1, now() - start);
+  check(memcmp(received, reference, TRANSFER_SIZE) == 0, "regenerated log");
+
+  memset(received, 0, sizeof(received));
+  start = now();
+  num = 0;
+  do {
+    check(get_block(&ep, &region_source, num++, 1024, &more) >= 0,
+          "GET region block");
+  } while(more);
+  report("Block2 1024, flash region", num, now() - start);
+  check(memcmp(received, reference, TRANSFER_SIZE) == 0, "region");
+}
+/*---------------------------------------------------------------------------*/
+static int
+put_block(const coap_endpoint_t *ep, const coap_block_sink_t *sink,
+          uint32_t num, uint16_t size)
+{
+  uint32_t offset = num * size;
+  uint16_t len = MIN(size, TRANSFER_SIZE - offset);
+  uint8_t more = offset + len < TRANSFER_SIZE;
+
+  make_request(ep, COAP_PUT, block_option(num, more, size),
+               COAP_OPTION_BLOCK1, reference + offset, len);
+  return coap_block_stream_put(sink, request, response);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_block1(void)
+{
+  coap_endpoint_t ep;
+  uint32_t num, blocks = TRANSFER_SIZE / 1024;
+  size_t len = 0;
+  double start;
+  int fd;
+  int r;
+
+  peer(&ep, 2);
+
+  memset(upload, 0, sizeof(upload));
+  start = now();
+  for(num = 0; num < blocks; num++) {
+    make_request(&ep, COAP_PUT,
+                 block_option(num, num + 1 < blocks, 1024),
+                 COAP_OPTION_BLOCK1, reference + num * 1024, 1024);
+    r = coap_block1_handler(request, response, upload, &len, sizeof(upload));
+    check(r == (num + 1 < blocks), "coap_block1_handler");
+  }
+  report("Block1 1024, coap_block1_handler", blocks, now() - start);
+  check(len == TRANSFER_SIZE && memcmp(upload, reference, len) == 0,
+        "coap_block1_handler upload");
+
+  memset(upload, 0, sizeof(upload));
+  start = now();
+  for(num = 0; num < blocks; num++) {
+    r = put_block(&ep, &region_sink, num, 1024);
+    check(r == (num + 1 < blocks), "region sink");
+  }
+  report("Block1 1024, RAM sink", blocks, now() - start);
+  check(memcmp(upload, reference, TRANSFER_SIZE) == 0, "RAM sink upload");
+
+  start = now();
+  for(num = 0; num < blocks; num++) {
+    r = put_block(&ep, &file_sink, num, 1024);
+    check(r == (num + 1 < blocks), "file sink");
+  }
+  report("Block1 1024, CFS file sink", blocks, now() - start);
+  memset(upload, 0, sizeof(upload));
+  fd = cfs_open(UPLOAD_FILE, CFS_READ);
+  check(fd >= 0 && cfs_read(fd, upload, sizeof(upload)) == TRANSFER_SIZE &&
+        memcmp(upload, reference, TRANSFER_SIZE) == 0, "file sink upload");
+  cfs_close(fd);
+  cfs_remove(UPLOAD_FILE);
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_transfers(void)
+{
+  coap_endpoint_t a, b;
+  uint8_t first[64];
+  uint8_t more;
+  uint32_t num, size1;
+  int i;
+
+  peer(&a, 10);
+  peer(&b, 11);
+
+  /* Two clients and two resources interleaved keep their own cursors */
+  memset(received, 0, sizeof(received));
+  generator_restarts = 0;
+  for(num = 0; num < 64; num++) {
+    get_block(&a, &log_source, num, 256, &more);
+    get_block(&b, &log_source, num, 256, &more);
+    get_block(&a, &log_source2, num, 256, &more);
+  }
+  check(generator_restarts == 3, "interleaved transfers keep their cursors");
+  check(memcmp(received, reference, 64 * 256) == 0, "interleaved content");
+
+  /* The last block again comes from the checkpoint */
+  get_block(&a, &log_source, 64, 256, &more);
+  memcpy(first, response->payload, sizeof(first));
+  get_block(&a, &log_source, 64, 256, &more);
+  check(memcmp(first, response->payload, sizeof(first)) == 0 &&
+        generator_restarts == 3, "repeated block from checkpoint");
+
+  /* Size2 with the first block */
+  get_block(&b, &region_source, 0, 64, &more);
+  check(coap_is_option(response, COAP_OPTION_SIZE2) &&
+        response->size2 == TRANSFER_SIZE, "Size2");
+
+  /* More transfers than slots: the oldest is dropped */
+  for(i = 0; i < COAP_BLOCK_TRANSFERS + 1; i++) {
+    peer(&a, 20 + i);
+    get_block(&a, &log_source, 0, 64, &more);
+  }
+  check(generator_restarts == 3 + COAP_BLOCK_TRANSFERS + 1, "new transfers");
+
+  /* Block1 out of order and too large */
+  peer(&a, 30);
+  check(put_block(&a, &region_sink, 0, 1024) == 1, "first block");
+  check(put_block(&a, &region_sink, 2, 1024) < 0 &&
+        response->code == REQUEST_ENTITY_INCOMPLETE_4_08, "out of order");
+  check(put_block(&a, &region_sink, 1, 1024) < 0, "transfer dropped");
+
+  /* The last block again once the upload is complete */
+  peer(&a, 31);
+  for(num = 0; num < TRANSFER_SIZE / 1024; num++) {
+    put_block(&a, &region_sink, num, 1024);
+  }
+  check(put_block(&a, &region_sink, num - 1, 1024) == 0 &&
+        response->code == CHANGED_2_04, "repeated last block");
+
+  make_request(&a, COAP_PUT, block_option(0, 1, 1024), COAP_OPTION_BLOCK1,
+               reference, 1024);
+  coap_set_header_size1(request, TRANSFER_SIZE + 1);
+  check(coap_block_stream_put(&region_sink, request, response) < 0 &&
+        response->code == REQUEST_ENTITY_TOO_LARGE_4_13 &&
+        coap_get_header_size1(response, &size1) && size1 == TRANSFER_SIZE,
+        "Size1 beyond the sink");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coap_block_stream_bench_process, ev, data)
+{
+  coap_block_cursor_t cursor;
+
+  PROCESS_BEGIN();
+
+  coap_block_source_generator(&log_source, log_read, NULL, TRANSFER_SIZE);
+  coap_block_source_generator(&log_source2, log_read, NULL, TRANSFER_SIZE);
+  memset(&cursor, 0, sizeof(cursor));
+  while(cursor.offset < TRANSFER_SIZE) {
+    log_read(&log_source, &cursor, reference + cursor.offset,
+             MIN(1024, TRANSFER_SIZE - cursor.offset));
+  }
+  coap_block_source_region(&region_source, reference, TRANSFER_SIZE);
+  coap_block_sink_region(&region_sink, upload, sizeof(upload));
+  coap_block_sink_cfs(&file_sink, UPLOAD_FILE, TRANSFER_SIZE);
+
+  printf("Transferring %lu bytes\n", TRANSFER_SIZE);
+  bench_block2();
+  bench_block1();
+  check_transfers();
+
+  printf("errors: %lu\n", errors);
+  exit(errors == 0 ? 0 : 1);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,490 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Benchmark and checks for the CoAP response cache and proxy
+ */
+
+#include "contiki.h"
+#include "coap-engine.h"
+#include "coap-cache.h"
+#include "coap-transactions.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/*---------------------------------------------------------------------------*/
+#define ROUNDS      100000
+/* Requests that call the handler are fewer, they take longer */
+#define HANDLER_ROUNDS 10000
+/* Time the handler spends reading the sensor, busy-waiting for it */
+#define SENSOR_READ_US 100
+#define CLIENTS     16
+#define TOKEN_LEN   2
+#define PROXY_URI   "coap://[fd00::200]/sensors/humidity"
+
+static const uint8_t token[TOKEN_LEN] = { 0xca, 0xc4 };
+static const uint8_t node_etag[2] = { 0xe7, 0x01 };
+static uint8_t buffer[COAP_MAX_PACKET_SIZE + 1];
+static coap_message_t message[1];
+static coap_message_t response[1];
+static unsigned long handler_calls;
+static unsigned long errors;
+static int temperature = 215;
+static struct etimer et;
+/*---------------------------------------------------------------------------*/
+PROCESS(coap_cache_bench_process, "CoAP cache benchmark");
+AUTOSTART_PROCESSES(&coap_cache_bench_process);
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, unsigned long ops, double seconds)
+{
+  printf("%-40s %8.1f ns/request\n", name, seconds * 1e9 / ops);
+}
+/*---------------------------------------------------------------------------*/
+static void
+report_hits(const char *name, const coap_cache_stats_t *stats)
+{
+  unsigned long lookups = stats->hits + stats->misses;
+
+  printf("%-40s %lu/%lu hits (%.2f%%), %lu coalesced, %lu stored\n", name,
+         (unsigned long)stats->hits, lookups,
+         lookups ? 100.0 * stats->hits / lookups : 0.0,
+         (unsigned long)stats->coalesced, (unsigned long)stats->stores);
+}
+/*---------------------------------------------------------------------------*/
+static void
+check(int condition, const char *what)
+{
+  if(!condition) {
+    printf("FAIL: %s\n", what);
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+peer(coap_endpoint_t *ep, uint16_t n)
+{
+  memset(ep, 0, sizeof(*ep));
+  uip_ip6addr(&ep->ipaddr, 0xfd00, 0, 0, 0, 0, 0, 0, n);
+  ep->port = UIP_HTONS(COAP_DEFAULT_PORT);
+}
+/*---------------------------------------------------------------------------*/
+/* Stands for a sensor conversion, which takes from tens of microseconds
+   for an on-chip ADC to milliseconds for an I2C sensor */
+static void
+read_sensor(void)
+{
+  double end = now() + SENSOR_READ_US / 1e6;
+
+  while(now() < end);
+}
+/*---------------------------------------------------------------------------*/
+/* The same rendering for both resources, only one sets Max-Age */
+static void
+render(coap_message_t *request, coap_message_t *response, uint8_t *buffer)
+{
+  unsigned int accept = TEXT_PLAIN;
+  int len;
+
+  handler_calls++;
+  read_sensor();
+  coap_get_header_accept(request, &accept);
+  if(accept == APPLICATION_JSON) {
+    len = snprintf((char *)buffer, COAP_MAX_CHUNK_SIZE,
+                   "{\"temp\":%d.%d,\"unit\":\"C\"}",
+                   temperature / 10, temperature % 10);
+  } else {
+    accept = TEXT_PLAIN;
+    len = snprintf((char *)buffer, COAP_MAX_CHUNK_SIZE, "%d.%d C",
+                   temperature / 10, temperature % 10);
+  }
+  coap_set_header_content_format(response, accept);
+  coap_set_payload(response, buffer, len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+temperature_get(coap_message_t *request, coap_message_t *response,
+                uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  uint8_t etag[2] = { temperature >> 8, temperature };
+
+  render(request, response, buffer);
+  coap_set_header_etag(response, etag, sizeof(etag));
+  coap_set_header_max_age(response, 30);
+}
+/*---------------------------------------------------------------------------*/
+static void
+temperature_put(coap_message_t *request, coap_message_t *response,
+                uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  temperature++;
+  coap_set_status_code(response, CHANGED_2_04);
+}
+/*---------------------------------------------------------------------------*/
+static void
+counter_get(coap_message_t *request, coap_message_t *response,
+            uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  render(request, response, buffer);
+}
+/*---------------------------------------------------------------------------*/
+RESOURCE(res_temperature, "title=\"Temperature\"", temperature_get, NULL,
+         temperature_put, NULL);
+RESOURCE(res_counter, "title=\"Uncached\"", counter_get, NULL, NULL, NULL);
+/*---------------------------------------------------------------------------*/
+static size_t
+make_request(coap_message_type_t type, uint8_t code, uint16_t mid,
+             const char *path, int accept, const uint8_t *etag,
+             const char *proxy_uri)
+{
+  coap_writer_t w;
+
+  coap_writer_init(&w, buffer, sizeof(buffer), type, code, mid, token,
+                   TOKEN_LEN);
+  if(etag != NULL) {
+    coap_writer_add_option(&w, COAP_OPTION_ETAG, etag, 2);
+  }
+  if(path != NULL) {
+    coap_writer_add_string_option(&w, COAP_OPTION_URI_PATH, path,
+                                  strlen(path), '/');
+  }
+  if(accept != COAP_CACHE_ANY_FORMAT) {
+    coap_writer_add_int_option(&w, COAP_OPTION_ACCEPT, accept);
+  }
+  if(proxy_uri != NULL) {
+    coap_writer_add_option(&w, COAP_OPTION_PROXY_URI, proxy_uri,
+                           strlen(proxy_uri));
+  }
+  return coap_writer_finish(&w, NULL, 0);
+}
+/*---------------------------------------------------------------------------*/
+/* A request as the engine receives it from a client */
+static int
+receive(const coap_endpoint_t *ep, coap_message_type_t type, uint8_t code,
+        uint16_t mid, const char *path, int accept, const char *proxy_uri)
+{
+  size_t len = make_request(type, code, mid, path, accept, NULL, proxy_uri);
+  return coap_receive(ep, buffer, len);
+}
+/*---------------------------------------------------------------------------*/
+/* A request parsed for calling the cache directly */
+static void
+parse_request(uint8_t code, const char *path, int accept,
+              const uint8_t *etag)
+{
+  size_t len = make_request(COAP_TYPE_CON, code, 0x1234, path, accept, etag,
+                            NULL);
+  check(coap_parse_message(message, buffer, len) == NO_ERROR,
+        "request parsed");
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, 0x1234);
+}
+/*---------------------------------------------------------------------------*/
+/* The proxy's request to the node, among the Message IDs used since base */
+static coap_transaction_t *
+find_upstream(const coap_endpoint_t *node, uint16_t base, unsigned *count)
+{
+  coap_transaction_t *found = NULL;
+  coap_transaction_t *t;
+  uint16_t mid;
+
+  *count = 0;
+  for(mid = base; mid != (uint16_t)(base + 4 * CLIENTS + 16); mid++) {
+    if((t = coap_get_transaction(node, mid)) != NULL) {
+      found = t;
+      (*count)++;
+    }
+  }
+  return found;
+}
+/*---------------------------------------------------------------------------*/
+/* The node answers the proxy's request t with a piggybacked response */
+static void
+node_reply(const coap_endpoint_t *node, coap_transaction_t *t, uint8_t code,
+           uint32_t max_age, const char *payload)
+{
+  static uint8_t reply[COAP_MAX_PACKET_SIZE + 1];
+  coap_writer_t w;
+  uint16_t mid;
+  size_t len;
+
+  memcpy(buffer, t->message, t->message_len);
+  check(coap_parse_message(message, buffer, t->message_len) == NO_ERROR,
+        "upstream request parsed");
+  mid = message->mid;
+  coap_writer_init(&w, reply, sizeof(reply), COAP_TYPE_ACK, code, mid,
+                   message->token, message->token_len);
+  coap_writer_add_option(&w, COAP_OPTION_ETAG, node_etag, sizeof(node_etag));
+  if(payload != NULL) {
+    coap_writer_add_int_option(&w, COAP_OPTION_CONTENT_FORMAT, TEXT_PLAIN);
+  }
+  coap_writer_add_int_option(&w, COAP_OPTION_MAX_AGE, max_age);
+  len = coap_writer_finish(&w, payload, payload ? strlen(payload) : 0);
+  coap_receive(node, reply, len);
+  check(coap_get_transaction(node, mid) == NULL, "upstream request closed");
+}
+/*---------------------------------------------------------------------------*/
+/* Whether the next option numbered number of a message has the value */
+static int
+next_option_is(coap_option_iterator_t *it, unsigned int number,
+               const char *value)
+{
+  coap_raw_option_t option;
+
+  return coap_option_find(it, number, &option) > 0 &&
+         option.len == strlen(value) &&
+         memcmp(option.value, value, option.len) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_local(void)
+{
+  const coap_cache_stats_t *stats = coap_cache_get_stats();
+  coap_endpoint_t clients[CLIENTS];
+  coap_endpoint_t secure;
+  unsigned long calls;
+  unsigned long i;
+  const uint8_t *etag;
+  uint32_t max_age;
+  double start;
+
+  for(i = 0; i < CLIENTS; i++) {
+    peer(&clients[i], 0x100 + i);
+  }
+
+  calls = handler_calls;
+  start = now();
+  for(i = 0; i < HANDLER_ROUNDS; i++) {
+    receive(&clients[i % CLIENTS], COAP_TYPE_CON, COAP_GET, i,
+            "sensors/uncached", COAP_CACHE_ANY_FORMAT, NULL);
+  }
+  report("GET without Max-Age (handler)", HANDLER_ROUNDS, now() - start);
+  check(handler_calls - calls == HANDLER_ROUNDS,
+        "resource without Max-Age not cached");
+
+  coap_cache_flush();
+  calls = handler_calls;
+  start = now();
+  for(i = 0; i < ROUNDS; i++) {
+    receive(&clients[i % CLIENTS], COAP_TYPE_CON, COAP_GET, i,
+            "sensors/temperature", i % 4 ? COAP_CACHE_ANY_FORMAT :
+            APPLICATION_JSON, NULL);
+  }
+  report("GET with Max-Age 30 (cache)", ROUNDS, now() - start);
+  printf("%-40s %lu of %lu requests\n", "handler calls", handler_calls - calls,
+         (unsigned long)ROUNDS);
+  check(handler_calls - calls == 2, "one handler call per Accept value");
+  report_hits("local cache", stats);
+
+  /* A client holding the ETag gets 2.03 and the remaining freshness */
+  parse_request(COAP_GET, "sensors/temperature", COAP_CACHE_ANY_FORMAT, NULL);
+  check(coap_cache_handle_request(message, response), "served from cache");
+  check(coap_get_header_etag(response, &etag) == 2, "ETag served");
+  coap_get_header_max_age(response, &max_age);
+  check(max_age > 0 && max_age <= 30, "Max-Age is the remaining freshness");
+  parse_request(COAP_GET, "sensors/temperature", COAP_CACHE_ANY_FORMAT,
+                etag);
+  check(coap_cache_handle_request(message, response), "validated from cache");
+  check(response->code == VALID_2_03 && response->payload_len == 0,
+        "2.03 Valid without payload");
+
+  /* PUT invalidates both representations */
+  calls = handler_calls;
+  receive(&clients[0], COAP_TYPE_CON, COAP_PUT, 1, "sensors/temperature",
+          COAP_CACHE_ANY_FORMAT, NULL);
+  check(stats->invalidations == 2, "PUT invalidates every Accept value");
+  receive(&clients[0], COAP_TYPE_CON, COAP_GET, 2, "sensors/temperature",
+          COAP_CACHE_ANY_FORMAT, NULL);
+  receive(&clients[0], COAP_TYPE_CON, COAP_GET, 3, "sensors/temperature",
+          COAP_CACHE_ANY_FORMAT, NULL);
+  check(handler_calls - calls == 1, "fetched once after PUT");
+
+  /* A response to a secure request is kept apart from insecure ones */
+  coap_cache_flush();
+  secure = clients[1];
+  secure.secure = 1;
+  parse_request(COAP_GET, "sensors/temperature", COAP_CACHE_ANY_FORMAT, NULL);
+  coap_set_src_endpoint(message, &secure);
+  check(!coap_cache_handle_request(message, response), "secure miss");
+  coap_set_header_max_age(response, 30);
+  coap_set_payload(response, "21", 2);
+  coap_cache_handle_response(message, response);
+  parse_request(COAP_GET, "sensors/temperature", COAP_CACHE_ANY_FORMAT, NULL);
+  coap_set_src_endpoint(message, &clients[1]);
+  check(!coap_cache_handle_request(message, response),
+        "secure entry not served to an insecure request");
+  parse_request(COAP_GET, "sensors/temperature", COAP_CACHE_ANY_FORMAT, NULL);
+  coap_set_src_endpoint(message, &secure);
+  check(coap_cache_handle_request(message, response),
+        "secure entry served to a secure request");
+
+  /* Removing the resource drops its entries */
+  coap_remove_resource(&res_temperature);
+  check(stats->invalidations == 1, "removal invalidates the resource");
+  parse_request(COAP_GET, "sensors/temperature", COAP_CACHE_ANY_FORMAT, NULL);
+  coap_set_src_endpoint(message, &secure);
+  check(!coap_cache_handle_request(message, response),
+        "nothing served after removal");
+  coap_activate_resource(&res_temperature, "sensors/temperature");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coap_cache_bench_process, ev, data)
+{
+  static coap_endpoint_t clients[CLIENTS];
+  static coap_endpoint_t node;
+  static coap_transaction_t *t;
+  static const coap_cache_stats_t *stats;
+  static unsigned count;
+  static uint16_t base;
+  static unsigned long i;
+  static double start;
+  const uint8_t *etag;
+
+  PROCESS_BEGIN();
+
+  coap_engine_init();
+  coap_activate_resource(&res_temperature, "sensors/temperature");
+  coap_activate_resource(&res_counter, "sensors/uncached");
+  stats = coap_cache_get_stats();
+
+  bench_local();
+
+  coap_cache_flush();
+  for(i = 0; i < CLIENTS; i++) {
+    peer(&clients[i], 0x100 + i);
+  }
+  peer(&node, 0x200);
+
+  /* Clients asking at once share one request into the mesh */
+  base = coap_get_mid();
+  for(i = 0; i < CLIENTS; i++) {
+    check(receive(&clients[i], COAP_TYPE_NON, COAP_GET, 0x5000 + i, NULL,
+                  COAP_CACHE_ANY_FORMAT, PROXY_URI) == MANUAL_RESPONSE,
+          "proxied request awaits the node");
+  }
+  t = find_upstream(&node, base, &count);
+  check(t != NULL && count == 1, "one upstream request for all clients");
+  check(stats->coalesced == CLIENTS - 1, "requests coalesced");
+  if(t == NULL) {
+    printf("errors: %lu\n", errors);
+    exit(1);
+  }
+  node_reply(&node, t, CONTENT_2_05, 1, "48.5 %RH");
+  check(message->uri_path_len == 16 &&
+        memcmp(message->uri_path, "sensors/humidity", 16) == 0,
+        "Uri-Path from the Proxy-Uri");
+
+  start = now();
+  for(i = 0; i < ROUNDS; i++) {
+    receive(&clients[i % CLIENTS], COAP_TYPE_NON, COAP_GET, i, NULL,
+            COAP_CACHE_ANY_FORMAT, PROXY_URI);
+  }
+  report("proxied GET (cache)", ROUNDS, now() - start);
+  printf("%-40s %lu of %lu requests\n", "upstream requests", 1UL,
+         (unsigned long)ROUNDS + CLIENTS);
+  report_hits("proxy cache", stats);
+  check(stats->hits == ROUNDS, "proxied GETs served from the cache");
+
+  /* Once stale, the entry is revalidated with its ETag */
+  etimer_set(&et, CLOCK_SECOND + CLOCK_SECOND / 4);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  base = coap_get_mid();
+  receive(&clients[0], COAP_TYPE_NON, COAP_GET, 0x6000, NULL,
+          COAP_CACHE_ANY_FORMAT, PROXY_URI);
+  t = find_upstream(&node, base, &count);
+  check(t != NULL && count == 1, "stale entry fetched again");
+  if(t != NULL) {
+    node_reply(&node, t, VALID_2_03, 60, NULL);
+    check(coap_get_header_etag(message, &etag) == sizeof(node_etag) &&
+          memcmp(etag, node_etag, sizeof(node_etag)) == 0,
+          "revalidated with the cached ETag");
+  }
+  i = stats->hits;
+  receive(&clients[1], COAP_TYPE_NON, COAP_GET, 0x6001, NULL,
+          COAP_CACHE_ANY_FORMAT, PROXY_URI);
+  check(stats->hits == i + 1, "fresh again after 2.03");
+
+  /* PUT is forwarded and invalidates the entry */
+  base = coap_get_mid();
+  receive(&clients[2], COAP_TYPE_NON, COAP_PUT, 0x6002, NULL,
+          COAP_CACHE_ANY_FORMAT, PROXY_URI);
+  check(coap_cache_find(PROXY_URI, strlen(PROXY_URI),
+                        COAP_CACHE_ANY_FORMAT, 0) == NULL,
+        "PUT invalidates the proxy entry");
+  t = find_upstream(&node, base, &count);
+  check(t != NULL && count == 1, "PUT forwarded");
+  if(t != NULL) {
+    node_reply(&node, t, CHANGED_2_04, 60, NULL);
+  }
+
+  /* Path and query segments are percent-decoded one by one */
+  base = coap_get_mid();
+  receive(&clients[3], COAP_TYPE_NON, COAP_GET, 0x6003, NULL,
+          COAP_CACHE_ANY_FORMAT,
+          "coap://[fd00::200]/files/a%2Fb/%7Euser?name=x%26y&unit=%25");
+  t = find_upstream(&node, base, &count);
+  check(t != NULL && count == 1, "percent-encoded request forwarded");
+  if(t != NULL) {
+    coap_option_iterator_t it;
+
+    coap_option_iterator_init(&it, t->message, t->message_len);
+    check(next_option_is(&it, COAP_OPTION_URI_PATH, "files") &&
+          next_option_is(&it, COAP_OPTION_URI_PATH, "a/b") &&
+          next_option_is(&it, COAP_OPTION_URI_PATH, "~user") &&
+          next_option_is(&it, COAP_OPTION_URI_QUERY, "name=x&y") &&
+          next_option_is(&it, COAP_OPTION_URI_QUERY, "unit=%"),
+          "Uri-Path and Uri-Query percent-decoded");
+    node_reply(&node, t, CONTENT_2_05, 0, "ok");
+  }
+  check(receive(&clients[3], COAP_TYPE_NON, COAP_GET, 0x6004, NULL,
+                COAP_CACHE_ANY_FORMAT, "coap://[fd00::200]/x%4") ==
+        BAD_REQUEST_4_00, "invalid percent-encoding rejected");
+
+  /* Anything but an IPv6 literal is not proxied */
+  check(receive(&clients[3], COAP_TYPE_NON, COAP_GET, 0x6005, NULL,
+                COAP_CACHE_ANY_FORMAT, "coap://node.local/x") ==
+        PROXYING_NOT_SUPPORTED_5_05, "host names not proxied");
+
+  printf("errors: %lu\n", errors);
+  exit(errors == 0 ? 0 : 1);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
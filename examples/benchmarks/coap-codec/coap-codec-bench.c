@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Micro-benchmark for CoAP message parsing and serialization
+ */
+
+#include "contiki.h"
+#include "coap.h"
+#include "coap-engine.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/*---------------------------------------------------------------------------*/
+#define ROUNDS 1000000
+#define RECEIVE_ROUNDS 200000
+/*---------------------------------------------------------------------------*/
+struct captured_message {
+  const char *name;
+  uint8_t len;
+  uint8_t data[64];
+};
+
+/* Messages as seen on the wire between a CoAP client and a sensor node */
+static const struct captured_message messages[] = {
+  { "CON GET /sensors/temperature?unit=c", 35,
+    { 0x44, 0x01, 0x1a, 0x2b, 0x12, 0x34, 0x56, 0x78, 0xb7, 0x73, 0x65, 0x6e,
+      0x73, 0x6f, 0x72, 0x73, 0x0b, 0x74, 0x65, 0x6d, 0x70, 0x65, 0x72, 0x61,
+      0x74, 0x75, 0x72, 0x65, 0x46, 0x75, 0x6e, 0x69, 0x74, 0x3d, 0x63 } },
+  { "CON GET /3303/0/5700, Observe", 28,
+    { 0x48, 0x01, 0x1a, 0x2c, 0xa1, 0xb2, 0xc3, 0xd4, 0xe5, 0xf6, 0x07, 0x18,
+      0x60, 0x54, 0x33, 0x33, 0x30, 0x33, 0x01, 0x30, 0x04, 0x35, 0x37, 0x30,
+      0x30, 0x62, 0x2d, 0x16 } },
+  { "CON GET /.well-known/core, Block2", 25,
+    { 0x42, 0x01, 0x1a, 0x2d, 0x99, 0x01, 0xbb, 0x2e, 0x77, 0x65, 0x6c, 0x6c,
+      0x2d, 0x6b, 0x6e, 0x6f, 0x77, 0x6e, 0x04, 0x63, 0x6f, 0x72, 0x65, 0xc1,
+      0x22 } },
+  { "NON POST /actuators/leds?color=r", 37,
+    { 0x51, 0x02, 0x1a, 0x2e, 0x42, 0xb9, 0x61, 0x63, 0x74, 0x75, 0x61, 0x74,
+      0x6f, 0x72, 0x73, 0x04, 0x6c, 0x65, 0x64, 0x73, 0x10, 0x37, 0x63, 0x6f,
+      0x6c, 0x6f, 0x72, 0x3d, 0x72, 0xff, 0x6d, 0x6f, 0x64, 0x65, 0x3d, 0x6f,
+      0x6e } },
+  { "ACK 2.05 JSON response", 36,
+    { 0x64, 0x45, 0x1a, 0x2b, 0x12, 0x34, 0x56, 0x78, 0x44, 0xde, 0xad, 0xbe,
+      0xef, 0x81, 0x32, 0x21, 0x1e, 0xff, 0x7b, 0x22, 0x74, 0x22, 0x3a, 0x32,
+      0x31, 0x2e, 0x35, 0x2c, 0x22, 0x75, 0x22, 0x3a, 0x22, 0x43, 0x22, 0x7d } },
+};
+#define MESSAGE_COUNT (sizeof(messages) / sizeof(messages[0]))
+#define RESPONSE_INDEX 4
+/* The messages before the response are requests */
+#define REQUEST_COUNT RESPONSE_INDEX
+
+static const uint8_t etag[] = { 0xde, 0xad, 0xbe, 0xef };
+static const char json[] = "{\"t\":21.5,\"u\":\"C\"}";
+
+static unsigned long errors;
+static int temperature = 215;
+/*---------------------------------------------------------------------------*/
+PROCESS(coap_codec_bench_process, "CoAP codec benchmark");
+AUTOSTART_PROCESSES(&coap_codec_bench_process);
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, unsigned long ops, double seconds)
+{
+  printf("%-36s %8.1f ns/op\n", name, seconds * 1e9 / ops);
+}
+/*---------------------------------------------------------------------------*/
+static void
+sensor_get(coap_message_t *request, coap_message_t *response,
+           uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  int len = snprintf((char *)buffer, preferred_size,
+                     "{\"t\":%d.%d,\"u\":\"C\"}",
+                     temperature / 10, temperature % 10);
+
+  coap_set_header_etag(response, etag, sizeof(etag));
+  coap_set_header_content_format(response, APPLICATION_JSON);
+  coap_set_header_max_age(response, 30);
+  coap_set_payload(response, buffer, len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+leds_post(coap_message_t *request, coap_message_t *response,
+          uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  const char *color;
+  const char *mode;
+
+  if(coap_get_query_variable(request, "color", &color) == 1
+     && coap_get_post_variable(request, "mode", &mode) == 2) {
+    coap_set_status_code(response, CHANGED_2_04);
+  } else {
+    coap_set_status_code(response, BAD_REQUEST_4_00);
+  }
+}
+/*---------------------------------------------------------------------------*/
+RESOURCE(res_temperature, "title=\"Temperature\"", sensor_get, NULL, NULL,
+         NULL);
+RESOURCE(res_ipso_temperature, "title=\"IPSO temperature\"", sensor_get,
+         NULL, NULL, NULL);
+RESOURCE(res_leds, "title=\"LEDs\"", NULL, leds_post, NULL, NULL);
+/*---------------------------------------------------------------------------*/
+/* What the engine needs to dispatch a request: path and Block2 */
+static int
+iterate_request(const uint8_t *data, uint16_t len, uint32_t *block2)
+{
+  coap_option_iterator_t it;
+  coap_raw_option_t option;
+  int path_len = 0;
+
+  coap_option_iterator_init(&it, data, len);
+  while(coap_option_find(&it, COAP_OPTION_URI_PATH, &option) > 0) {
+    path_len += option.len + 1;
+  }
+  *block2 = 0;
+  if(coap_option_find(&it, COAP_OPTION_BLOCK2, &option) > 0) {
+    *block2 = coap_option_get_int(&option);
+  }
+  return path_len > 0 ? path_len - 1 : 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+build_response(coap_message_t *response)
+{
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, 0x1a2b);
+  coap_set_token(response, messages[0].data + COAP_HEADER_LEN, 4);
+  coap_set_header_etag(response, etag, sizeof(etag));
+  coap_set_header_content_format(response, APPLICATION_JSON);
+  coap_set_header_max_age(response, 30);
+  coap_set_payload(response, json, sizeof(json) - 1);
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+write_response(uint8_t *buf)
+{
+  coap_writer_t w;
+
+  coap_writer_init(&w, buf, COAP_MAX_PACKET_SIZE, COAP_TYPE_ACK,
+                   CONTENT_2_05, 0x1a2b,
+                   messages[0].data + COAP_HEADER_LEN, 4);
+  coap_writer_add_option(&w, COAP_OPTION_ETAG, etag, sizeof(etag));
+  coap_writer_add_int_option(&w, COAP_OPTION_CONTENT_FORMAT, APPLICATION_JSON);
+  coap_writer_add_int_option(&w, COAP_OPTION_MAX_AGE, 30);
+  return coap_writer_finish(&w, json, sizeof(json) - 1);
+}
+/*---------------------------------------------------------------------------*/
+/* Check that both parsers agree and both serializers match the capture */
+static void
+check_messages(void)
+{
+  static coap_message_t message[1];
+  uint8_t buf[COAP_MAX_PACKET_SIZE + 1];
+  const char *path;
+  uint32_t block2;
+  int path_len;
+  size_t len;
+  int i;
+
+  for(i = 0; i < MESSAGE_COUNT; i++) {
+    memcpy(buf, messages[i].data, messages[i].len);
+    path_len = iterate_request(messages[i].data, messages[i].len, &block2);
+    if(coap_parse_message(message, buf, messages[i].len) != NO_ERROR
+       || coap_get_header_uri_path(message, &path) != path_len
+       || (coap_is_option(message, COAP_OPTION_BLOCK2)
+           && (message->block2_num << 4 | 2) != block2)) {
+      printf("%s: parse mismatch\n", messages[i].name);
+      errors++;
+    }
+  }
+
+  build_response(message);
+  len = coap_serialize_message(message, buf);
+  if(len != messages[RESPONSE_INDEX].len
+     || memcmp(buf, messages[RESPONSE_INDEX].data, len) != 0) {
+    printf("coap_serialize_message: mismatch\n");
+    errors++;
+  }
+  len = write_response(buf);
+  if(len != messages[RESPONSE_INDEX].len
+     || memcmp(buf, messages[RESPONSE_INDEX].data, len) != 0) {
+    printf("coap_writer: mismatch\n");
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_parse(void)
+{
+  static coap_message_t message[1];
+  uint8_t buf[COAP_MAX_PACKET_SIZE + 1];
+  unsigned long sum = 0;
+  uint32_t block2;
+  double t;
+  int r;
+  int i;
+
+  /* coap_parse_message() merges options in place, parse a fresh copy */
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    for(i = 0; i < MESSAGE_COUNT; i++) {
+      memcpy(buf, messages[i].data, messages[i].len);
+      sum += coap_parse_message(message, buf, messages[i].len);
+      sum += message->uri_path_len;
+    }
+  }
+  report("coap_parse_message", ROUNDS * MESSAGE_COUNT, now() - t);
+
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    for(i = 0; i < MESSAGE_COUNT; i++) {
+      sum += iterate_request(messages[i].data, messages[i].len, &block2);
+      sum += block2;
+    }
+  }
+  report("option iterator: Uri-Path, Block2", ROUNDS * MESSAGE_COUNT,
+         now() - t);
+
+  /* Keep the compiler from optimizing the loops away */
+  if(sum == 0) {
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_serialize(void)
+{
+  static coap_message_t response[1];
+  uint8_t buf[COAP_MAX_PACKET_SIZE + 1];
+  unsigned long sum = 0;
+  double t;
+  int r;
+
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    build_response(response);
+    sum += coap_serialize_message(response, buf);
+  }
+  report("coap_message_t + serialize", ROUNDS, now() - t);
+
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    sum += write_response(buf);
+  }
+  report("coap_writer", ROUNDS, now() - t);
+
+  if(sum == 0) {
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The whole request path of the engine, and the share of the codec in it */
+static void
+bench_receive(void)
+{
+  static coap_message_t message[1];
+  static coap_message_t response[1];
+  uint8_t buf[COAP_MAX_PACKET_SIZE + 1];
+  coap_endpoint_t client;
+  unsigned long sum = 0;
+  double receive_time;
+  double parse_time;
+  double serialize_time;
+  double t;
+  int r;
+  int i;
+
+  coap_engine_init();
+  coap_activate_resource(&res_temperature, "sensors/temperature");
+  coap_activate_resource(&res_ipso_temperature, "3303/0/5700");
+  coap_activate_resource(&res_leds, "actuators/leds");
+
+  memset(&client, 0, sizeof(client));
+  uip_ip6addr(&client.ipaddr, 0xfd00, 0, 0, 0, 0, 0, 0, 0x100);
+  client.port = UIP_HTONS(COAP_DEFAULT_PORT);
+
+  for(i = 0; i < REQUEST_COUNT; i++) {
+    memcpy(buf, messages[i].data, messages[i].len);
+    if(coap_receive(&client, buf, messages[i].len) != NO_ERROR) {
+      printf("%s: not answered\n", messages[i].name);
+      errors++;
+    }
+  }
+
+  /* coap_receive() parses the request and serializes the response */
+  t = now();
+  for(r = 0; r < RECEIVE_ROUNDS; r++) {
+    for(i = 0; i < REQUEST_COUNT; i++) {
+      memcpy(buf, messages[i].data, messages[i].len);
+      sum += coap_receive(&client, buf, messages[i].len) == NO_ERROR;
+    }
+  }
+  receive_time = now() - t;
+  report("coap_receive", RECEIVE_ROUNDS * REQUEST_COUNT, receive_time);
+
+  t = now();
+  for(r = 0; r < RECEIVE_ROUNDS; r++) {
+    for(i = 0; i < REQUEST_COUNT; i++) {
+      memcpy(buf, messages[i].data, messages[i].len);
+      sum += coap_parse_message(message, buf, messages[i].len);
+    }
+  }
+  parse_time = now() - t;
+  report("  of which coap_parse_message", RECEIVE_ROUNDS * REQUEST_COUNT,
+         parse_time);
+
+  t = now();
+  for(r = 0; r < RECEIVE_ROUNDS; r++) {
+    for(i = 0; i < REQUEST_COUNT; i++) {
+      build_response(response);
+      sum += coap_serialize_message(response, buf);
+    }
+  }
+  serialize_time = now() - t;
+  report("  of which serializing the response",
+         RECEIVE_ROUNDS * REQUEST_COUNT, serialize_time);
+  printf("%-36s %8.1f %%\n", "codec share of coap_receive",
+         100.0 * (parse_time + serialize_time) / receive_time);
+
+  if(sum == 0) {
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coap_codec_bench_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  check_messages();
+  bench_parse();
+  bench_serialize();
+  bench_receive();
+
+  printf("errors: %lu\n", errors);
+  exit(errors == 0 ? 0 : 1);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
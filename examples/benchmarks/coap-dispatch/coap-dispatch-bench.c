@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Micro-benchmark for CoAP resource dispatch
+ */
+
+#include "contiki.h"
+#include "coap-engine.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/*---------------------------------------------------------------------------*/
+#define ROUNDS 200000
+
+/* LwM2M-like layout: IPSO objects with INSTANCES instances each */
+static const uint16_t objects[] = {
+  3303, 3304, 3311, 3315, 3323, 3336, 3340, 3342
+};
+#define OBJECTS (sizeof(objects) / sizeof(objects[0]))
+#define INSTANCES 15
+#define RESOURCE_COUNT (OBJECTS * INSTANCES + OBJECTS)
+#define URL_LEN 16
+
+static coap_resource_t resources[RESOURCE_COUNT];
+static char urls[RESOURCE_COUNT][URL_LEN];
+
+static const char *paths[] = {
+  "3303/0",          /* early leaf */
+  "3342/14",         /* last leaf */
+  "3315/7",          /* leaf in the middle */
+  "3336/3/5700",     /* served by the object parent resource */
+  "3340",            /* object */
+  "3340/21/5700",    /* unknown instance, also served by the object */
+  "9999/0",          /* unknown object */
+  ".well-known/core",
+};
+#define PATH_COUNT (sizeof(paths) / sizeof(paths[0]))
+
+static unsigned long errors;
+/*---------------------------------------------------------------------------*/
+PROCESS(coap_dispatch_bench_process, "CoAP dispatch benchmark");
+AUTOSTART_PROCESSES(&coap_dispatch_bench_process);
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, unsigned long ops, double seconds)
+{
+  printf("%-32s %8.1f ns/op\n", name, seconds * 1e9 / ops);
+}
+/*---------------------------------------------------------------------------*/
+static void
+res_get_handler(coap_message_t *request, coap_message_t *response,
+                uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+}
+/*---------------------------------------------------------------------------*/
+/* The linear scan the engine used before, as a reference */
+static coap_resource_t *
+linear_lookup(const char *url, int url_len)
+{
+  coap_resource_t *resource;
+  int res_url_len;
+
+  for(resource = coap_get_first_resource(); resource;
+      resource = coap_get_next_resource(resource)) {
+    res_url_len = strlen(resource->url);
+    if((url_len == res_url_len
+        || (url_len > res_url_len
+            && (resource->flags & HAS_SUB_RESOURCES)
+            && url[res_url_len] == '/'))
+       && strncmp(resource->url, url, res_url_len) == 0) {
+      return resource;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+activate_resources(void)
+{
+  int i = 0;
+  int o;
+  int n;
+
+  /* Instances first, then their objects as parent resources */
+  for(o = 0; o < OBJECTS; o++) {
+    for(n = 0; n < INSTANCES; n++, i++) {
+      snprintf(urls[i], URL_LEN, "%u/%u", objects[o], n);
+      resources[i].flags = METHOD_GET;
+      resources[i].get_handler = res_get_handler;
+      coap_activate_resource(&resources[i], urls[i]);
+    }
+  }
+  for(o = 0; o < OBJECTS; o++, i++) {
+    snprintf(urls[i], URL_LEN, "%u", objects[o]);
+    resources[i].flags = METHOD_GET | HAS_SUB_RESOURCES;
+    resources[i].get_handler = res_get_handler;
+    coap_activate_resource(&resources[i], urls[i]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_paths(void)
+{
+  coap_resource_t *r;
+  int i;
+
+  for(i = 0; i < PATH_COUNT; i++) {
+    r = coap_get_resource_by_path(paths[i], strlen(paths[i]));
+    printf("/%-20s -> %s\n", paths[i], r != NULL ? r->url : "not found");
+    if(r != linear_lookup(paths[i], strlen(paths[i]))) {
+      printf("/%s: lookup mismatch\n", paths[i]);
+      errors++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Activating a resource again under a new path must drop the old one */
+static void
+check_reactivation(void)
+{
+  coap_resource_t *moved = &resources[0];
+  const char *old_url = moved->url;
+  coap_resource_t *r;
+
+  coap_activate_resource(moved, "9999/0");
+  r = coap_get_resource_by_path(old_url, strlen(old_url));
+  printf("/%-20s -> %s after moving it\n", old_url,
+         r != NULL ? r->url : "not found");
+  if(r == moved || r != linear_lookup(old_url, strlen(old_url))) {
+    printf("/%s: still served by the moved resource\n", old_url);
+    errors++;
+  }
+  if(coap_get_resource_by_path("9999/0", 6) != moved) {
+    printf("/9999/0: not served by the moved resource\n");
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_lookup(void)
+{
+  unsigned long sum = 0;
+  double t;
+  int r;
+  int i;
+
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    for(i = 0; i < PATH_COUNT; i++) {
+      sum += linear_lookup(paths[i], strlen(paths[i])) != NULL;
+    }
+  }
+  report("linear scan", ROUNDS * PATH_COUNT, now() - t);
+
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    for(i = 0; i < PATH_COUNT; i++) {
+      sum += coap_get_resource_by_path(paths[i], strlen(paths[i])) != NULL;
+    }
+  }
+  report("coap_get_resource_by_path", ROUNDS * PATH_COUNT, now() - t);
+
+  /* Keep the compiler from optimizing the loops away */
+  if(sum == 0) {
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coap_dispatch_bench_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  coap_engine_init();
+  activate_resources();
+
+  printf("resources: %u, trie: %s\n", (unsigned)RESOURCE_COUNT + 1,
+         COAP_RESOURCE_TRIE ? "yes" : "no");
+
+  check_paths();
+  bench_lookup();
+  check_reactivation();
+
+  printf("errors: %lu\n", errors);
+  exit(errors == 0 ? 0 : 1);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Throughput of CoAP over TCP with BERT against UDP blockwise
+ */
+
+#include "contiki.h"
+#include "coap-engine.h"
+#include "coap-tcp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/*---------------------------------------------------------------------------*/
+#define RESOURCE_SIZE (64 * 1024UL)
+#define TRANSFERS     20
+#define TCP_MSS       1220 /* IPv6 minimum MTU less IPv6 and TCP headers */
+#define TOKEN_LEN     4
+#define BERT_SIZE \
+  ((COAP_TCP_MAX_MESSAGE_SIZE - COAP_MAX_HEADER_SIZE) & ~(COAP_BERT_BLOCK_SIZE - 1))
+
+#define MESSAGE_SIZE (COAP_TCP_HEADROOM + COAP_TCP_MAX_MESSAGE_SIZE + 1)
+
+struct result {
+  unsigned long round_trips;
+  unsigned long packets;
+  unsigned long bytes;
+};
+
+static const uint8_t token[TOKEN_LEN] = { 0xc0, 0xa9, 0x12, 0x34 };
+static uint8_t resource[RESOURCE_SIZE];
+static uint8_t received[RESOURCE_SIZE];
+static uint8_t request_buffer[MESSAGE_SIZE];
+static uint8_t response_buffer[MESSAGE_SIZE];
+static uint8_t wire[COAP_TCP_MAX_HEADER_LEN + COAP_TCP_MAX_MESSAGE_SIZE];
+static uint8_t client_input[MESSAGE_SIZE];
+static uint8_t server_input[MESSAGE_SIZE];
+static coap_tcp_stream_t client_stream;
+static coap_tcp_stream_t server_stream;
+static coap_message_t message[1];
+static unsigned long errors;
+/*---------------------------------------------------------------------------*/
+PROCESS(coap_tcp_bench_process, "CoAP over TCP benchmark");
+AUTOSTART_PROCESSES(&coap_tcp_bench_process);
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, const struct result *r, double seconds)
+{
+  printf("%-22s %6lu round trips %6lu packets %8lu bytes %8.1f MB/s\n",
+         name, r->round_trips / TRANSFERS, r->packets / TRANSFERS,
+         r->bytes / TRANSFERS, RESOURCE_SIZE * TRANSFERS / seconds / 1e6);
+}
+/*---------------------------------------------------------------------------*/
+static void
+check(int condition, const char *what)
+{
+  if(!condition) {
+    printf("FAIL: %s\n", what);
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+block2_value(uint32_t num, uint8_t more, uint16_t size)
+{
+  uint8_t szx = 0;
+
+  while((16 << szx) < size) {
+    szx++;
+  }
+  return num << 4 | (more ? 0x08 : 0) | szx;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+write_request(uint8_t *buffer, uint16_t mid, uint32_t num, uint16_t size)
+{
+  coap_writer_t w;
+
+  coap_writer_init(&w, buffer, MESSAGE_SIZE - 1, COAP_TYPE_CON, COAP_GET,
+                   mid, token, TOKEN_LEN);
+  coap_writer_add_string_option(&w, COAP_OPTION_URI_PATH, "fw/image", 8, '/');
+  coap_writer_add_int_option(&w, COAP_OPTION_BLOCK2,
+                             block2_value(num, 0, size));
+  return coap_writer_finish(&w, NULL, 0);
+}
+/*---------------------------------------------------------------------------*/
+/* The server side: answer a Block2 request from the resource */
+static uint16_t
+serve(uint8_t *request, uint16_t len, uint8_t *buffer, int bert)
+{
+  coap_writer_t w;
+  uint32_t num, offset;
+  uint16_t size, mid;
+  uint8_t more;
+
+  if(coap_parse_message(message, request, len) != NO_ERROR ||
+     !coap_get_header_block2(message, &num, NULL, &size, &offset)) {
+    return 0;
+  }
+  mid = message->mid;
+  if(bert && size == COAP_BERT_SZX_SIZE) {
+    offset = num * COAP_BERT_BLOCK_SIZE;
+    size = BERT_SIZE;
+  }
+  if(offset >= RESOURCE_SIZE) {
+    return 0;
+  }
+  more = RESOURCE_SIZE - offset > size;
+  if(!more) {
+    size = RESOURCE_SIZE - offset;
+  }
+
+  coap_writer_init(&w, buffer, MESSAGE_SIZE - 1, COAP_TYPE_ACK, CONTENT_2_05,
+                   mid, token, TOKEN_LEN);
+  coap_writer_add_int_option(&w, COAP_OPTION_CONTENT_FORMAT,
+                             APPLICATION_OCTET_STREAM);
+  coap_writer_add_int_option(&w, COAP_OPTION_BLOCK2,
+                             block2_value(num, more,
+                                          bert ? COAP_BERT_SZX_SIZE : size));
+  return coap_writer_finish(&w, resource + offset, size);
+}
+/*---------------------------------------------------------------------------*/
+/* The client side: store a block, return the number of the next one */
+static uint32_t
+consume(uint8_t *response, uint16_t len, int bert, uint8_t *more)
+{
+  uint32_t num, offset;
+  uint16_t size;
+
+  *more = 0;
+  if(coap_parse_message(message, response, len) != NO_ERROR ||
+     !coap_get_header_block2(message, &num, more, &size, &offset)) {
+    check(0, "response parsed");
+    return 0;
+  }
+  if(bert) {
+    offset = num * COAP_BERT_BLOCK_SIZE;
+  }
+  if(offset + message->payload_len > RESOURCE_SIZE) {
+    check(0, "block within the resource");
+    *more = 0;
+    return 0;
+  }
+  memcpy(received + offset, message->payload, message->payload_len);
+  return bert ? num + message->payload_len / COAP_BERT_BLOCK_SIZE : num + 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+udp_transfer(uint16_t block_size, struct result *r)
+{
+  uint16_t len, mid = 0;
+  uint32_t num = 0;
+  uint8_t more;
+
+  do {
+    len = write_request(request_buffer, ++mid, num, block_size);
+    r->bytes += len;
+    len = serve(request_buffer, len, response_buffer, 0);
+    r->bytes += len;
+    num = consume(response_buffer, len, 0, &more);
+    r->round_trips++;
+    r->packets += 2;
+  } while(more);
+}
+/*---------------------------------------------------------------------------*/
+/* Frame a message and deliver it to a stream in MSS-sized segments */
+static uint16_t
+tcp_deliver(coap_tcp_stream_t *s, const uint8_t *data, uint16_t len,
+            struct result *r, uint8_t **message)
+{
+  uint16_t message_len = 0;
+  uint16_t header_len, body_len, sent, segment;
+  int n;
+
+  header_len = coap_tcp_frame_header(wire, data, len, 0);
+  body_len = len - COAP_HEADER_LEN - TOKEN_LEN;
+  memcpy(wire + header_len, data + len - body_len, body_len);
+  len = header_len + body_len;
+  r->bytes += len;
+
+  *message = NULL;
+  for(sent = 0; sent < len; sent += segment) {
+    segment = MIN(TCP_MSS, len - sent);
+    r->packets++;
+    for(n = 0; n < segment; n += coap_tcp_stream_input(s, wire + sent + n,
+                                                       segment - n, message,
+                                                       &message_len)) {
+      if(*message != NULL) {
+        break;
+      }
+    }
+  }
+  return message_len;
+}
+/*---------------------------------------------------------------------------*/
+static void
+tcp_transfer(struct result *r)
+{
+  uint8_t *message;
+  uint16_t len;
+  uint32_t num = 0;
+  uint8_t more;
+
+  do {
+    len = write_request(request_buffer, 0, num, COAP_BERT_SZX_SIZE);
+    len = tcp_deliver(&server_stream, request_buffer, len, r, &message);
+    len = serve(message, len, response_buffer, 1);
+    len = tcp_deliver(&client_stream, response_buffer, len, r, &message);
+    num = consume(message, len, 1, &more);
+    r->round_trips++;
+  } while(more);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_udp(const char *name, uint16_t block_size)
+{
+  struct result r = { 0, 0, 0 };
+  double start;
+  int i;
+
+  memset(received, 0, sizeof(received));
+  start = now();
+  for(i = 0; i < TRANSFERS; i++) {
+    udp_transfer(block_size, &r);
+  }
+  report(name, &r, now() - start);
+  check(memcmp(received, resource, RESOURCE_SIZE) == 0, "UDP transfer intact");
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_tcp(void)
+{
+  struct result r = { 0, 0, 0 };
+  double start;
+  int i;
+
+  memset(received, 0, sizeof(received));
+  start = now();
+  for(i = 0; i < TRANSFERS; i++) {
+    tcp_transfer(&r);
+  }
+  report("TCP BERT", &r, now() - start);
+  check(memcmp(received, resource, RESOURCE_SIZE) == 0, "TCP transfer intact");
+}
+/*---------------------------------------------------------------------------*/
+/* Length fields at the boundaries of RFC 8323, section 3.2 */
+static void
+check_framing(void)
+{
+  static const uint16_t lengths[] = { 0, 12, 13, 268, 269, 4000 };
+  static const uint8_t header_lens[] = { 2, 2, 3, 3, 4, 4 };
+  uint8_t header[COAP_TCP_MAX_HEADER_LEN];
+  uint8_t *message;
+  uint16_t message_len, len;
+  coap_writer_t w;
+  unsigned i, j;
+  int n;
+
+  for(i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+    coap_writer_init(&w, request_buffer, MESSAGE_SIZE - 1, COAP_TYPE_CON,
+                     CONTENT_2_05, 0x1234, token, TOKEN_LEN);
+    len = coap_writer_finish(&w, resource, lengths[i] ? lengths[i] - 1 : 0);
+    n = coap_tcp_frame_header(header, request_buffer, len, 0);
+    check(n == header_lens[i] + TOKEN_LEN, "frame header length");
+
+    /* One byte at a time */
+    memcpy(wire, header, n);
+    memcpy(wire + n, request_buffer + COAP_HEADER_LEN + TOKEN_LEN,
+           len - COAP_HEADER_LEN - TOKEN_LEN);
+    message = NULL;
+    for(j = 0; j < n + len - COAP_HEADER_LEN - TOKEN_LEN; j++) {
+      check(message == NULL, "no early message");
+      check(coap_tcp_stream_input(&server_stream, wire + j, 1, &message,
+                                  &message_len) == 1, "byte consumed");
+    }
+    check(message != NULL && message_len == len &&
+          message[1] == CONTENT_2_05 &&
+          memcmp(message + COAP_HEADER_LEN, token, TOKEN_LEN) == 0 &&
+          memcmp(message + COAP_HEADER_LEN + TOKEN_LEN,
+                 request_buffer + COAP_HEADER_LEN + TOKEN_LEN,
+                 len - COAP_HEADER_LEN - TOKEN_LEN) == 0,
+          "message reassembled");
+  }
+
+  /* WebSocket frames carry no length */
+  n = coap_tcp_frame_header(header, request_buffer, len, 1);
+  check(n == 2 + TOKEN_LEN && (header[0] >> 4) == 0, "WebSocket header");
+
+  /* A frame beyond Max-Message-Size is refused */
+  wire[0] = (14 << 4) | TOKEN_LEN;
+  wire[1] = 0xff;
+  wire[2] = 0xff;
+  check(coap_tcp_stream_input(&server_stream, wire, 3, &message,
+                              &message_len) < 0, "oversized frame refused");
+  coap_tcp_stream_init(&server_stream, server_input,
+                       COAP_TCP_MAX_MESSAGE_SIZE, 0);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coap_tcp_bench_process, ev, data)
+{
+  unsigned long i;
+
+  PROCESS_BEGIN();
+
+  for(i = 0; i < RESOURCE_SIZE; i++) {
+    resource[i] = i * 7 + (i >> 8);
+  }
+  coap_tcp_stream_init(&server_stream, server_input,
+                       COAP_TCP_MAX_MESSAGE_SIZE, 0);
+  coap_tcp_stream_init(&client_stream, client_input,
+                       COAP_TCP_MAX_MESSAGE_SIZE, 0);
+
+  check_framing();
+
+  printf("Fetching %lu bytes, BERT messages of %u bytes\n",
+         RESOURCE_SIZE, (unsigned)BERT_SIZE);
+  bench_udp("UDP blockwise 64", 64);
+  bench_udp("UDP blockwise 512", 512);
+  bench_udp("UDP blockwise 1024", 1024);
+  bench_tcp();
+
+  printf("errors: %lu\n", errors);
+  exit(errors == 0 ? 0 : 1);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Benchmark and checks for the CoAP transaction layer
+ */
+
+#include "contiki.h"
+#include "coap-engine.h"
+#include "coap-transactions.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/*---------------------------------------------------------------------------*/
+#define ROUNDS 1000000
+#define TOKEN_LEN 4
+
+static coap_transaction_t *open[COAP_MAX_OPEN_TRANSACTIONS];
+static unsigned open_count;
+static unsigned long errors;
+static unsigned responses;
+static struct etimer et;
+/*---------------------------------------------------------------------------*/
+PROCESS(coap_transactions_bench_process, "CoAP transactions benchmark");
+AUTOSTART_PROCESSES(&coap_transactions_bench_process);
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, unsigned long ops, double seconds)
+{
+  printf("%-36s %8.1f ns/op\n", name, seconds * 1e9 / ops);
+}
+/*---------------------------------------------------------------------------*/
+static void
+check(int condition, const char *what)
+{
+  if(!condition) {
+    printf("FAIL: %s\n", what);
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+peer(coap_endpoint_t *ep, uint16_t n)
+{
+  memset(ep, 0, sizeof(*ep));
+  uip_ip6addr(&ep->ipaddr, 0xfd00, 0, 0, 0, 0, 0, 0, n);
+  ep->port = UIP_HTONS(COAP_DEFAULT_PORT);
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_token(uint8_t *token, unsigned n)
+{
+  token[0] = 0xa5;
+  token[1] = n >> 8;
+  token[2] = n;
+  token[3] = 0x5a ^ n;
+}
+/*---------------------------------------------------------------------------*/
+static void
+response_handler(void *data, coap_message_t *response)
+{
+  responses++;
+}
+/*---------------------------------------------------------------------------*/
+/* A small Confirmable GET as a client would send it */
+static coap_transaction_t *
+send_request(const coap_endpoint_t *ep, uint16_t mid, unsigned n)
+{
+  coap_transaction_t *t;
+  coap_writer_t writer;
+  uint8_t token[TOKEN_LEN];
+
+  t = coap_new_transaction(mid, ep);
+  if(t == NULL) {
+    return NULL;
+  }
+  make_token(token, n);
+  coap_writer_init(&writer, t->message, COAP_MAX_PACKET_SIZE + 1,
+                   COAP_TYPE_CON, COAP_GET, mid, token, TOKEN_LEN);
+  coap_writer_add_string_option(&writer, COAP_OPTION_URI_PATH,
+                                "sensors/temperature", 19, '/');
+  t->message_len = coap_writer_finish(&writer, NULL, 0);
+  t->callback = response_handler;
+  coap_send_transaction(t);
+  return t;
+}
+/*---------------------------------------------------------------------------*/
+static void
+clear_all(void)
+{
+  while(open_count > 0) {
+    coap_clear_transaction(open[--open_count]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Small messages only keep the blocks they use */
+static void
+check_pool(void)
+{
+  coap_endpoint_t ep;
+  coap_transaction_t *t;
+  unsigned full = COAP_TRANSACTION_BUFFER_SIZE / (COAP_MAX_PACKET_SIZE + 1);
+
+  for(open_count = 0; open_count < COAP_MAX_OPEN_TRANSACTIONS; open_count++) {
+    peer(&ep, 0x100 + open_count);
+    t = send_request(&ep, 0x1000 + open_count, open_count);
+    if(t == NULL) {
+      break;
+    }
+    open[open_count] = t;
+  }
+  printf("%u requests open in a %u byte pool (%u at full size)\n",
+         open_count, (unsigned)COAP_TRANSACTION_BUFFER_SIZE, full);
+  check(open_count > full, "pool holds more small than full-size messages");
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_lookup(void)
+{
+  coap_endpoint_t eps[COAP_MAX_OPEN_TRANSACTIONS];
+  uint8_t token[TOKEN_LEN];
+  coap_transaction_t *t;
+  unsigned long i;
+  unsigned j, n;
+  double start;
+
+  for(j = 0; j < open_count; j++) {
+    peer(&eps[j], 0x100 + j);
+  }
+
+  for(j = 0; j < open_count; j++) {
+    make_token(token, j);
+    check(coap_get_transaction(&eps[j], 0x1000 + j) == open[j],
+          "lookup by MID");
+    check(coap_get_transaction_by_token(&eps[j], token, TOKEN_LEN) == open[j],
+          "lookup by token");
+    check(coap_get_transaction(&eps[(j + 1) % open_count], 0x1000 + j) == NULL,
+          "MID of another peer");
+  }
+
+  /* What coap_get_transaction_by_mid() did before: walk every transaction */
+  start = now();
+  for(i = 0, n = 0; i < ROUNDS; i++) {
+    j = i % open_count;
+    for(t = NULL, n = 0; n < open_count; n++) {
+      if(open[n]->mid == 0x1000 + j &&
+         coap_endpoint_cmp(&open[n]->endpoint, &eps[j])) {
+        t = open[n];
+        break;
+      }
+    }
+    check(t != NULL, "linear scan");
+  }
+  report("linear scan by MID", ROUNDS, now() - start);
+
+  start = now();
+  for(i = 0; i < ROUNDS; i++) {
+    j = i % open_count;
+    check(coap_get_transaction(&eps[j], 0x1000 + j) != NULL, "lookup by MID");
+  }
+  report("hash lookup by MID", ROUNDS, now() - start);
+
+  start = now();
+  for(i = 0; i < ROUNDS; i++) {
+    j = i % open_count;
+    make_token(token, j);
+    check(coap_get_transaction_by_token(&eps[j], token, TOKEN_LEN) != NULL,
+          "lookup by token");
+  }
+  report("hash lookup by token", ROUNDS, now() - start);
+
+  start = now();
+  for(i = 0; i < ROUNDS / 64; i++) {
+    clear_all();
+    for(open_count = 0; open_count < 32; open_count++) {
+      open[open_count] = send_request(&eps[open_count], 0x1000 + open_count,
+                                      open_count);
+    }
+  }
+  report("open, send and clear a request", (ROUNDS / 64) * 32, now() - start);
+  clear_all();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coap_transactions_bench_process, ev, data)
+{
+  static coap_endpoint_t ep;
+  static coap_transaction_t *first;
+  static coap_transaction_t *second;
+  static uint8_t response[COAP_HEADER_LEN + TOKEN_LEN];
+  static uint32_t rto;
+  static int i;
+
+  PROCESS_BEGIN();
+
+  coap_engine_init();
+
+  check_pool();
+  bench_lookup();
+
+  /* NSTART: the second request to a peer waits for the first */
+  peer(&ep, 1);
+  first = send_request(&ep, 0x2000, 1);
+  second = send_request(&ep, 0x2001, 2);
+  check(first != NULL && second != NULL, "requests allocated");
+  check(second->retrans_interval == 0, "second request deferred");
+  check(coap_acknowledge_transaction(first, 0) == 0, "piggybacked ACK");
+  coap_clear_transaction(first);
+  etimer_set(&et, CLOCK_SECOND / 50);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  check(second->retrans_interval != 0, "second request started after ACK");
+
+  /* A separate response is matched by token and acknowledged */
+  check(coap_acknowledge_transaction(second, 1) == 1, "empty ACK keeps request");
+  response[0] = (COAP_TYPE_CON << COAP_HEADER_TYPE_POSITION) | TOKEN_LEN |
+    (1 << COAP_HEADER_VERSION_POSITION);
+  response[1] = CONTENT_2_05;
+  response[2] = 0x77;
+  response[3] = 0x01;
+  make_token(response + COAP_HEADER_LEN, 2);
+  responses = 0;
+  coap_receive(&ep, response, sizeof(response));
+  check(responses == 1, "separate response delivered");
+  check(coap_get_transaction(&ep, 0x2001) == NULL, "request closed");
+
+  /* CoCoA: quick strong RTT samples pull the RTO below the 2 s default */
+  check(coap_get_endpoint_rto(&ep) <= 2000, "peer tracked");
+  for(i = 0; i < 8; i++) {
+    first = send_request(&ep, 0x3000 + i, i);
+    etimer_set(&et, CLOCK_SECOND / 20);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    coap_acknowledge_transaction(first, 0);
+    coap_clear_transaction(first);
+  }
+  rto = coap_get_endpoint_rto(&ep);
+  printf("RTO after 8 x 50 ms round trips: %lu ms\n", (unsigned long)rto);
+  check(rto > 0 && rto < 1000, "RTO adapts to the round-trip time");
+
+  /* The timer wheel retransmits with the adapted timeout */
+  first = send_request(&ep, 0x4000, 0x4000);
+  etimer_set(&et, (CLOCK_SECOND * 2 * rto) / 1000);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  check(first->retrans_counter >= 1, "request retransmitted");
+  coap_clear_transaction(first);
+
+  printf("errors: %lu\n", errors);
+  exit(errors == 0 ? 0 : 1);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
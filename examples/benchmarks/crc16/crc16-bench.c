@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Cross-check and throughput benchmark for CRC16
+ */
+
+#include "contiki.h"
+#include "lib/crc16.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+/*---------------------------------------------------------------------------*/
+#define CHECK_ROUNDS 20000
+#define BUF_LEN      2048
+#define BENCH_BYTES  (64UL * 1024 * 1024)
+/*---------------------------------------------------------------------------*/
+static unsigned char buf[BUF_LEN + 8];
+static unsigned long errors;
+/*---------------------------------------------------------------------------*/
+PROCESS(crc16_bench_process, "CRC16 benchmark");
+AUTOSTART_PROCESSES(&crc16_bench_process);
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+/* The byte-at-a-time reference */
+static unsigned short
+bitwise(const unsigned char *data, int len, unsigned short acc)
+{
+  for(; len > 0; len--) {
+    acc = crc16_add(*data++, acc);
+  }
+  return acc;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check(void)
+{
+  static const unsigned char check_string[] = "123456789";
+  struct crc16_block blocks[4];
+  unsigned short acc;
+  unsigned short ref;
+  int offset;
+  int len;
+  int i;
+  int r;
+
+  /* CRC-16/KERMIT check value */
+  if(crc16_data(check_string, 9, 0) != 0x2189) {
+    printf("check value: 0x%04x\n", crc16_data(check_string, 9, 0));
+    errors++;
+  }
+
+  for(i = 0; i < sizeof(buf); i++) {
+    buf[i] = random_rand();
+  }
+
+  for(r = 0; r < CHECK_ROUNDS; r++) {
+    offset = random_rand() % 8;
+    len = random_rand() % (r < CHECK_ROUNDS / 2 ? 40 : BUF_LEN);
+    acc = random_rand();
+
+    ref = bitwise(buf + offset, len, acc);
+    if(crc16_data(buf + offset, len, acc) != ref ||
+       crc16_sw_data(buf + offset, len, acc) != ref) {
+      printf("mismatch: offset %d, len %d\n", offset, len);
+      errors++;
+    }
+
+    /* The same data, cut into up to four blocks */
+    for(i = 0; i < 4; i++) {
+      blocks[i].data = buf + offset;
+      blocks[i].len = i == 3 ? len : random_rand() % (len + 1);
+      offset += blocks[i].len;
+      len -= blocks[i].len;
+    }
+    if(crc16_blocks(blocks, 4, acc) != ref) {
+      printf("block mismatch\n");
+      errors++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(const char *name, int len,
+      unsigned short (* f)(const unsigned char *, int, unsigned short))
+{
+  unsigned long rounds = BENCH_BYTES / len;
+  unsigned long r;
+  unsigned short acc = 0;
+  double t;
+
+  t = now();
+  for(r = 0; r < rounds; r++) {
+    acc = f(buf, len, acc);
+  }
+  t = now() - t;
+  printf("%-10s %5d bytes %8.1f MB/s %8.1f ns/op (0x%04x)\n", name, len,
+         rounds * len / t / 1e6, t * 1e9 / rounds, acc);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(crc16_bench_process, ev, data)
+{
+  static const int lens[] = { 16, 127, 1280, BUF_LEN };
+  int i;
+
+  PROCESS_BEGIN();
+
+  check();
+
+  printf("CRC16_SLICES: %d\n", CRC16_SLICES);
+  for(i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+    bench("bitwise", lens[i], bitwise);
+    bench("crc16_data", lens[i], crc16_data);
+  }
+
+  printf("errors: %lu\n", errors);
+  exit(errors == 0 ? 0 : 1);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
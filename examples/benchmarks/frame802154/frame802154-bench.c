@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Micro-benchmark for IEEE 802.15.4 frame parsing and creation
+ */
+
+#include "contiki.h"
+#include "net/mac/framer/frame802154.h"
+#include "net/mac/framer/frame802154e-ie.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/*---------------------------------------------------------------------------*/
+#define ROUNDS 2000000
+
+/* c.f. IEEE 802.15.4e Table 4d */
+#define MLME_SHORT_IE_TSCH_SYNCHRONIZATION 0x1a
+/*---------------------------------------------------------------------------*/
+struct captured_frame {
+  const char *name;
+  uint8_t len;
+  uint8_t data[64];
+};
+
+/* Frames as seen on the air (without FCS) in typical Contiki-NG networks */
+static struct captured_frame frames[] = {
+  { "2006 data, short addr", 15,
+    { 0x41, 0x88, 0x2a, 0xcd, 0xab, 0x02, 0x00, 0x01, 0x00,
+      0x7a, 0x33, 0x3a, 0x80, 0x00, 0x12 } },
+  { "2006 data, long addr", 27,
+    { 0x41, 0xcc, 0x2b, 0xcd, 0xab,
+      0x02, 0x02, 0x02, 0x00, 0x00, 0x4b, 0x12, 0x00,
+      0x01, 0x01, 0x01, 0x00, 0x00, 0x4b, 0x12, 0x00,
+      0x7a, 0x33, 0x3a, 0x80, 0x00, 0x12 } },
+  { "2006 broadcast", 19,
+    { 0x41, 0xc8, 0x2c, 0xcd, 0xab, 0xff, 0xff,
+      0x01, 0x01, 0x01, 0x00, 0x00, 0x4b, 0x12, 0x00,
+      0x7a, 0x3b, 0x3a, 0x1a } },
+  { "2015 data, long addr", 23,
+    { 0x41, 0xec, 0x2d,
+      0x02, 0x02, 0x02, 0x00, 0x00, 0x4b, 0x12, 0x00,
+      0x01, 0x01, 0x01, 0x00, 0x00, 0x4b, 0x12, 0x00,
+      0x7a, 0x33, 0x3a, 0x80 } },
+  { "2015 enhanced beacon", 47,
+    { 0x00, 0xea, 0x2e, 0xcd, 0xab, 0xff, 0xff, 0xcd, 0xab,
+      0x01, 0x01, 0x01, 0x00, 0x00, 0x4b, 0x12, 0x00,
+      /* Header IE list termination 1 */
+      0x00, 0x3f,
+      /* Payload MLME IE */
+      0x1a, 0x88,
+      /* TSCH synchronization: ASN, join priority */
+      0x06, 0x1a, 0x10, 0x27, 0x00, 0x00, 0x00, 0x01,
+      /* TSCH timeslot */
+      0x01, 0x1c, 0x00,
+      /* TSCH slotframe and link: one slotframe of 7, one shared link */
+      0x0a, 0x1b, 0x01, 0x00, 0x07, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x0f,
+      /* Channel hopping sequence */
+      0x01, 0xc8, 0x00 } },
+  { "2015 enhanced ack", 17,
+    { 0x02, 0x2e, 0x2f, 0xcd, 0xab,
+      0x02, 0x02, 0x02, 0x00, 0x00, 0x4b, 0x12, 0x00,
+      /* ACK/NACK time correction */
+      0x02, 0x0f, 0x12, 0x00 } },
+};
+#define FRAME_COUNT (sizeof(frames) / sizeof(frames[0]))
+#define EB_INDEX 4
+
+static unsigned long errors;
+/*---------------------------------------------------------------------------*/
+PROCESS(frame802154_bench_process, "802.15.4 framer benchmark");
+AUTOSTART_PROCESSES(&frame802154_bench_process);
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, unsigned long ops, double seconds)
+{
+  printf("%-32s %8.1f ns/op\n", name, seconds * 1e9 / ops);
+}
+/*---------------------------------------------------------------------------*/
+/* Parse each frame, create it again and check both agree */
+static void
+check_frames(void)
+{
+  frame802154_t frame;
+  uint8_t buf[64];
+  int hdrlen;
+  int i;
+
+  for(i = 0; i < FRAME_COUNT; i++) {
+    hdrlen = frame802154_parse(frames[i].data, frames[i].len, &frame);
+    if(hdrlen <= 0 || frame802154_create(&frame, buf) != hdrlen ||
+       memcmp(buf, frames[i].data, hdrlen) != 0) {
+      printf("%s: header mismatch\n", frames[i].name);
+      errors++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_header(void)
+{
+  frame802154_t frame[FRAME_COUNT];
+  uint8_t buf[64];
+  unsigned long sum = 0;
+  double t;
+  int r;
+  int i;
+
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    for(i = 0; i < FRAME_COUNT; i++) {
+      sum += frame802154_parse(frames[i].data, frames[i].len, &frame[i]);
+    }
+  }
+  report("frame802154_parse", ROUNDS * FRAME_COUNT, now() - t);
+
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    for(i = 0; i < FRAME_COUNT; i++) {
+      sum += frame802154_create(&frame[i], buf);
+    }
+  }
+  report("frame802154_create", ROUNDS * FRAME_COUNT, now() - t);
+
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    for(i = 0; i < FRAME_COUNT; i++) {
+      sum += frame802154_hdrlen(&frame[i]);
+    }
+  }
+  report("frame802154_hdrlen", ROUNDS * FRAME_COUNT, now() - t);
+
+  /* Keep the compiler from optimizing the loops away */
+  if(sum == 0) {
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_ies(void)
+{
+  struct frame802154e_ie_iterator it;
+  struct frame802154e_ie ie;
+  struct ieee802154_ies ies;
+  frame802154_t frame;
+  const uint8_t *p;
+  uint8_t len;
+  double t;
+  int r;
+
+  /* IEs of the enhanced beacon, right after its header */
+  len = frames[EB_INDEX].len;
+  len -= frame802154_parse(frames[EB_INDEX].data, len, &frame);
+  p = frame.payload;
+
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    memset(&ies, 0, sizeof(ies));
+    if(frame802154e_parse_information_elements(p, len, &ies) != len) {
+      errors++;
+    }
+  }
+  report("EB: parse all IEs", ROUNDS, now() - t);
+  if(ies.ie_asn.ls4b != 10000 || ies.ie_join_priority != 1 ||
+     ies.ie_tsch_slotframe_and_link.slotframe_size != 7) {
+    errors++;
+  }
+
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    memset(&ies, 0, sizeof(ies));
+    frame802154e_ie_iterator_init(&it, p, len);
+    if(frame802154e_ie_find(&it, FRAME802154E_IE_MLME_SHORT,
+                            MLME_SHORT_IE_TSCH_SYNCHRONIZATION, &ie) != 1 ||
+       frame802154e_ie_decode(&ie, &ies) < 0) {
+      errors++;
+    }
+  }
+  report("EB: find and decode ASN only", ROUNDS, now() - t);
+  if(ies.ie_asn.ls4b != 10000) {
+    errors++;
+  }
+
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    if(frame802154e_ie_header_len(p, len) != 2) {
+      errors++;
+    }
+  }
+  report("EB: header IE length", ROUNDS, now() - t);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(frame802154_bench_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("layout table: %s\n", FRAME802154_LAYOUT_TABLE ? "yes" : "no");
+
+  check_frames();
+  bench_header();
+  bench_ies();
+
+  printf("errors: %lu\n", errors);
+  exit(errors == 0 ? 0 : 1);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
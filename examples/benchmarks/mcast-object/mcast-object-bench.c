@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Completion time and radio energy of a multicast object push
+ *         with NACK-based repair, compared with unicast to every node
+ */
+
+#include "contiki.h"
+#include "services/mcast-object/mcast-object.h"
+#include "cfs/cfs.h"
+#include "lib/random.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/*---------------------------------------------------------------------------*/
+#define WIDTH          10
+#define HEIGHT         5
+#define NODES          (WIDTH * HEIGHT)
+#define OBJECT_SIZE    (100 * 1024UL)
+#define DEADLINE       (CLOCK_SECOND * 25)
+
+/* IEEE 802.15.4 at 250 kbit/s: 32 us per byte, CC2420 at 3 V */
+#define SLOT_MS        4.3    /* One 127-byte frame with CSMA and ACK */
+#define TX_UJ_PER_BYTE 1.67   /* 17.4 mA */
+#define RX_UJ_PER_BYTE 1.80   /* 18.8 mA */
+#define FRAME_OVERHEAD 31     /* PHY, MAC, 6LoWPAN and UDP headers */
+#define ACK_LEN        11     /* PHY header and ACK frame */
+
+/* A node of the simulated network, node 0 is the source */
+struct node {
+  int parent;
+  int hops;
+  int neighbours[8];
+  int neighbour_count;
+  char file[24];
+  struct mcast_object object;
+  unsigned long tx_frames;
+  unsigned long tx_bytes;
+  unsigned long rx_bytes;
+};
+
+static struct node nodes[NODES];
+static unsigned loss;  /* Per-mille frame loss on every link */
+static uint32_t rng = 1;
+static int completed;
+static unsigned long errors;
+/*---------------------------------------------------------------------------*/
+PROCESS(mcast_object_bench_process, "Multicast object benchmark");
+AUTOSTART_PROCESSES(&mcast_object_bench_process);
+/*---------------------------------------------------------------------------*/
+static void
+check(int condition, const char *what)
+{
+  if(!condition) {
+    printf("FAIL: %s\n", what);
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+rand32(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+/*---------------------------------------------------------------------------*/
+static int
+lost(void)
+{
+  return rand32() % 1000 < loss;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Nodes on a grid, each with its eight surrounding nodes in radio range.
+ * Every node picks a random parent among its neighbours one hop closer
+ * to the source.
+ */
+static void
+topology_build(void)
+{
+  int i, j, dx, dy, candidates;
+
+  for(i = 0; i < NODES; i++) {
+    nodes[i].neighbour_count = 0;
+    for(j = 0; j < NODES; j++) {
+      dx = i % WIDTH - j % WIDTH;
+      dy = i / WIDTH - j / WIDTH;
+      if(i != j && dx >= -1 && dx <= 1 && dy >= -1 && dy <= 1) {
+        nodes[i].neighbours[nodes[i].neighbour_count++] = j;
+      }
+    }
+    dx = i % WIDTH;
+    dy = i / WIDTH;
+    nodes[i].hops = dx > dy ? dx : dy;
+  }
+  for(i = 1; i < NODES; i++) {
+    candidates = 0;
+    for(j = 0; j < nodes[i].neighbour_count; j++) {
+      if(nodes[nodes[i].neighbours[j]].hops == nodes[i].hops - 1 &&
+         rand32() % ++candidates == 0) {
+        nodes[i].parent = nodes[i].neighbours[j];
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * The multicast engine: a node forwards a group datagram from its
+ * preferred parent once, as SMRF and BMF do. Every neighbour hears it.
+ */
+static void
+group_forward(int from, const uint8_t *data, uint16_t len)
+{
+  int i, n;
+
+  nodes[from].tx_frames++;
+  nodes[from].tx_bytes += len + FRAME_OVERHEAD;
+  for(i = 0; i < nodes[from].neighbour_count; i++) {
+    n = nodes[from].neighbours[i];
+    if(lost()) {
+      continue;
+    }
+    nodes[n].rx_bytes += len + FRAME_OVERHEAD;
+    if(nodes[n].parent == from && n != 0) {
+      mcast_object_input(&nodes[n].object, data, len);
+      group_forward(n, data, len);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+output(struct mcast_object *o, uint8_t to, const uint8_t *data, uint16_t len)
+{
+  struct node *from = (struct node *)((char *)o - offsetof(struct node, object));
+  int i, n;
+
+  if(to == MCAST_OBJECT_TO_GROUP) {
+    group_forward(from - nodes, data, len);
+    return;
+  }
+
+  from->tx_frames++;
+  from->tx_bytes += len + FRAME_OVERHEAD;
+  for(i = 0; i < from->neighbour_count; i++) {
+    n = from->neighbours[i];
+    if(!lost()) {
+      nodes[n].rx_bytes += len + FRAME_OVERHEAD;
+      mcast_object_input(&nodes[n].object, data, len);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+complete(struct mcast_object *o)
+{
+  completed++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+object_write(uint16_t id, unsigned long size)
+{
+  static uint8_t buf[256];
+  unsigned long offset;
+  int fd, i;
+
+  fd = cfs_open(nodes[0].file, CFS_WRITE);
+  for(offset = 0; offset < size; offset += sizeof(buf)) {
+    for(i = 0; i < sizeof(buf); i++) {
+      buf[i] = (offset + i) * 7 + id;
+    }
+    cfs_write(fd, buf, sizeof(buf));
+  }
+  cfs_close(fd);
+}
+/*---------------------------------------------------------------------------*/
+/* The node's file holds the object, and nothing after it */
+static int
+object_verify(int n, uint16_t id, unsigned long size)
+{
+  static uint8_t buf[256];
+  unsigned long offset;
+  int fd, i, ok = 1;
+
+  fd = cfs_open(nodes[n].file, CFS_READ);
+  for(offset = 0; offset < size && ok; offset += sizeof(buf)) {
+    ok = cfs_read(fd, buf, sizeof(buf)) == sizeof(buf);
+    for(i = 0; i < sizeof(buf) && ok; i++) {
+      ok = buf[i] == (uint8_t)((offset + i) * 7 + id);
+    }
+  }
+  ok = ok && cfs_read(fd, buf, 1) == 0;
+  cfs_close(fd);
+  return ok;
+}
+/*---------------------------------------------------------------------------*/
+static double
+energy_mj(unsigned long tx_bytes, unsigned long rx_bytes)
+{
+  return (tx_bytes * TX_UJ_PER_BYTE + rx_bytes * RX_UJ_PER_BYTE) / 1000;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Unicast to every node along the tree, with link-layer retransmissions
+ * until a frame gets through and an ACK for every received frame. The
+ * source sends a packet every third slot, like the multicast push.
+ */
+static void
+unicast_report(void)
+{
+  double attempts = 1000.0 / (1000 - loss);
+  double packets = (OBJECT_SIZE + MCAST_OBJECT_PACKET_SIZE - 1) /
+    MCAST_OBJECT_PACKET_SIZE;
+  double frame = MCAST_OBJECT_PACKET_SIZE + MCAST_OBJECT_DATA_LEN +
+    FRAME_OVERHEAD;
+  double hops = 0, tx, rx;
+  int i;
+
+  for(i = 1; i < NODES; i++) {
+    hops += nodes[i].hops;
+  }
+  tx = hops * packets * (attempts * frame + ACK_LEN);
+  rx = hops * packets * (frame + ACK_LEN);
+
+  printf("%-10s %8.1f s %10.0f %10.1f %10.1f\n", "unicast",
+         (NODES - 1) * packets * attempts * MCAST_OBJECT_CONF_TX_INTERVAL *
+         SLOT_MS / 1000,
+         hops * packets * attempts, energy_mj(tx, rx) / NODES,
+         energy_mj(tx, rx));
+}
+/*---------------------------------------------------------------------------*/
+static void
+multicast_report(clock_time_t elapsed)
+{
+  unsigned long frames = 0, data = 0, nacks = 0, advs = 0;
+  unsigned long tx = 0, rx = 0;
+  int i;
+
+  for(i = 0; i < NODES; i++) {
+    frames += nodes[i].tx_frames;
+    tx += nodes[i].tx_bytes;
+    rx += nodes[i].rx_bytes;
+    data += nodes[i].object.data_out;
+    nacks += nodes[i].object.nack_out;
+    advs += nodes[i].object.adv_out;
+  }
+
+  printf("%-10s %8.1f s %10lu %10.1f %10.1f   (%lu data, %lu NACK, %lu ADV, "
+         "%lu forwarded)\n", "multicast",
+         elapsed * SLOT_MS / 1000, frames, energy_mj(tx, rx) / NODES,
+         energy_mj(tx, rx), data, nacks, advs, frames - data - nacks - advs);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(mcast_object_bench_process, ev, data)
+{
+  static struct etimer et;
+  static const unsigned losses[] = { 100, 200 };
+  static clock_time_t start;
+  static int run, i;
+
+  PROCESS_BEGIN();
+
+  random_init(1);
+  topology_build();
+  for(i = 0; i < NODES; i++) {
+    snprintf(nodes[i].file, sizeof(nodes[i].file), "mcast-object-%02d.bin", i);
+  }
+
+  printf("%d nodes, %d hops deep, %lu-byte object in %lu pages of %d "
+         "packets\n", NODES, nodes[NODES - 1].hops, OBJECT_SIZE,
+         (OBJECT_SIZE + MCAST_OBJECT_PAGE_SIZE - 1) / MCAST_OBJECT_PAGE_SIZE,
+         MCAST_OBJECT_PAGE_PACKETS);
+
+  for(run = 0; run < sizeof(losses) / sizeof(losses[0]); run++) {
+    loss = losses[run];
+    completed = 0;
+    for(i = 0; i < NODES; i++) {
+      nodes[i].tx_frames = nodes[i].tx_bytes = nodes[i].rx_bytes = 0;
+      mcast_object_init(&nodes[i].object, nodes[i].file, output, complete);
+    }
+    object_write(run + 1, OBJECT_SIZE);
+
+    printf("\n%u%% frame loss      time     frames  mJ/node   mJ total\n",
+           loss / 10);
+    start = clock_time();
+    check(mcast_object_publish(&nodes[0].object, run + 1, OBJECT_SIZE),
+          "object published");
+
+    while(completed < NODES - 1 && clock_time() - start < DEADLINE) {
+      etimer_set(&et, CLOCK_SECOND / 20);
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    }
+    check(completed == NODES - 1, "every node complete");
+    multicast_report(clock_time() - start);
+    unicast_report();
+
+    for(i = 1; i < NODES; i++) {
+      check(mcast_object_is_complete(&nodes[i].object) &&
+            object_verify(i, run + 1, OBJECT_SIZE), "object stored intact");
+    }
+  }
+
+  /* A smaller object replaces the previous one entirely */
+  completed = 0;
+  object_write(run + 1, OBJECT_SIZE / 4);
+  start = clock_time();
+  check(mcast_object_publish(&nodes[0].object, run + 1, OBJECT_SIZE / 4),
+        "smaller object published");
+  while(completed < NODES - 1 && clock_time() - start < DEADLINE) {
+    etimer_set(&et, CLOCK_SECOND / 20);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  }
+  for(i = 1; i < NODES; i++) {
+    check(mcast_object_is_complete(&nodes[i].object) &&
+          object_verify(i, run + 1, OBJECT_SIZE / 4),
+          "smaller object stored without trailing bytes");
+  }
+
+  for(i = 0; i < NODES; i++) {
+    cfs_remove(nodes[i].file);
+  }
+
+  printf("errors: %lu\n", errors);
+  exit(errors == 0 ? 0 : 1);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
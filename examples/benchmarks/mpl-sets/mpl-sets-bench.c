@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *         Benchmark and checks for the MPL seed and buffered message sets
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-icmp6.h"
+#include "net/ipv6/multicast/uip-mcast6.h"
+#include "net/netstack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/*---------------------------------------------------------------------------*/
+#define DOMAINS        (MPL_DOMAIN_SET_SIZE - 1)
+#define SEEDS          (MPL_SEED_SET_SIZE / DOMAINS)
+#define MESSAGES       4 /* per seed, MPL_BUFFERED_MESSAGE_SET_SIZE / MPL_SEED_SET_SIZE */
+#define ROUNDS         200000
+#define CONTROL_ROUNDS 20000
+#define NEW_MESSAGES   200
+#define PAYLOAD_LEN    16
+
+/* Forwarding check: the last domain has one seed that sends these */
+#define FWD_DOMAIN     DOMAINS
+#define FWD_FIRST_SEQ  1
+#define FWD_MESSAGES   4
+#define FWD_DUP_EVERY  2                  /* ticks between copies of the first */
+#define FWD_DURATION   (CLOCK_SECOND * 3)
+#define FWD_MAX_TX     64
+
+static const uint8_t fill_order[MESSAGES] = { 1, 4, 2, 3 };
+static uip_ip6addr_t domains[MPL_DOMAIN_SET_SIZE];
+static unsigned long errors;
+
+static struct {
+  uint8_t seq;
+  clock_time_t time;
+} fwd_tx[FWD_MAX_TX];
+static int fwd_tx_count;
+static uint8_t fwd_capture;
+/*---------------------------------------------------------------------------*/
+PROCESS(mpl_sets_bench_process, "MPL sets benchmark");
+AUTOSTART_PROCESSES(&mpl_sets_bench_process);
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, unsigned long ops, double seconds)
+{
+  printf("%-40s %8.1f ns/message\n", name, seconds * 1e9 / ops);
+}
+/*---------------------------------------------------------------------------*/
+static void
+check(int condition, const char *what)
+{
+  if(!condition) {
+    printf("FAIL: %s\n", what);
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+seed_addr(uip_ip6addr_t *addr, int domain, int seed)
+{
+  uip_ip6addr(addr, 0xfd00, 0, 0, 0, 0, 0, domain + 1, seed + 1);
+}
+/*---------------------------------------------------------------------------*/
+/* An S=0 MPL data message from a seed, as it arrives from a neighbour */
+static uint8_t
+data_in_flags(int domain, int seed, uint8_t seq, uint8_t flags)
+{
+  uint8_t *hbh = UIP_IP_PAYLOAD(0);
+  uint8_t *udp = UIP_IP_PAYLOAD(8);
+  uint8_t ret;
+
+  memset(uip_buf, 0, UIP_IPH_LEN + 8 + UIP_UDPH_LEN + PAYLOAD_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_HBHO;
+  UIP_IP_BUF->ttl = 64;
+  seed_addr(&UIP_IP_BUF->srcipaddr, domain, seed);
+  uip_ip6addr_copy(&UIP_IP_BUF->destipaddr, &domains[domain]);
+
+  hbh[0] = UIP_PROTO_UDP;
+  hbh[1] = 0;
+  hbh[2] = HBHO_OPT_TYPE_MPL;
+  hbh[3] = MPL_OPT_LEN_S0;
+  hbh[4] = flags;
+  hbh[5] = seq;
+  hbh[6] = UIP_EXT_HDR_OPT_PADN;
+  hbh[7] = 0;
+
+  udp[1] = udp[3] = 0x33;
+  udp[5] = UIP_UDPH_LEN + PAYLOAD_LEN;
+  memset(udp + UIP_UDPH_LEN, seq, PAYLOAD_LEN);
+
+  uip_len = UIP_IPH_LEN + 8 + UIP_UDPH_LEN + PAYLOAD_LEN;
+  uip_ext_len = 8;
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+  ret = UIP_MCAST6.in();
+  uipbuf_clear();
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+data_in(int domain, int seed, uint8_t seq)
+{
+  return data_in_flags(domain, seed, seq, 0x20); /* S=0, M */
+}
+/*---------------------------------------------------------------------------*/
+/* Records the MPL data messages the engine forwards, instead of sending them */
+static enum netstack_ip_action
+fwd_output(const linkaddr_t *localdest)
+{
+  uint8_t *hbh = UIP_IP_PAYLOAD(0);
+
+  if(!fwd_capture) {
+    return NETSTACK_IP_PROCESS;
+  }
+  if(UIP_IP_BUF->proto == UIP_PROTO_HBHO && hbh[2] == HBHO_OPT_TYPE_MPL
+     && fwd_tx_count < FWD_MAX_TX) {
+    fwd_tx[fwd_tx_count].seq = hbh[5];
+    fwd_tx[fwd_tx_count].time = clock_time();
+    fwd_tx_count++;
+  }
+  return NETSTACK_IP_DROP;
+}
+static struct netstack_ip_packet_processor fwd_processor = {
+  .process_output = fwd_output
+};
+/*---------------------------------------------------------------------------*/
+/*
+ * A control message from a neighbour that holds messages first..first+7 of
+ * every seed in the domain, or of only every other seed
+ */
+static void
+control_in(int domain, uint8_t first, int every)
+{
+  uint8_t *info = UIP_ICMP_PAYLOAD;
+  uint16_t len = 0;
+  int seed;
+
+  memset(uip_buf, 0, UIP_BUFSIZE);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_ICMP6;
+  UIP_IP_BUF->ttl = MPL_IP_HOP_LIMIT;
+  uip_ip6addr(&UIP_IP_BUF->srcipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 0x99);
+  uip_ip6addr_copy(&UIP_IP_BUF->destipaddr, &domains[domain]);
+  UIP_IP_BUF->destipaddr.u8[1] = UIP_MCAST6_SCOPE_LINK_LOCAL;
+
+  for(seed = 0; seed < SEEDS; seed += every) {
+    info[len++] = first;
+    info[len++] = (1 << 2) | 3; /* one byte of bit vector, S=3 */
+    seed_addr((uip_ip6addr_t *)&info[len], domain, seed);
+    len += sizeof(uip_ip6addr_t);
+    info[len++] = 0xff;
+  }
+
+  uip_len = UIP_IPH_LEN + UIP_ICMPH_LEN + len;
+  uip_ext_len = 0;
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+  UIP_ICMP_BUF->type = ICMP6_MPL;
+  UIP_ICMP_BUF->icode = 0;
+  uip_icmp6_input(ICMP6_MPL, 0);
+}
+/*---------------------------------------------------------------------------*/
+/* Messages of one seed, copies of the first keep arriving from neighbours */
+static void
+check_forwarding(void)
+{
+  int sent[FWD_MESSAGES] = { 0 };
+  clock_time_t gap = FWD_DURATION;
+  int i;
+
+  for(i = 0; i < fwd_tx_count; i++) {
+    if((uint8_t)(fwd_tx[i].seq - FWD_FIRST_SEQ) < FWD_MESSAGES) {
+      sent[(uint8_t)(fwd_tx[i].seq - FWD_FIRST_SEQ)]++;
+    }
+    if(i > 0 && fwd_tx[i].time - fwd_tx[i - 1].time < gap) {
+      gap = fwd_tx[i].time - fwd_tx[i - 1].time;
+    }
+  }
+  printf("forwarded %d messages, sent", fwd_tx_count);
+  for(i = 0; i < FWD_MESSAGES; i++) {
+    printf(" %d", sent[i]);
+  }
+  printf(" times, at least %lu ticks apart\n", (unsigned long)gap);
+
+  check(sent[0] == 0, "message suppressed by copies of itself");
+  for(i = 1; i < FWD_MESSAGES; i++) {
+    check(sent[i] == MPL_DATA_MESSAGE_TIMER_EXPIRATIONS + 1,
+          "other messages forwarded on every expiration");
+  }
+  check(gap >= MPL_DATA_MESSAGE_TX_SPACING, "transmissions paced");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(mpl_sets_bench_process, ev, data)
+{
+  static int d, s, i;
+  static unsigned long ops;
+  static double t;
+  static struct etimer et;
+  static clock_time_t fwd_end;
+
+  PROCESS_BEGIN();
+
+  /* ff03::fc is the All MPL Forwarders domain the engine joins itself */
+  uip_ip6addr(&domains[0], 0xff03, 0, 0, 0, 0, 0, 0, 0xfc);
+  for(d = 1; d < MPL_DOMAIN_SET_SIZE; d++) {
+    uip_ip6addr(&domains[d], 0xff03, 0, 0, 0, 0, 0, 1, d);
+    check(uip_ds6_maddr_add(&domains[d]) != NULL, "domain joined");
+  }
+
+  /*
+   * Forwarding: the data timer is shared by the seed's messages, but a copy
+   * of one of them must not hold back the others
+   */
+  netstack_ip_packet_processor_add(&fwd_processor);
+  fwd_capture = 1;
+  for(i = 0; i < FWD_MESSAGES; i++) {
+    check(data_in(FWD_DOMAIN, 0, FWD_FIRST_SEQ + i) == UIP_MCAST6_ACCEPT,
+          "new message accepted");
+  }
+  fwd_end = clock_time() + FWD_DURATION;
+  while(clock_time() < fwd_end) {
+    data_in_flags(FWD_DOMAIN, 0, FWD_FIRST_SEQ, 0x00); /* S=0 */
+    etimer_set(&et, FWD_DUP_EVERY);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  }
+  fwd_capture = 0;
+  check_forwarding();
+
+  printf("%d domains x %d seeds x %d messages, seed ring of %d\n",
+         DOMAINS, SEEDS, MESSAGES, MPL_SEED_RING_SIZE);
+
+  /* Fill the sets, every seed out of order: 1, 4, 2, 3 */
+  for(d = 0; d < DOMAINS; d++) {
+    for(s = 0; s < SEEDS; s++) {
+      for(i = 0; i < MESSAGES; i++) {
+        check(data_in(d, s, fill_order[i]) == UIP_MCAST6_ACCEPT,
+              "new message accepted");
+      }
+    }
+  }
+  for(d = 0; d < DOMAINS; d++) {
+    for(s = 0; s < SEEDS; s++) {
+      for(i = 0; i < MESSAGES; i++) {
+        check(data_in(d, s, 1 + i) == UIP_MCAST6_DROP, "duplicate dropped");
+      }
+    }
+  }
+
+  /* Duplicates: the common case once a message has spread */
+  t = now();
+  for(ops = 0; ops < ROUNDS; ops++) {
+    data_in(ops % DOMAINS, (ops / DOMAINS) % SEEDS, 1 + ops % MESSAGES);
+  }
+  report("duplicate data message", ops, now() - t);
+
+  /* Control messages that agree with our sets */
+  t = now();
+  for(ops = 0; ops < CONTROL_ROUNDS; ops++) {
+    control_in(ops % DOMAINS, 1, 1);
+  }
+  report("consistent control message", ops, now() - t);
+
+  /* Control messages that miss half of our seeds */
+  t = now();
+  for(ops = 0; ops < CONTROL_ROUNDS; ops++) {
+    control_in(ops % DOMAINS, 1, 2);
+  }
+  report("control message missing seeds", ops, now() - t);
+
+  /* New messages once the buffers are full, each reclaiming an old one */
+  t = now();
+  ops = 0;
+  for(i = 0; i < NEW_MESSAGES; i++) {
+    for(d = 0; d < DOMAINS; d++) {
+      for(s = 0; s < SEEDS; s++) {
+        if(data_in(d, s, 1 + MESSAGES + i) != UIP_MCAST6_ACCEPT) {
+          check(0, "new message accepted after reclaim");
+        }
+        ops++;
+      }
+    }
+  }
+  report("new data message, buffers full", ops, now() - t);
+
+  /* The newest messages are kept, the oldest ones are too old now */
+  for(d = 0; d < DOMAINS; d++) {
+    for(s = 0; s < SEEDS; s++) {
+      check(data_in(d, s, MESSAGES + NEW_MESSAGES) == UIP_MCAST6_DROP,
+            "newest message kept");
+      check(data_in(d, s, 1) == UIP_MCAST6_DROP, "oldest message dropped");
+    }
+  }
+
+  printf("errors: %lu\n", errors);
+  exit(errors == 0 ? 0 : 1);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef PROJECT_CONF_H_
+#define PROJECT_CONF_H_
+
+#include "net/ipv6/multicast/uip-mcast6-engines.h"
+
+/*
+ * A forwarder in a busy deployment: several domains with many seeds each,
+ * plus a domain with a single seed for the forwarding check
+ */
+#define UIP_MCAST6_CONF_ENGINE             UIP_MCAST6_ENGINE_MPL
+#define MPL_CONF_DOMAIN_SET_SIZE           (4 + 1)
+#define MPL_CONF_SEED_SET_SIZE             (32 + 1)
+#define MPL_CONF_BUFFERED_MESSAGE_SET_SIZE (128 + 4)
+#define MPL_CONF_SEED_RING_SIZE            8
+#define MPL_CONF_SEED_HASH_SIZE            32
+#define MPL_CONF_PROACTIVE_FORWARDING      1
+
+/* Native clock ticks are milliseconds: keep the forwarding check short */
+#define MPL_CONF_DATA_MESSAGE_IMIN         64
+#define MPL_CONF_DATA_MESSAGE_IMAX         2
+
+/* A data and a control address per domain */
+#define UIP_CONF_DS6_MADDR_NBU             (MPL_CONF_DOMAIN_SET_SIZE * 2)
+
+#endif /* PROJECT_CONF_H_ */
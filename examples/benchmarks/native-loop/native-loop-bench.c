@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Wakeups and CPU time of the native main loop per forwarded packet
+ */
+
+#include "contiki.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <err.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+/*---------------------------------------------------------------------------*/
+#define PACKETS      2000
+#define PACKET_LEN   128
+#define INTERVAL_US  500      /* Between two packets from the peer */
+#define IDLE_SECONDS 3
+#define DEADLINE     (CLOCK_SECOND * 30)
+#define IDLE_FDS     16       /* Quiet descriptors, e.g. shell and TCP servers */
+/*---------------------------------------------------------------------------*/
+/*
+ * The peer stands in for both sides of a border router: it sends
+ * packets on one socket, as the tun or SLIP side would, and counts those
+ * forwarded back on the other.
+ */
+static int in_fd = -1;
+static int out_fd = -1;
+static int idle_fds[IDLE_FDS][2];
+static unsigned long forwarded;
+static unsigned long errors;
+/*---------------------------------------------------------------------------*/
+PROCESS(native_loop_bench_process, "Native main loop benchmark");
+AUTOSTART_PROCESSES(&native_loop_bench_process);
+/*---------------------------------------------------------------------------*/
+static void
+check(int condition, const char *what)
+{
+  if(!condition) {
+    printf("FAIL: %s\n", what);
+    errors++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static double
+cpu_seconds(void)
+{
+  struct rusage ru;
+
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+    ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+/*---------------------------------------------------------------------------*/
+static int
+forward_set_fd(fd_set *rset, fd_set *wset)
+{
+  FD_SET(in_fd, rset);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+forward_handle_fd(fd_set *rset, fd_set *wset)
+{
+  uint8_t buf[PACKET_LEN];
+  ssize_t len;
+
+  if(!FD_ISSET(in_fd, rset)) {
+    return;
+  }
+  /* Drain the socket, as the edge-triggered epoll backend requires */
+  while((len = read(in_fd, buf, sizeof(buf))) > 0) {
+    if(write(out_fd, buf, len) == len) {
+      forwarded++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static const struct select_callback forward_fd = {
+  forward_set_fd, forward_handle_fd
+};
+/*---------------------------------------------------------------------------*/
+static int
+idle_set_fd(fd_set *rset, fd_set *wset)
+{
+  int i;
+
+  for(i = 0; i < IDLE_FDS; i++) {
+    FD_SET(idle_fds[i][0], rset);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+idle_handle_fd(fd_set *rset, fd_set *wset)
+{
+  int i;
+
+  for(i = 0; i < IDLE_FDS; i++) {
+    check(!FD_ISSET(idle_fds[i][0], rset), "idle descriptor quiet");
+  }
+}
+/*---------------------------------------------------------------------------*/
+static const struct select_callback idle_fd = {
+  idle_set_fd, idle_handle_fd
+};
+/*---------------------------------------------------------------------------*/
+/* Exits with 0 if every packet came back */
+static void
+peer(int tx, int rx)
+{
+  uint8_t buf[PACKET_LEN];
+  unsigned long received = 0;
+  int i;
+
+  memset(buf, 0xa5, sizeof(buf));
+  fcntl(rx, F_SETFL, O_NONBLOCK);
+  for(i = 0; i < PACKETS; i++) {
+    if(write(tx, buf, sizeof(buf)) != sizeof(buf)) {
+      _exit(2);
+    }
+    usleep(INTERVAL_US);
+    while(read(rx, buf, sizeof(buf)) > 0) {
+      received++;
+    }
+  }
+  for(i = 0; i < 1000 && received < PACKETS; i++) {
+    usleep(1000);
+    while(read(rx, buf, sizeof(buf)) > 0) {
+      received++;
+    }
+  }
+  _exit(received == PACKETS ? 0 : 1);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(native_loop_bench_process, ev, data)
+{
+  static struct etimer et;
+  static struct select_stats base;
+  static clock_time_t start;
+  static double cpu;
+  static pid_t pid;
+  static int i;
+  const struct select_stats *stats = select_get_stats();
+  int in[2];
+  int out[2];
+  int status;
+
+  PROCESS_BEGIN();
+
+  /* Datagram sockets keep the packet boundaries */
+  if(socketpair(AF_UNIX, SOCK_DGRAM, 0, in) < 0 ||
+     socketpair(AF_UNIX, SOCK_DGRAM, 0, out) < 0) {
+    err(1, "socketpair");
+  }
+  pid = fork();
+  if(pid < 0) {
+    err(1, "fork");
+  } else if(pid == 0) {
+    close(in[0]);
+    close(out[0]);
+    peer(in[1], out[1]);
+  }
+  close(in[1]);
+  close(out[1]);
+  in_fd = in[0];
+  out_fd = out[0];
+  fcntl(in_fd, F_SETFL, O_NONBLOCK);
+  for(i = 0; i < IDLE_FDS; i++) {
+    if(socketpair(AF_UNIX, SOCK_DGRAM, 0, idle_fds[i]) < 0) {
+      err(1, "socketpair");
+    }
+    select_set_callback(idle_fds[i][0], &idle_fd);
+  }
+
+  printf("%s backend, %d packets of %d bytes every %d us, %d idle "
+         "descriptors\n", SELECT_CONF_EPOLL ? "epoll" : "select", PACKETS,
+         PACKET_LEN, INTERVAL_US, IDLE_FDS);
+
+  base = *stats;
+  cpu = cpu_seconds();
+  start = clock_time();
+  select_set_callback(in_fd, &forward_fd);
+  while(forwarded < PACKETS && clock_time() - start < DEADLINE) {
+    etimer_set(&et, CLOCK_SECOND / 10);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  }
+  cpu = cpu_seconds() - cpu;
+  check(forwarded == PACKETS, "every packet forwarded");
+  if(forwarded > 0) {
+    printf("%-32s %8.2f\n", "wakeups per forwarded packet",
+           (double)(stats->wakeups - base.wakeups) / forwarded);
+    printf("%-32s %8.2f\n", "handler calls per forwarded packet",
+           (double)(stats->fd_events - base.fd_events) / forwarded);
+    printf("%-32s %8.2f us\n", "CPU time per forwarded packet",
+           cpu * 1e6 / forwarded);
+  }
+
+  waitpid(pid, &status, 0);
+  check(WIFEXITED(status) && WEXITSTATUS(status) == 0,
+        "every packet back at the peer");
+
+  /* Idle: nothing but this process's own timer */
+  base = *stats;
+  cpu = cpu_seconds();
+  etimer_set(&et, CLOCK_SECOND * IDLE_SECONDS);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  cpu = cpu_seconds() - cpu;
+  printf("%-32s %8.2f\n", "idle wakeups per second",
+         (double)(stats->wakeups - base.wakeups) / IDLE_SECONDS);
+  printf("%-32s %8.2f ms\n", "idle CPU time per second",
+         cpu * 1e3 / IDLE_SECONDS);
+
+  select_set_callback(in_fd, NULL);
+  close(in_fd);
+  close(out_fd);
+  for(i = 0; i < IDLE_FDS; i++) {
+    select_set_callback(idle_fds[i][0], NULL);
+    close(idle_fds[i][0]);
+    close(idle_fds[i][1]);
+  }
+
+  printf("errors: %lu\n", errors);
+  exit(errors == 0 ? 0 : 1);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Throughput benchmark for the block-based SLIP codec
+ */
+
+#include "contiki.h"
+#include "lib/slip-codec.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <err.h>
+#include <sys/socket.h>
+/*---------------------------------------------------------------------------*/
+#define FRAME_COUNT  256
+#define FRAME_MAXLEN 1280
+#define ROUNDS       200
+/*---------------------------------------------------------------------------*/
+static uint8_t frames[FRAME_COUNT][FRAME_MAXLEN];
+static size_t frame_len[FRAME_COUNT];
+static uint8_t encoded[FRAME_COUNT * SLIP_CODEC_MAX_ENCODED_LEN(FRAME_MAXLEN)];
+static size_t encoded_len;
+static uint8_t rxframe[FRAME_MAXLEN];
+static unsigned long received;
+static unsigned long errors;
+/*---------------------------------------------------------------------------*/
+PROCESS(slip_codec_bench_process, "SLIP codec benchmark");
+AUTOSTART_PROCESSES(&slip_codec_bench_process);
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, size_t bytes, double seconds)
+{
+  printf("%-28s %8.1f MB/s\n", name, bytes / seconds / 1e6);
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_frame(const uint8_t *frame, size_t len, void *ptr)
+{
+  int i = received % FRAME_COUNT;
+  if(len != frame_len[i] || memcmp(frame, frames[i], len) != 0) {
+    errors++;
+  }
+  received++;
+}
+/*---------------------------------------------------------------------------*/
+/* The byte-at-a-time encoder the native border router used to have */
+static size_t
+bytewise_encode(const uint8_t *p, size_t len, uint8_t *out)
+{
+  size_t i;
+  size_t n = 0;
+
+  for(i = 0; i < len; i++) {
+    switch(p[i]) {
+    case SLIP_CODEC_END:
+      out[n++] = SLIP_CODEC_ESC;
+      out[n++] = SLIP_CODEC_ESC_END;
+      break;
+    case SLIP_CODEC_ESC:
+      out[n++] = SLIP_CODEC_ESC;
+      out[n++] = SLIP_CODEC_ESC_ESC;
+      break;
+    default:
+      out[n++] = p[i];
+      break;
+    }
+  }
+  out[n++] = SLIP_CODEC_END;
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/* ...and its decoder, one byte per call */
+static void
+bytewise_decode(uint8_t c)
+{
+  static size_t len;
+  static int esc;
+
+  if(esc) {
+    esc = 0;
+    if(c == SLIP_CODEC_ESC_END) {
+      c = SLIP_CODEC_END;
+    } else if(c == SLIP_CODEC_ESC_ESC) {
+      c = SLIP_CODEC_ESC;
+    }
+  } else if(c == SLIP_CODEC_ESC) {
+    esc = 1;
+    return;
+  } else if(c == SLIP_CODEC_END) {
+    if(len > 0) {
+      check_frame(rxframe, len, NULL);
+      len = 0;
+    }
+    return;
+  }
+  if(len < sizeof(rxframe)) {
+    rxframe[len++] = c;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_frames(void)
+{
+  int i;
+  size_t j;
+
+  for(i = 0; i < FRAME_COUNT; i++) {
+    /* A mix of 802.15.4-sized and full IPv6 MTU frames */
+    frame_len[i] = (i & 1) ? 1 + random_rand() % 127 : FRAME_MAXLEN;
+    for(j = 0; j < frame_len[i]; j++) {
+      frames[i][j] = random_rand();
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_memory(void)
+{
+  struct slip_decoder d;
+  size_t bytes = 0;
+  double t;
+  int r;
+  int i;
+
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    encoded_len = 0;
+    for(i = 0; i < FRAME_COUNT; i++) {
+      encoded_len += bytewise_encode(frames[i], frame_len[i],
+                                     encoded + encoded_len);
+    }
+    bytes += encoded_len;
+  }
+  report("encode, byte-wise", bytes, now() - t);
+
+  bytes = 0;
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    encoded_len = 0;
+    for(i = 0; i < FRAME_COUNT; i++) {
+      encoded_len += slip_encode(frames[i], frame_len[i],
+                                 encoded + encoded_len,
+                                 sizeof(encoded) - encoded_len);
+    }
+    bytes += encoded_len;
+  }
+  report("encode, block", bytes, now() - t);
+
+  received = errors = 0;
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    for(i = 0; i < encoded_len; i++) {
+      bytewise_decode(encoded[i]);
+    }
+  }
+  report("decode, byte-wise", encoded_len * ROUNDS, now() - t);
+
+  slip_decoder_init(&d, rxframe, sizeof(rxframe));
+  t = now();
+  for(r = 0; r < ROUNDS; r++) {
+    slip_decode(&d, encoded, encoded_len, check_frame, NULL);
+  }
+  report("decode, block", encoded_len * ROUNDS, now() - t);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_loopback(void)
+{
+  static uint8_t rxbuf[4096];
+  struct slip_decoder d;
+  size_t off;
+  int sv[2];
+  int size = sizeof(encoded);
+  FILE *in;
+  double t;
+  ssize_t n;
+  ssize_t m;
+  int r;
+  int i;
+  int c;
+
+  if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+    err(1, "socketpair");
+  }
+  setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+  setsockopt(sv[1], SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+  /* Old style: one write per frame, stdio byte-wise reads */
+  in = fdopen(sv[1], "r");
+  t = now();
+  for(r = 0; r < ROUNDS / 10; r++) {
+    off = 0;
+    for(i = 0; i < FRAME_COUNT; i++) {
+      n = bytewise_encode(frames[i], frame_len[i], encoded);
+      if(write(sv[0], encoded, n) != n) {
+        err(1, "write");
+      }
+      off += n;
+      /* Drain as we go so that the socket buffer never fills up */
+      while(off > 0) {
+        if((c = fgetc(in)) == EOF) {
+          err(1, "fgetc");
+        }
+        bytewise_decode(c);
+        off--;
+      }
+    }
+  }
+  report("loopback, byte-wise", encoded_len * (ROUNDS / 10), now() - t);
+
+  /* Block codec: all queued frames in one write, large reads */
+  slip_decoder_init(&d, rxframe, sizeof(rxframe));
+  t = now();
+  for(r = 0; r < ROUNDS / 10; r++) {
+    encoded_len = 0;
+    for(i = 0; i < FRAME_COUNT; i++) {
+      encoded_len += slip_encode(frames[i], frame_len[i],
+                                 encoded + encoded_len,
+                                 sizeof(encoded) - encoded_len);
+    }
+    off = 0;
+    while(off < encoded_len) {
+      n = write(sv[0], encoded + off, encoded_len - off);
+      if(n <= 0) {
+        err(1, "write");
+      }
+      off += n;
+      /* Drain whatever the kernel took */
+      while(n > 0) {
+        m = read(sv[1], rxbuf, sizeof(rxbuf));
+        if(m <= 0) {
+          err(1, "read");
+        }
+        slip_decode(&d, rxbuf, m, check_frame, NULL);
+        n -= m;
+      }
+    }
+  }
+  report("loopback, block", encoded_len * (ROUNDS / 10), now() - t);
+
+  fclose(in);
+  close(sv[0]);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(slip_codec_bench_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  make_frames();
+
+  received = errors = 0;
+  bench_memory();
+  bench_loopback();
+
+  printf("frames decoded: %lu, errors: %lu\n", received, errors);
+  exit(errors == 0 ? 0 : 1);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -88,8 +88,7 @@ res_post_handler(coap_message_t *request, coap_message_t *response, uint8_t *buf
         coap_set_header_block2(resp, 0, 1, request_metadata.block2_size);
       }
 
-      /* Warning: No check for serialization error. */
-      transaction->message_len = coap_serialize_message(resp, transaction->message);
+      coap_serialize_transaction(transaction, resp);
       coap_send_transaction(transaction);
     }
   } else {
@@ -111,8 +111,7 @@ res_resume_handler()
        */
       coap_set_header_block2(response, separate_store->request_metadata.block2_num, 0, separate_store->request_metadata.block2_size);
 
-      /* Warning: No check for serialization error. */
-      transaction->message_len = coap_serialize_message(response, transaction->message);
+      coap_serialize_transaction(transaction, response);
       coap_send_transaction(transaction);
       /* The engine will clear the transaction (right after send for NON, after acked for CON). */
 
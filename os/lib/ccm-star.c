@@ -59,84 +59,27 @@ set_iv(uint8_t *iv,
   iv[15] = counter;
 }
 /*---------------------------------------------------------------------------*/
-/* XORs the block m[pos] ... m[pos + 15] with K_{counter} */
+/* Feeds the additional authenticated data into the CBC-MAC state x */
 static void
-ctr_step(const uint8_t *nonce,
-    uint8_t pos,
-    uint8_t *m_and_result,
-    uint8_t m_len,
-    uint8_t counter)
+mic_aad(uint8_t *x, const uint8_t *a, uint8_t a_len)
 {
-  uint8_t a[AES_128_BLOCK_SIZE];
+  uint16_t pos;
   uint8_t i;
-  
-  set_iv(a, CCM_STAR_ENCRYPTION_FLAGS, nonce, counter);
-  AES_128.encrypt(a);
-  
-  for(i = 0; (pos + i < m_len) && (i < AES_128_BLOCK_SIZE); i++) {
-    m_and_result[pos + i] ^= a[i];
+
+  x[1] = x[1] ^ a_len;
+  for(i = 2; (i - 2 < a_len) && (i < AES_128_BLOCK_SIZE); i++) {
+    x[i] ^= a[i - 2];
   }
-}
-/*---------------------------------------------------------------------------*/
-static void
-mic(const uint8_t *nonce,
-    const uint8_t *m, uint8_t m_len,
-    const uint8_t *a, uint8_t a_len,
-    uint8_t *result,
-    uint8_t mic_len)
-{
-  uint8_t x[AES_128_BLOCK_SIZE];
-  uint8_t pos;
-  uint8_t i;
-  
-  set_iv(x, CCM_STAR_AUTH_FLAGS(a_len, mic_len), nonce, m_len);
+
   AES_128.encrypt(x);
-  
-  if(a_len) {
-    x[1] = x[1] ^ a_len;
-    for(i = 2; (i - 2 < a_len) && (i < AES_128_BLOCK_SIZE); i++) {
-      x[i] ^= a[i - 2];
-    }
-    
-    AES_128.encrypt(x);
-    
-    pos = 14;
-    while(pos < a_len) {
-      for(i = 0; (pos + i < a_len) && (i < AES_128_BLOCK_SIZE); i++) {
-        x[i] ^= a[pos + i];
-      }
-      pos += AES_128_BLOCK_SIZE;
-      AES_128.encrypt(x);
-    }
-  }
-  
-  if(m_len) {
-    pos = 0;
-    while(pos < m_len) {
-      for(i = 0; (pos + i < m_len) && (i < AES_128_BLOCK_SIZE); i++) {
-        x[i] ^= m[pos + i];
-      }
-      pos += AES_128_BLOCK_SIZE;
-      AES_128.encrypt(x);
+
+  pos = 14;
+  while(pos < a_len) {
+    for(i = 0; (pos + i < a_len) && (i < AES_128_BLOCK_SIZE); i++) {
+      x[i] ^= a[pos + i];
     }
-  }
-  
-  ctr_step(nonce, 0, x, AES_128_BLOCK_SIZE, 0);
-  
-  memcpy(result, x, mic_len);
-}
-/*---------------------------------------------------------------------------*/
-static void
-ctr(const uint8_t *nonce, uint8_t *m, uint8_t m_len)
-{
-  uint8_t pos;
-  uint8_t counter;
-  
-  pos = 0;
-  counter = 1;
-  while(pos < m_len) {
-    ctr_step(nonce, pos, m, m_len, counter++);
     pos += AES_128_BLOCK_SIZE;
+    AES_128.encrypt(x);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -146,6 +89,11 @@ set_key(const uint8_t *key)
   AES_128.set_key(key);
 }
 /*---------------------------------------------------------------------------*/
+/*
+ * CBC-MAC and CTR in a single pass over the message: each block is
+ * authenticated and encrypted (or decrypted and authenticated) while it
+ * is hot, instead of walking the message twice.
+ */
 static void
 aead(const uint8_t* nonce,
     uint8_t* m, uint8_t m_len,
@@ -153,20 +101,51 @@ aead(const uint8_t* nonce,
     uint8_t *result, uint8_t mic_len,
     int forward)
 {
-  if(!forward) {
-    /* decrypt */
-    ctr(nonce, m, m_len);
+  uint8_t x[AES_128_BLOCK_SIZE];
+  uint8_t ctr[AES_128_BLOCK_SIZE];
+  uint8_t s[AES_128_BLOCK_SIZE];
+  uint16_t pos;
+  uint8_t len;
+  uint8_t i;
+
+  /* B_0 */
+  set_iv(x, CCM_STAR_AUTH_FLAGS(a_len, mic_len), nonce, m_len);
+  AES_128.encrypt(x);
+
+  if(a_len) {
+    mic_aad(x, a, a_len);
   }
-  
-  mic(nonce,
-    m, m_len,
-    a, a_len,
-    result,
-    mic_len);
-  
-  if(forward) {
-    /* encrypt */
-    ctr(nonce, m, m_len);
+
+  /* A_0; A_i only differ in their last byte since m_len < 256 */
+  set_iv(ctr, CCM_STAR_ENCRYPTION_FLAGS, nonce, 0);
+
+  for(pos = 0; pos < m_len; pos += AES_128_BLOCK_SIZE) {
+    len = MIN(m_len - pos, AES_128_BLOCK_SIZE);
+    ctr[15]++;
+    memcpy(s, ctr, AES_128_BLOCK_SIZE);
+    AES_128.encrypt(s);
+
+    if(forward) {
+      /* authenticate the plaintext, then encrypt it */
+      for(i = 0; i < len; i++) {
+        x[i] ^= m[pos + i];
+        m[pos + i] ^= s[i];
+      }
+    } else {
+      /* decrypt, then authenticate the plaintext */
+      for(i = 0; i < len; i++) {
+        m[pos + i] ^= s[i];
+        x[i] ^= m[pos + i];
+      }
+    }
+    AES_128.encrypt(x);
+  }
+
+  /* MIC is the CBC-MAC encrypted with S_0 */
+  ctr[15] = 0;
+  AES_128.encrypt(ctr);
+  for(i = 0; i < mic_len; i++) {
+    result[i] = x[i] ^ ctr[i];
   }
 }
 /*---------------------------------------------------------------------------*/
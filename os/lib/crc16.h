@@ -55,6 +55,49 @@
 #ifndef CRC16_H_
 #define CRC16_H_
 
+#include "contiki.h"
+
+/**
+ * Software algorithm used by crc16_data(): 0 for the bitwise
+ * crc16_add() loop (no table), 1 for a 512-byte table in ROM, 4 or 8
+ * for slice-by-4/8 (the table in ROM plus 1.5/3.5 KiB of tables built
+ * in RAM on first use).
+ */
+#ifdef CRC16_CONF_SLICES
+#define CRC16_SLICES CRC16_CONF_SLICES
+#else
+#define CRC16_SLICES 0
+#endif
+
+#if CRC16_SLICES != 0 && CRC16_SLICES != 1 && CRC16_SLICES != 4 && CRC16_SLICES != 8
+#error "CRC16_CONF_SLICES must be 0, 1, 4 or 8"
+#endif
+
+/**
+ * Structure of CRC16 drivers. A platform with a CRC unit sets
+ * CRC16_CONF_DRIVER to the name of its driver, which crc16_data() then
+ * uses instead of the software implementation. The hardware must
+ * compute the same (reflected) CRC-CCITT as crc16_add().
+ */
+struct crc16_driver {
+  /**
+   * \brief Continue the CRC16 \p acc over \p len bytes at \p data
+   */
+  unsigned short (* data)(const unsigned char *data, int len,
+                          unsigned short acc);
+};
+
+#ifdef CRC16_CONF_DRIVER
+#define CRC16_DRIVER CRC16_CONF_DRIVER
+extern const struct crc16_driver CRC16_DRIVER;
+#endif /* CRC16_CONF_DRIVER */
+
+/** A buffer that is part of a scattered data area */
+struct crc16_block {
+  const unsigned char *data;
+  int len;
+};
+
 /**
  * \brief      Update an accumulated CRC16 checksum with one byte.
  * \param b    The byte to be added to the checksum
@@ -80,16 +123,37 @@ unsigned short crc16_add(unsigned char b, unsigned short crc);
  * \param acc  The accumulated CRC that is to be updated (or zero).
  * \return     The CRC16 checksum.
  *
- *             This function calculates the CRC16 checksum of a data area.
- *
- *             \note The algorithm used in this implementation is
- *             tailored for a running checksum and does not perform as
- *             well as a table-driven algorithm when checksumming an
- *             entire data block.
+ *             This function calculates the CRC16 checksum of a data
+ *             area, using the platform's CRC16_CONF_DRIVER if any and
+ *             the algorithm selected by CRC16_CONF_SLICES otherwise.
  */
 unsigned short crc16_data(const unsigned char *data, int datalen,
 			  unsigned short acc);
 
+/**
+ * \brief      Calculate the CRC16 over a data area in software
+ * \param data Pointer to the data
+ * \param datalen The length of the data
+ * \param acc  The accumulated CRC that is to be updated (or zero).
+ * \return     The CRC16 checksum.
+ *
+ *             Same as crc16_data() but always uses the algorithm
+ *             selected by CRC16_CONF_SLICES. Hardware drivers can
+ *             fall back to it, e.g. for short or unaligned data.
+ */
+unsigned short crc16_sw_data(const unsigned char *data, int datalen,
+                             unsigned short acc);
+
+/**
+ * \brief      Calculate the CRC16 over a scattered data area
+ * \param blocks The buffers, in order
+ * \param count The number of buffers
+ * \param acc  The accumulated CRC that is to be updated (or zero).
+ * \return     The CRC16 checksum of the concatenated buffers.
+ */
+unsigned short crc16_blocks(const struct crc16_block *blocks, int count,
+                            unsigned short acc);
+
 #endif /* CRC16_H_ */
 
 /** @} */
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \addtogroup slip-codec
+ * @{ */
+
+/**
+ * \file
+ *         Implementation of the block-based SLIP codec
+ */
+
+#include "lib/slip-codec.h"
+
+#include <string.h>
+/*---------------------------------------------------------------------------*/
+/* Find the first occurrence of c in [p, end), or end if there is none */
+static const uint8_t *
+scan(const uint8_t *p, const uint8_t *end, uint8_t c)
+{
+  const uint8_t *r = memchr(p, c, end - p);
+  return r != NULL ? r : end;
+}
+/*---------------------------------------------------------------------------*/
+size_t
+slip_encode(const uint8_t *data, size_t len, uint8_t *out, size_t size)
+{
+  const uint8_t *p = data;
+  const uint8_t *end = data + len;
+  const uint8_t *e;
+  const uint8_t *c;
+  const uint8_t *s;
+  size_t n = 0;
+
+  /* Next END and ESC; each is only searched for again once passed */
+  e = scan(p, end, SLIP_CODEC_END);
+  c = scan(p, end, SLIP_CODEC_ESC);
+
+  while(1) {
+    s = e < c ? e : c;
+
+    /* Copy the run that needs no escaping */
+    if(n + (s - p) > size) {
+      return 0;
+    }
+    memcpy(out + n, p, s - p);
+    n += s - p;
+
+    if(s == end) {
+      break;
+    }
+
+    if(n + 2 > size) {
+      return 0;
+    }
+    out[n++] = SLIP_CODEC_ESC;
+    p = s + 1;
+    if(s == e) {
+      out[n++] = SLIP_CODEC_ESC_END;
+      e = scan(p, end, SLIP_CODEC_END);
+    } else {
+      out[n++] = SLIP_CODEC_ESC_ESC;
+      c = scan(p, end, SLIP_CODEC_ESC);
+    }
+  }
+
+  if(n + 1 > size) {
+    return 0;
+  }
+  out[n++] = SLIP_CODEC_END;
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+void
+slip_decoder_init(struct slip_decoder *d, uint8_t *buf, size_t size)
+{
+  memset(d, 0, sizeof(*d));
+  d->buf = buf;
+  d->size = size;
+}
+/*---------------------------------------------------------------------------*/
+static void
+append(struct slip_decoder *d, const uint8_t *data, size_t len)
+{
+  if(d->overflow || d->len + len > d->size) {
+    /* Drop the rest of this frame */
+    d->overflow = 1;
+    return;
+  }
+  memcpy(d->buf + d->len, data, len);
+  d->len += len;
+}
+/*---------------------------------------------------------------------------*/
+void
+slip_decode(struct slip_decoder *d, const uint8_t *data, size_t len,
+            slip_frame_callback_t cb, void *ptr)
+{
+  const uint8_t *p = data;
+  const uint8_t *end = data + len;
+  const uint8_t *e;
+  const uint8_t *c;
+  const uint8_t *s;
+  uint8_t b;
+
+  e = scan(p, end, SLIP_CODEC_END);
+  c = scan(p, end, SLIP_CODEC_ESC);
+
+  while(p < end) {
+    if(d->esc) {
+      /* The byte following an ESC, possibly from the previous call */
+      d->esc = 0;
+      b = *p++;
+      if(b == SLIP_CODEC_ESC_END) {
+        b = SLIP_CODEC_END;
+      } else if(b == SLIP_CODEC_ESC_ESC) {
+        b = SLIP_CODEC_ESC;
+      }
+      append(d, &b, 1);
+      if(e < p) {
+        e = scan(p, end, SLIP_CODEC_END);
+      }
+      if(c < p) {
+        c = scan(p, end, SLIP_CODEC_ESC);
+      }
+      continue;
+    }
+
+    s = e < c ? e : c;
+    append(d, p, s - p);
+    if(s == end) {
+      return;
+    }
+    p = s + 1;
+
+    if(s == c) {
+      d->esc = 1;
+      c = scan(p, end, SLIP_CODEC_ESC);
+      continue;
+    }
+
+    e = scan(p, end, SLIP_CODEC_END);
+    if(d->overflow) {
+      d->dropped++;
+      d->overflow = 0;
+      d->len = 0;
+    } else if(d->len > 0) {
+      cb(d->buf, d->len, ptr);
+      d->len = 0;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+
+/** @} */
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Header file for the block-based SLIP (RFC 1055) codec
+ */
+
+/** \addtogroup lib
+ * @{ */
+
+/**
+ * \defgroup slip-codec Block-based SLIP codec
+ *
+ * Encodes and decodes SLIP frames a buffer at a time rather than a byte at
+ * a time. Runs of bytes that need no escaping are located with memchr() and
+ * copied with memcpy(), which makes the codec suitable for hosts that move
+ * a lot of traffic over a serial line or a TCP connection, such as the
+ * native border router.
+ *
+ * @{
+ */
+
+#ifndef SLIP_CODEC_H_
+#define SLIP_CODEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SLIP_CODEC_END     0300
+#define SLIP_CODEC_ESC     0333
+#define SLIP_CODEC_ESC_END 0334
+#define SLIP_CODEC_ESC_ESC 0335
+
+/** Upper bound for the encoded size of a frame of \a len bytes */
+#define SLIP_CODEC_MAX_ENCODED_LEN(len) (2 * (len) + 1)
+
+/** Called by slip_decode() for each complete frame */
+typedef void (*slip_frame_callback_t)(const uint8_t *frame, size_t len,
+                                      void *ptr);
+
+/** State of a streaming SLIP decoder */
+struct slip_decoder {
+  uint8_t *buf;
+  size_t size;
+  size_t len;
+  uint8_t esc;
+  uint8_t overflow;
+  unsigned long dropped;  /**< Frames dropped because they did not fit */
+};
+
+/**
+ * \brief      Encode one frame
+ * \param data The frame to encode
+ * \param len  The length of the frame
+ * \param out  Where to write the encoded frame
+ * \param size The size of \a out
+ * \return     The length of the encoded frame, including the trailing
+ *             END, or 0 if it does not fit in \a out
+ */
+size_t slip_encode(const uint8_t *data, size_t len, uint8_t *out, size_t size);
+
+/**
+ * \brief      Initialize a decoder
+ * \param d    The decoder
+ * \param buf  Buffer for the frame being received
+ * \param size The size of \a buf, i.e. the largest frame accepted
+ */
+void slip_decoder_init(struct slip_decoder *d, uint8_t *buf, size_t size);
+
+/**
+ * \brief      Feed received bytes to a decoder
+ * \param d    The decoder
+ * \param data The received bytes
+ * \param len  The number of received bytes
+ * \param cb   Called for each frame completed by these bytes
+ * \param ptr  Passed on to \a cb
+ *
+ *             Frames may span several calls, and a single call may
+ *             complete any number of frames. Empty frames are skipped.
+ */
+void slip_decode(struct slip_decoder *d, const uint8_t *data, size_t len,
+                 slip_frame_callback_t cb, void *ptr);
+
+#endif /* SLIP_CODEC_H_ */
+
+/** @} */
+/** @} */
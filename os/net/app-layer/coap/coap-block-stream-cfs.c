@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      CFS files as sources and sinks of streaming blockwise transfers
+ */
+
+/**
+ * \addtogroup coap-block-stream
+ * @{
+ */
+
+#include "coap-block-stream.h"
+#include "cfs/cfs.h"
+#include <string.h>
+
+/* Log configuration */
+#include "coap-log.h"
+#define LOG_MODULE "coap"
+#define LOG_LEVEL  LOG_LEVEL_COAP
+
+/*---------------------------------------------------------------------------*/
+static int
+cfs_source_read(const coap_block_source_t *source,
+                coap_block_cursor_t *cursor, uint8_t *buffer, uint16_t len)
+{
+  int fd;
+  int n = -1;
+
+  fd = cfs_open(source->data, CFS_READ);
+  if(fd < 0) {
+    return -1;
+  }
+  if((uint32_t)cfs_seek(fd, cursor->offset, CFS_SEEK_SET) == cursor->offset) {
+    n = cfs_read(fd, buffer, len);
+  }
+  cfs_close(fd);
+  if(n > 0) {
+    cursor->offset += n;
+  }
+  return n < 0 ? -1 : n;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_block_source_cfs(coap_block_source_t *source, const char *filename)
+{
+  cfs_offset_t size;
+  int fd;
+
+  fd = cfs_open(filename, CFS_READ);
+  if(fd < 0) {
+    LOG_WARN("Cannot open %s\n", filename);
+    return -1;
+  }
+  size = cfs_seek(fd, 0, CFS_SEEK_END);
+  cfs_close(fd);
+
+  source->read = cfs_source_read;
+  source->data = filename;
+  source->size = size > 0 ? size : 0;
+  source->flags = COAP_BLOCK_SOURCE_SEEKABLE;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+cfs_sink_write(const coap_block_sink_t *sink, coap_block_cursor_t *cursor,
+               const uint8_t *data, uint16_t len)
+{
+  int fd;
+  int n;
+
+  if(cursor->offset == 0) {
+    cfs_remove(sink->data);
+  }
+  fd = cfs_open(sink->data, CFS_WRITE | CFS_APPEND);
+  if(fd < 0) {
+    return -1;
+  }
+  n = cfs_write(fd, data, len);
+  cfs_close(fd);
+  return n == len ? 0 : -1;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_block_sink_cfs(coap_block_sink_t *sink, const char *filename,
+                    uint32_t max_size)
+{
+  sink->write = cfs_sink_write;
+  sink->finish = NULL;
+  sink->data = (void *)filename;
+  sink->max_size = max_size;
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
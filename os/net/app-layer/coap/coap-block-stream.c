@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      CoAP streaming blockwise transfers (RFC 7959)
+ */
+
+/**
+ * \addtogroup coap-block-stream
+ * @{
+ */
+
+#include "coap-block-stream.h"
+#include "coap-engine.h"
+#include "coap-timer.h"
+#include "lib/memb.h"
+#include "lib/list.h"
+#include <string.h>
+#include <inttypes.h>
+
+/* Log configuration */
+#include "coap-log.h"
+#define LOG_MODULE "coap"
+#define LOG_LEVEL  LOG_LEVEL_COAP
+
+/* A transfer in progress: one endpoint, one source or sink */
+struct transfer {
+  struct transfer *next;
+  coap_endpoint_t endpoint;
+  const void *stream;
+  uint64_t last_used;
+  coap_block_cursor_t cursor;     /* end of the last block */
+  coap_block_cursor_t checkpoint; /* start of the last block */
+  uint8_t complete;               /* Block1 upload finished, kept to
+                                     acknowledge a repeated last block */
+};
+
+MEMB(transfers_memb, struct transfer, COAP_BLOCK_TRANSFERS);
+LIST(transfers_list);
+/*---------------------------------------------------------------------------*/
+static void
+transfer_free(struct transfer *t)
+{
+  if(t != NULL) {
+    list_remove(transfers_list, t);
+    memb_free(&transfers_memb, t);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct transfer *
+transfer_find(const coap_endpoint_t *ep, const void *stream)
+{
+  uint64_t now = coap_timer_uptime();
+  struct transfer *t;
+  struct transfer *next;
+
+  for(t = list_head(transfers_list); t != NULL; t = next) {
+    next = t->next;
+    if(now - t->last_used > COAP_BLOCK_TRANSFER_LIFETIME * 1000UL) {
+      LOG_DBG("Blockwise transfer expired\n");
+      transfer_free(t);
+    } else if(t->stream == stream && coap_endpoint_cmp(&t->endpoint, ep)) {
+      t->last_used = now;
+      return t;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static struct transfer *
+transfer_new(const coap_endpoint_t *ep, const void *stream)
+{
+  struct transfer *t = memb_alloc(&transfers_memb);
+  struct transfer *oldest;
+
+  if(t == NULL) {
+    /* Make room by dropping the least recently used transfer */
+    oldest = list_head(transfers_list);
+    for(t = oldest; t != NULL; t = t->next) {
+      if(t->last_used < oldest->last_used) {
+        oldest = t;
+      }
+    }
+    LOG_DBG("Dropping a blockwise transfer for a new one\n");
+    transfer_free(oldest);
+    t = memb_alloc(&transfers_memb);
+    if(t == NULL) {
+      return NULL;
+    }
+  }
+
+  coap_endpoint_copy(&t->endpoint, ep);
+  t->stream = stream;
+  t->last_used = coap_timer_uptime();
+  memset(&t->cursor, 0, sizeof(t->cursor));
+  memset(&t->checkpoint, 0, sizeof(t->checkpoint));
+  t->complete = 0;
+  list_add(transfers_list, t);
+  return t;
+}
+/*---------------------------------------------------------------------------*/
+/* Fill the buffer unless the source ends first */
+static int
+read_block(const coap_block_source_t *source, coap_block_cursor_t *cursor,
+           uint8_t *buffer, uint16_t len)
+{
+  uint16_t done = 0;
+  int n;
+
+  while(done < len) {
+    n = source->read(source, cursor, buffer + done, len - done);
+    if(n < 0) {
+      return -1;
+    }
+    if(n == 0) {
+      break;
+    }
+    done += n;
+  }
+  return done;
+}
+/*---------------------------------------------------------------------------*/
+/* Run a generator forward to an offset, using the buffer as scratch space */
+static int
+skip_to(const coap_block_source_t *source, coap_block_cursor_t *cursor,
+        uint32_t offset, uint8_t *buffer, uint16_t len)
+{
+  int n;
+
+  while(cursor->offset < offset) {
+    n = read_block(source, cursor, buffer,
+                   MIN(len, offset - cursor->offset));
+    if(n <= 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_block_stream_get(const coap_block_source_t *source,
+                      coap_message_t *request, coap_message_t *response,
+                      uint8_t *buffer, uint16_t preferred_size,
+                      int32_t *offset)
+{
+  const coap_endpoint_t *ep = coap_get_src_endpoint(request);
+  coap_block_cursor_t seek;
+  coap_block_cursor_t *cursor;
+  struct transfer *t = NULL;
+  uint32_t start = *offset;
+  uint8_t more;
+  int n;
+
+  if(source->flags & COAP_BLOCK_SOURCE_SEEKABLE) {
+    memset(&seek, 0, sizeof(seek));
+    seek.offset = start;
+    cursor = &seek;
+  } else {
+    t = transfer_find(ep, source);
+    if(t == NULL && (t = transfer_new(ep, source)) == NULL) {
+      coap_status_code = SERVICE_UNAVAILABLE_5_03;
+      coap_error_message = "NoFreeTransfer";
+      return -1;
+    }
+    if(start == t->checkpoint.offset && start != t->cursor.offset) {
+      /* The last block again */
+      t->cursor = t->checkpoint;
+    } else if(start < t->cursor.offset) {
+      LOG_DBG("Blockwise: restarting generator for offset %"PRIu32"\n", start);
+      memset(&t->cursor, 0, sizeof(t->cursor));
+    }
+    if(skip_to(source, &t->cursor, start, buffer, preferred_size) < 0) {
+      transfer_free(t);
+      coap_status_code = BAD_OPTION_4_02;
+      coap_error_message = "BlockOutOfScope";
+      return -1;
+    }
+    t->checkpoint = t->cursor;
+    cursor = &t->cursor;
+  }
+
+  if(source->size > 0 && start > 0 && start >= source->size) {
+    transfer_free(t);
+    coap_status_code = BAD_OPTION_4_02;
+    coap_error_message = "BlockOutOfScope";
+    return -1;
+  }
+
+  n = read_block(source, cursor, buffer, preferred_size);
+  if(n < 0) {
+    transfer_free(t);
+    coap_status_code = INTERNAL_SERVER_ERROR_5_00;
+    coap_error_message = "SourceError";
+    return -1;
+  }
+
+  if(source->size > 0) {
+    more = start + n < source->size;
+  } else {
+    more = n == preferred_size;
+  }
+  if(!more) {
+    transfer_free(t);
+  }
+
+  coap_set_payload(response, buffer, n);
+  if(source->size > 0 &&
+     (start == 0 || coap_is_option(request, COAP_OPTION_SIZE2))) {
+    coap_set_header_size2(response, source->size);
+  }
+
+  /* A changed offset tells the engine to add Block2 */
+  if(more) {
+    *offset = start + n;
+  } else if(start > 0 || coap_is_option(request, COAP_OPTION_BLOCK2)) {
+    *offset = -1;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/* Errors go into the response itself, so that Size1 reaches the client */
+static int
+put_error(coap_message_t *response, struct transfer *t, coap_status_t code,
+          const char *message)
+{
+  transfer_free(t);
+  coap_set_status_code(response, code);
+  coap_set_payload(response, message, strlen(message));
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_block_stream_put(const coap_block_sink_t *sink,
+                      coap_message_t *request, coap_message_t *response)
+{
+  const coap_endpoint_t *ep = coap_get_src_endpoint(request);
+  const uint8_t *payload = NULL;
+  coap_block_cursor_t single;
+  coap_block_cursor_t *cursor;
+  struct transfer *t = NULL;
+  uint32_t num = 0, offset = 0, size1;
+  uint16_t size = 0;
+  uint8_t more = 0;
+  int block;
+  int len;
+
+  len = coap_get_payload(request, &payload);
+  block = coap_get_header_block1(request, &num, &more, &size, &offset);
+
+  if(coap_get_header_size1(request, &size1) && size1 > sink->max_size) {
+    coap_set_header_size1(response, sink->max_size);
+    return put_error(response, NULL, REQUEST_ENTITY_TOO_LARGE_4_13, "TooLarge");
+  }
+
+  if(block) {
+    LOG_DBG("Blockwise: block 1 #%"PRIu32"%s @ %"PRIu32" (%d bytes)\n",
+            num, more ? "+" : "", offset, len);
+    t = transfer_find(ep, sink);
+    if(offset == 0) {
+      if(t == NULL && (t = transfer_new(ep, sink)) == NULL) {
+        return put_error(response, NULL, SERVICE_UNAVAILABLE_5_03,
+                         "NoFreeTransfer");
+      }
+      memset(&t->cursor, 0, sizeof(t->cursor));
+      t->complete = 0;
+    } else if(t == NULL) {
+      return put_error(response, NULL, REQUEST_ENTITY_INCOMPLETE_4_08,
+                       "NoTransfer");
+    } else if(offset == t->checkpoint.offset &&
+              offset + len == t->cursor.offset) {
+      /* The last block again: acknowledge without writing it twice */
+      coap_set_header_block1(response, num, more, size);
+      if(t->complete) {
+        coap_set_status_code(response, CHANGED_2_04);
+        return 0;
+      }
+      coap_set_status_code(response, CONTINUE_2_31);
+      return 1;
+    } else if(t->complete) {
+      return put_error(response, t, REQUEST_ENTITY_INCOMPLETE_4_08,
+                       "NoTransfer");
+    } else if(offset != t->cursor.offset) {
+      return put_error(response, t, REQUEST_ENTITY_INCOMPLETE_4_08,
+                       "BlockOutOfOrder");
+    }
+    t->checkpoint = t->cursor;
+    cursor = &t->cursor;
+  } else {
+    memset(&single, 0, sizeof(single));
+    cursor = &single;
+  }
+
+  if(offset + len > sink->max_size) {
+    coap_set_header_size1(response, sink->max_size);
+    return put_error(response, t, REQUEST_ENTITY_TOO_LARGE_4_13, "TooLarge");
+  }
+  if(len > 0 && sink->write(sink, cursor, payload, len) < 0) {
+    return put_error(response, t, INTERNAL_SERVER_ERROR_5_00, "SinkError");
+  }
+  cursor->offset += len;
+
+  if(block) {
+    coap_set_header_block1(response, num, more, size);
+    if(more) {
+      coap_set_status_code(response, CONTINUE_2_31);
+      return 1;
+    }
+  }
+
+  if(sink->finish != NULL && sink->finish(sink, cursor) < 0) {
+    return put_error(response, t, INTERNAL_SERVER_ERROR_5_00, "SinkError");
+  }
+  if(t != NULL) {
+    /* Kept until it expires, in case our response to the last block is lost */
+    t->complete = 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/*- Memory regions ----------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+static int
+region_read(const coap_block_source_t *source, coap_block_cursor_t *cursor,
+            uint8_t *buffer, uint16_t len)
+{
+  if(cursor->offset >= source->size) {
+    return 0;
+  }
+  len = MIN(len, source->size - cursor->offset);
+  memcpy(buffer, (const uint8_t *)source->data + cursor->offset, len);
+  cursor->offset += len;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_block_source_region(coap_block_source_t *source,
+                         const void *data, uint32_t size)
+{
+  source->read = region_read;
+  source->data = data;
+  source->size = size;
+  source->flags = COAP_BLOCK_SOURCE_SEEKABLE;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_block_source_generator(coap_block_source_t *source,
+                            int (*read)(const coap_block_source_t *,
+                                        coap_block_cursor_t *,
+                                        uint8_t *, uint16_t),
+                            const void *data, uint32_t size)
+{
+  source->read = read;
+  source->data = data;
+  source->size = size;
+  source->flags = 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+region_write(const coap_block_sink_t *sink, coap_block_cursor_t *cursor,
+             const uint8_t *data, uint16_t len)
+{
+  memcpy((uint8_t *)sink->data + cursor->offset, data, len);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_block_sink_region(coap_block_sink_t *sink, void *buffer, uint32_t size)
+{
+  sink->write = region_write;
+  sink->finish = NULL;
+  sink->data = buffer;
+  sink->max_size = size;
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
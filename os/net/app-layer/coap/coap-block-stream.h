@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      CoAP streaming blockwise transfers (RFC 7959)
+ */
+
+/**
+ * \addtogroup coap
+ * @{
+ *
+ * \defgroup coap-block-stream Streaming blockwise transfers
+ * @{
+ *
+ * Serves Block2 transfers from a data source and hands Block1 uploads to
+ * a data sink, one block at a time, so that large representations are
+ * neither kept in RAM nor regenerated from the start for every block.
+ *
+ * A source reads from a cursor. Seekable sources, such as a memory or
+ * flash region or a CFS file, read at any offset. Generators produce the
+ * representation in order and keep their state in the cursor; the cursor
+ * is kept per endpoint and source between blocks, with a checkpoint at
+ * the start of the last block so that a repeated request does not restart
+ * the generator either.
+ *
+ * Sinks receive Block1 payloads in order. Up to COAP_BLOCK_TRANSFERS
+ * transfers, from any number of endpoints and to any number of resources,
+ * run at once; the least recently used is dropped when more start. A
+ * completed upload is remembered until COAP_BLOCK_TRANSFER_LIFETIME
+ * expires, so that a repeated last block is acknowledged again.
+ *
+ * Transfers are told apart by endpoint and by the address of the source
+ * or sink. Sources and sinks must therefore be static, and each resource
+ * needs its own: one set up on the stack of a handler, or shared by two
+ * resources, mixes up their transfers.
+ *
+ * Size2 is sent with the first block when the size is known, and Size1 is
+ * checked against the sink's limit before an upload starts.
+ */
+
+#ifndef COAP_BLOCK_STREAM_H_
+#define COAP_BLOCK_STREAM_H_
+
+#include "coap.h"
+
+/** Read position in a representation, with room for generator state */
+typedef struct coap_block_cursor {
+  uint32_t offset;
+  uint32_t state[COAP_BLOCK_CURSOR_STATE];
+} coap_block_cursor_t;
+
+/* The source reads at any cursor offset without earlier state */
+#define COAP_BLOCK_SOURCE_SEEKABLE 0x01
+
+typedef struct coap_block_source coap_block_source_t;
+
+struct coap_block_source {
+  /**
+   * Reads up to len bytes at cursor->offset and advances the cursor.
+   * Returns the number of bytes read, 0 at the end, or -1 on error.
+   * A cursor at offset 0 has all-zero state.
+   */
+  int (*read)(const coap_block_source_t *source, coap_block_cursor_t *cursor,
+              uint8_t *buffer, uint16_t len);
+  const void *data;
+  uint32_t size;  /* 0 if not known in advance */
+  uint8_t flags;
+};
+
+typedef struct coap_block_sink coap_block_sink_t;
+
+struct coap_block_sink {
+  /**
+   * Writes len bytes at cursor->offset; the engine advances the cursor.
+   * Returns 0 on success or -1 on error.
+   */
+  int (*write)(const coap_block_sink_t *sink, coap_block_cursor_t *cursor,
+               const uint8_t *data, uint16_t len);
+  /** Called, if set, when the last block is in; cursor->offset is the size */
+  int (*finish)(const coap_block_sink_t *sink, coap_block_cursor_t *cursor);
+  void *data;
+  uint32_t max_size;
+};
+
+/**
+ * \brief        A source reading from memory or memory-mapped flash
+ */
+void coap_block_source_region(coap_block_source_t *source,
+                              const void *data, uint32_t size);
+
+/**
+ * \brief        A source generating the representation in order
+ * \param read   The generator; see coap_block_source_t
+ * \param data   Passed to the generator in source->data
+ * \param size   The size if known, else 0
+ */
+void coap_block_source_generator(coap_block_source_t *source,
+                                 int (*read)(const coap_block_source_t *,
+                                             coap_block_cursor_t *,
+                                             uint8_t *, uint16_t),
+                                 const void *data, uint32_t size);
+
+/**
+ * \brief        A source reading a CFS file
+ * \return       0, or -1 if the file cannot be opened
+ *
+ * The size is taken when the source is set up.
+ */
+int coap_block_source_cfs(coap_block_source_t *source, const char *filename);
+
+/**
+ * \brief        A sink writing into a RAM buffer
+ */
+void coap_block_sink_region(coap_block_sink_t *sink, void *buffer,
+                            uint32_t size);
+
+/**
+ * \brief        A sink writing a CFS file, replaced by each new upload
+ */
+void coap_block_sink_cfs(coap_block_sink_t *sink, const char *filename,
+                         uint32_t max_size);
+
+/**
+ * \brief        Serve a GET from a source, blockwise when needed
+ * \param source The source, static and specific to the resource
+ * \param request, response, buffer, preferred_size, offset
+ *               As passed to the resource handler
+ * \return       The payload length, or -1 on error with the status set
+ *
+ * Call from a resource handler; the engine adds the Block2 option.
+ */
+int coap_block_stream_get(const coap_block_source_t *source,
+                          coap_message_t *request, coap_message_t *response,
+                          uint8_t *buffer, uint16_t preferred_size,
+                          int32_t *offset);
+
+/**
+ * \brief        Take a PUT or POST payload into a sink
+ * \param sink   The sink, static and specific to the resource
+ * \param request, response As passed to the resource handler
+ * \return       1 if more blocks follow (2.31 Continue is set), 0 when the
+ *               upload is complete, -1 on error with the status set
+ *
+ * A repeated last block of a completed upload is not written again: 0 is
+ * returned with 2.04 Changed set.
+ */
+int coap_block_stream_put(const coap_block_sink_t *sink,
+                          coap_message_t *request, coap_message_t *response);
+
+#endif /* COAP_BLOCK_STREAM_H_ */
+/** @} */
+/** @} */
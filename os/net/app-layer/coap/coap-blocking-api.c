@@ -43,6 +43,9 @@
 
 #include "coap-engine.h"
 #include "coap-blocking-api.h"
+#ifdef WITH_COAP_TCP
+#include "coap-tcp.h"
+#endif /* WITH_COAP_TCP */
 #include "sys/cc.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -91,14 +94,20 @@ PT_THREAD(coap_blocking_request
       state->transaction->callback = coap_blocking_request_callback;
       state->transaction->callback_data = blocking_state;
 
+#ifdef WITH_COAP_TCP
+      if(state->block_num == 0) {
+        state->bert = coap_tcp_bert_size(remote_ep) > 0;
+      }
+      if(state->bert) {
+        coap_set_header_block2(request, state->block_num, 0,
+                               COAP_BERT_SZX_SIZE);
+      } else
+#endif /* WITH_COAP_TCP */
       if(state->block_num > 0) {
         coap_set_header_block2(request, state->block_num, 0,
                                COAP_MAX_CHUNK_SIZE);
       }
-      state->transaction->message_len = coap_serialize_message(request,
-                                                              state->
-                                                              transaction->
-                                                              message);
+      coap_serialize_transaction(state->transaction, request);
 
       coap_send_transaction(state->transaction);
       LOG_DBG("Requested #%"PRIu32" (MID %u)\n", state->block_num, request->mid);
@@ -124,6 +133,12 @@ PT_THREAD(coap_blocking_request
 
       if(state->res_block == state->block_num) {
         request_callback(state->response);
+#ifdef WITH_COAP_TCP
+        if(state->bert) {
+          state->block_num += MAX(1, state->response->payload_len /
+                                  COAP_BERT_BLOCK_SIZE);
+        } else
+#endif /* WITH_COAP_TCP */
         ++(state->block_num);
       } else {
         LOG_WARN("WRONG BLOCK %"PRIu32"/%"PRIu32"\n",
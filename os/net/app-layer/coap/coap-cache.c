@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      CoAP response cache (RFC 7252, Section 5.6)
+ */
+
+/**
+ * \addtogroup coap-cache
+ * @{
+ */
+
+#include "coap-cache.h"
+#include "coap-engine.h"
+#include "coap-timer.h"
+#include "lib/memb.h"
+#include "lib/list.h"
+#include <string.h>
+
+/* Log configuration */
+#include "coap-log.h"
+#define LOG_MODULE "coap"
+#define LOG_LEVEL  LOG_LEVEL_COAP
+
+struct coap_cache_entry {
+  struct coap_cache_entry *next;
+  uint64_t expires;
+  uint64_t last_used;
+  int accept;
+  uint8_t secure;
+  uint16_t uri_len;
+  uint16_t payload_len;
+  uint16_t content_format;
+  uint8_t has_content_format;
+  uint8_t etag_len;
+  uint8_t etag[COAP_ETAG_LEN];
+  char uri[COAP_CACHE_URI_LEN];
+  uint8_t payload[COAP_CACHE_PAYLOAD_SIZE];
+};
+
+MEMB(entries_memb, coap_cache_entry_t, COAP_CACHE_ENTRIES);
+LIST(entries_list);
+
+static coap_cache_stats_t stats;
+/*---------------------------------------------------------------------------*/
+static void
+entry_free(coap_cache_entry_t *e)
+{
+  list_remove(entries_list, e);
+  memb_free(&entries_memb, e);
+}
+/*---------------------------------------------------------------------------*/
+static coap_cache_entry_t *
+entry_alloc(void)
+{
+  coap_cache_entry_t *e;
+  coap_cache_entry_t *lru;
+
+  e = memb_alloc(&entries_memb);
+  if(e == NULL) {
+    /* Reuse the least recently used entry */
+    lru = list_head(entries_list);
+    for(e = lru; e != NULL; e = e->next) {
+      if(e->last_used < lru->last_used) {
+        lru = e;
+      }
+    }
+    if(lru == NULL) {
+      return NULL;
+    }
+    LOG_DBG("Cache: evicting ");
+    LOG_DBG_COAP_STRING(lru->uri, lru->uri_len);
+    LOG_DBG_("\n");
+    list_remove(entries_list, lru);
+    stats.evictions++;
+    e = lru;
+  }
+  list_add(entries_list, e);
+  return e;
+}
+/*---------------------------------------------------------------------------*/
+/* The key of a local resource: path, then '?' and the query if any */
+static const char *
+request_key(coap_message_t *request, size_t *len)
+{
+  static char key[COAP_CACHE_URI_LEN];
+  const char *path;
+  const char *query;
+  size_t path_len;
+  size_t query_len;
+
+  path_len = coap_get_header_uri_path(request, &path);
+  query_len = coap_get_header_uri_query(request, &query);
+  *len = path_len + (query_len > 0 ? 1 + query_len : 0);
+  if(*len > sizeof(key)) {
+    return NULL;
+  }
+  memcpy(key, path, path_len);
+  if(query_len > 0) {
+    key[path_len] = '?';
+    memcpy(key + path_len + 1, query, query_len);
+  }
+  return key;
+}
+/*---------------------------------------------------------------------------*/
+static int
+request_accept(coap_message_t *request)
+{
+  unsigned int accept;
+
+  if(coap_get_header_accept(request, &accept)) {
+    return (int)accept;
+  }
+  return COAP_CACHE_ANY_FORMAT;
+}
+/*---------------------------------------------------------------------------*/
+/* Did the request come over DTLS? Requests built locally have no source */
+static int
+request_secure(coap_message_t *request)
+{
+  const coap_endpoint_t *src = coap_get_src_endpoint(request);
+
+  return src != NULL && coap_endpoint_is_secure(src);
+}
+/*---------------------------------------------------------------------------*/
+coap_cache_entry_t *
+coap_cache_find(const char *uri, size_t uri_len, int accept, int secure)
+{
+  coap_cache_entry_t *e;
+
+  for(e = list_head(entries_list); e != NULL; e = e->next) {
+    if(e->uri_len == uri_len && e->accept == accept &&
+       e->secure == (secure != 0) &&
+       memcmp(e->uri, uri, uri_len) == 0) {
+      return e;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_cache_is_fresh(const coap_cache_entry_t *entry)
+{
+  return entry->expires > coap_timer_uptime();
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_cache_get_etag(const coap_cache_entry_t *entry, const uint8_t **etag)
+{
+  *etag = entry->etag;
+  return entry->etag_len;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_cache_respond(coap_cache_entry_t *entry, coap_message_t *request,
+                   coap_message_t *response)
+{
+  uint64_t now = coap_timer_uptime();
+  const uint8_t *etag;
+
+  entry->last_used = now;
+  if(request != NULL) {
+    stats.hits++;
+  }
+
+  /* Max-Age is what is left of the freshness, rounded up */
+  coap_set_header_max_age(response, entry->expires > now ?
+                          (uint32_t)((entry->expires - now + 999) / 1000) : 0);
+  if(entry->etag_len > 0) {
+    coap_set_header_etag(response, entry->etag, entry->etag_len);
+    if(request != NULL &&
+       coap_get_header_etag(request, &etag) == entry->etag_len &&
+       memcmp(etag, entry->etag, entry->etag_len) == 0) {
+      stats.validations++;
+      coap_set_status_code(response, VALID_2_03);
+      return;
+    }
+  }
+  coap_set_status_code(response, CONTENT_2_05);
+  if(entry->has_content_format) {
+    coap_set_header_content_format(response, entry->content_format);
+  }
+  coap_set_payload(response, entry->payload, entry->payload_len);
+}
+/*---------------------------------------------------------------------------*/
+coap_cache_entry_t *
+coap_cache_store(const char *uri, size_t uri_len, int accept, int secure,
+                 coap_message_t *response, uint32_t max_age)
+{
+  coap_cache_entry_t *e;
+  const uint8_t *etag;
+  unsigned int format;
+
+  if(response->code != CONTENT_2_05 || max_age == 0 ||
+     uri_len > COAP_CACHE_URI_LEN ||
+     response->payload_len > COAP_CACHE_PAYLOAD_SIZE) {
+    return NULL;
+  }
+
+  e = coap_cache_find(uri, uri_len, accept, secure);
+  if(e == NULL && (e = entry_alloc()) == NULL) {
+    return NULL;
+  }
+
+  memcpy(e->uri, uri, uri_len);
+  e->uri_len = uri_len;
+  e->accept = accept;
+  e->secure = secure != 0;
+  e->has_content_format = coap_get_header_content_format(response, &format);
+  e->content_format = e->has_content_format ? format : 0;
+  e->etag_len = coap_get_header_etag(response, &etag);
+  memcpy(e->etag, etag, e->etag_len);
+  memcpy(e->payload, response->payload, response->payload_len);
+  e->payload_len = response->payload_len;
+  e->last_used = coap_timer_uptime();
+  e->expires = e->last_used + (uint64_t)max_age * 1000;
+  stats.stores++;
+
+  LOG_DBG("Cache: stored ");
+  LOG_DBG_COAP_STRING(uri, uri_len);
+  LOG_DBG_(" for %lu s\n", (unsigned long)max_age);
+  return e;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_cache_refresh(coap_cache_entry_t *entry, uint32_t max_age)
+{
+  entry->last_used = coap_timer_uptime();
+  entry->expires = entry->last_used + (uint64_t)max_age * 1000;
+  stats.stores++;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_cache_invalidate(const char *uri, size_t uri_len)
+{
+  coap_cache_entry_t *e;
+  coap_cache_entry_t *next;
+
+  for(e = list_head(entries_list); e != NULL; e = next) {
+    next = e->next;
+    if(e->uri_len == uri_len && memcmp(e->uri, uri, uri_len) == 0) {
+      entry_free(e);
+      stats.invalidations++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_cache_invalidate_resource(const char *path)
+{
+  coap_cache_entry_t *e;
+  coap_cache_entry_t *next;
+  size_t len = strlen(path);
+
+  /* The path itself, with any query, and the paths below it */
+  for(e = list_head(entries_list); e != NULL; e = next) {
+    next = e->next;
+    if(e->uri_len >= len && memcmp(e->uri, path, len) == 0 &&
+       (e->uri_len == len || e->uri[len] == '?' || e->uri[len] == '/')) {
+      entry_free(e);
+      stats.invalidations++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_cache_count_miss(void)
+{
+  stats.misses++;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_cache_count_coalesced(void)
+{
+  stats.coalesced++;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_cache_handle_request(coap_message_t *request, coap_message_t *response)
+{
+  coap_cache_entry_t *e;
+  const char *key;
+  size_t len;
+
+  key = request_key(request, &len);
+  if(key == NULL) {
+    return 0;
+  }
+
+  if(request->code != COAP_GET) {
+    coap_cache_invalidate(key, len);
+    return 0;
+  }
+
+  /* Notifications and blocks are left to the resource */
+  if(coap_is_option(request, COAP_OPTION_OBSERVE) ||
+     coap_is_option(request, COAP_OPTION_BLOCK1) ||
+     coap_is_option(request, COAP_OPTION_BLOCK2)) {
+    return 0;
+  }
+
+  e = coap_cache_find(key, len, request_accept(request),
+                      request_secure(request));
+  if(e != NULL && coap_cache_is_fresh(e)) {
+    coap_cache_respond(e, request, response);
+    return 1;
+  }
+  stats.misses++;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_cache_handle_response(coap_message_t *request, coap_message_t *response)
+{
+  const char *key;
+  size_t len;
+
+  if(request->code != COAP_GET ||
+     !coap_is_option(response, COAP_OPTION_MAX_AGE) ||
+     coap_is_option(request, COAP_OPTION_OBSERVE) ||
+     coap_is_option(request, COAP_OPTION_BLOCK1) ||
+     coap_is_option(request, COAP_OPTION_BLOCK2) ||
+     coap_is_option(response, COAP_OPTION_OBSERVE) ||
+     coap_is_option(response, COAP_OPTION_BLOCK2)) {
+    return;
+  }
+
+  key = request_key(request, &len);
+  if(key != NULL) {
+    coap_cache_store(key, len, request_accept(request),
+                     request_secure(request), response, response->max_age);
+  }
+}
+/*---------------------------------------------------------------------------*/
+const coap_cache_stats_t *
+coap_cache_get_stats(void)
+{
+  return &stats;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_cache_flush(void)
+{
+  coap_cache_entry_t *e;
+
+  while((e = list_head(entries_list)) != NULL) {
+    entry_free(e);
+  }
+  memset(&stats, 0, sizeof(stats));
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      CoAP response cache (RFC 7252, Section 5.6)
+ */
+
+/**
+ * \addtogroup coap
+ * @{
+ *
+ * \defgroup coap-cache Response cache
+ * @{
+ *
+ * Keeps copies of 2.05 Content responses to GET requests, keyed on the
+ * request URI, the Accept option and whether the request came over DTLS,
+ * for as long as their Max-Age allows. A response to a secure request is
+ * thus never served to an insecure one.
+ * A fresh entry answers the request without calling the resource again;
+ * a request carrying the entry's ETag is answered with 2.03 Valid and no
+ * payload. Max-Age in a served response is the remaining freshness.
+ *
+ * With COAP_CACHE, the engine caches local resources that set Max-Age
+ * explicitly; resources leaving it out are not cached, as the 60-second
+ * default would change their behavior. PUT, POST and DELETE invalidate
+ * the entries for their URI, (re)activating or removing a resource those
+ * for its path. The forward proxy (coap-proxy.h) uses the
+ * same entries for upstream responses, with the default Max-Age.
+ *
+ * Up to COAP_CACHE_ENTRIES responses of at most COAP_CACHE_PAYLOAD_SIZE
+ * bytes are kept; the least recently used one makes room for a new one.
+ */
+
+#ifndef COAP_CACHE_H_
+#define COAP_CACHE_H_
+
+#include "coap.h"
+
+typedef struct coap_cache_entry coap_cache_entry_t;
+
+/** Counters since boot, e.g. to compute the hit rate */
+typedef struct coap_cache_stats {
+  uint32_t hits;          /**< Requests answered from a fresh entry */
+  uint32_t validations;   /**< Of these, answered 2.03 Valid */
+  uint32_t misses;        /**< GET requests without a fresh entry */
+  uint32_t stores;        /**< Responses stored or refreshed */
+  uint32_t evictions;     /**< Entries dropped to make room */
+  uint32_t invalidations; /**< Entries dropped by PUT, POST, DELETE or a
+                               resource change */
+  uint32_t coalesced;     /**< Proxy requests joined to one in flight */
+} coap_cache_stats_t;
+
+/** Accept value of a cache key for requests without an Accept option */
+#define COAP_CACHE_ANY_FORMAT -1
+
+/**
+ * \brief         Finds the entry for a key, fresh or not
+ * \param uri     The key: path and query, or the Proxy-Uri
+ * \param uri_len The key length
+ * \param accept  The Accept option of the request, or COAP_CACHE_ANY_FORMAT
+ * \param secure  Non-zero if the request came over DTLS
+ * \return        The entry or NULL
+ */
+coap_cache_entry_t *coap_cache_find(const char *uri, size_t uri_len,
+                                    int accept, int secure);
+
+/**
+ * \brief   Tells whether an entry may still be served
+ */
+int coap_cache_is_fresh(const coap_cache_entry_t *entry);
+
+/**
+ * \brief   Returns the ETag of an entry, e.g. to revalidate it upstream
+ * \param etag Set to the ETag
+ * \return  The ETag length, 0 if the response had none
+ */
+int coap_cache_get_etag(const coap_cache_entry_t *entry, const uint8_t **etag);
+
+/**
+ * \brief          Answers a request from an entry
+ * \param entry    A fresh entry
+ * \param request  The request, checked for a matching ETag, or NULL to
+ *                 answer with the full representation
+ * \param response The response to fill in; the payload points into the
+ *                 entry and stays valid until the entry is replaced
+ *
+ * Counts a hit when answering a request.
+ */
+void coap_cache_respond(coap_cache_entry_t *entry, coap_message_t *request,
+                        coap_message_t *response);
+
+/**
+ * \brief          Stores a response, replacing any entry for the key
+ * \param uri      The key: path and query, or the Proxy-Uri
+ * \param uri_len  The key length
+ * \param accept   The Accept option of the request, or COAP_CACHE_ANY_FORMAT
+ * \param secure   Non-zero if the request came over DTLS
+ * \param response The 2.05 response
+ * \param max_age  Freshness in seconds
+ * \return         The entry, or NULL if the response cannot be cached
+ */
+coap_cache_entry_t *coap_cache_store(const char *uri, size_t uri_len,
+                                     int accept, int secure,
+                                     coap_message_t *response,
+                                     uint32_t max_age);
+
+/**
+ * \brief         Makes an entry fresh again after a 2.03 Valid
+ * \param max_age Freshness in seconds
+ */
+void coap_cache_refresh(coap_cache_entry_t *entry, uint32_t max_age);
+
+/**
+ * \brief         Drops the entries for a URI, whatever their Accept value
+ */
+void coap_cache_invalidate(const char *uri, size_t uri_len);
+
+/**
+ * \brief         Drops the entries of a local resource
+ * \param path    The resource path, without leading '/'
+ *
+ * Covers the path with any query and the paths below it, which a
+ * resource with sub-resources may have answered.
+ */
+void coap_cache_invalidate_resource(const char *path);
+
+/**
+ * \brief          Counts a cacheable request that found no fresh entry
+ */
+void coap_cache_count_miss(void);
+
+/**
+ * \brief          Counts a request joined to one already in flight
+ */
+void coap_cache_count_coalesced(void);
+
+/**
+ * \brief          Answers a request for a local resource from the cache
+ * \return         1 if the response is complete, 0 to call the resource
+ *
+ * Called by the engine with COAP_CACHE. Also invalidates the URI for
+ * PUT, POST and DELETE.
+ */
+int coap_cache_handle_request(coap_message_t *request,
+                              coap_message_t *response);
+
+/**
+ * \brief          Stores the response of a local resource if cacheable
+ *
+ * Called by the engine with COAP_CACHE once the resource has answered.
+ */
+void coap_cache_handle_response(coap_message_t *request,
+                                coap_message_t *response);
+
+/**
+ * \brief   Returns the counters
+ */
+const coap_cache_stats_t *coap_cache_get_stats(void);
+
+/**
+ * \brief   Drops all entries and clears the counters
+ */
+void coap_cache_flush(void);
+
+#endif /* COAP_CACHE_H_ */
+/** @} */
+/** @} */
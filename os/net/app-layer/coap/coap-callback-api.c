@@ -45,6 +45,9 @@
 #include "coap-engine.h"
 #include "coap-callback-api.h"
 #include "coap-transactions.h"
+#ifdef WITH_COAP_TCP
+#include "coap-tcp.h"
+#endif /* WITH_COAP_TCP */
 #include "sys/cc.h"
 #include <stdlib.h>
 #include <string.h>
@@ -69,12 +72,20 @@ progress_request(coap_callback_request_state_t *callback_state) {
     state->transaction->callback = coap_request_callback;
     state->transaction->callback_data = state;
 
+#ifdef WITH_COAP_TCP
+    if(state->block_num == 0) {
+      state->bert = coap_tcp_bert_size(state->remote_endpoint) > 0;
+    }
+    if(state->bert) {
+      coap_set_header_block2(request, state->block_num, 0,
+                             COAP_BERT_SZX_SIZE);
+    } else
+#endif /* WITH_COAP_TCP */
     if(state->block_num > 0) {
       coap_set_header_block2(request, state->block_num, 0,
                              COAP_MAX_CHUNK_SIZE);
     }
-    state->transaction->message_len =
-      coap_serialize_message(request, state->transaction->message);
+    coap_serialize_transaction(state->transaction, request);
 
     coap_send_transaction(state->transaction);
     LOG_DBG("Requested #%"PRIu32" (MID %u)\n", state->block_num, request->mid);
@@ -122,6 +133,11 @@ coap_request_callback(void *callback_data, coap_message_t *response)
     }
     callback_state->callback(callback_state);
     /* this is only for counting BLOCK2 blocks.*/
+#ifdef WITH_COAP_TCP
+    if(state->bert) {
+      state->block_num += MAX(1, response->payload_len / COAP_BERT_BLOCK_SIZE);
+    } else
+#endif /* WITH_COAP_TCP */
     ++(state->block_num);
   } else {
     LOG_WARN("WRONG BLOCK %"PRIu32"/%"PRIu32"\n", state->res_block, state->block_num);
@@ -70,9 +70,29 @@
 #endif /* COAP_LINK_FORMAT_FILTERING */
 
 #ifndef COAP_PROXY_OPTION_PROCESSING
-#define COAP_PROXY_OPTION_PROCESSING   0
+#define COAP_PROXY_OPTION_PROCESSING   COAP_PROXY
 #endif /* COAP_PROXY_OPTION_PROCESSING */
 
+/*
+ * Look up resources in a path-segment trie built when resources are
+ * activated instead of comparing the URI path against every resource.
+ */
+#ifdef COAP_CONF_RESOURCE_TRIE
+#define COAP_RESOURCE_TRIE COAP_CONF_RESOURCE_TRIE
+#else
+#define COAP_RESOURCE_TRIE             0
+#endif /* COAP_CONF_RESOURCE_TRIE */
+
+/*
+ * Number of trie nodes, one per distinct path segment. When they run out,
+ * lookups fall back to the linear scan.
+ */
+#ifdef COAP_CONF_RESOURCE_TRIE_NODES
+#define COAP_RESOURCE_TRIE_NODES COAP_CONF_RESOURCE_TRIE_NODES
+#else
+#define COAP_RESOURCE_TRIE_NODES       16
+#endif /* COAP_CONF_RESOURCE_TRIE_NODES */
+
 /* Listening port for the CoAP REST Engine */
 #ifndef COAP_SERVER_PORT
 #define COAP_SERVER_PORT               COAP_DEFAULT_PORT
@@ -83,6 +103,72 @@
 #define COAP_MAX_OPEN_TRANSACTIONS     4
 #endif /* COAP_MAX_OPEN_TRANSACTIONS */
 
+/* Number of MID and token hash buckets for open transactions (power of two) */
+#ifdef COAP_CONF_TRANSACTION_HASH_SIZE
+#define COAP_TRANSACTION_HASH_SIZE COAP_CONF_TRANSACTION_HASH_SIZE
+#else
+#define COAP_TRANSACTION_HASH_SIZE     4
+#endif /* COAP_CONF_TRANSACTION_HASH_SIZE */
+
+/*
+ * Transaction messages are allocated from a shared pool in blocks of
+ * COAP_TRANSACTION_BLOCK_SIZE bytes. A new transaction needs room for a
+ * full-size message; the unused tail is returned once it is serialized,
+ * so a pool sized for a few full messages holds many small ones.
+ */
+#ifdef COAP_CONF_TRANSACTION_BLOCK_SIZE
+#define COAP_TRANSACTION_BLOCK_SIZE COAP_CONF_TRANSACTION_BLOCK_SIZE
+#else
+#define COAP_TRANSACTION_BLOCK_SIZE    16
+#endif /* COAP_CONF_TRANSACTION_BLOCK_SIZE */
+
+#ifdef COAP_CONF_TRANSACTION_BUFFER_SIZE
+#define COAP_TRANSACTION_BUFFER_SIZE COAP_CONF_TRANSACTION_BUFFER_SIZE
+#elif defined(WITH_COAP_TCP)
+/* Room for one message of COAP_TCP_MAX_MESSAGE_SIZE on top */
+#define COAP_TRANSACTION_BUFFER_SIZE   (COAP_MAX_OPEN_TRANSACTIONS * (COAP_MAX_PACKET_SIZE + 1) + \
+                                        COAP_TCP_MAX_MESSAGE_SIZE + COAP_TRANSACTION_BLOCK_SIZE)
+#else
+#define COAP_TRANSACTION_BUFFER_SIZE   (COAP_MAX_OPEN_TRANSACTIONS * (COAP_MAX_PACKET_SIZE + 1))
+#endif /* COAP_CONF_TRANSACTION_BUFFER_SIZE */
+
+/* Retransmission timer wheel: number of slots and slot width in ms */
+#ifdef COAP_CONF_TRANSACTION_WHEEL_SLOTS
+#define COAP_TRANSACTION_WHEEL_SLOTS COAP_CONF_TRANSACTION_WHEEL_SLOTS
+#else
+#define COAP_TRANSACTION_WHEEL_SLOTS   8
+#endif /* COAP_CONF_TRANSACTION_WHEEL_SLOTS */
+
+#ifdef COAP_CONF_TRANSACTION_WHEEL_TICK
+#define COAP_TRANSACTION_WHEEL_TICK COAP_CONF_TRANSACTION_WHEEL_TICK
+#else
+#define COAP_TRANSACTION_WHEEL_TICK    500
+#endif /* COAP_CONF_TRANSACTION_WHEEL_TICK */
+
+/*
+ * Per-peer congestion control: at most COAP_NSTART outstanding
+ * Confirmable messages per peer (further ones are queued) and a
+ * CoCoA-style adaptive retransmission timeout for up to
+ * COAP_CC_ENDPOINTS peers.
+ */
+#ifdef COAP_CONF_CONGESTION_CONTROL
+#define COAP_CONGESTION_CONTROL COAP_CONF_CONGESTION_CONTROL
+#else
+#define COAP_CONGESTION_CONTROL        0
+#endif /* COAP_CONF_CONGESTION_CONTROL */
+
+#ifdef COAP_CONF_NSTART
+#define COAP_NSTART COAP_CONF_NSTART
+#else
+#define COAP_NSTART                    1
+#endif /* COAP_CONF_NSTART */
+
+#ifdef COAP_CONF_CC_ENDPOINTS
+#define COAP_CC_ENDPOINTS COAP_CONF_CC_ENDPOINTS
+#else
+#define COAP_CC_ENDPOINTS              4
+#endif /* COAP_CONF_CC_ENDPOINTS */
+
 /* Maximum number of failed request attempts before action */
 #ifndef COAP_MAX_ATTEMPTS
 #define COAP_MAX_ATTEMPTS              4
@@ -93,9 +179,14 @@
 #define COAP_MAX_HEADER_SIZE           (4 + COAP_TOKEN_LEN + 3 + 1 + COAP_ETAG_LEN + 4 + 4 + 30)  /* 65 */
 #endif /* COAP_MAX_HEADER_SIZE */
 
-/* Number of observer slots (each takes abot xxx bytes) */
+/*
+ * Number of observer slots. Notifications are rendered once into a shared
+ * buffer and sent as NON without a transaction, so this is independent of
+ * COAP_MAX_OPEN_TRANSACTIONS; only the periodic confirmable refresh needs
+ * a free transaction.
+ */
 #ifndef COAP_MAX_OBSERVERS
-#define COAP_MAX_OBSERVERS    COAP_MAX_OPEN_TRANSACTIONS - 1
+#define COAP_MAX_OBSERVERS    4
 #endif /* COAP_MAX_OBSERVERS */
 
 /* Interval in notifies in which NON notifies are changed to CON notifies to check client. */
@@ -112,5 +203,106 @@
 #define COAP_OBSERVER_URL_LEN 20
 #endif
 
+/*
+ * CoAP over TCP and WebSockets (RFC 8323), built with MAKE_WITH_COAP_TCP=1.
+ * COAP_TCP_MAX_MESSAGE_SIZE is the Max-Message-Size announced to peers and
+ * bounds the payload of a single message on reliable transports; the
+ * transaction pool must be able to hold a message of this size.
+ */
+#ifdef COAP_CONF_TCP_CONNECTIONS
+#define COAP_TCP_CONNECTIONS COAP_CONF_TCP_CONNECTIONS
+#else
+#define COAP_TCP_CONNECTIONS 2
+#endif /* COAP_CONF_TCP_CONNECTIONS */
+
+#ifdef COAP_CONF_TCP_MAX_MESSAGE_SIZE
+#define COAP_TCP_MAX_MESSAGE_SIZE COAP_CONF_TCP_MAX_MESSAGE_SIZE
+#else
+#define COAP_TCP_MAX_MESSAGE_SIZE 1152
+#endif /* COAP_CONF_TCP_MAX_MESSAGE_SIZE */
+
+/* Outgoing CoAP over WebSocket connections, also limited by WEBSOCKET_CONF_MAX_MSGLEN */
+#ifdef COAP_CONF_WS_CONNECTIONS
+#define COAP_WS_CONNECTIONS COAP_CONF_WS_CONNECTIONS
+#else
+#define COAP_WS_CONNECTIONS 1
+#endif /* COAP_CONF_WS_CONNECTIONS */
+
+/*
+ * Streaming blockwise transfers (coap-block-stream.h): the number of
+ * transfers tracked at once, over all endpoints, how long an idle one is
+ * kept in seconds, and the 32-bit words of generator state in a cursor.
+ */
+#ifdef COAP_CONF_BLOCK_TRANSFERS
+#define COAP_BLOCK_TRANSFERS COAP_CONF_BLOCK_TRANSFERS
+#else
+#define COAP_BLOCK_TRANSFERS 4
+#endif /* COAP_CONF_BLOCK_TRANSFERS */
+
+#ifdef COAP_CONF_BLOCK_TRANSFER_LIFETIME
+#define COAP_BLOCK_TRANSFER_LIFETIME COAP_CONF_BLOCK_TRANSFER_LIFETIME
+#else
+#define COAP_BLOCK_TRANSFER_LIFETIME 120
+#endif /* COAP_CONF_BLOCK_TRANSFER_LIFETIME */
+
+#ifdef COAP_CONF_BLOCK_CURSOR_STATE
+#define COAP_BLOCK_CURSOR_STATE COAP_CONF_BLOCK_CURSOR_STATE
+#else
+#define COAP_BLOCK_CURSOR_STATE 2
+#endif /* COAP_CONF_BLOCK_CURSOR_STATE */
+
+/*
+ * Response cache (coap-cache.h): serve GET requests for local resources
+ * that set Max-Age from a copy of their last response. The forward proxy
+ * always caches, in the same entries.
+ */
+#ifdef COAP_CONF_CACHE
+#define COAP_CACHE COAP_CONF_CACHE
+#else
+#define COAP_CACHE 0
+#endif /* COAP_CONF_CACHE */
+
+#ifdef COAP_CONF_CACHE_ENTRIES
+#define COAP_CACHE_ENTRIES COAP_CONF_CACHE_ENTRIES
+#else
+#define COAP_CACHE_ENTRIES 4
+#endif /* COAP_CONF_CACHE_ENTRIES */
+
+/* Longest key, i.e. path and query or Proxy-Uri, that can be cached */
+#ifdef COAP_CONF_CACHE_URI_LEN
+#define COAP_CACHE_URI_LEN COAP_CONF_CACHE_URI_LEN
+#else
+#define COAP_CACHE_URI_LEN 64
+#endif /* COAP_CONF_CACHE_URI_LEN */
+
+#ifdef COAP_CONF_CACHE_PAYLOAD_SIZE
+#define COAP_CACHE_PAYLOAD_SIZE COAP_CONF_CACHE_PAYLOAD_SIZE
+#else
+#define COAP_CACHE_PAYLOAD_SIZE COAP_MAX_CHUNK_SIZE
+#endif /* COAP_CONF_CACHE_PAYLOAD_SIZE */
+
+/*
+ * Forward proxy (coap-proxy.h): handle requests carrying a Proxy-Uri by
+ * forwarding them, and coalesce concurrent GETs for the same resource
+ * into one upstream request with up to COAP_PROXY_WAITERS clients each.
+ */
+#ifdef COAP_CONF_PROXY
+#define COAP_PROXY COAP_CONF_PROXY
+#else
+#define COAP_PROXY 0
+#endif /* COAP_CONF_PROXY */
+
+#ifdef COAP_CONF_PROXY_REQUESTS
+#define COAP_PROXY_REQUESTS COAP_CONF_PROXY_REQUESTS
+#else
+#define COAP_PROXY_REQUESTS 4
+#endif /* COAP_CONF_PROXY_REQUESTS */
+
+#ifdef COAP_CONF_PROXY_WAITERS
+#define COAP_PROXY_WAITERS COAP_CONF_PROXY_WAITERS
+#else
+#define COAP_PROXY_WAITERS 4
+#endif /* COAP_CONF_PROXY_WAITERS */
+
 #endif /* COAP_CONF_H_ */
 /** @} */
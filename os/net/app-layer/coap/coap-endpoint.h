@@ -46,6 +46,11 @@
 #include "contiki.h"
 #include <stdlib.h>
 
+/* Transports of an endpoint, UDP unless built with WITH_COAP_TCP */
+#define COAP_TRANSPORT_UDP 0
+#define COAP_TRANSPORT_TCP 1
+#define COAP_TRANSPORT_WS  2
+
 #ifndef COAP_ENDPOINT_CUSTOM
 #include "net/ipv6/uip.h"
 
@@ -53,6 +58,9 @@ typedef struct {
   uip_ipaddr_t ipaddr;
   uint16_t port;
   uint8_t secure;
+#ifdef WITH_COAP_TCP
+  uint8_t transport;
+#endif /* WITH_COAP_TCP */
 } coap_endpoint_t;
 #endif /* COAP_ENDPOINT_CUSTOM */
 
@@ -120,6 +128,18 @@ int coap_endpoint_parse(const char *text, size_t size, coap_endpoint_t *ep);
  */
 int coap_endpoint_is_secure(const coap_endpoint_t *ep);
 
+/**
+ * \brief      Check if a CoAP endpoint uses a reliable transport
+ *             (CoAP over TCP or WebSockets).
+ *
+ *             Messages to reliable endpoints have no type or Message ID
+ *             on the wire and are never retransmitted by CoAP.
+ *
+ * \param ep   A pointer to a CoAP endpoint.
+ * \return     Returns non-zero if the endpoint is reliable and zero otherwise.
+ */
+int coap_endpoint_is_reliable(const coap_endpoint_t *ep);
+
 /**
  * \brief      Check if a CoAP endpoint is connected.
  *
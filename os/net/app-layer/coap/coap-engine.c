@@ -42,8 +42,18 @@
  */
 
 #include "coap-engine.h"
+#ifdef WITH_COAP_TCP
+#include "coap-tcp.h"
+#endif /* WITH_COAP_TCP */
+#if COAP_CACHE || COAP_PROXY
+#include "coap-cache.h"
+#endif /* COAP_CACHE || COAP_PROXY */
+#if COAP_PROXY
+#include "coap-proxy.h"
+#endif /* COAP_PROXY */
 #include "sys/cc.h"
 #include "lib/list.h"
+#include "lib/memb.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <inttypes.h>
@@ -72,6 +82,22 @@ LIST(coap_handlers);
 LIST(coap_resource_services);
 static uint8_t is_initialized = 0;
 
+#if COAP_RESOURCE_TRIE
+/* One node per path segment, the segment points into the resource URL */
+struct resource_trie_node {
+  struct resource_trie_node *child;
+  struct resource_trie_node *sibling;
+  coap_resource_t *resource;
+  const char *segment;
+  uint16_t segment_len;
+  uint16_t order;       /* activation order, the first match wins */
+};
+MEMB(resource_trie_memb, struct resource_trie_node, COAP_RESOURCE_TRIE_NODES);
+static struct resource_trie_node *resource_trie;
+static uint16_t resource_count;
+static uint8_t resource_trie_complete;
+#endif /* COAP_RESOURCE_TRIE */
+
 /*---------------------------------------------------------------------------*/
 /*- CoAP service handlers---------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -152,6 +178,14 @@ coap_receive(const coap_endpoint_t *src,
 
   coap_status_code = coap_parse_message(message, payload, payload_length);
   coap_set_src_endpoint(message, src);
+#ifdef WITH_COAP_TCP
+  /* Datagrams keep to the UDP limit, as resources and clients expect */
+  if(coap_status_code == NO_ERROR && !coap_endpoint_is_reliable(src) &&
+     message->payload_len > COAP_MAX_CHUNK_SIZE) {
+    message->payload_len = COAP_MAX_CHUNK_SIZE;
+    message->payload[message->payload_len] = '\0';
+  }
+#endif /* WITH_COAP_TCP */
 
   if(coap_status_code == NO_ERROR) {
 
@@ -173,6 +207,7 @@ coap_receive(const coap_endpoint_t *src,
       if((transaction = coap_new_transaction(message->mid, src))) {
         uint32_t block_num = 0;
         uint16_t block_size = COAP_MAX_BLOCK_SIZE;
+        uint16_t block_szx_size = 0; /* Block2 size put on the wire */
         uint32_t block_offset = 0;
         int32_t new_offset = 0;
 
@@ -195,7 +230,18 @@ coap_receive(const coap_endpoint_t *src,
            (message, &block_num, NULL, &block_size, &block_offset)) {
           LOG_DBG("Blockwise: block request %"PRIu32" (%u/%u) @ %"PRIu32" bytes\n",
                   block_num, block_size, COAP_MAX_BLOCK_SIZE, block_offset);
+#ifdef WITH_COAP_TCP
+          if(block_size == COAP_BERT_SZX_SIZE && coap_tcp_bert_size(src) > 0) {
+            /* BERT: SZX 7 counts 1024-byte blocks, many per message */
+            block_offset = block_num * COAP_BERT_BLOCK_SIZE;
+            block_size = coap_tcp_bert_size(src);
+            block_szx_size = COAP_BERT_SZX_SIZE;
+          } else
+#endif /* WITH_COAP_TCP */
           block_size = MIN(block_size, COAP_MAX_BLOCK_SIZE);
+          if(block_szx_size == 0) {
+            block_szx_size = block_size;
+          }
           new_offset = block_offset;
         }
 
@@ -204,11 +250,26 @@ coap_receive(const coap_endpoint_t *src,
           coap_status_code = BAD_OPTION_4_02;
           coap_error_message = "BlockOutOfScope";
           status = COAP_HANDLER_STATUS_CONTINUE;
+#if COAP_PROXY
+        } else if(coap_is_option(message, COAP_OPTION_PROXY_URI) ||
+                  coap_is_option(message, COAP_OPTION_PROXY_SCHEME)) {
+          status = coap_proxy_handle_request(message, response);
+#endif /* COAP_PROXY */
+#if COAP_CACHE
+        } else if(coap_cache_handle_request(message, response)) {
+          status = COAP_HANDLER_STATUS_PROCESSED;
+#endif /* COAP_CACHE */
         } else {
           /* call CoAP framework and check if found and allowed */
           status = call_service(message, response,
                                 transaction->message + COAP_MAX_HEADER_SIZE,
                                 block_size, &new_offset);
+#if COAP_CACHE
+          if(status != COAP_HANDLER_STATUS_CONTINUE &&
+             coap_status_code == NO_ERROR && new_offset == 0) {
+            coap_cache_handle_response(message, response);
+          }
+#endif /* COAP_CACHE */
         }
 
         if(status != COAP_HANDLER_STATUS_CONTINUE) {
@@ -242,7 +303,7 @@ coap_receive(const coap_endpoint_t *src,
                     coap_set_header_block2(response, block_num,
                                            response->payload_len -
                                            block_offset > block_size,
-                                           block_size);
+                                           block_szx_size);
                     coap_set_payload(response,
                                      response->payload + block_offset,
                                      MIN(response->payload_len -
@@ -256,7 +317,7 @@ coap_receive(const coap_endpoint_t *src,
                   coap_set_header_block2(response, block_num,
                                          new_offset != -1
                                          || response->payload_len >
-                                         block_size, block_size);
+                                         block_size, block_szx_size);
 
                   if(response->payload_len > block_size) {
                     coap_set_payload(response, response->payload,
@@ -280,10 +341,7 @@ coap_receive(const coap_endpoint_t *src,
             /* serialize response */
         }
           if(coap_status_code == NO_ERROR) {
-            if((transaction->message_len = coap_serialize_message(response,
-                                                                 transaction->
-                                                                 message)) ==
-               0) {
+            if(coap_serialize_transaction(transaction, response) == 0) {
               coap_status_code = PACKET_SERIALIZATION_ERROR;
             }
           }
@@ -307,10 +365,24 @@ coap_receive(const coap_endpoint_t *src,
         coap_remove_observer_by_mid(src, message->mid);
       }
 
-      if((transaction = coap_get_transaction_by_mid(message->mid))) {
+      if(message->type == COAP_TYPE_ACK || message->type == COAP_TYPE_RST) {
+        transaction = coap_get_transaction(src, message->mid);
+        if(transaction && coap_acknowledge_transaction(transaction,
+             message->type == COAP_TYPE_ACK && message->code == 0)) {
+          /* empty ACK, the response follows separately */
+          transaction = NULL;
+        }
+      } else if(message->code != 0) {
+        /* separate response to one of our requests */
+        transaction = coap_get_transaction_by_token(src, message->token,
+                                                    message->token_len);
+      }
+
+      if(transaction) {
         /* free transaction memory before callback, as it may create a new transaction */
         coap_resource_response_handler_t callback = transaction->callback;
         void *callback_data = transaction->callback_data;
+        uint8_t ack_separate = message->type == COAP_TYPE_CON;
 
         coap_clear_transaction(transaction);
 
@@ -318,6 +390,15 @@ coap_receive(const coap_endpoint_t *src,
         if(callback) {
           callback(callback_data, message);
         }
+
+        if(ack_separate) {
+          uint8_t ack[COAP_HEADER_LEN];
+          coap_writer_t writer;
+
+          coap_writer_init(&writer, ack, sizeof(ack), COAP_TYPE_ACK, 0,
+                           message->mid, NULL, 0);
+          coap_sendto(src, ack, coap_writer_finish(&writer, NULL, 0));
+        }
       }
       /* if(ACKed transaction) */
       transaction = NULL;
@@ -379,13 +460,115 @@ coap_engine_init(void)
 
   list_init(coap_handlers);
   list_init(coap_resource_services);
+#if COAP_RESOURCE_TRIE
+  memb_init(&resource_trie_memb);
+  resource_trie = NULL;
+  resource_count = 0;
+  resource_trie_complete = 1;
+#endif /* COAP_RESOURCE_TRIE */
 
   coap_activate_resource(&res_well_known_core, ".well-known/core");
 
+#if COAP_PROXY
+  coap_proxy_init();
+#endif /* COAP_PROXY */
+
   coap_transport_init();
   coap_init_connection();
 }
 /*---------------------------------------------------------------------------*/
+#if COAP_RESOURCE_TRIE
+static const char *
+segment_end(const char *segment, const char *end)
+{
+  const char *p = memchr(segment, '/', end - segment);
+  return p != NULL ? p : end;
+}
+/*---------------------------------------------------------------------------*/
+static struct resource_trie_node *
+find_segment(struct resource_trie_node *node, const char *segment, int len)
+{
+  for(; node != NULL; node = node->sibling) {
+    if(node->segment_len == len && memcmp(node->segment, segment, len) == 0) {
+      return node;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+resource_trie_add(coap_resource_t *resource)
+{
+  struct resource_trie_node **level = &resource_trie;
+  struct resource_trie_node *node = NULL;
+  const char *segment = resource->url;
+  const char *end = segment + strlen(segment);
+  const char *next;
+
+  while(1) {
+    next = segment_end(segment, end);
+    node = find_segment(*level, segment, next - segment);
+    if(node == NULL) {
+      node = memb_alloc(&resource_trie_memb);
+      if(node == NULL) {
+        LOG_WARN("Resource trie full, using linear lookup\n");
+        resource_trie_complete = 0;
+        return;
+      }
+      node->child = NULL;
+      node->resource = NULL;
+      node->segment = segment;
+      node->segment_len = next - segment;
+      node->sibling = *level;
+      *level = node;
+    }
+    if(next == end) {
+      break;
+    }
+    level = &node->child;
+    segment = next + 1;
+  }
+
+  /* Keep the resource activated first, as the linear lookup does */
+  if(node->resource == NULL) {
+    node->resource = resource;
+    node->order = resource_count;
+  }
+  resource_count++;
+}
+/*---------------------------------------------------------------------------*/
+static coap_resource_t *
+resource_trie_lookup(const char *path, int path_len)
+{
+  struct resource_trie_node *level = resource_trie;
+  struct resource_trie_node *node;
+  struct resource_trie_node *match = NULL;
+  const char *end = path + path_len;
+  const char *next;
+
+  while(1) {
+    next = segment_end(path, end);
+    node = find_segment(level, path, next - path);
+    if(node == NULL) {
+      break;
+    }
+    /* Exact match, or a parent resource of the remaining path */
+    if(node->resource != NULL
+       && (next == end || (node->resource->flags & HAS_SUB_RESOURCES))
+       && (match == NULL || node->order < match->order)) {
+      match = node;
+    }
+    if(next == end) {
+      break;
+    }
+    level = node->child;
+    path = next + 1;
+  }
+
+  return match != NULL ? match->resource : NULL;
+}
+#endif /* COAP_RESOURCE_TRIE */
+/*---------------------------------------------------------------------------*/
 /**
  * \brief Makes a resource available under the given URI path
  * \param resource A pointer to a resource implementation
@@ -399,8 +582,22 @@ void
 coap_activate_resource(coap_resource_t *resource, const char *path)
 {
   coap_periodic_resource_t *periodic;
+
+  if(list_contains(coap_resource_services, resource)) {
+    /* Moving to a new path: nothing may still refer to the previous one */
+    coap_remove_resource(resource);
+  }
   resource->url = path;
   list_add(coap_resource_services, resource);
+#if COAP_RESOURCE_TRIE
+  if(resource_trie_complete) {
+    resource_trie_add(resource);
+  }
+#endif /* COAP_RESOURCE_TRIE */
+#if COAP_CACHE
+  /* Responses of a resource previously answering for the path */
+  coap_cache_invalidate_resource(path);
+#endif /* COAP_CACHE */
 
   LOG_INFO("Activating: %s\n", resource->url);
 
@@ -416,6 +613,43 @@ coap_activate_resource(coap_resource_t *resource, const char *path)
   }
 }
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief Makes a resource unavailable again
+ * \param resource A resource activated with coap_activate_resource()
+ *
+ * Stops its periodic handler and drops its observers and cached responses.
+ */
+void
+coap_remove_resource(coap_resource_t *resource)
+{
+#if COAP_RESOURCE_TRIE
+  coap_resource_t *r;
+#endif /* COAP_RESOURCE_TRIE */
+
+  list_remove(coap_resource_services, resource);
+#if COAP_RESOURCE_TRIE
+  /* Rebuilt from the remaining resources, in activation order */
+  memb_init(&resource_trie_memb);
+  resource_trie = NULL;
+  resource_count = 0;
+  resource_trie_complete = 1;
+  for(r = list_head(coap_resource_services);
+      r != NULL && resource_trie_complete; r = r->next) {
+    resource_trie_add(r);
+  }
+#endif /* COAP_RESOURCE_TRIE */
+
+  LOG_INFO("Removing: %s\n", resource->url);
+
+  if(resource->flags & IS_PERIODIC && resource->periodic) {
+    coap_timer_stop(&resource->periodic->periodic_timer);
+  }
+  coap_remove_observer_by_uri(NULL, resource->url);
+#if COAP_CACHE
+  coap_cache_invalidate_resource(resource->url);
+#endif /* COAP_CACHE */
+}
+/*---------------------------------------------------------------------------*/
 
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
@@ -432,6 +666,39 @@ coap_get_next_resource(coap_resource_t *resource)
   return list_item_next(resource);
 }
 /*---------------------------------------------------------------------------*/
+coap_resource_t *
+coap_get_resource_by_path(const char *path, int path_len)
+{
+  coap_resource_t *resource;
+  int res_url_len;
+
+  if(path == NULL) {
+    path = "";
+    path_len = 0;
+  }
+
+#if COAP_RESOURCE_TRIE
+  if(resource_trie_complete) {
+    return resource_trie_lookup(path, path_len);
+  }
+#endif /* COAP_RESOURCE_TRIE */
+
+  for(resource = list_head(coap_resource_services);
+      resource; resource = resource->next) {
+
+    /* if the web service handles that kind of requests and urls matches */
+    res_url_len = strlen(resource->url);
+    if((path_len == res_url_len
+        || (path_len > res_url_len
+            && (resource->flags & HAS_SUB_RESOURCES)
+            && path[res_url_len] == '/'))
+       && strncmp(resource->url, path, res_url_len) == 0) {
+      return resource;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
 static int
 invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
                              uint8_t *buffer, uint16_t buffer_size,
@@ -442,44 +709,35 @@ invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
 
   coap_resource_t *resource = NULL;
   const char *url = NULL;
-  int url_len, res_url_len;
+  int url_len;
 
   url_len = coap_get_header_uri_path(request, &url);
-  for(resource = list_head(coap_resource_services);
-      resource; resource = resource->next) {
-
-    /* if the web service handles that kind of requests and urls matches */
-    res_url_len = strlen(resource->url);
-    if((url_len == res_url_len
-        || (url_len > res_url_len
-            && (resource->flags & HAS_SUB_RESOURCES)
-            && url[res_url_len] == '/'))
-       && strncmp(resource->url, url, res_url_len) == 0) {
-      coap_resource_flags_t method = coap_get_method_type(request);
-      found = 1;
-
-      LOG_INFO("/%s, method %u, resource->flags %u\n", resource->url,
-               (uint16_t)method, resource->flags);
-
-      if((method & METHOD_GET) && resource->get_handler != NULL) {
-        /* call handler function */
-        resource->get_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_POST) && resource->post_handler != NULL) {
-        /* call handler function */
-        resource->post_handler(request, response, buffer, buffer_size,
+  resource = coap_get_resource_by_path(url, url_len);
+  if(resource != NULL) {
+    coap_resource_flags_t method = coap_get_method_type(request);
+    found = 1;
+    resource->hits++;
+
+    LOG_INFO("/%s, method %u, resource->flags %u\n", resource->url,
+             (uint16_t)method, resource->flags);
+
+    if((method & METHOD_GET) && resource->get_handler != NULL) {
+      /* call handler function */
+      resource->get_handler(request, response, buffer, buffer_size, offset);
+    } else if((method & METHOD_POST) && resource->post_handler != NULL) {
+      /* call handler function */
+      resource->post_handler(request, response, buffer, buffer_size,
+                             offset);
+    } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
+      /* call handler function */
+      resource->put_handler(request, response, buffer, buffer_size, offset);
+    } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
+      /* call handler function */
+      resource->delete_handler(request, response, buffer, buffer_size,
                                offset);
-      } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
-        /* call handler function */
-        resource->put_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
-        /* call handler function */
-        resource->delete_handler(request, response, buffer, buffer_size,
-                                 offset);
-      } else {
-        allowed = 0;
-        coap_set_status_code(response, METHOD_NOT_ALLOWED_4_05);
-      }
-      break;
+    } else {
+      allowed = 0;
+      coap_set_status_code(response, METHOD_NOT_ALLOWED_4_05);
     }
   }
   if(!found) {
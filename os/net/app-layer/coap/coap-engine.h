@@ -111,6 +111,7 @@ struct coap_resource_s {
     coap_resource_trigger_handler_t trigger;
     coap_resource_trigger_handler_t resume;
   };
+  uint32_t hits;                    /* requests dispatched to this resource */
 };
 
 struct coap_periodic_resource_s {
@@ -155,6 +156,15 @@ struct coap_periodic_resource_s {
  */
 void coap_activate_resource(coap_resource_t *resource, const char *path);
 /*---------------------------------------------------------------------------*/
+/**
+ *
+ * \brief      Makes an activated resource unavailable again, e.g. before
+ *             re-activating it under another path.
+ * \param resource
+ *             A resource activated with coap_activate_resource().
+ */
+void coap_remove_resource(coap_resource_t *resource);
+/*---------------------------------------------------------------------------*/
 /**
  * \brief      Returns the first of registered CoAP resources.
  * \return     The first registered CoAP resource or NULL if none exists.
@@ -167,6 +177,15 @@ coap_resource_t *coap_get_first_resource(void);
  */
 coap_resource_t *coap_get_next_resource(coap_resource_t *resource);
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief      Finds the resource that serves a URI path.
+ * \param path The URI path, without leading slash
+ * \param path_len The length of the path
+ * \return     The first activated resource whose URL equals the path, or
+ *             is a parent resource of it, or NULL if there is none.
+ */
+coap_resource_t *coap_get_resource_by_path(const char *path, int path_len);
+/*---------------------------------------------------------------------------*/
 
 #include "coap-transactions.h"
 #include "coap-observe.h"
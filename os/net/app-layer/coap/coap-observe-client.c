@@ -175,12 +175,11 @@ static void
 simple_reply(coap_message_type_t type, const coap_endpoint_t *endpoint,
              coap_message_t *notification)
 {
-  static coap_message_t response[1];
-  size_t len;
+  coap_writer_t response;
 
-  coap_init_message(response, type, NO_ERROR, notification->mid);
-  len = coap_serialize_message(response, coap_databuf());
-  coap_sendto(endpoint, coap_databuf(), len);
+  coap_writer_init(&response, coap_databuf(), COAP_HEADER_LEN,
+                   type, NO_ERROR, notification->mid, NULL, 0);
+  coap_sendto(endpoint, coap_databuf(), coap_writer_finish(&response, NULL, 0));
 }
 /*----------------------------------------------------------------------------*/
 static coap_notification_flag_t
@@ -304,7 +303,7 @@ coap_obs_request_registration(const coap_endpoint_t *endpoint, char *uri,
     if(obs) {
       t->callback = handle_obs_registration_response;
       t->callback_data = obs;
-      t->message_len = coap_serialize_message(request, t->message);
+      coap_serialize_transaction(t, request);
       coap_send_transaction(t);
     } else {
       LOG_DBG("Could not allocate obs_subject resource buffer\n");
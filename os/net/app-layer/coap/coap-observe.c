@@ -60,8 +60,9 @@ LIST(observers_list);
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 static coap_observer_t *
-add_observer(const coap_endpoint_t *endpoint, const uint8_t *token,
-             size_t token_len, const char *uri, int uri_len)
+add_observer(coap_resource_t *resource, const coap_endpoint_t *endpoint,
+             const uint8_t *token, size_t token_len,
+             const char *uri, int uri_len)
 {
   /* Remove existing observe relationship, if any. */
   coap_remove_observer_by_uri(endpoint, uri);
@@ -75,6 +76,7 @@ add_observer(const coap_endpoint_t *endpoint, const uint8_t *token,
     }
     memcpy(o->url, uri, max);
     o->url[max] = 0;
+    o->resource = resource;
     coap_endpoint_copy(&o->endpoint, endpoint);
     o->token_len = token_len;
     memcpy(o->token, token, token_len);
@@ -185,6 +187,136 @@ coap_notify_observers(coap_resource_t *resource)
 {
   coap_notify_observers_sub(resource, NULL);
 }
+/*---------------------------------------------------------------------------*/
+static int
+observe_value_len(uint32_t value)
+{
+  if(value > 0xFFFF) {
+    return 3;
+  } else if(value > 0xFF) {
+    return 2;
+  } else if(value > 0) {
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the offset of the Observe option header in a serialized message,
+   or 0 if the message has no Observe option. */
+static uint16_t
+find_observe_option(const uint8_t *message, uint16_t len)
+{
+  coap_option_iterator_t it;
+  coap_raw_option_t option;
+
+  coap_option_iterator_init(&it, message, len);
+  if(coap_option_find(&it, COAP_OPTION_OBSERVE, &option) <= 0) {
+    return 0;
+  }
+  /* The option header is a single byte, Observe is a low option number */
+  return option.value - message - 1;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Shared notification buffer. The representation is rendered once at
+ * NOTIFY_PAYLOAD_OFFSET and the per-observer header is placed so that it
+ * ends right before the payload, so the payload is never copied again.
+ */
+#define NOTIFY_PAYLOAD_OFFSET (COAP_MAX_HEADER_SIZE + 1)
+static uint8_t notify_buffer[NOTIFY_PAYLOAD_OFFSET + COAP_MAX_CHUNK_SIZE + 1];
+static uint8_t *notify_message;
+static uint16_t notify_len;
+static uint16_t notify_observe_offset;
+/*---------------------------------------------------------------------------*/
+/* Serializes the header of the rendered notification in front of the
+   shared payload. Returns 0 if the header does not fit. */
+static int
+build_notification_header(coap_message_t *notification)
+{
+  uint16_t payload_len = notification->payload_len;
+  size_t header_len;
+
+  notification->payload_len = 0;
+  header_len = coap_serialize_message(notification, notify_buffer);
+  notification->payload_len = payload_len;
+  if(header_len == 0) {
+    return 0;
+  }
+  if(payload_len > 0) {
+    notify_buffer[header_len++] = 0xFF;
+  }
+
+  notify_message = notify_buffer + NOTIFY_PAYLOAD_OFFSET - header_len;
+  memmove(notify_message, notify_buffer, header_len);
+  notify_len = header_len + payload_len;
+  notify_observe_offset = find_observe_option(notify_message, header_len);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Adapts the serialized notification to an observer, patching the header
+   in place whenever the token and Observe lengths allow it. */
+static int
+prepare_notification(coap_message_t *notification, coap_observer_t *obs,
+                     coap_message_type_t type, uint16_t mid)
+{
+  uint8_t *observe;
+  int observe_len;
+  int i;
+
+  notification->type = type;
+  notification->mid = mid;
+  coap_set_token(notification, obs->token, obs->token_len);
+  if(notification->code < BAD_REQUEST_4_00) {
+    coap_set_header_observe(notification, obs->obs_counter);
+  }
+
+  if(notify_message == NULL
+     || (notify_message[0] & COAP_HEADER_TOKEN_LEN_MASK) != obs->token_len) {
+    return build_notification_header(notification);
+  }
+
+  observe_len = 0;
+  if(notify_observe_offset != 0) {
+    observe = notify_message + notify_observe_offset;
+    observe_len = observe_value_len(obs->obs_counter);
+    if((*observe & COAP_HEADER_OPTION_SHORT_LENGTH_MASK) != observe_len) {
+      return build_notification_header(notification);
+    }
+    for(i = observe_len; i > 0; i--) {
+      observe[i] = (uint8_t)(obs->obs_counter >> (8 * (observe_len - i)));
+    }
+  }
+
+  notify_message[0] &= ~COAP_HEADER_TYPE_MASK;
+  notify_message[0] |= COAP_HEADER_TYPE_MASK & type << COAP_HEADER_TYPE_POSITION;
+  notify_message[2] = (uint8_t)(mid >> 8);
+  notify_message[3] = (uint8_t)mid;
+  memcpy(notify_message + COAP_HEADER_LEN, obs->token, obs->token_len);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+observer_matches(coap_observer_t *obs, coap_resource_t *resource,
+                 const char *url, int url_len, uint8_t sub_ok)
+{
+  int obs_url_len;
+
+  /* Observers of another resource can never match */
+  if(resource != NULL && obs->resource != NULL && obs->resource != resource) {
+    return 0;
+  }
+
+  obs_url_len = strlen(obs->url);
+
+  /* Do a match based on the parent/sub-resource match so that it is
+     possible to do parent-node observe */
+  return (obs_url_len == url_len
+          || (obs_url_len > url_len
+              && sub_ok
+              && obs->url[url_len] == '/'))
+    && strncmp(url, obs->url, url_len) == 0;
+}
+/*---------------------------------------------------------------------------*/
 /* Can be used either for sub - or when there is not resource - just
    a handler */
 void
@@ -194,9 +326,15 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
   coap_message_t notification[1]; /* this way the message can be treated as pointer as usual */
   coap_message_t request[1]; /* this way the message can be treated as pointer as usual */
   coap_observer_t *obs = NULL;
-  int url_len, obs_url_len;
+  coap_transaction_t *transaction;
+  coap_message_type_t type;
+  int url_len;
   char url[COAP_OBSERVER_URL_LEN];
   uint8_t sub_ok = 0;
+  uint8_t *payload;
+  int32_t new_offset = 0;
+  uint16_t mid;
+  int count = 0;
 
   if(resource != NULL) {
     url_len = strlen(resource->url);
@@ -216,94 +354,114 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
   /* url now contains the notify URL that needs to match the observer */
   LOG_INFO("Notification from %s\n", url);
 
-  coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
-  /* create a "fake" request for the URI */
-  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
-  coap_set_header_uri_path(request, url);
-
-  /* iterate over observers */
   url_len = strlen(url);
   /* Assumes lazy evaluation... */
   sub_ok = (resource == NULL) || (resource->flags & HAS_SUB_RESOURCES);
+
+  /* Nothing to render if nobody observes this URL */
   for(obs = (coap_observer_t *)list_head(observers_list); obs;
       obs = obs->next) {
-    obs_url_len = strlen(obs->url);
-
-    /* Do a match based on the parent/sub-resource match so that it is
-       possible to do parent-node observe */
-
-    /***** TODO fix here so that we handle the notofication correctly ******/
-    /* All the new-style ... is assuming that the URL might be within */
-    if((obs_url_len == url_len
-        || (obs_url_len > url_len
-            && sub_ok
-            && obs->url[url_len] == '/'))
-       && strncmp(url, obs->url, url_len) == 0) {
-      coap_transaction_t *transaction = NULL;
-
-      /*TODO implement special transaction for CON, sharing the same buffer to allow for more observers */
-
-      if((transaction = coap_new_transaction(coap_get_mid(), &obs->endpoint))) {
-        /* if COAP_OBSERVE_REFRESH_INTERVAL is zero, never send observations as confirmable messages */
-        if(COAP_OBSERVE_REFRESH_INTERVAL != 0
-            && (obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0)) {
-          LOG_DBG("           Force Confirmable for\n");
-          notification->type = COAP_TYPE_CON;
-        }
+    if(observer_matches(obs, resource, url, url_len, sub_ok)) {
+      break;
+    }
+  }
+  if(obs == NULL) {
+    return;
+  }
 
-        LOG_DBG("           Observer ");
-        LOG_DBG_COAP_EP(&obs->endpoint);
-        LOG_DBG_("\n");
+  coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
+  /* create a "fake" request for the URI */
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_set_header_uri_path(request, url);
 
-        /* update last MID for RST matching */
-        obs->last_mid = transaction->mid;
+  /* Render the representation once for all observers */
+  payload = notify_buffer + NOTIFY_PAYLOAD_OFFSET;
+  if(coap_call_handlers(request, notification, payload,
+                        COAP_MAX_CHUNK_SIZE, &new_offset) > 0) {
+    LOG_DBG("Notification on new handlers\n");
+  } else {
+    if(resource != NULL) {
+      resource->get_handler(request, notification, payload,
+                            COAP_MAX_CHUNK_SIZE, &new_offset);
+    } else {
+      /* What to do here? */
+      notification->code = BAD_REQUEST_4_00;
+    }
+  }
 
-        /* prepare response */
-        notification->mid = transaction->mid;
+  if(new_offset != 0) {
+    coap_set_header_block2(notification,
+                           0,
+                           new_offset != -1,
+                           COAP_MAX_BLOCK_SIZE);
+    coap_set_payload(notification,
+                     notification->payload,
+                     MIN(notification->payload_len,
+                         COAP_MAX_BLOCK_SIZE));
+  }
 
-	int32_t new_offset = 0;
+  /* Handlers may point the payload at their own storage */
+  if(notification->payload_len > COAP_MAX_CHUNK_SIZE) {
+    notification->payload_len = COAP_MAX_CHUNK_SIZE;
+  }
+  if(notification->payload_len > 0 && notification->payload != payload) {
+    memmove(payload, notification->payload, notification->payload_len);
+    notification->payload = payload;
+  }
+  notify_message = NULL;
 
-        /* Either old style get_handler or the full handler */
-        if(coap_call_handlers(request, notification, transaction->message +
-                              COAP_MAX_HEADER_SIZE, COAP_MAX_CHUNK_SIZE,
-                              &new_offset) > 0) {
-          LOG_DBG("Notification on new handlers\n");
-        } else {
-          if(resource != NULL) {
-            resource->get_handler(request, notification,
-                                  transaction->message + COAP_MAX_HEADER_SIZE,
-                                  COAP_MAX_CHUNK_SIZE, &new_offset);
-          } else {
-            /* What to do here? */
-            notification->code = BAD_REQUEST_4_00;
-          }
-        }
+  /* Fan out: only type, MID, token and Observe differ per observer */
+  for(; obs; obs = obs->next) {
+    if(!observer_matches(obs, resource, url, url_len, sub_ok)) {
+      continue;
+    }
 
-        if(notification->code < BAD_REQUEST_4_00) {
-          coap_set_header_observe(notification, (obs->obs_counter)++);
-          /* mask out to keep the CoAP observe option length <= 3 bytes */
-          obs->obs_counter &= 0xffffff;
-        }
-        coap_set_token(notification, obs->token, obs->token_len);
-
-	if(new_offset != 0) {
-	  coap_set_header_block2(notification,
-				 0,
-				 new_offset != -1,
-				 COAP_MAX_BLOCK_SIZE);
-	  coap_set_payload(notification,
-			   notification->payload,
-			   MIN(notification->payload_len,
-			       COAP_MAX_BLOCK_SIZE));
-	}
-
-        transaction->message_len =
-          coap_serialize_message(notification, transaction->message);
-
-        coap_send_transaction(transaction);
+    /* if COAP_OBSERVE_REFRESH_INTERVAL is zero, never send observations as confirmable messages */
+    type = COAP_TYPE_NON;
+    transaction = NULL;
+    mid = coap_get_mid();
+    if(COAP_OBSERVE_REFRESH_INTERVAL != 0
+       && (obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0)) {
+      /* Only confirmable notifications need a transaction of their own */
+      transaction = coap_new_transaction(mid, &obs->endpoint);
+      if(transaction != NULL) {
+        LOG_DBG("           Force Confirmable for\n");
+        type = COAP_TYPE_CON;
+      } else {
+        LOG_DBG("           No transaction for Confirmable, sending NON\n");
       }
     }
+
+    if(!prepare_notification(notification, obs, type, mid)) {
+      LOG_WARN("Notification header too large: %s\n", coap_error_message);
+      coap_clear_transaction(transaction);
+      return;
+    }
+
+    LOG_DBG("           Observer ");
+    LOG_DBG_COAP_EP(&obs->endpoint);
+    LOG_DBG_("\n");
+
+    /* update last MID for RST matching */
+    obs->last_mid = mid;
+
+    if(notification->code < BAD_REQUEST_4_00) {
+      (obs->obs_counter)++;
+      /* mask out to keep the CoAP observe option length <= 3 bytes */
+      obs->obs_counter &= 0xffffff;
+    }
+
+    if(transaction != NULL) {
+      memcpy(transaction->message, notify_message, notify_len);
+      transaction->message_len = notify_len;
+      coap_send_transaction(transaction);
+    } else {
+      coap_sendto(&obs->endpoint, notify_message, notify_len);
+    }
+    count++;
   }
+
+  LOG_DBG("Rendered once for %d observers (%u B)\n", count, notify_len);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -321,7 +479,7 @@ coap_observe_handler(coap_resource_t *resource, coap_message_t *coap_req,
       if(src_ep == NULL) {
         /* No source endpoint, can not add */
       } else if(coap_req->observe == 0) {
-        obs = add_observer(src_ep,
+        obs = add_observer(resource, src_ep,
                            coap_req->token, coap_req->token_len,
                            coap_req->uri_path, coap_req->uri_path_len);
         if(obs) {
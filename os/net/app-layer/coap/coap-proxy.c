@@ -0,0 +1,438 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      CoAP forward proxy (RFC 7252, Section 5.7)
+ */
+
+/**
+ * \addtogroup coap-proxy
+ * @{
+ */
+
+#include "coap-proxy.h"
+#include "coap-cache.h"
+#include "coap-separate.h"
+#include "coap-transactions.h"
+#include "lib/memb.h"
+#include "lib/list.h"
+#include "lib/random.h"
+#include <string.h>
+
+/* Log configuration */
+#include "coap-log.h"
+#define LOG_MODULE "coap"
+#define LOG_LEVEL  LOG_LEVEL_COAP
+
+#define PROXY_TOKEN_LEN 4
+
+/* An upstream request and the clients waiting for its response */
+struct pending {
+  struct pending *next;
+  int accept;
+  uint8_t method;
+  uint8_t waiter_count;
+  uint8_t token[PROXY_TOKEN_LEN];
+  uint16_t uri_len;
+  char uri[COAP_CACHE_URI_LEN];
+  coap_separate_t waiters[COAP_PROXY_WAITERS];
+};
+
+MEMB(pending_memb, struct pending, COAP_PROXY_REQUESTS);
+LIST(pending_list);
+
+static uint32_t next_token;
+/*---------------------------------------------------------------------------*/
+static int
+has_prefix(const char *uri, size_t len, const char *prefix)
+{
+  size_t prefix_len = strlen(prefix);
+
+  return len >= prefix_len && memcmp(uri, prefix, prefix_len) == 0;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Splits a Proxy-Uri into the endpoint, the path and the query. The
+ * path and query are left percent-encoded, see add_uri_options().
+ */
+static int
+parse_uri(const char *uri, size_t len, coap_endpoint_t *ep,
+          const char **path, size_t *path_len,
+          const char **query, size_t *query_len)
+{
+  const char *end = uri + len;
+  const char *s;
+
+  if(has_prefix(uri, len, "coap://")) {
+    s = uri + 7;
+#ifdef WITH_COAP_TCP
+  } else if(has_prefix(uri, len, "coap+tcp://")) {
+    s = uri + 11;
+  } else if(has_prefix(uri, len, "coap+ws://")) {
+    s = uri + 10;
+#endif /* WITH_COAP_TCP */
+  } else {
+    return 0;
+  }
+
+  /* Only IPv6 literals, there is no resolver */
+  if(s == end || *s != '[' || (s = memchr(s, ']', end - s)) == NULL) {
+    return 0;
+  }
+  while(s < end && *s != '/' && *s != '?') {
+    s++;
+  }
+  if(!coap_endpoint_parse(uri, s - uri, ep) || ep->secure) {
+    return 0;
+  }
+
+  if(s < end && *s == '/') {
+    s++;
+  }
+  *path = s;
+  while(s < end && *s != '?') {
+    s++;
+  }
+  *path_len = s - *path;
+  *query = s < end ? s + 1 : end;
+  *query_len = end - *query;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+hex_value(char c)
+{
+  if(c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if(c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if(c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Adds each segment of a path or query as an option. Segments are split
+ * before being percent-decoded, so that an encoded separator stays in its
+ * option (RFC 7252, 6.4). Returns 0 if a percent-encoding is invalid.
+ */
+static int
+add_uri_options(coap_writer_t *w, unsigned int number, const char *str,
+                size_t len, char separator)
+{
+  /* Decoding never makes a segment longer than the Proxy-Uri */
+  static char segment[COAP_CACHE_URI_LEN];
+  const char *end = str + len;
+  size_t segment_len;
+  int high;
+  int low;
+
+  while(1) {
+    segment_len = 0;
+    for(; str < end && *str != separator; str++) {
+      if(*str == '%') {
+        if(end - str < 3 || (high = hex_value(str[1])) < 0 ||
+           (low = hex_value(str[2])) < 0) {
+          return 0;
+        }
+        segment[segment_len++] = high << 4 | low;
+        str += 2;
+      } else {
+        segment[segment_len++] = *str;
+      }
+    }
+    coap_writer_add_option(w, number, segment, segment_len);
+    if(str == end) {
+      return 1;
+    }
+    str++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct pending *
+pending_find(const char *uri, size_t uri_len, int accept)
+{
+  struct pending *p;
+
+  for(p = list_head(pending_list); p != NULL; p = p->next) {
+    if(p->method == COAP_GET && p->accept == accept &&
+       p->uri_len == uri_len && memcmp(p->uri, uri, uri_len) == 0 &&
+       p->waiter_count < COAP_PROXY_WAITERS) {
+      return p;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+reply_waiters(struct pending *p, coap_message_t *upstream)
+{
+  /* The upstream payload is in the buffer the replies are sent from */
+  static uint8_t payload[COAP_MAX_CHUNK_SIZE];
+  static coap_message_t relay[1];
+  coap_cache_entry_t *entry = NULL;
+  coap_transaction_t *t;
+  coap_separate_t *w;
+  uint8_t code = GATEWAY_TIMEOUT_5_04;
+  uint16_t payload_len = 0;
+  uint32_t max_age = 0;
+  unsigned int format = 0;
+  int has_format = 0;
+  const uint8_t *etag = NULL;
+  int etag_len = 0;
+  int i;
+
+  if(upstream != NULL) {
+    coap_get_header_max_age(upstream, &max_age);
+    if(coap_is_option(upstream, COAP_OPTION_BLOCK2)) {
+      code = BAD_GATEWAY_5_02;
+      max_age = 0;
+    } else if(p->method != COAP_GET) {
+      code = upstream->code;
+    } else if(upstream->code == VALID_2_03) {
+      entry = coap_cache_find(p->uri, p->uri_len, p->accept, 0);
+      if(entry != NULL) {
+        coap_cache_refresh(entry, max_age);
+      } else {
+        /* Evicted while revalidating */
+        code = BAD_GATEWAY_5_02;
+      }
+    } else {
+      code = upstream->code;
+      entry = coap_cache_store(p->uri, p->uri_len, p->accept, 0, upstream,
+                               max_age);
+    }
+    if(entry == NULL && code == upstream->code) {
+      payload_len = MIN(upstream->payload_len, sizeof(payload));
+      memcpy(payload, upstream->payload, payload_len);
+      has_format = coap_get_header_content_format(upstream, &format);
+      etag_len = coap_get_header_etag(upstream, &etag);
+    }
+  }
+
+  for(i = 0; i < p->waiter_count; i++) {
+    w = &p->waiters[i];
+    t = coap_new_transaction(w->mid, &w->endpoint);
+    if(t == NULL) {
+      LOG_WARN("Proxy: no transaction to reply with\n");
+      continue;
+    }
+    coap_separate_resume(relay, w, code);
+    if(entry != NULL) {
+      coap_cache_respond(entry, NULL, relay);
+    } else {
+      if(upstream != NULL && coap_is_option(upstream, COAP_OPTION_MAX_AGE)) {
+        coap_set_header_max_age(relay, max_age);
+      }
+      if(etag_len > 0) {
+        coap_set_header_etag(relay, etag, etag_len);
+      }
+      if(has_format) {
+        coap_set_header_content_format(relay, format);
+      }
+      coap_set_payload(relay, payload, payload_len);
+    }
+    coap_serialize_transaction(t, relay);
+    coap_send_transaction(t);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+upstream_callback(void *data, coap_message_t *response)
+{
+  struct pending *p = data;
+
+  LOG_DBG("Proxy: %s for ", response == NULL ? "timeout" : "response");
+  LOG_DBG_COAP_STRING(p->uri, p->uri_len);
+  LOG_DBG_(" to %u clients\n", p->waiter_count);
+
+  list_remove(pending_list, p);
+  reply_waiters(p, response);
+  memb_free(&pending_memb, p);
+}
+/*---------------------------------------------------------------------------*/
+static coap_handler_status_t
+forward(coap_message_t *request, const char *uri, size_t uri_len, int accept,
+        const coap_endpoint_t *upstream, const char *path, size_t path_len,
+        const char *query, size_t query_len)
+{
+  struct pending *p;
+  coap_transaction_t *t;
+  coap_cache_entry_t *stale;
+  coap_writer_t w;
+  const uint8_t *etag;
+  unsigned int format;
+  int etag_len;
+  int valid;
+
+  p = memb_alloc(&pending_memb);
+  if(p == NULL) {
+    coap_separate_reject();
+    return COAP_HANDLER_STATUS_PROCESSED;
+  }
+  t = coap_new_transaction(coap_get_mid(), upstream);
+  if(t == NULL) {
+    memb_free(&pending_memb, p);
+    coap_status_code = SERVICE_UNAVAILABLE_5_03;
+    coap_error_message = "NoFreeTraBuffer";
+    return COAP_HANDLER_STATUS_PROCESSED;
+  }
+
+  next_token++;
+  memcpy(p->token, &next_token, PROXY_TOKEN_LEN);
+  memcpy(p->uri, uri, uri_len);
+  p->uri_len = uri_len;
+  p->accept = accept;
+  p->method = request->code;
+  p->waiter_count = 0;
+
+  /* Written before anything is sent, the request is in the send buffer */
+  coap_writer_init(&w, t->message, COAP_MAX_PACKET_SIZE, COAP_TYPE_CON,
+                   request->code, t->mid, p->token, PROXY_TOKEN_LEN);
+  if(request->code == COAP_GET &&
+     (stale = coap_cache_find(uri, uri_len, accept, 0)) != NULL &&
+     (etag_len = coap_cache_get_etag(stale, &etag)) > 0) {
+    coap_writer_add_option(&w, COAP_OPTION_ETAG, etag, etag_len);
+  }
+  valid = path_len == 0 ||
+    add_uri_options(&w, COAP_OPTION_URI_PATH, path, path_len, '/');
+  if(coap_get_header_content_format(request, &format)) {
+    coap_writer_add_int_option(&w, COAP_OPTION_CONTENT_FORMAT, format);
+  }
+  if(valid && query_len > 0) {
+    valid = add_uri_options(&w, COAP_OPTION_URI_QUERY, query, query_len,
+                            '&');
+  }
+  if(accept != COAP_CACHE_ANY_FORMAT) {
+    coap_writer_add_int_option(&w, COAP_OPTION_ACCEPT, accept);
+  }
+  t->message_len = coap_writer_finish(&w, request->payload,
+                                      request->payload_len);
+  if(!valid || t->message_len == 0) {
+    coap_clear_transaction(t);
+    memb_free(&pending_memb, p);
+    if(!valid) {
+      coap_status_code = BAD_REQUEST_4_00;
+      coap_error_message = "BadProxyUriEncoding";
+    } else {
+      coap_status_code = REQUEST_ENTITY_TOO_LARGE_4_13;
+      coap_error_message = "ProxyRequestTooLarge";
+    }
+    return COAP_HANDLER_STATUS_PROCESSED;
+  }
+
+  coap_separate_accept(request, &p->waiters[0]);
+  if(coap_status_code != MANUAL_RESPONSE) {
+    coap_clear_transaction(t);
+    memb_free(&pending_memb, p);
+    return COAP_HANDLER_STATUS_PROCESSED;
+  }
+  p->waiter_count = 1;
+  list_add(pending_list, p);
+
+  t->callback = upstream_callback;
+  t->callback_data = p;
+  coap_send_transaction(t);
+  return COAP_HANDLER_STATUS_PROCESSED;
+}
+/*---------------------------------------------------------------------------*/
+coap_handler_status_t
+coap_proxy_handle_request(coap_message_t *request, coap_message_t *response)
+{
+  coap_endpoint_t upstream;
+  coap_cache_entry_t *entry;
+  struct pending *p;
+  const char *uri;
+  const char *path;
+  const char *query;
+  size_t uri_len;
+  size_t path_len;
+  size_t query_len;
+  unsigned int accept;
+  int key_accept;
+
+  uri_len = coap_get_header_proxy_uri(request, &uri);
+  if(uri_len == 0 || coap_is_option(request, COAP_OPTION_PROXY_SCHEME) ||
+     coap_is_option(request, COAP_OPTION_BLOCK1) ||
+     coap_is_option(request, COAP_OPTION_BLOCK2) ||
+     !parse_uri(uri, uri_len, &upstream, &path, &path_len,
+                &query, &query_len)) {
+    coap_status_code = PROXYING_NOT_SUPPORTED_5_05;
+    coap_error_message = "UnsupportedProxyUri";
+    return COAP_HANDLER_STATUS_PROCESSED;
+  }
+  if(uri_len > COAP_CACHE_URI_LEN) {
+    coap_status_code = PROXYING_NOT_SUPPORTED_5_05;
+    coap_error_message = "ProxyUriTooLong";
+    return COAP_HANDLER_STATUS_PROCESSED;
+  }
+
+  key_accept = coap_get_header_accept(request, &accept) ?
+    (int)accept : COAP_CACHE_ANY_FORMAT;
+
+  if(request->code != COAP_GET) {
+    coap_cache_invalidate(uri, uri_len);
+  } else {
+    /* Upstream requests are never secured: entries are not secure either */
+    entry = coap_cache_find(uri, uri_len, key_accept, 0);
+    if(entry != NULL && coap_cache_is_fresh(entry)) {
+      coap_cache_respond(entry, request, response);
+      return COAP_HANDLER_STATUS_PROCESSED;
+    }
+    coap_cache_count_miss();
+
+    p = pending_find(uri, uri_len, key_accept);
+    if(p != NULL) {
+      coap_separate_accept(request, &p->waiters[p->waiter_count]);
+      if(coap_status_code == MANUAL_RESPONSE) {
+        p->waiter_count++;
+        coap_cache_count_coalesced();
+      }
+      return COAP_HANDLER_STATUS_PROCESSED;
+    }
+  }
+
+  return forward(request, uri, uri_len, key_accept, &upstream,
+                 path, path_len, query, query_len);
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_proxy_init(void)
+{
+  memb_init(&pending_memb);
+  list_init(pending_list);
+  next_token = random_rand() | ((uint32_t)random_rand() << 16);
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      CoAP forward proxy (RFC 7252, Section 5.7)
+ */
+
+/**
+ * \addtogroup coap
+ * @{
+ *
+ * \defgroup coap-proxy Forward proxy
+ * @{
+ *
+ * With COAP_PROXY, requests carrying a Proxy-Uri are forwarded to the
+ * node it names instead of being dispatched to local resources, e.g. by
+ * a border router on behalf of clients outside the mesh. The Proxy-Uri
+ * must name the node by its IPv6 address in brackets; Proxy-Scheme,
+ * host names, secure schemes and blockwise transfers are answered with
+ * 5.05 Proxying Not Supported.
+ *
+ * The client gets an empty ACK and a separate response once the node
+ * answers, or 5.04 Gateway Timeout once the upstream request gives up.
+ * Responses to GET are kept in the response cache (coap-cache.h) with
+ * their Max-Age, and later GETs are served from it while fresh. A stale
+ * entry with an ETag is revalidated upstream, and a GET for a resource
+ * that is already being fetched waits for that response instead of
+ * sending another request into the mesh.
+ */
+
+#ifndef COAP_PROXY_H_
+#define COAP_PROXY_H_
+
+#include "coap-engine.h"
+
+/**
+ * \brief      Initializes the proxy, called by coap_engine_init()
+ */
+void coap_proxy_init(void);
+
+/**
+ * \brief      Forwards a request carrying Proxy-Uri or Proxy-Scheme
+ *
+ * Called by the engine in place of the handlers and resources.
+ */
+coap_handler_status_t coap_proxy_handle_request(coap_message_t *request,
+                                                coap_message_t *response);
+
+#endif /* COAP_PROXY_H_ */
+/** @} */
+/** @} */
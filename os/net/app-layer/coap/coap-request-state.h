@@ -60,6 +60,9 @@ typedef struct coap_request_state {
   uint32_t res_block;
   uint8_t more;
   uint8_t block_error;
+#ifdef WITH_COAP_TCP
+  uint8_t bert; /* Block2 in BERT units of COAP_BERT_BLOCK_SIZE */
+#endif /* WITH_COAP_TCP */
   void *user_data;
   coap_request_status_t status;
 } coap_request_state_t;
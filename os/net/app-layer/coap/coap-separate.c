@@ -85,7 +85,8 @@ coap_separate_reject()
 void
 coap_separate_accept(coap_message_t *coap_req, coap_separate_t *separate_store)
 {
-  coap_transaction_t *const t = coap_get_transaction_by_mid(coap_req->mid);
+  coap_transaction_t *const t =
+    coap_get_transaction(coap_get_src_endpoint(coap_req), coap_req->mid);
 
   LOG_DBG("Separate ACCEPT: /");
   LOG_DBG_COAP_STRING(coap_req->uri_path, coap_req->uri_path_len);
@@ -93,7 +94,7 @@ coap_separate_accept(coap_message_t *coap_req, coap_separate_t *separate_store)
   if(t) {
     /* send separate ACK for CON */
     if(coap_req->type == COAP_TYPE_CON) {
-      coap_message_t ack[1];
+      coap_writer_t ack;
       const coap_endpoint_t *ep;
 
       ep = coap_get_src_endpoint(coap_req);
@@ -101,10 +102,10 @@ coap_separate_accept(coap_message_t *coap_req, coap_separate_t *separate_store)
         LOG_ERR("ERROR: no endpoint in request\n");
       } else {
         /* ACK with empty code (0) */
-        coap_init_message(ack, COAP_TYPE_ACK, 0, coap_req->mid);
         /* serializing into IPBUF: Only overwrites header parts that are already parsed into the request struct */
-        coap_sendto(ep, coap_databuf(),
-                    coap_serialize_message(ack, coap_databuf()));
+        coap_writer_init(&ack, coap_databuf(), COAP_HEADER_LEN,
+                         COAP_TYPE_ACK, 0, coap_req->mid, NULL, 0);
+        coap_sendto(ep, coap_databuf(), coap_writer_finish(&ack, NULL, 0));
       }
     }
 
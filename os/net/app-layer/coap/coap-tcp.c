@@ -0,0 +1,756 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      CoAP over TCP and WebSockets (RFC 8323)
+ */
+
+/**
+ * \addtogroup coap-tcp
+ * @{
+ */
+
+#ifdef WITH_COAP_TCP
+
+#include "contiki.h"
+#include "net/ipv6/tcp-socket.h"
+#include "net/ipv6/uiplib.h"
+#include "websocket.h"
+#include "coap-tcp.h"
+#include "coap-engine.h"
+#include "coap-observe.h"
+#include <string.h>
+#include <stdio.h>
+
+/* Log configuration */
+#include "coap-log.h"
+#define LOG_MODULE "coap-tcp"
+#define LOG_LEVEL  LOG_LEVEL_COAP
+
+#if !UIP_TCP
+#error "CoAP over TCP needs UIP_CONF_TCP"
+#endif
+
+/* Max-Message-Size assumed until the peer's CSM arrives */
+#define DEFAULT_MAX_MESSAGE_SIZE 1152
+
+#define SOCKET_INPUT_SIZE  128
+#define SOCKET_OUTPUT_SIZE (2 * (COAP_TCP_MAX_HEADER_LEN + COAP_TCP_MAX_MESSAGE_SIZE))
+
+#define WS_PATH "/.well-known/coap"
+
+enum {
+  STATE_FREE,
+  STATE_LISTENING,
+  STATE_CLOSING,
+  STATE_CONNECTING,
+  STATE_OPEN,
+};
+
+struct connection {
+  coap_endpoint_t endpoint;
+  coap_tcp_stream_t stream;
+  uint32_t peer_max_message_size;
+  uint8_t state;
+  uint8_t peer_bert;
+  uint8_t input[COAP_TCP_HEADROOM + COAP_TCP_MAX_MESSAGE_SIZE + 1];
+};
+
+struct tcp_connection {
+  struct connection c;
+  struct tcp_socket socket;
+  uint8_t socket_input[SOCKET_INPUT_SIZE];
+  uint8_t socket_output[SOCKET_OUTPUT_SIZE];
+};
+
+struct ws_connection {
+  struct connection c;
+  struct websocket ws;
+};
+
+static struct tcp_connection tcp_connections[COAP_TCP_CONNECTIONS];
+static struct ws_connection ws_connections[COAP_WS_CONNECTIONS];
+static uint8_t ws_frame[COAP_TCP_MAX_HEADER_LEN + WEBSOCKET_MAX_MSGLEN];
+
+static int tcp_input(struct tcp_socket *s, void *ptr,
+                     const uint8_t *data, int len);
+static void tcp_event(struct tcp_socket *s, void *ptr,
+                      tcp_socket_event_t event);
+/*---------------------------------------------------------------------------*/
+/*- Framing -----------------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+int
+coap_tcp_frame_header(uint8_t *header, const uint8_t *data, uint16_t len,
+                      uint8_t ws)
+{
+  uint8_t token_len;
+  uint16_t body_len;
+  int i = 1;
+
+  if(len < COAP_HEADER_LEN) {
+    return -1;
+  }
+  token_len = data[0] & COAP_HEADER_TOKEN_LEN_MASK;
+  if(token_len > COAP_TOKEN_LEN || len < COAP_HEADER_LEN + token_len) {
+    return -1;
+  }
+  body_len = len - COAP_HEADER_LEN - token_len;
+
+  /* Options and payload length, in the header nibble or extended */
+  if(ws) {
+    header[0] = 0;
+  } else if(body_len < 13) {
+    header[0] = body_len << 4;
+  } else if(body_len < 269) {
+    header[0] = 13 << 4;
+    header[i++] = body_len - 13;
+  } else {
+    header[0] = 14 << 4;
+    header[i++] = (body_len - 269) >> 8;
+    header[i++] = (body_len - 269);
+  }
+  header[0] |= token_len;
+  header[i++] = data[1];
+  memcpy(&header[i], &data[COAP_HEADER_LEN], token_len);
+  return i + token_len;
+}
+/*---------------------------------------------------------------------------*/
+/* Rewrite a complete frame in place into the UDP layout the engine parses */
+static int
+frame_to_message(coap_tcp_stream_t *s, uint8_t **message,
+                 uint16_t *message_len)
+{
+  uint8_t *frame = s->buffer + COAP_TCP_HEADROOM;
+  uint8_t *udp = frame + s->header_len - COAP_HEADER_LEN;
+  uint8_t token_len = frame[0] & COAP_HEADER_TOKEN_LEN_MASK;
+  uint8_t code = frame[s->header_len - 1];
+
+  if(token_len > COAP_TOKEN_LEN || s->len < s->header_len + token_len) {
+    return -1;
+  }
+  udp[0] = (1 << COAP_HEADER_VERSION_POSITION) |
+    (COAP_TYPE_NON << COAP_HEADER_TYPE_POSITION) | token_len;
+  udp[1] = code;
+  udp[2] = 0;
+  udp[3] = 0;
+  *message = udp;
+  *message_len = s->len - s->header_len + COAP_HEADER_LEN;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_tcp_stream_init(coap_tcp_stream_t *s, uint8_t *buffer, uint16_t size,
+                     uint8_t ws)
+{
+  s->buffer = buffer;
+  s->size = size;
+  s->len = 0;
+  s->expected = 0;
+  s->header_len = ws ? 2 : 0;
+  s->ws = ws;
+}
+/*---------------------------------------------------------------------------*/
+/* Sets the frame length once the length fields are in, 0 if more is needed */
+static int
+parse_length(coap_tcp_stream_t *s)
+{
+  uint8_t *frame = s->buffer + COAP_TCP_HEADROOM;
+  uint8_t nibble = frame[0] >> 4;
+  uint8_t ext = nibble < 13 ? 0 : (nibble == 13 ? 1 : (nibble == 14 ? 2 : 4));
+  uint32_t body_len;
+
+  if(s->len < 1 + ext) {
+    return 0;
+  }
+  switch(ext) {
+  case 0:
+    body_len = nibble;
+    break;
+  case 1:
+    body_len = frame[1] + 13;
+    break;
+  case 2:
+    body_len = ((uint32_t)frame[1] << 8 | frame[2]) + 269;
+    break;
+  default:
+    body_len = ((uint32_t)frame[1] << 24 | (uint32_t)frame[2] << 16 |
+                (uint32_t)frame[3] << 8 | frame[4]) + 65805;
+    break;
+  }
+  s->header_len = 2 + ext;
+  body_len += s->header_len + (frame[0] & COAP_HEADER_TOKEN_LEN_MASK);
+  if(body_len > s->size) {
+    LOG_WARN("Frame of %lu bytes exceeds %u\n",
+             (unsigned long)body_len, s->size);
+    return -1;
+  }
+  s->expected = body_len;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_tcp_stream_input(coap_tcp_stream_t *s, const uint8_t *data,
+                      uint16_t len, uint8_t **message, uint16_t *message_len)
+{
+  uint8_t *frame = s->buffer + COAP_TCP_HEADROOM;
+  uint16_t used = 0;
+  uint16_t n;
+  int r;
+
+  *message = NULL;
+  if(!s->ws && s->expected > 0 && s->len == s->expected) {
+    /* The previous message has been processed */
+    s->len = 0;
+    s->expected = 0;
+  }
+
+  while(used < len) {
+    if(s->ws) {
+      n = MIN(len - used, s->size - s->len);
+      if(n == 0) {
+        LOG_WARN("WebSocket frame exceeds %u\n", s->size);
+        return -1;
+      }
+    } else if(s->expected == 0) {
+      /* Byte by byte until the length fields are complete */
+      n = 1;
+    } else {
+      n = MIN(len - used, s->expected - s->len);
+    }
+    memcpy(frame + s->len, data + used, n);
+    s->len += n;
+    used += n;
+
+    if(!s->ws && s->expected == 0) {
+      r = parse_length(s);
+      if(r < 0) {
+        return -1;
+      }
+    }
+    if(!s->ws && s->expected > 0 && s->len == s->expected) {
+      if(frame_to_message(s, message, message_len) < 0) {
+        return -1;
+      }
+      return used;
+    }
+  }
+  return used;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_tcp_stream_finish(coap_tcp_stream_t *s, uint8_t **message,
+                       uint16_t *message_len)
+{
+  uint8_t *frame = s->buffer + COAP_TCP_HEADROOM;
+  int r = -1;
+
+  /* The length nibble is always zero on WebSockets */
+  if(s->len >= 2 && (frame[0] >> 4) == 0) {
+    s->header_len = 2;
+    r = frame_to_message(s, message, message_len);
+  }
+  s->len = 0;
+  return r;
+}
+/*---------------------------------------------------------------------------*/
+/*- Connections -------------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+static struct tcp_connection *
+tcp_connection(struct connection *c)
+{
+  return (struct tcp_connection *)c;
+}
+/*---------------------------------------------------------------------------*/
+static struct ws_connection *
+ws_connection(struct connection *c)
+{
+  return (struct ws_connection *)c;
+}
+/*---------------------------------------------------------------------------*/
+static struct connection *
+find_connection(const coap_endpoint_t *ep)
+{
+  int i;
+
+  for(i = 0; i < COAP_TCP_CONNECTIONS; i++) {
+    if(tcp_connections[i].c.state >= STATE_CONNECTING &&
+       coap_endpoint_cmp(&tcp_connections[i].c.endpoint, ep)) {
+      return &tcp_connections[i].c;
+    }
+  }
+  for(i = 0; i < COAP_WS_CONNECTIONS; i++) {
+    if(ws_connections[i].c.state >= STATE_CONNECTING &&
+       coap_endpoint_cmp(&ws_connections[i].c.endpoint, ep)) {
+      return &ws_connections[i].c;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+connection_init(struct connection *c, const coap_endpoint_t *ep,
+                uint8_t state)
+{
+  if(ep != NULL) {
+    coap_endpoint_copy(&c->endpoint, ep);
+  }
+  coap_tcp_stream_init(&c->stream, c->input, COAP_TCP_MAX_MESSAGE_SIZE,
+                       c->endpoint.transport == COAP_TRANSPORT_WS);
+  c->peer_max_message_size = DEFAULT_MAX_MESSAGE_SIZE;
+  c->peer_bert = 0;
+  c->state = state;
+}
+/*---------------------------------------------------------------------------*/
+/* (Re)register a TCP socket; listening sockets accept incoming connections */
+static void
+tcp_socket_setup(struct tcp_connection *tc, int listen)
+{
+  tcp_socket_unregister(&tc->socket);
+  tcp_socket_register(&tc->socket, tc,
+                      tc->socket_input, sizeof(tc->socket_input),
+                      tc->socket_output, sizeof(tc->socket_output),
+                      tcp_input, tcp_event);
+  if(listen) {
+    tcp_socket_listen(&tc->socket, COAP_DEFAULT_PORT);
+    tc->c.state = STATE_LISTENING;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+connection_send(struct connection *c, const uint8_t *data, uint16_t len)
+{
+  uint8_t header[COAP_TCP_MAX_HEADER_LEN];
+  uint8_t ws = c->endpoint.transport == COAP_TRANSPORT_WS;
+  uint16_t body_len;
+  int header_len;
+
+  header_len = coap_tcp_frame_header(header, data, len, ws);
+  if(header_len < 0) {
+    return -1;
+  }
+  body_len = len - COAP_HEADER_LEN - (data[0] & COAP_HEADER_TOKEN_LEN_MASK);
+  if(header_len + body_len > c->peer_max_message_size) {
+    LOG_WARN("Message of %u bytes exceeds the peer's limit of %lu\n",
+             header_len + body_len, (unsigned long)c->peer_max_message_size);
+    return -1;
+  }
+
+  if(ws) {
+    if(c->state != STATE_OPEN ||
+       header_len + body_len > sizeof(ws_frame) - COAP_TCP_MAX_HEADER_LEN) {
+      return -1;
+    }
+    memcpy(ws_frame, header, header_len);
+    memcpy(ws_frame + header_len, data + len - body_len, body_len);
+    if(websocket_send(&ws_connection(c)->ws, ws_frame,
+                      header_len + body_len) < 0) {
+      return -1;
+    }
+  } else {
+    struct tcp_socket *s = &tcp_connection(c)->socket;
+
+    /* Only queue whole messages, the stream must stay in sync */
+    if(tcp_socket_max_sendlen(s) < header_len + body_len) {
+      LOG_WARN("TCP output buffer full\n");
+      return -1;
+    }
+    tcp_socket_send(s, header, header_len);
+    tcp_socket_send(s, data + len - body_len, body_len);
+  }
+
+  LOG_INFO("sent to ");
+  LOG_INFO_COAP_EP(&c->endpoint);
+  LOG_INFO_(" %u bytes\n", header_len + body_len);
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_signal(struct connection *c, uint8_t code,
+            const uint8_t *token, uint8_t token_len)
+{
+  uint8_t buffer[COAP_HEADER_LEN + COAP_TOKEN_LEN + 8];
+  coap_writer_t w;
+
+  coap_writer_init(&w, buffer, sizeof(buffer), COAP_TYPE_NON, code, 0,
+                   token, token_len);
+  if(code == COAP_SIGNAL_CSM) {
+    coap_writer_add_int_option(&w, COAP_SIGNAL_OPTION_MAX_MESSAGE_SIZE,
+                               COAP_TCP_MAX_MESSAGE_SIZE);
+    coap_writer_add_option(&w, COAP_SIGNAL_OPTION_BLOCK_WISE_TRANSFER,
+                           NULL, 0);
+  }
+  connection_send(c, buffer, coap_writer_finish(&w, NULL, 0));
+}
+/*---------------------------------------------------------------------------*/
+static void
+connection_closed(struct connection *c)
+{
+  if(c->state >= STATE_CONNECTING) {
+    LOG_INFO("Connection to ");
+    LOG_INFO_COAP_EP(&c->endpoint);
+    LOG_INFO_(" closed\n");
+    coap_remove_observer_by_client(&c->endpoint);
+  }
+  if(c->endpoint.transport == COAP_TRANSPORT_WS) {
+    c->state = STATE_FREE;
+  } else {
+    tcp_socket_setup(tcp_connection(c), 1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+connection_close(struct connection *c, uint8_t signal)
+{
+  if(signal) {
+    send_signal(c, signal, NULL, 0);
+  }
+  coap_remove_observer_by_client(&c->endpoint);
+  if(c->endpoint.transport == COAP_TRANSPORT_WS) {
+    websocket_close(&ws_connection(c)->ws);
+    c->state = STATE_FREE;
+  } else {
+    /*
+     * tcp-socket reports no event for a close of our own once the output
+     * is flushed; the socket is reused when it has let go of the uIP
+     * connection.
+     */
+    tcp_socket_close(&tcp_connection(c)->socket);
+    c->state = STATE_CLOSING;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_signal(struct connection *c, const uint8_t *message, uint16_t len)
+{
+  coap_option_iterator_t it;
+  coap_raw_option_t option;
+
+  switch(message[1]) {
+  case COAP_SIGNAL_CSM:
+    if(coap_option_iterator_init(&it, message, len) < 0) {
+      break;
+    }
+    while(coap_option_next(&it, &option) > 0) {
+      if(option.number == COAP_SIGNAL_OPTION_MAX_MESSAGE_SIZE) {
+        c->peer_max_message_size = coap_option_get_int(&option);
+      } else if(option.number == COAP_SIGNAL_OPTION_BLOCK_WISE_TRANSFER) {
+        c->peer_bert = 1;
+      }
+    }
+    LOG_DBG("CSM: Max-Message-Size %lu%s\n",
+            (unsigned long)c->peer_max_message_size,
+            c->peer_bert ? ", BERT" : "");
+    break;
+  case COAP_SIGNAL_PING:
+    send_signal(c, COAP_SIGNAL_PONG, message + COAP_HEADER_LEN,
+                message[0] & COAP_HEADER_TOKEN_LEN_MASK);
+    break;
+  case COAP_SIGNAL_PONG:
+    LOG_DBG("Pong\n");
+    break;
+  case COAP_SIGNAL_RELEASE:
+  case COAP_SIGNAL_ABORT:
+    LOG_INFO("Peer %s the connection\n",
+             message[1] == COAP_SIGNAL_RELEASE ? "released" : "aborted");
+    connection_close(c, 0);
+    break;
+  default:
+    LOG_DBG("Ignoring signal %u.%02u\n", message[1] >> 5, message[1] & 0x1F);
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_message(struct connection *c, uint8_t *message, uint16_t len)
+{
+  if(message[1] >= COAP_SIGNAL_CSM) {
+    handle_signal(c, message, len);
+  } else if(message[1] != 0) {
+    coap_receive(&c->endpoint, message, len);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+tcp_input(struct tcp_socket *s, void *ptr, const uint8_t *data, int len)
+{
+  struct connection *c = ptr;
+  uint8_t *message;
+  uint16_t message_len;
+  int n;
+
+  while(len > 0 && c->state == STATE_OPEN) {
+    n = coap_tcp_stream_input(&c->stream, data, len, &message, &message_len);
+    if(n < 0) {
+      connection_close(c, COAP_SIGNAL_ABORT);
+      break;
+    }
+    if(message != NULL) {
+      handle_message(c, message, message_len);
+    }
+    data += n;
+    len -= n;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+tcp_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
+{
+  struct connection *c = ptr;
+  coap_endpoint_t ep;
+
+  switch(event) {
+  case TCP_SOCKET_CONNECTED:
+    if(c->state != STATE_CONNECTING) {
+      memset(&ep, 0, sizeof(ep));
+      uip_ipaddr_copy(&ep.ipaddr, &s->c->ripaddr);
+      ep.port = s->c->rport;
+      ep.transport = COAP_TRANSPORT_TCP;
+      connection_init(c, &ep, STATE_OPEN);
+      send_signal(c, COAP_SIGNAL_CSM, NULL, 0);
+    } else {
+      c->state = STATE_OPEN;
+    }
+    LOG_INFO("Connected to ");
+    LOG_INFO_COAP_EP(&c->endpoint);
+    LOG_INFO_("\n");
+    break;
+  case TCP_SOCKET_CLOSED:
+  case TCP_SOCKET_TIMEDOUT:
+  case TCP_SOCKET_ABORTED:
+    connection_closed(c);
+    break;
+  default:
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct ws_connection *
+ws_find(struct websocket *s)
+{
+  int i;
+
+  for(i = 0; i < COAP_WS_CONNECTIONS; i++) {
+    if(&ws_connections[i].ws == s) {
+      return &ws_connections[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+ws_event(struct websocket *s, websocket_result_t result,
+         const uint8_t *data, uint16_t len)
+{
+  struct ws_connection *wc = ws_find(s);
+  uint8_t *message;
+  uint16_t message_len;
+
+  if(wc == NULL || wc->c.state == STATE_FREE) {
+    return;
+  }
+
+  switch(result) {
+  case WEBSOCKET_CONNECTED:
+    wc->c.state = STATE_OPEN;
+    LOG_INFO("Connected to ");
+    LOG_INFO_COAP_EP(&wc->c.endpoint);
+    LOG_INFO_("\n");
+    send_signal(&wc->c, COAP_SIGNAL_CSM, NULL, 0);
+    break;
+  case WEBSOCKET_DATA:
+    if(coap_tcp_stream_input(&wc->c.stream, data, len,
+                             &message, &message_len) < 0) {
+      connection_close(&wc->c, COAP_SIGNAL_ABORT);
+    }
+    break;
+  case WEBSOCKET_DATA_RECEIVED:
+    if(coap_tcp_stream_finish(&wc->c.stream, &message, &message_len) > 0) {
+      handle_message(&wc->c, message, message_len);
+    }
+    break;
+  case WEBSOCKET_CLOSED:
+  case WEBSOCKET_RESET:
+  case WEBSOCKET_TIMEDOUT:
+  case WEBSOCKET_HOSTNAME_NOT_FOUND:
+  case WEBSOCKET_ERR:
+    connection_closed(&wc->c);
+    break;
+  default:
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+ws_open(const coap_endpoint_t *ep)
+{
+  static char url[sizeof("ws://[]:65535" WS_PATH) + UIPLIB_IPV6_MAX_STR_LEN];
+  struct ws_connection *wc = NULL;
+  int n;
+  int i;
+
+  for(i = 0; i < COAP_WS_CONNECTIONS; i++) {
+    if(ws_connections[i].c.state == STATE_FREE) {
+      wc = &ws_connections[i];
+      break;
+    }
+  }
+  if(wc == NULL) {
+    LOG_WARN("No free WebSocket connection\n");
+    return 0;
+  }
+
+  n = snprintf(url, sizeof(url), "ws://[");
+  n += uiplib_ipaddr_snprint(url + n, sizeof(url) - n, &ep->ipaddr);
+  snprintf(url + n, sizeof(url) - n, "]:%u" WS_PATH, uip_ntohs(ep->port));
+
+  connection_init(&wc->c, ep, STATE_CONNECTING);
+  websocket_init(&wc->ws);
+  if(websocket_open(&wc->ws, url, "coap", NULL, ws_event) == WEBSOCKET_ERR) {
+    wc->c.state = STATE_FREE;
+    return 0;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+tcp_open(const coap_endpoint_t *ep)
+{
+  struct tcp_connection *tc = NULL;
+  int i;
+
+  for(i = 0; i < COAP_TCP_CONNECTIONS; i++) {
+    if(tcp_connections[i].c.state == STATE_LISTENING ||
+       (tcp_connections[i].c.state == STATE_CLOSING &&
+        tcp_connections[i].socket.c == NULL)) {
+      tc = &tcp_connections[i];
+      break;
+    }
+  }
+  if(tc == NULL) {
+    LOG_WARN("No free TCP connection\n");
+    return 0;
+  }
+
+  tcp_socket_setup(tc, 0);
+  connection_init(&tc->c, ep, STATE_CONNECTING);
+  /* The CSM waits in the output buffer until the connection is up */
+  send_signal(&tc->c, COAP_SIGNAL_CSM, NULL, 0);
+  if(tcp_socket_connect(&tc->socket, &ep->ipaddr, uip_ntohs(ep->port)) < 0) {
+    tcp_socket_setup(tc, 1);
+    return 0;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/*- Transport API -----------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+int
+coap_tcp_connect(const coap_endpoint_t *ep)
+{
+  if(find_connection(ep) != NULL) {
+    return 1;
+  }
+  LOG_INFO("Connecting to ");
+  LOG_INFO_COAP_EP(ep);
+  LOG_INFO_("\n");
+  if(ep->transport == COAP_TRANSPORT_WS) {
+    return ws_open(ep);
+  }
+  return tcp_open(ep);
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_tcp_disconnect(const coap_endpoint_t *ep)
+{
+  struct connection *c = find_connection(ep);
+
+  if(c != NULL) {
+    connection_close(c, COAP_SIGNAL_RELEASE);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_tcp_is_connected(const coap_endpoint_t *ep)
+{
+  struct connection *c = find_connection(ep);
+
+  return c != NULL && c->state == STATE_OPEN;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_tcp_sendto(const coap_endpoint_t *ep, const uint8_t *data, uint16_t len)
+{
+  struct connection *c = find_connection(ep);
+
+  if(c == NULL) {
+    if(!coap_tcp_connect(ep)) {
+      return -1;
+    }
+    c = find_connection(ep);
+  }
+  return connection_send(c, data, len);
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+coap_tcp_bert_size(const coap_endpoint_t *ep)
+{
+  struct connection *c = find_connection(ep);
+  uint32_t size;
+
+  if(c == NULL || !c->peer_bert) {
+    return 0;
+  }
+  size = MIN(c->peer_max_message_size, COAP_TCP_MAX_MESSAGE_SIZE);
+  if(size < COAP_MAX_HEADER_SIZE + COAP_BERT_BLOCK_SIZE) {
+    return 0;
+  }
+  return (size - COAP_MAX_HEADER_SIZE) & ~(COAP_BERT_BLOCK_SIZE - 1);
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_tcp_init(void)
+{
+  int i;
+
+  for(i = 0; i < COAP_TCP_CONNECTIONS; i++) {
+    tcp_connections[i].c.endpoint.transport = COAP_TRANSPORT_TCP;
+    tcp_socket_setup(&tcp_connections[i], 1);
+  }
+  for(i = 0; i < COAP_WS_CONNECTIONS; i++) {
+    ws_connections[i].c.endpoint.transport = COAP_TRANSPORT_WS;
+    ws_connections[i].c.state = STATE_FREE;
+  }
+  LOG_INFO("Listening for CoAP over TCP on port %u\n", COAP_DEFAULT_PORT);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* WITH_COAP_TCP */
+/** @} */
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      CoAP over TCP and WebSockets (RFC 8323)
+ */
+
+/**
+ * \addtogroup coap-transport
+ * @{
+ *
+ * \defgroup coap-tcp CoAP over reliable transports
+ * @{
+ *
+ * Carries CoAP messages over TCP connections (coap+tcp://), accepted on
+ * COAP_DEFAULT_PORT or opened on demand, and over outgoing WebSocket
+ * connections (coap+ws://). Messages are handed to the engine in the UDP
+ * layout with type NON and Message ID 0, and converted back to the
+ * length-prefixed framing on the way out, so the engine, observe and the
+ * client APIs work unchanged. Signaling messages (CSM, Ping, Pong,
+ * Release and Abort) are handled here.
+ *
+ * Messages may be up to COAP_TCP_MAX_MESSAGE_SIZE, and Block2 transfers
+ * use BERT blocks (SZX 7, payloads of several 1024 byte blocks) with
+ * peers that announce support for them.
+ */
+
+#ifndef COAP_TCP_H_
+#define COAP_TCP_H_
+
+#include "coap.h"
+#include "coap-endpoint.h"
+
+/* Len/TKL, up to four bytes extended length, Code, Token */
+#define COAP_TCP_MAX_HEADER_LEN (1 + 4 + 1 + COAP_TOKEN_LEN)
+
+/* Bytes in front of a stream buffer for the conversion to the UDP layout */
+#define COAP_TCP_HEADROOM 2
+
+/* Signaling codes (7.xx) */
+#define COAP_SIGNAL_CSM     0xE1
+#define COAP_SIGNAL_PING    0xE2
+#define COAP_SIGNAL_PONG    0xE3
+#define COAP_SIGNAL_RELEASE 0xE4
+#define COAP_SIGNAL_ABORT   0xE5
+
+/* CSM options */
+#define COAP_SIGNAL_OPTION_MAX_MESSAGE_SIZE    2
+#define COAP_SIGNAL_OPTION_BLOCK_WISE_TRANSFER 4
+
+/* BERT: the Block2 size that encodes SZX 7, and the unit of its block numbers */
+#define COAP_BERT_SZX_SIZE   2048
+#define COAP_BERT_BLOCK_SIZE 1024
+
+/** Reassembly state of one connection */
+typedef struct coap_tcp_stream {
+  uint8_t *buffer;   /* COAP_TCP_HEADROOM + size + 1 bytes */
+  uint16_t size;
+  uint16_t len;
+  uint16_t expected; /* frame length once the header is known */
+  uint8_t header_len;
+  uint8_t ws;
+} coap_tcp_stream_t;
+
+/**
+ * \brief        Write the reliable-transport header for a message
+ * \param header Buffer of COAP_TCP_MAX_HEADER_LEN bytes
+ * \param data   The message in the UDP layout
+ * \param len    The message length
+ * \param ws     Non-zero for WebSocket framing (no length field)
+ * \return       The header length, or -1 for a malformed message
+ *
+ * The header includes the token. The rest of the frame is the message
+ * from data + COAP_HEADER_LEN + token length on.
+ */
+int coap_tcp_frame_header(uint8_t *header, const uint8_t *data, uint16_t len,
+                          uint8_t ws);
+
+/**
+ * \brief        Initialize a stream
+ * \param s      The stream
+ * \param buffer COAP_TCP_HEADROOM + size + 1 bytes
+ * \param size   The largest frame accepted
+ * \param ws     Non-zero if frames are delimited by WebSocket messages
+ */
+void coap_tcp_stream_init(coap_tcp_stream_t *s, uint8_t *buffer,
+                          uint16_t size, uint8_t ws);
+
+/**
+ * \brief         Feed received bytes into a stream
+ * \param s       The stream
+ * \param data    The received bytes
+ * \param len     The number of bytes
+ * \param message Set to the complete message in the UDP layout, or NULL
+ * \param message_len Set to the message length
+ * \return        The number of bytes consumed, or -1 if the frame is
+ *                malformed or larger than the stream buffer
+ *
+ * Consumption stops after a complete message so it can be processed; the
+ * message stays valid until the next call.
+ */
+int coap_tcp_stream_input(coap_tcp_stream_t *s, const uint8_t *data,
+                          uint16_t len, uint8_t **message,
+                          uint16_t *message_len);
+
+/**
+ * \brief         Complete a WebSocket frame fed into a stream
+ * \param s       The stream
+ * \param message Set to the message in the UDP layout
+ * \param message_len Set to the message length
+ * \return        1 on success, -1 if the frame is malformed
+ */
+int coap_tcp_stream_finish(coap_tcp_stream_t *s, uint8_t **message,
+                           uint16_t *message_len);
+
+/**
+ * \brief      Send a message in the UDP layout to a reliable endpoint
+ * \param ep   The endpoint; TCP connections are opened on demand
+ * \param data The message
+ * \param len  The message length
+ * \return     The number of bytes sent or queued, or -1 on error
+ */
+int coap_tcp_sendto(const coap_endpoint_t *ep, const uint8_t *data,
+                    uint16_t len);
+
+/**
+ * \brief    Open a connection to a reliable endpoint
+ * \param ep The endpoint
+ * \return   1 if the connection is open or being opened, 0 otherwise
+ */
+int coap_tcp_connect(const coap_endpoint_t *ep);
+
+/**
+ * \brief    Release the connection to a reliable endpoint
+ * \param ep The endpoint
+ */
+void coap_tcp_disconnect(const coap_endpoint_t *ep);
+
+/**
+ * \brief    Check if the connection to a reliable endpoint is open
+ * \param ep The endpoint
+ * \return   Non-zero once the connection is established
+ */
+int coap_tcp_is_connected(const coap_endpoint_t *ep);
+
+/**
+ * \brief    Get the BERT payload size to use with a peer
+ * \param ep The endpoint
+ * \return   A multiple of COAP_BERT_BLOCK_SIZE bounded by both sides'
+ *           Max-Message-Size, or 0 if the peer does not support BERT
+ */
+uint16_t coap_tcp_bert_size(const coap_endpoint_t *ep);
+
+/**
+ * \brief Initialize the reliable transports; called by the CoAP transport
+ */
+void coap_tcp_init(void);
+
+#endif /* COAP_TCP_H_ */
+/** @} */
+/** @} */
@@ -47,28 +47,555 @@
 #include "lib/memb.h"
 #include "lib/list.h"
 #include <stdlib.h>
+#include <string.h>
 
 /* Log configuration */
 #include "coap-log.h"
 #define LOG_MODULE "coap"
 #define LOG_LEVEL  LOG_LEVEL_COAP
 
+#define FLAG_OUTSTANDING 0x01 /* sent and counted against NSTART */
+#define FLAG_DEFERRED    0x02 /* queued until the peer is below NSTART */
+#define FLAG_AWAIT       0x04 /* ACKed, waiting for a separate response */
+#define FLAG_TOKEN       0x08 /* linked into the token hash */
+#define FLAG_TIMER       0x10 /* linked into the timer wheel */
+
+#define HASH_MASK (COAP_TRANSACTION_HASH_SIZE - 1)
+#if COAP_TRANSACTION_HASH_SIZE & HASH_MASK
+#error "COAP_TRANSACTION_HASH_SIZE must be a power of two"
+#endif
+
+#define BLOCKS(len) (((len) + COAP_TRANSACTION_BLOCK_SIZE - 1) / \
+                     COAP_TRANSACTION_BLOCK_SIZE)
+#define POOL_BLOCKS (COAP_TRANSACTION_BUFFER_SIZE / COAP_TRANSACTION_BLOCK_SIZE)
+#define FULL_BLOCKS BLOCKS(COAP_MAX_PACKET_SIZE + 1)
+#if POOL_BLOCKS < FULL_BLOCKS
+#error "COAP_TRANSACTION_BUFFER_SIZE cannot hold a full-size message"
+#endif
+#ifdef WITH_COAP_TCP
+/* Messages on reliable transports may carry up to COAP_MAX_PAYLOAD_SIZE */
+#define RELIABLE_BLOCKS BLOCKS(COAP_MAX_HEADER_SIZE + COAP_MAX_PAYLOAD_SIZE + 1)
+#if POOL_BLOCKS < RELIABLE_BLOCKS
+#error "COAP_TRANSACTION_BUFFER_SIZE cannot hold a COAP_TCP_MAX_MESSAGE_SIZE message"
+#endif
+#endif /* WITH_COAP_TCP */
+
+/* How long a request ACKed with an empty ACK waits for its response */
+#define SEPARATE_RESPONSE_TIMEOUT \
+  (COAP_RESPONSE_TIMEOUT_TICKS * ((2UL << COAP_MAX_RETRANSMIT) - 1) * 3 / 2)
+
+#define WHEEL_TICK(time) ((time) / COAP_TRANSACTION_WHEEL_TICK)
+#define WHEEL_SLOT(time) (WHEEL_TICK(time) % COAP_TRANSACTION_WHEEL_SLOTS)
+
 /*---------------------------------------------------------------------------*/
 MEMB(transactions_memb, coap_transaction_t, COAP_MAX_OPEN_TRANSACTIONS);
 LIST(transactions_list);
 
+static coap_transaction_t *mid_hash[COAP_TRANSACTION_HASH_SIZE];
+static coap_transaction_t *token_hash[COAP_TRANSACTION_HASH_SIZE];
+
+static uint8_t buffer_pool[POOL_BLOCKS * COAP_TRANSACTION_BLOCK_SIZE];
+static uint8_t buffer_map[(POOL_BLOCKS + 7) / 8];
+
+static coap_transaction_t *wheel[COAP_TRANSACTION_WHEEL_SLOTS];
+static coap_timer_t wheel_timer;
+static uint64_t wheel_tick;
+static uint64_t wheel_next;
+static uint16_t wheel_count;
+
+#if COAP_CONGESTION_CONTROL
+struct coap_endpoint_state {
+  struct coap_endpoint_state *next;
+  coap_endpoint_t endpoint;
+  uint64_t last_used;
+  uint64_t rto_updated;
+  uint32_t rto;
+  uint32_t srtt[2];
+  uint32_t rttvar[2];
+  uint8_t estimators;
+  uint8_t outstanding;
+  uint8_t deferred;
+};
+
+#define ESTIMATOR_STRONG 0
+#define ESTIMATOR_WEAK   1
+#define RTO_INITIAL      2000
+#define RTO_MAX          60000
+
+MEMB(endpoints_memb, struct coap_endpoint_state, COAP_CC_ENDPOINTS);
+LIST(endpoints_list);
+#endif /* COAP_CONGESTION_CONTROL */
+
+static void start_transaction(coap_transaction_t *t);
+static void wheel_expired(coap_timer_t *timer);
+
+/*---------------------------------------------------------------------------*/
+/*- Message buffer pool -----------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+static int
+block_used(uint16_t block)
+{
+  return buffer_map[block >> 3] & (1 << (block & 7));
+}
+/*---------------------------------------------------------------------------*/
+static void
+mark_blocks(uint16_t first, uint16_t count, int used)
+{
+  for(; count > 0; first++, count--) {
+    if(used) {
+      buffer_map[first >> 3] |= 1 << (first & 7);
+    } else {
+      buffer_map[first >> 3] &= ~(1 << (first & 7));
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t *
+buffer_alloc(uint16_t count)
+{
+  uint16_t block;
+  uint16_t run;
+
+  /* First fit */
+  for(block = 0, run = 0; block < POOL_BLOCKS; block++) {
+    if(block_used(block)) {
+      run = 0;
+    } else if(++run == count) {
+      block -= count - 1;
+      mark_blocks(block, count, 1);
+      return &buffer_pool[block * COAP_TRANSACTION_BLOCK_SIZE];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+buffer_free(uint8_t *buffer, uint16_t count)
+{
+  mark_blocks((buffer - buffer_pool) / COAP_TRANSACTION_BLOCK_SIZE, count, 0);
+}
+/*---------------------------------------------------------------------------*/
+static void
+buffer_trim(coap_transaction_t *t)
+{
+  uint16_t blocks = BLOCKS(t->message_len + 1);
+
+  if(blocks < t->message_blocks) {
+    buffer_free(t->message + blocks * COAP_TRANSACTION_BLOCK_SIZE,
+                t->message_blocks - blocks);
+    t->message_blocks = blocks;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*- Hash tables -------------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+static uint8_t
+token_hash_of(const uint8_t *token, uint8_t len)
+{
+  uint8_t h = len;
+
+  while(len-- > 0) {
+    h = (h << 3) + (h >> 5) + *token++;
+  }
+  return h & HASH_MASK;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+transaction_token_len(const coap_transaction_t *t)
+{
+  uint8_t len = t->message[0] & COAP_HEADER_TOKEN_LEN_MASK;
+
+  if(len > COAP_TOKEN_LEN || t->message_len < COAP_HEADER_LEN + len) {
+    return 0;
+  }
+  return len;
+}
 /*---------------------------------------------------------------------------*/
 static void
-coap_retransmit_transaction(coap_timer_t *nt)
+unlink_hash(coap_transaction_t **head, coap_transaction_t *t, int token)
 {
-  coap_transaction_t *t = coap_timer_get_user_data(nt);
-  if(t == NULL) {
-    LOG_DBG("No retransmission data in coap_timer!\n");
+  coap_transaction_t **p;
+
+  for(p = head; *p != NULL;
+      p = token ? &(*p)->next_token : &(*p)->next_mid) {
+    if(*p == t) {
+      *p = token ? t->next_token : t->next_mid;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+token_hash_add(coap_transaction_t *t)
+{
+  uint8_t len = transaction_token_len(t);
+  uint8_t h;
+
+  if(len > 0 && !(t->flags & FLAG_TOKEN)) {
+    h = token_hash_of(t->message + COAP_HEADER_LEN, len);
+    t->next_token = token_hash[h];
+    token_hash[h] = t;
+    t->flags |= FLAG_TOKEN;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*- Timer wheel -------------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+static void
+wheel_schedule(void)
+{
+  coap_transaction_t *t;
+  uint64_t next = 0;
+  uint64_t tick;
+  uint64_t now;
+  int i;
+
+  /* The earliest entry is in the first slot holding one due this round */
+  for(i = 0, tick = wheel_tick;
+      next == 0 && i < COAP_TRANSACTION_WHEEL_SLOTS; i++, tick++) {
+    for(t = wheel[tick % COAP_TRANSACTION_WHEEL_SLOTS]; t != NULL;
+        t = t->next_timer) {
+      if(WHEEL_TICK(t->expiration_time) <= tick &&
+         (next == 0 || t->expiration_time < next)) {
+        next = t->expiration_time;
+      }
+    }
+  }
+  /* Everything is at least one round away */
+  for(i = 0; next == 0 && i < COAP_TRANSACTION_WHEEL_SLOTS; i++) {
+    for(t = wheel[i]; t != NULL; t = t->next_timer) {
+      if(next == 0 || t->expiration_time < next) {
+        next = t->expiration_time;
+      }
+    }
+  }
+
+  wheel_next = next;
+  if(next == 0) {
+    coap_timer_stop(&wheel_timer);
+  } else {
+    now = coap_timer_uptime();
+    coap_timer_set_callback(&wheel_timer, wheel_expired);
+    coap_timer_set(&wheel_timer, next > now ? next - now : 0);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_remove(coap_transaction_t *t)
+{
+  coap_transaction_t **p;
+
+  if(!(t->flags & FLAG_TIMER)) {
     return;
   }
-  ++(t->retrans_counter);
-  LOG_DBG("Retransmitting %u (%u)\n", t->mid, t->retrans_counter);
-  coap_send_transaction(t);
+  for(p = &wheel[WHEEL_SLOT(t->expiration_time)]; *p != NULL;
+      p = &(*p)->next_timer) {
+    if(*p == t) {
+      *p = t->next_timer;
+      break;
+    }
+  }
+  t->flags &= ~FLAG_TIMER;
+  if(--wheel_count == 0) {
+    wheel_next = 0;
+    coap_timer_stop(&wheel_timer);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_add(coap_transaction_t *t, uint32_t interval)
+{
+  uint8_t slot;
+
+  wheel_remove(t);
+  t->expiration_time = coap_timer_uptime() + interval;
+  if(wheel_count++ == 0) {
+    wheel_tick = WHEEL_TICK(coap_timer_uptime());
+  }
+  slot = WHEEL_SLOT(t->expiration_time);
+  t->next_timer = wheel[slot];
+  wheel[slot] = t;
+  t->flags |= FLAG_TIMER;
+
+  if(wheel_next == 0 || t->expiration_time < wheel_next) {
+    wheel_next = t->expiration_time;
+    coap_timer_set_callback(&wheel_timer, wheel_expired);
+    coap_timer_set(&wheel_timer, interval);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static coap_transaction_t *
+wheel_pop_expired(uint64_t now)
+{
+  coap_transaction_t **p;
+  coap_transaction_t *t;
+  uint64_t last = WHEEL_TICK(now);
+  uint64_t tick;
+  int i;
+
+  for(i = 0, tick = wheel_tick;
+      tick <= last && i < COAP_TRANSACTION_WHEEL_SLOTS; i++, tick++) {
+    for(p = &wheel[tick % COAP_TRANSACTION_WHEEL_SLOTS]; *p != NULL;
+        p = &(*p)->next_timer) {
+      if((*p)->expiration_time <= now) {
+        t = *p;
+        *p = t->next_timer;
+        t->flags &= ~FLAG_TIMER;
+        wheel_count--;
+        return t;
+      }
+    }
+  }
+  wheel_tick = last;
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/*- Congestion control ------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+#if COAP_CONGESTION_CONTROL
+static struct coap_endpoint_state *
+endpoint_state_get(const coap_endpoint_t *ep)
+{
+  struct coap_endpoint_state *s;
+  struct coap_endpoint_state *lru = NULL;
+
+  for(s = list_head(endpoints_list); s != NULL; s = s->next) {
+    if(coap_endpoint_cmp(&s->endpoint, ep)) {
+      s->last_used = coap_timer_uptime();
+      return s;
+    }
+    if(s->outstanding == 0 && s->deferred == 0 &&
+       (lru == NULL || s->last_used < lru->last_used)) {
+      lru = s;
+    }
+  }
+
+  s = memb_alloc(&endpoints_memb);
+  if(s == NULL) {
+    if(lru == NULL) {
+      LOG_DBG("No congestion state for peer, using defaults\n");
+      return NULL;
+    }
+    s = lru;
+  } else {
+    list_add(endpoints_list, s);
+  }
+
+  coap_endpoint_copy(&s->endpoint, ep);
+  s->last_used = s->rto_updated = coap_timer_uptime();
+  s->rto = RTO_INITIAL;
+  s->estimators = 0;
+  s->outstanding = 0;
+  s->deferred = 0;
+  return s;
+}
+/*---------------------------------------------------------------------------*/
+static void
+endpoint_state_age(struct coap_endpoint_state *s)
+{
+  uint64_t idle = coap_timer_uptime() - s->rto_updated;
+
+  if(s->rto < 1000 && idle > 16 * (uint64_t)s->rto) {
+    s->rto *= 2;
+    s->rto_updated = coap_timer_uptime();
+  } else if(s->rto > 3000 && idle > 4 * (uint64_t)s->rto) {
+    s->rto = (RTO_INITIAL + s->rto) / 2;
+    s->rto_updated = coap_timer_uptime();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+endpoint_state_sample(struct coap_endpoint_state *s, uint8_t estimator,
+                      uint32_t rtt)
+{
+  uint32_t rto;
+
+  if(!(s->estimators & (1 << estimator))) {
+    s->srtt[estimator] = rtt;
+    s->rttvar[estimator] = rtt / 2;
+    s->estimators |= 1 << estimator;
+  } else {
+    s->rttvar[estimator] = (3 * s->rttvar[estimator] +
+                            (s->srtt[estimator] > rtt ?
+                             s->srtt[estimator] - rtt :
+                             rtt - s->srtt[estimator])) / 4;
+    s->srtt[estimator] = (7 * s->srtt[estimator] + rtt) / 8;
+  }
+
+  /* CoCoA: K = 4 for strong and K = 1 for weak samples, weak ones weigh less */
+  if(estimator == ESTIMATOR_STRONG) {
+    rto = s->srtt[estimator] + 4 * s->rttvar[estimator];
+    s->rto = (rto + s->rto) / 2;
+  } else {
+    rto = s->srtt[estimator] + s->rttvar[estimator];
+    s->rto = (rto + 3 * s->rto) / 4;
+  }
+  if(s->rto > RTO_MAX) {
+    s->rto = RTO_MAX;
+  }
+  s->rto_updated = coap_timer_uptime();
+  LOG_DBG("RTT %s %lu ms, RTO %lu ms\n",
+          estimator == ESTIMATOR_STRONG ? "strong" : "weak",
+          (unsigned long)rtt, (unsigned long)s->rto);
+}
+/*---------------------------------------------------------------------------*/
+static void
+endpoint_state_release(coap_transaction_t *t)
+{
+  struct coap_endpoint_state *s = t->cc;
+  coap_transaction_t *next;
+  coap_transaction_t *first = NULL;
+
+  if(s == NULL || !(t->flags & (FLAG_OUTSTANDING | FLAG_DEFERRED))) {
+    return;
+  }
+  if(t->flags & FLAG_OUTSTANDING) {
+    s->outstanding--;
+  } else {
+    s->deferred--;
+  }
+  t->flags &= ~(FLAG_OUTSTANDING | FLAG_DEFERRED);
+
+  if(s->outstanding >= COAP_NSTART || s->deferred == 0) {
+    return;
+  }
+  /* Start the oldest queued message from the timer, not from the caller */
+  for(next = list_head(transactions_list); next != NULL; next = next->next) {
+    if(next->cc == s && (next->flags & FLAG_DEFERRED)) {
+      if(next->flags & FLAG_TIMER) {
+        return;
+      }
+      if(first == NULL) {
+        first = next;
+      }
+    }
+  }
+  if(first != NULL) {
+    wheel_add(first, 0);
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+coap_get_endpoint_rto(const coap_endpoint_t *ep)
+{
+  struct coap_endpoint_state *s;
+
+  for(s = list_head(endpoints_list); s != NULL; s = s->next) {
+    if(coap_endpoint_cmp(&s->endpoint, ep)) {
+      return s->rto;
+    }
+  }
+  return 0;
+}
+#endif /* COAP_CONGESTION_CONTROL */
+/*---------------------------------------------------------------------------*/
+static uint32_t
+initial_interval(coap_transaction_t *t)
+{
+#if COAP_CONGESTION_CONTROL
+  if(t->cc != NULL) {
+    endpoint_state_age(t->cc);
+    return t->cc->rto + (rand() % (t->cc->rto / 2 + 1));
+  }
+#endif /* COAP_CONGESTION_CONTROL */
+  return COAP_RESPONSE_TIMEOUT_TICKS +
+    (rand() % COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+backoff_interval(coap_transaction_t *t)
+{
+#if COAP_CONGESTION_CONTROL
+  /* CoCoA variable backoff factor */
+  if(t->cc != NULL && t->cc->rto < 1000) {
+    return t->retrans_interval * 3;
+  }
+  if(t->cc != NULL && t->cc->rto > 3000) {
+    return t->retrans_interval + t->retrans_interval / 2;
+  }
+#endif /* COAP_CONGESTION_CONTROL */
+  return t->retrans_interval << 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+timeout_transaction(coap_transaction_t *t)
+{
+  coap_resource_response_handler_t callback = t->callback;
+  void *callback_data = t->callback_data;
+
+  LOG_DBG("Timeout\n");
+
+  /* handle observers */
+  if(!(t->flags & FLAG_AWAIT)) {
+    coap_remove_observer_by_client(&t->endpoint);
+  }
+
+  coap_clear_transaction(t);
+
+  if(callback) {
+    callback(callback_data, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+transaction_expired(coap_transaction_t *t)
+{
+  if(t->flags & FLAG_DEFERRED) {
+#if COAP_CONGESTION_CONTROL
+    if(t->cc != NULL && t->cc->outstanding >= COAP_NSTART) {
+      /* Another message took the slot; wait for the next release */
+      return;
+    }
+#endif /* COAP_CONGESTION_CONTROL */
+    start_transaction(t);
+  } else if(t->flags & FLAG_AWAIT) {
+    timeout_transaction(t);
+  } else if(++(t->retrans_counter) <= COAP_MAX_RETRANSMIT) {
+    LOG_DBG("Retransmitting %u (%u)\n", t->mid, t->retrans_counter);
+    coap_sendto(&t->endpoint, t->message, t->message_len);
+    t->retrans_interval = backoff_interval(t);
+    LOG_DBG("Backed off (%u) interval %lu ms\n", t->retrans_counter,
+            (unsigned long)t->retrans_interval);
+    wheel_add(t, t->retrans_interval);
+  } else {
+    timeout_transaction(t);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_expired(coap_timer_t *timer)
+{
+  coap_transaction_t *t;
+  uint64_t now = coap_timer_uptime();
+
+  wheel_next = 0;
+  while((t = wheel_pop_expired(now)) != NULL) {
+    transaction_expired(t);
+  }
+  wheel_schedule();
+}
+/*---------------------------------------------------------------------------*/
+static void
+start_transaction(coap_transaction_t *t)
+{
+#if COAP_CONGESTION_CONTROL
+  if(t->cc != NULL) {
+    if(t->flags & FLAG_DEFERRED) {
+      t->cc->deferred--;
+      t->flags &= ~FLAG_DEFERRED;
+    }
+    t->cc->outstanding++;
+    t->flags |= FLAG_OUTSTANDING;
+  }
+  t->start_time = coap_timer_uptime();
+#endif /* COAP_CONGESTION_CONTROL */
+
+  t->retrans_counter = 0;
+  t->retrans_interval = initial_interval(t);
+  LOG_DBG("Initial interval %lu msec\n", (unsigned long)t->retrans_interval);
+
+  coap_sendto(&t->endpoint, t->message, t->message_len);
+  wheel_add(t, t->retrans_interval);
 }
 /*---------------------------------------------------------------------------*/
 
@@ -79,88 +606,180 @@ coap_transaction_t *
 coap_new_transaction(uint16_t mid, const coap_endpoint_t *endpoint)
 {
   coap_transaction_t *t = memb_alloc(&transactions_memb);
+  uint16_t blocks = FULL_BLOCKS;
+  uint8_t h;
 
   if(t) {
+#ifdef WITH_COAP_TCP
+    if(coap_endpoint_is_reliable(endpoint)) {
+      blocks = RELIABLE_BLOCKS;
+    }
+#endif /* WITH_COAP_TCP */
+    t->message = buffer_alloc(blocks);
+    if(t->message == NULL) {
+      LOG_DBG("No transaction buffer left\n");
+      memb_free(&transactions_memb, t);
+      return NULL;
+    }
+    t->message_blocks = blocks;
+    t->message_len = 0;
     t->mid = mid;
+    t->flags = 0;
     t->retrans_counter = 0;
+    t->retrans_interval = 0;
+    t->callback = NULL;
+    t->callback_data = NULL;
+#if COAP_CONGESTION_CONTROL
+    t->cc = NULL;
+#endif /* COAP_CONGESTION_CONTROL */
 
     /* save client address */
     coap_endpoint_copy(&t->endpoint, endpoint);
 
+    h = mid & HASH_MASK;
+    t->next_mid = mid_hash[h];
+    mid_hash[h] = t;
+
     list_add(transactions_list, t); /* list itself makes sure same element is not added twice */
   }
 
   return t;
 }
 /*---------------------------------------------------------------------------*/
+uint16_t
+coap_serialize_transaction(coap_transaction_t *t, coap_message_t *message)
+{
+#ifdef WITH_COAP_TCP
+  /* Datagrams keep to the UDP limit whatever the payload set */
+  if(!coap_endpoint_is_reliable(&t->endpoint) &&
+     message->payload_len > COAP_MAX_CHUNK_SIZE) {
+    message->payload_len = COAP_MAX_CHUNK_SIZE;
+  }
+#endif /* WITH_COAP_TCP */
+  t->message_len = coap_serialize_message_bounded(message, t->message,
+                                                  t->message_blocks *
+                                                  COAP_TRANSACTION_BLOCK_SIZE);
+  return t->message_len;
+}
+/*---------------------------------------------------------------------------*/
 void
 coap_send_transaction(coap_transaction_t *t)
 {
   LOG_DBG("Sending transaction %u\n", t->mid);
 
-  if(COAP_TYPE_CON ==
-     ((COAP_HEADER_TYPE_MASK & t->message[0]) >> COAP_HEADER_TYPE_POSITION)) {
-    if(t->retrans_counter <= COAP_MAX_RETRANSMIT) {
-      /* not timed out yet */
-      coap_sendto(&t->endpoint, t->message, t->message_len);
-      LOG_DBG("Keeping transaction %u\n", t->mid);
-
-      if(t->retrans_counter == 0) {
-        coap_timer_set_callback(&t->retrans_timer, coap_retransmit_transaction);
-        coap_timer_set_user_data(&t->retrans_timer, t);
-        t->retrans_interval =
-          COAP_RESPONSE_TIMEOUT_TICKS + (rand() %
-                                         COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
-        LOG_DBG("Initial interval %lu msec\n",
-                (unsigned long)t->retrans_interval);
-      } else {
-        t->retrans_interval <<= 1;  /* double */
-        LOG_DBG("Doubled (%u) interval %lu s\n", t->retrans_counter,
-                (unsigned long)(t->retrans_interval / 1000));
-      }
-
-      /* interval updated above */
-      coap_timer_set(&t->retrans_timer, t->retrans_interval);
-    } else {
-      /* timed out */
-      LOG_DBG("Timeout\n");
-      coap_resource_response_handler_t callback = t->callback;
-      void *callback_data = t->callback_data;
+  if(t->message_len == 0) {
+    /* Serialization failed. Report the failure from the timer rather than
+       from the context of the sender. */
+    LOG_WARN("Transaction %u has no message, dropping it\n", t->mid);
+    t->flags |= FLAG_AWAIT;
+    wheel_add(t, 0);
+    return;
+  }
 
-      /* handle observers */
-      coap_remove_observer_by_client(&t->endpoint);
+  buffer_trim(t);
 
+#ifdef WITH_COAP_TCP
+  if(coap_endpoint_is_reliable(&t->endpoint)) {
+    /*
+     * The transport is reliable: nothing is retransmitted and only
+     * requests keep their transaction to match the response by token.
+     */
+    coap_sendto(&t->endpoint, t->message, t->message_len);
+    if(t->callback != NULL &&
+       t->message[1] >= COAP_GET && t->message[1] <= COAP_DELETE) {
+      token_hash_add(t);
+      t->flags |= FLAG_AWAIT;
+      wheel_add(t, SEPARATE_RESPONSE_TIMEOUT);
+    } else {
       coap_clear_transaction(t);
+    }
+    return;
+  }
+#endif /* WITH_COAP_TCP */
 
-      if(callback) {
-        callback(callback_data, NULL);
-      }
+  if(COAP_TYPE_CON ==
+     ((COAP_HEADER_TYPE_MASK & t->message[0]) >> COAP_HEADER_TYPE_POSITION)) {
+    LOG_DBG("Keeping transaction %u\n", t->mid);
+    token_hash_add(t);
+
+#if COAP_CONGESTION_CONTROL
+    t->cc = endpoint_state_get(&t->endpoint);
+    if(t->cc != NULL &&
+       (t->cc->outstanding >= COAP_NSTART || t->cc->deferred > 0)) {
+      LOG_DBG("Deferring transaction %u (NSTART)\n", t->mid);
+      t->cc->deferred++;
+      t->flags |= FLAG_DEFERRED;
+      return;
     }
+#endif /* COAP_CONGESTION_CONTROL */
+
+    start_transaction(t);
   } else {
     coap_sendto(&t->endpoint, t->message, t->message_len);
     coap_clear_transaction(t);
   }
 }
 /*---------------------------------------------------------------------------*/
+int
+coap_acknowledge_transaction(coap_transaction_t *t, int empty)
+{
+  uint8_t code = t->message[1];
+
+  wheel_remove(t);
+
+#if COAP_CONGESTION_CONTROL
+  if(t->cc != NULL && (t->flags & FLAG_OUTSTANDING) &&
+     t->retrans_counter <= 2) {
+    endpoint_state_sample(t->cc, t->retrans_counter == 0 ?
+                          ESTIMATOR_STRONG : ESTIMATOR_WEAK,
+                          coap_timer_uptime() - t->start_time);
+  }
+  endpoint_state_release(t);
+#endif /* COAP_CONGESTION_CONTROL */
+
+  if(empty && t->callback != NULL &&
+     code >= COAP_GET && code <= COAP_DELETE && (t->flags & FLAG_TOKEN)) {
+    LOG_DBG("Transaction %u waits for a separate response\n", t->mid);
+    t->flags |= FLAG_AWAIT;
+    wheel_add(t, SEPARATE_RESPONSE_TIMEOUT);
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
 void
 coap_clear_transaction(coap_transaction_t *t)
 {
+  uint8_t len;
+
   if(t) {
     LOG_DBG("Freeing transaction %u: %p\n", t->mid, t);
 
-    coap_timer_stop(&t->retrans_timer);
+    wheel_remove(t);
+#if COAP_CONGESTION_CONTROL
+    endpoint_state_release(t);
+#endif /* COAP_CONGESTION_CONTROL */
+
+    unlink_hash(&mid_hash[t->mid & HASH_MASK], t, 0);
+    if(t->flags & FLAG_TOKEN) {
+      len = transaction_token_len(t);
+      unlink_hash(&token_hash[token_hash_of(t->message + COAP_HEADER_LEN,
+                                            len)], t, 1);
+    }
+
+    buffer_free(t->message, t->message_blocks);
     list_remove(transactions_list, t);
     memb_free(&transactions_memb, t);
   }
 }
 /*---------------------------------------------------------------------------*/
 coap_transaction_t *
-coap_get_transaction_by_mid(uint16_t mid)
+coap_get_transaction(const coap_endpoint_t *ep, uint16_t mid)
 {
-  coap_transaction_t *t = NULL;
+  coap_transaction_t *t;
 
-  for(t = (coap_transaction_t *)list_head(transactions_list); t; t = t->next) {
-    if(t->mid == mid) {
+  for(t = mid_hash[mid & HASH_MASK]; t != NULL; t = t->next_mid) {
+    if(t->mid == mid && (ep == NULL || coap_endpoint_cmp(&t->endpoint, ep))) {
       LOG_DBG("Found transaction for MID %u: %p\n", t->mid, t);
       return t;
     }
@@ -168,4 +787,31 @@ coap_get_transaction_by_mid(uint16_t mid)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+coap_transaction_t *
+coap_get_transaction_by_mid(uint16_t mid)
+{
+  return coap_get_transaction(NULL, mid);
+}
+/*---------------------------------------------------------------------------*/
+coap_transaction_t *
+coap_get_transaction_by_token(const coap_endpoint_t *ep,
+                              const uint8_t *token, uint8_t len)
+{
+  coap_transaction_t *t;
+
+  if(len == 0) {
+    return NULL;
+  }
+  for(t = token_hash[token_hash_of(token, len)]; t != NULL;
+      t = t->next_token) {
+    if(transaction_token_len(t) == len &&
+       memcmp(t->message + COAP_HEADER_LEN, token, len) == 0 &&
+       coap_endpoint_cmp(&t->endpoint, ep)) {
+      LOG_DBG("Found transaction for token: %p\n", t);
+      return t;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
 /** @} */
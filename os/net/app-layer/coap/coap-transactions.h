@@ -55,14 +55,29 @@
 #define COAP_RESPONSE_TIMEOUT_TICKS         (1000 * COAP_RESPONSE_TIMEOUT)
 #define COAP_RESPONSE_TIMEOUT_BACKOFF_MASK  (uint32_t)(((1000 * COAP_RESPONSE_TIMEOUT * ((float)COAP_RESPONSE_RANDOM_FACTOR - 1.0)) + 0.5) + 1)
 
-/* container for transactions with message buffer and retransmission info */
+struct coap_endpoint_state;
+
+/*
+ * Container for transactions with message buffer and retransmission info.
+ * Transactions are indexed by MID and, once sent as Confirmable, by token;
+ * the message buffer is taken from a shared block pool and trimmed to the
+ * serialized length when the transaction is sent.
+ */
 typedef struct coap_transaction {
   struct coap_transaction *next;        /* for LIST */
+  struct coap_transaction *next_mid;    /* MID hash bucket */
+  struct coap_transaction *next_token;  /* token hash bucket */
+  struct coap_transaction *next_timer;  /* timer wheel slot */
 
   uint16_t mid;
-  coap_timer_t retrans_timer;
-  uint32_t retrans_interval;
+  uint8_t flags;
   uint8_t retrans_counter;
+  uint32_t retrans_interval;
+  uint64_t expiration_time;
+#if COAP_CONGESTION_CONTROL
+  uint64_t start_time;
+  struct coap_endpoint_state *cc;
+#endif /* COAP_CONGESTION_CONTROL */
 
   coap_endpoint_t endpoint;
 
@@ -70,14 +85,66 @@ typedef struct coap_transaction {
   void *callback_data;
 
   uint16_t message_len;
-  uint8_t message[COAP_MAX_PACKET_SIZE + 1];     /* +1 for the terminating '\0' which will not be sent
-                                                 * Use snprintf(buf, len+1, "", ...) to completely fill payload */
+  uint16_t message_blocks;
+  uint8_t *message;     /* COAP_MAX_PACKET_SIZE + 1 bytes until sent, +1 for the terminating '\0' which will not be sent
+                         * Use snprintf(buf, len+1, "", ...) to completely fill payload */
 } coap_transaction_t;
 
 coap_transaction_t *coap_new_transaction(uint16_t mid, const coap_endpoint_t *ep);
+/*
+ * Serializes message into the buffer of t and sets t->message_len. On
+ * datagram transports, the payload is cut to COAP_MAX_CHUNK_SIZE. Returns
+ * the length, 0 if the message does not fit: sending the transaction then
+ * fails it as if it had timed out.
+ */
+uint16_t coap_serialize_transaction(coap_transaction_t *t,
+                                    coap_message_t *message);
 void coap_send_transaction(coap_transaction_t *t);
 void coap_clear_transaction(coap_transaction_t *t);
 coap_transaction_t *coap_get_transaction_by_mid(uint16_t mid);
 
+/**
+ * \brief      Look up an open transaction by endpoint and Message ID
+ * \param ep   The peer of the transaction, or NULL to match any peer
+ * \param mid  The Message ID
+ * \return     The transaction or NULL if none is open
+ */
+coap_transaction_t *coap_get_transaction(const coap_endpoint_t *ep,
+                                         uint16_t mid);
+
+/**
+ * \brief       Look up a sent Confirmable transaction by endpoint and token
+ * \param ep    The peer of the transaction
+ * \param token The token of the received response
+ * \param len   The token length
+ * \return      The transaction or NULL if none matches
+ *
+ * Used to match separate responses, which carry a new Message ID.
+ */
+coap_transaction_t *coap_get_transaction_by_token(const coap_endpoint_t *ep,
+                                                  const uint8_t *token,
+                                                  uint8_t len);
+
+/**
+ * \brief       Handle an ACK or RST for a Confirmable transaction
+ * \param t     The transaction matched by Message ID
+ * \param empty Non-zero for an empty ACK
+ * \return      1 if the transaction stays open to await a separate
+ *              response, 0 if the caller should clear it
+ *
+ * Stops retransmissions, feeds the round-trip time estimator and frees
+ * the NSTART slot of the peer.
+ */
+int coap_acknowledge_transaction(coap_transaction_t *t, int empty);
+
+#if COAP_CONGESTION_CONTROL
+/**
+ * \brief    Get the current retransmission timeout estimate for a peer
+ * \param ep The peer
+ * \return   The RTO in milliseconds, or 0 if the peer is not tracked
+ */
+uint32_t coap_get_endpoint_rto(const coap_endpoint_t *ep);
+#endif /* COAP_CONGESTION_CONTROL */
+
 #endif /* COAP_TRANSACTIONS_H_ */
 /** @} */
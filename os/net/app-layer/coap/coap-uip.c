@@ -58,6 +58,9 @@
 #include "coap-constants.h"
 #include "coap-keystore.h"
 #include "coap-keystore-simple.h"
+#ifdef WITH_COAP_TCP
+#include "coap-tcp.h"
+#endif /* WITH_COAP_TCP */
 
 /* Log configuration */
 #include "coap-log.h"
@@ -89,6 +92,20 @@ PROCESS(coap_engine, "CoAP Engine");
 
 static struct uip_udp_conn *udp_conn = NULL;
 
+/*---------------------------------------------------------------------------*/
+static const char *
+endpoint_scheme(const coap_endpoint_t *ep)
+{
+#ifdef WITH_COAP_TCP
+  if(ep->transport == COAP_TRANSPORT_TCP) {
+    return "coap+tcp://[";
+  }
+  if(ep->transport == COAP_TRANSPORT_WS) {
+    return "coap+ws://[";
+  }
+#endif /* WITH_COAP_TCP */
+  return ep->secure ? "coaps://[" : "coap://[";
+}
 /*---------------------------------------------------------------------------*/
 void
 coap_endpoint_log(const coap_endpoint_t *ep)
@@ -97,11 +114,7 @@ coap_endpoint_log(const coap_endpoint_t *ep)
     LOG_OUTPUT("(NULL EP)");
     return;
   }
-  if(ep->secure) {
-    LOG_OUTPUT("coaps://[");
-  } else {
-    LOG_OUTPUT("coap://[");
-  }
+  LOG_OUTPUT("%s", endpoint_scheme(ep));
   log_6addr(&ep->ipaddr);
   LOG_OUTPUT("]:%u", uip_ntohs(ep->port));
 }
@@ -113,11 +126,7 @@ coap_endpoint_print(const coap_endpoint_t *ep)
     printf("(NULL EP)");
     return;
   }
-  if(ep->secure) {
-    printf("coaps://[");
-  } else {
-    printf("coap://[");
-  }
+  printf("%s", endpoint_scheme(ep));
   uiplib_ipaddr_print(&ep->ipaddr);
   printf("]:%u", uip_ntohs(ep->port));
 }
@@ -132,11 +141,7 @@ coap_endpoint_snprint(char *buf, size_t size, const coap_endpoint_t *ep)
   if(ep == NULL) {
     n = snprintf(buf, size - 1, "(NULL EP)");
   } else {
-    if(ep->secure) {
-      n = snprintf(buf, size - 1, "coaps://[");
-    } else {
-      n = snprintf(buf, size - 1, "coap://[");
-    }
+    n = snprintf(buf, size - 1, "%s", endpoint_scheme(ep));
     if(n < size - 1) {
       n += uiplib_ipaddr_snprint(&buf[n], size - n - 1, &ep->ipaddr);
     }
@@ -157,6 +162,9 @@ coap_endpoint_copy(coap_endpoint_t *destination,
   uip_ipaddr_copy(&destination->ipaddr, &from->ipaddr);
   destination->port = from->port;
   destination->secure = from->secure;
+#ifdef WITH_COAP_TCP
+  destination->transport = from->transport;
+#endif /* WITH_COAP_TCP */
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -165,6 +173,11 @@ coap_endpoint_cmp(const coap_endpoint_t *e1, const coap_endpoint_t *e2)
   if(!uip_ipaddr_cmp(&e1->ipaddr, &e2->ipaddr)) {
     return 0;
   }
+#ifdef WITH_COAP_TCP
+  if(e1->transport != e2->transport) {
+    return 0;
+  }
+#endif /* WITH_COAP_TCP */
   return e1->port == e2->port && e1->secure == e2->secure;
 }
 /*---------------------------------------------------------------------------*/
@@ -206,11 +219,25 @@ coap_endpoint_parse(const char *text, size_t size, coap_endpoint_t *ep)
   uint32_t port;
 
   ep->secure = strncmp(text, "coaps:", 6) == 0;
+#ifdef WITH_COAP_TCP
+  if(strncmp(text, "coap+tcp:", 9) == 0) {
+    ep->transport = COAP_TRANSPORT_TCP;
+  } else if(strncmp(text, "coap+ws:", 8) == 0) {
+    ep->transport = COAP_TRANSPORT_WS;
+  } else {
+    ep->transport = COAP_TRANSPORT_UDP;
+  }
+#endif /* WITH_COAP_TCP */
   if(start >= 0 && end > start &&
      uiplib_ipaddrconv(&text[start], &ep->ipaddr)) {
     if(text[end + 1] == ':' &&
        get_port(text + end + 2, size - end - 2, &port)) {
       ep->port = UIP_HTONS(port);
+#ifdef WITH_COAP_TCP
+    } else if(ep->transport == COAP_TRANSPORT_WS) {
+      /* CoAP over WebSockets uses the HTTP port by default */
+      ep->port = UIP_HTONS(80);
+#endif /* WITH_COAP_TCP */
     } else if(ep->secure) {
       /* Use secure CoAP port by default for secure endpoints. */
       ep->port = SERVER_LISTEN_SECURE_PORT;
@@ -237,6 +264,9 @@ get_src_endpoint(uint8_t secure)
   uip_ipaddr_copy(&src.ipaddr, &UIP_IP_BUF->srcipaddr);
   src.port = UIP_UDP_BUF->srcport;
   src.secure = secure;
+#ifdef WITH_COAP_TCP
+  src.transport = COAP_TRANSPORT_UDP;
+#endif /* WITH_COAP_TCP */
   return &src;
 }
 /*---------------------------------------------------------------------------*/
@@ -247,6 +277,16 @@ coap_endpoint_is_secure(const coap_endpoint_t *ep)
 }
 /*---------------------------------------------------------------------------*/
 int
+coap_endpoint_is_reliable(const coap_endpoint_t *ep)
+{
+#ifdef WITH_COAP_TCP
+  return ep->transport != COAP_TRANSPORT_UDP;
+#else /* WITH_COAP_TCP */
+  return 0;
+#endif /* WITH_COAP_TCP */
+}
+/*---------------------------------------------------------------------------*/
+int
 coap_endpoint_is_connected(const coap_endpoint_t *ep)
 {
 #ifndef CONTIKI_TARGET_NATIVE
@@ -256,6 +296,12 @@ coap_endpoint_is_connected(const coap_endpoint_t *ep)
   }
 #endif
 
+#ifdef WITH_COAP_TCP
+  if(ep != NULL && ep->transport != COAP_TRANSPORT_UDP) {
+    return coap_tcp_is_connected(ep);
+  }
+#endif /* WITH_COAP_TCP */
+
 #ifdef WITH_DTLS
   if(ep != NULL && ep->secure != 0) {
     dtls_peer_t *peer;
@@ -286,6 +332,12 @@ coap_endpoint_is_connected(const coap_endpoint_t *ep)
 int
 coap_endpoint_connect(coap_endpoint_t *ep)
 {
+#ifdef WITH_COAP_TCP
+  if(ep->transport != COAP_TRANSPORT_UDP) {
+    return coap_tcp_connect(ep);
+  }
+#endif /* WITH_COAP_TCP */
+
   if(ep->secure == 0) {
     LOG_DBG("connect to ");
     LOG_DBG_COAP_EP(ep);
@@ -311,6 +363,13 @@ coap_endpoint_connect(coap_endpoint_t *ep)
 void
 coap_endpoint_disconnect(coap_endpoint_t *ep)
 {
+#ifdef WITH_COAP_TCP
+  if(ep && ep->transport != COAP_TRANSPORT_UDP) {
+    coap_tcp_disconnect(ep);
+    return;
+  }
+#endif /* WITH_COAP_TCP */
+
 #ifdef WITH_DTLS
   if(ep && ep->secure && dtls_context) {
     dtls_close(dtls_context, ep);
@@ -336,6 +395,9 @@ coap_transport_init(void)
 #endif /* COAP_DTLS_KEYSTORE_CONF_WITH_SIMPLE */
 
 #endif /* WITH_DTLS */
+#ifdef WITH_COAP_TCP
+  coap_tcp_init();
+#endif /* WITH_COAP_TCP */
 }
 /*---------------------------------------------------------------------------*/
 #ifdef WITH_DTLS
@@ -373,6 +435,13 @@ coap_sendto(const coap_endpoint_t *ep, const uint8_t *data, uint16_t length)
     return -1;
   }
 
+#ifdef WITH_COAP_TCP
+  if(ep->transport != COAP_TRANSPORT_UDP) {
+    /* connects on demand */
+    return coap_tcp_sendto(ep, data, length);
+  }
+#endif /* WITH_COAP_TCP */
+
   if(!coap_endpoint_is_connected(ep)) {
     LOG_WARN("endpoint ");
     LOG_WARN_COAP_EP(ep);
@@ -304,6 +304,15 @@ coap_init_message(coap_message_t *coap_pkt, coap_message_type_t type,
 /*---------------------------------------------------------------------------*/
 size_t
 coap_serialize_message(coap_message_t *coap_pkt, uint8_t *buffer)
+{
+  /* Message buffers are COAP_MAX_PACKET_SIZE + 1 bytes */
+  return coap_serialize_message_bounded(coap_pkt, buffer,
+                                        COAP_MAX_PACKET_SIZE + 1);
+}
+/*---------------------------------------------------------------------------*/
+size_t
+coap_serialize_message_bounded(coap_message_t *coap_pkt, uint8_t *buffer,
+                               size_t size)
 {
   uint8_t *option;
   unsigned int current_number = 0;
@@ -385,19 +394,24 @@ coap_serialize_message(coap_message_t *coap_pkt, uint8_t *buffer)
   LOG_DBG("-Done serializing at %p----\n", option);
 
   /* Pack payload */
-  if((option - coap_pkt->buffer) <= COAP_MAX_HEADER_SIZE) {
-    /* Payload marker */
-    if(coap_pkt->payload_len) {
-      *option = 0xFF;
-      ++option;
-    }
-    memmove(option, coap_pkt->payload, coap_pkt->payload_len);
-  } else {
+  if((option - coap_pkt->buffer) > COAP_MAX_HEADER_SIZE) {
     /* an error occurred: caller must check for !=0 */
     coap_pkt->buffer = NULL;
     coap_error_message = "Serialized header exceeds COAP_MAX_HEADER_SIZE";
     return 0;
   }
+  if((option - coap_pkt->buffer) + (coap_pkt->payload_len ? 1 : 0)
+     + coap_pkt->payload_len > size) {
+    coap_pkt->buffer = NULL;
+    coap_error_message = "Serialized message exceeds the buffer";
+    return 0;
+  }
+  /* Payload marker */
+  if(coap_pkt->payload_len) {
+    *option = 0xFF;
+    ++option;
+  }
+  memmove(option, coap_pkt->payload, coap_pkt->payload_len);
 
   LOG_DBG("-Done %u B (header len %u, payload len %u)-\n",
           (unsigned int)(coap_pkt->payload_len + option - buffer),
@@ -420,6 +434,7 @@ coap_parse_message(coap_message_t *coap_pkt, uint8_t *data, uint16_t data_len)
 
   /* pointer to message bytes */
   coap_pkt->buffer = data;
+  coap_pkt->buffer_len = data_len;
 
   /* parse header fields */
   coap_pkt->version = (COAP_HEADER_VERSION_MASK & coap_pkt->buffer[0])
@@ -441,6 +456,11 @@ coap_parse_message(coap_message_t *coap_pkt, uint8_t *data, uint16_t data_len)
     return BAD_REQUEST_4_00;
   }
 
+  if(data_len < COAP_HEADER_LEN + coap_pkt->token_len) {
+    coap_error_message = "Message too short";
+    return BAD_REQUEST_4_00;
+  }
+
   uint8_t *current_option = data + COAP_HEADER_LEN;
 
   memcpy(coap_pkt->token, current_option, coap_pkt->token_len);
@@ -451,63 +471,17 @@ coap_parse_message(coap_message_t *coap_pkt, uint8_t *data, uint16_t data_len)
           );                     /* FIXME always prints 8 bytes */
 
   /* parse options */
-  memset(coap_pkt->options, 0, sizeof(coap_pkt->options));
-  current_option += coap_pkt->token_len;
-
-  unsigned int option_number = 0;
-  unsigned int option_delta = 0;
-  size_t option_length = 0;
-
-  while(current_option < data + data_len) {
-    /* payload marker 0xFF, currently only checking for 0xF* because rest is reserved */
-    if((current_option[0] & 0xF0) == 0xF0) {
-      coap_pkt->payload = ++current_option;
-      coap_pkt->payload_len = data_len - (coap_pkt->payload - data);
-
-      /* also for receiving, the Erbium upper bound is COAP_MAX_CHUNK_SIZE */
-      if(coap_pkt->payload_len > COAP_MAX_CHUNK_SIZE) {
-        coap_pkt->payload_len = COAP_MAX_CHUNK_SIZE;
-        /* null-terminate payload */
-      }
-      coap_pkt->payload[coap_pkt->payload_len] = '\0';
-
-      break;
-    }
-
-    option_delta = current_option[0] >> 4;
-    option_length = current_option[0] & 0x0F;
-    ++current_option;
-
-    if(option_delta == 13) {
-      option_delta += current_option[0];
-      ++current_option;
-    } else if(option_delta == 14) {
-      option_delta += 255;
-      option_delta += current_option[0] << 8;
-      ++current_option;
-      option_delta += current_option[0];
-      ++current_option;
-    }
-
-    if(option_length == 13) {
-      option_length += current_option[0];
-      ++current_option;
-    } else if(option_length == 14) {
-      option_length += 255;
-      option_length += current_option[0] << 8;
-      ++current_option;
-      option_length += current_option[0];
-      ++current_option;
-    }
-
-    if(current_option + option_length > data + data_len) {
-      /* Malformed CoAP - out of bounds */
-      LOG_WARN("BAD REQUEST: options outside data message: %u > %u\n",
-               (unsigned)(current_option + option_length - data), data_len);
-      return BAD_REQUEST_4_00;
-    }
-
-    option_number += option_delta;
+  coap_option_iterator_t it;
+  coap_raw_option_t option;
+  unsigned int option_number;
+  size_t option_length;
+  int ret;
+
+  coap_option_iterator_init(&it, data, data_len);
+  while((ret = coap_option_next(&it, &option)) > 0) {
+    current_option = (uint8_t *)option.value;
+    option_number = option.number;
+    option_length = option.len;
 
     if(option_number > COAP_OPTION_SIZE1) {
       /* Malformed CoAP - out of bounds */
@@ -515,8 +489,7 @@ coap_parse_message(coap_message_t *coap_pkt, uint8_t *data, uint16_t data_len)
       return BAD_REQUEST_4_00;
     }
 
-    LOG_DBG("OPTION %u (delta %u, len %zu): ", option_number, option_delta,
-            option_length);
+    LOG_DBG("OPTION %u (len %zu): ", option_number, option_length);
 
     coap_set_option(coap_pkt, option_number);
 
@@ -565,25 +538,28 @@ coap_parse_message(coap_message_t *coap_pkt, uint8_t *data, uint16_t data_len)
 #if COAP_PROXY_OPTION_PROCESSING
       coap_pkt->proxy_uri = (char *)current_option;
       coap_pkt->proxy_uri_len = option_length;
-#endif /* COAP_PROXY_OPTION_PROCESSING */
-      LOG_DBG_("Proxy-Uri NOT IMPLEMENTED [");
+      LOG_DBG_("Proxy-Uri [");
       LOG_DBG_COAP_STRING(coap_pkt->proxy_uri, coap_pkt->proxy_uri_len);
       LOG_DBG_("]\n");
-
+      break;
+#else /* COAP_PROXY_OPTION_PROCESSING */
+      LOG_DBG_("Proxy-Uri NOT IMPLEMENTED\n");
       coap_error_message = "This is a constrained server (Contiki)";
       return PROXYING_NOT_SUPPORTED_5_05;
-      break;
+#endif /* COAP_PROXY_OPTION_PROCESSING */
     case COAP_OPTION_PROXY_SCHEME:
 #if COAP_PROXY_OPTION_PROCESSING
       coap_pkt->proxy_scheme = (char *)current_option;
       coap_pkt->proxy_scheme_len = option_length;
-#endif
-      LOG_DBG_("Proxy-Scheme NOT IMPLEMENTED [");
+      LOG_DBG_("Proxy-Scheme [");
       LOG_DBG_COAP_STRING(coap_pkt->proxy_scheme, coap_pkt->proxy_scheme_len);
       LOG_DBG_("]\n");
+      break;
+#else /* COAP_PROXY_OPTION_PROCESSING */
+      LOG_DBG_("Proxy-Scheme NOT IMPLEMENTED\n");
       coap_error_message = "This is a constrained server (Contiki)";
       return PROXYING_NOT_SUPPORTED_5_05;
-      break;
+#endif /* COAP_PROXY_OPTION_PROCESSING */
 
     case COAP_OPTION_URI_HOST:
       coap_pkt->uri_host = (char *)current_option;
@@ -682,13 +658,274 @@ coap_parse_message(coap_message_t *coap_pkt, uint8_t *data, uint16_t data_len)
       }
     }
 
-    current_option += option_length;
-  }                             /* for */
+  }                             /* while */
+
+  if(ret < 0) {
+    /* Malformed CoAP - out of bounds */
+    LOG_WARN("BAD REQUEST: options outside data message\n");
+    return BAD_REQUEST_4_00;
+  }
+
+  /* payload marker 0xFF, currently only checking for 0xF* because rest is reserved */
+  if(it.pos < it.end) {
+    coap_pkt->payload = (uint8_t *)it.pos + 1;
+    coap_pkt->payload_len = data_len - (coap_pkt->payload - data);
+
+    /* also for receiving, the Erbium upper bound is COAP_MAX_PAYLOAD_SIZE.
+       coap_receive() further cuts datagrams to COAP_MAX_CHUNK_SIZE. */
+    if(coap_pkt->payload_len > COAP_MAX_PAYLOAD_SIZE) {
+      coap_pkt->payload_len = COAP_MAX_PAYLOAD_SIZE;
+      /* null-terminate payload */
+    }
+    coap_pkt->payload[coap_pkt->payload_len] = '\0';
+  }
   LOG_DBG("-Done parsing-------\n");
 
   return NO_ERROR;
 }
 /*---------------------------------------------------------------------------*/
+/*- Option iterator ---------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+int
+coap_option_iterator_init(coap_option_iterator_t *it, const uint8_t *data,
+                          uint16_t data_len)
+{
+  unsigned int token_len;
+
+  it->number = 0;
+  it->end = data + data_len;
+  if(data_len < COAP_HEADER_LEN) {
+    it->pos = it->end;
+    return 0;
+  }
+  token_len = (COAP_HEADER_TOKEN_LEN_MASK & data[0])
+    >> COAP_HEADER_TOKEN_LEN_POSITION;
+  if(token_len > COAP_TOKEN_LEN || COAP_HEADER_LEN + token_len > data_len) {
+    it->pos = it->end;
+    return 0;
+  }
+  it->pos = data + COAP_HEADER_LEN + token_len;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_option_next(coap_option_iterator_t *it, coap_raw_option_t *option)
+{
+  const uint8_t *p = it->pos;
+  unsigned int delta;
+  unsigned int length;
+
+  /* payload marker 0xFF, currently only checking for 0xF* because rest is reserved */
+  if(p >= it->end || (p[0] & 0xF0) == 0xF0) {
+    return 0;
+  }
+
+  delta = p[0] >> 4;
+  length = p[0] & 0x0F;
+  ++p;
+
+  if(delta == 13) {
+    if(p + 1 > it->end) {
+      return -1;
+    }
+    delta += p[0];
+    ++p;
+  } else if(delta == 14) {
+    if(p + 2 > it->end) {
+      return -1;
+    }
+    delta = 269 + (p[0] << 8) + p[1];
+    p += 2;
+  }
+
+  if(length == 13) {
+    if(p + 1 > it->end) {
+      return -1;
+    }
+    length += p[0];
+    ++p;
+  } else if(length == 14) {
+    if(p + 2 > it->end) {
+      return -1;
+    }
+    length = 269 + (p[0] << 8) + p[1];
+    p += 2;
+  } else if(length == 15) {
+    return -1;
+  }
+
+  if(length > it->end - p || it->number + delta > 0xFFFF) {
+    return -1;
+  }
+
+  it->number += delta;
+  option->number = it->number;
+  option->len = length;
+  option->value = p;
+  it->pos = p + length;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_option_find(coap_option_iterator_t *it, unsigned int number,
+                 coap_raw_option_t *option)
+{
+  const uint8_t *pos;
+  unsigned int current;
+  int ret;
+
+  while(it->number <= number) {
+    pos = it->pos;
+    current = it->number;
+    ret = coap_option_next(it, option);
+    if(ret <= 0) {
+      return ret;
+    }
+    if(option->number == number) {
+      return 1;
+    }
+    if(option->number > number) {
+      /* Options are sorted: step back so that the option can be found */
+      it->pos = pos;
+      it->number = current;
+      break;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+coap_option_get_int(const coap_raw_option_t *option)
+{
+  return coap_parse_int_option((uint8_t *)option->value, option->len);
+}
+/*---------------------------------------------------------------------------*/
+/*- One-pass writer ---------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+void
+coap_writer_init(coap_writer_t *w, uint8_t *buffer, uint16_t size,
+                 coap_message_type_t type, uint8_t code, uint16_t mid,
+                 const uint8_t *token, uint8_t token_len)
+{
+  w->buffer = buffer;
+  w->size = size;
+  w->number = 0;
+  w->error = 0;
+
+  if(token_len > COAP_TOKEN_LEN || size < COAP_HEADER_LEN + token_len) {
+    w->len = 0;
+    w->error = 1;
+    return;
+  }
+
+  buffer[0] = COAP_HEADER_VERSION_MASK & 1 << COAP_HEADER_VERSION_POSITION;
+  buffer[0] |= COAP_HEADER_TYPE_MASK & type << COAP_HEADER_TYPE_POSITION;
+  buffer[0] |= COAP_HEADER_TOKEN_LEN_MASK
+    & token_len << COAP_HEADER_TOKEN_LEN_POSITION;
+  buffer[1] = code;
+  buffer[2] = (uint8_t)(mid >> 8);
+  buffer[3] = (uint8_t)mid;
+  memcpy(buffer + COAP_HEADER_LEN, token, token_len);
+  w->len = COAP_HEADER_LEN + token_len;
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+option_header_len(unsigned int delta, size_t length)
+{
+  return 1 + (delta > 268 ? 2 : (delta > 12 ? 1 : 0))
+    + (length > 268 ? 2 : (length > 12 ? 1 : 0));
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_writer_add_option(coap_writer_t *w, unsigned int number,
+                       const void *value, size_t len)
+{
+  unsigned int delta;
+
+  if(w->error || number < w->number) {
+    w->error = 1;
+    return 0;
+  }
+  delta = number - w->number;
+  if(option_header_len(delta, len) + len > w->size - w->len) {
+    w->error = 1;
+    return 0;
+  }
+
+  w->len += coap_set_option_header(delta, len, w->buffer + w->len);
+  memcpy(w->buffer + w->len, value, len);
+  w->len += len;
+  w->number = number;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_writer_add_int_option(coap_writer_t *w, unsigned int number,
+                           uint32_t value)
+{
+  uint8_t bytes[4];
+  size_t len = 0;
+  int i;
+
+  /* shortest form, zero is encoded as an empty option */
+  for(i = 3; i >= 0; i--) {
+    if(len > 0 || (value >> (8 * i)) != 0) {
+      bytes[len++] = (uint8_t)(value >> (8 * i));
+    }
+  }
+  return coap_writer_add_option(w, number, bytes, len);
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_writer_add_string_option(coap_writer_t *w, unsigned int number,
+                              const char *str, size_t len, char separator)
+{
+  const char *end = str + len;
+  const char *part;
+
+  do {
+    part = memchr(str, separator, end - str);
+    if(part == NULL) {
+      part = end;
+    }
+    if(!coap_writer_add_option(w, number, str, part - str)) {
+      return 0;
+    }
+    str = part + 1;
+  } while(part < end);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t *
+coap_writer_payload(coap_writer_t *w, uint16_t *size)
+{
+  *size = w->error || w->len + 1 > w->size ? 0 : w->size - w->len - 1;
+  return w->buffer + w->len + 1;
+}
+/*---------------------------------------------------------------------------*/
+size_t
+coap_writer_finish(coap_writer_t *w, const void *payload,
+                   uint16_t payload_len)
+{
+  uint8_t *dst = w->buffer + w->len + 1;
+
+  if(w->error) {
+    return 0;
+  }
+  if(payload_len > 0) {
+    if(w->len + 1 + payload_len > w->size) {
+      w->error = 1;
+      return 0;
+    }
+    w->buffer[w->len] = 0xFF;
+    if(payload != dst) {
+      memmove(dst, payload, payload_len);
+    }
+    w->len += 1 + payload_len;
+  }
+  return w->len;
+}
+/*---------------------------------------------------------------------------*/
 /*- CoAP Engine API ---------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 int
@@ -1125,7 +1362,7 @@ int
 coap_set_payload(coap_message_t *coap_pkt, const void *payload, size_t length)
 {
   coap_pkt->payload = (uint8_t *)payload;
-  coap_pkt->payload_len = MIN(COAP_MAX_CHUNK_SIZE, length);
+  coap_pkt->payload_len = MIN(COAP_MAX_PAYLOAD_SIZE, length);
 
   return coap_pkt->payload_len;
 }
@@ -59,6 +59,13 @@
  */
 #define COAP_MAX_PACKET_SIZE  (COAP_MAX_HEADER_SIZE + COAP_MAX_CHUNK_SIZE)
 
+/* Largest payload of a single message; only reliable transports exceed COAP_MAX_CHUNK_SIZE */
+#if defined(WITH_COAP_TCP) && COAP_TCP_MAX_MESSAGE_SIZE > COAP_MAX_PACKET_SIZE
+#define COAP_MAX_PAYLOAD_SIZE (COAP_TCP_MAX_MESSAGE_SIZE - COAP_MAX_HEADER_SIZE)
+#else
+#define COAP_MAX_PAYLOAD_SIZE COAP_MAX_CHUNK_SIZE
+#endif
+
 /* COAP_MAX_CHUNK_SIZE can be different from 2^x so we need to get next lower 2^x for COAP_MAX_BLOCK_SIZE */
 #ifndef COAP_MAX_BLOCK_SIZE
 #define COAP_MAX_BLOCK_SIZE           (COAP_MAX_CHUNK_SIZE < 32 ? 16 : \
@@ -76,6 +83,7 @@
 /* parsed message struct */
 typedef struct {
   uint8_t *buffer; /* pointer to CoAP header / incoming message buffer / memory to serialize message */
+  uint16_t buffer_len; /* length of a parsed message */
 
   uint8_t version;
   coap_message_type_t type;
@@ -186,6 +194,29 @@ coap_is_option(const coap_message_t *message, unsigned int opt)
     current_number = number; \
   }
 
+/* A single option as located by the option iterator, not decoded */
+typedef struct {
+  uint16_t number;
+  uint16_t len;
+  const uint8_t *value;
+} coap_raw_option_t;
+
+/* Lazy iterator over the options of a serialized message */
+typedef struct {
+  const uint8_t *pos;
+  const uint8_t *end;
+  unsigned int number;
+} coap_option_iterator_t;
+
+/* One-pass serializer, options must be added in ascending order */
+typedef struct {
+  uint8_t *buffer;
+  uint16_t size;
+  uint16_t len;
+  unsigned int number;
+  uint8_t error;
+} coap_writer_t;
+
 /* to store error code and human-readable payload */
 extern coap_status_t coap_status_code;
 extern const char *coap_error_message;
@@ -196,9 +227,103 @@ uint16_t coap_get_mid(void);
 void coap_init_message(coap_message_t *message, coap_message_type_t type,
                        uint8_t code, uint16_t mid);
 size_t coap_serialize_message(coap_message_t *message, uint8_t *buffer);
+/* Serializes into a buffer of size bytes, 0 if the message does not fit.
+   coap_serialize_message() assumes COAP_MAX_PACKET_SIZE + 1 bytes. */
+size_t coap_serialize_message_bounded(coap_message_t *message,
+                                      uint8_t *buffer, size_t size);
 coap_status_t coap_parse_message(coap_message_t *request, uint8_t *data,
                                  uint16_t data_len);
 
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Starts iterating over the options of a serialized message.
+ * \param it   The iterator
+ * \param data The message, starting with the CoAP header
+ * \param data_len The length of the message
+ * \return     1 if the header is valid, 0 otherwise
+ *
+ * No option is decoded until asked for, and the message is not modified.
+ */
+int coap_option_iterator_init(coap_option_iterator_t *it, const uint8_t *data,
+                              uint16_t data_len);
+
+/**
+ * \brief      Starts iterating over the options of a parsed message.
+ */
+static inline int
+coap_option_iterator_init_message(coap_option_iterator_t *it,
+                                  const coap_message_t *message)
+{
+  return coap_option_iterator_init(it, message->buffer, message->buffer_len);
+}
+
+/**
+ * \brief      Locates the next option.
+ * \return     1 if an option was found, 0 at the end of the options and
+ *             -1 if the message is malformed
+ */
+int coap_option_next(coap_option_iterator_t *it, coap_raw_option_t *option);
+
+/**
+ * \brief      Skips to the next option with the given number. Repeated
+ *             options such as Uri-Path are returned one by one.
+ * \return     1 if found, 0 if not and -1 if the message is malformed
+ */
+int coap_option_find(coap_option_iterator_t *it, unsigned int number,
+                     coap_raw_option_t *option);
+
+/**
+ * \brief      Decodes the value of an unsigned integer option.
+ */
+uint32_t coap_option_get_int(const coap_raw_option_t *option);
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Starts writing a message into a buffer, in a single pass.
+ *
+ * The header and token are written right away; options follow in
+ * ascending order of their number, then the payload. Writing directly
+ * into coap_databuf() lets coap_sendto() send the message without a copy.
+ */
+void coap_writer_init(coap_writer_t *w, uint8_t *buffer, uint16_t size,
+                      coap_message_type_t type, uint8_t code, uint16_t mid,
+                      const uint8_t *token, uint8_t token_len);
+
+/**
+ * \brief      Appends an option with an opaque or string value.
+ * \return     1 on success, 0 if it does not fit or is out of order
+ */
+int coap_writer_add_option(coap_writer_t *w, unsigned int number,
+                           const void *value, size_t len);
+
+/**
+ * \brief      Appends an unsigned integer option in its shortest form.
+ */
+int coap_writer_add_int_option(coap_writer_t *w, unsigned int number,
+                               uint32_t value);
+
+/**
+ * \brief      Appends a string split into repeated options, e.g. a path
+ *             split on '/' into Uri-Path options.
+ */
+int coap_writer_add_string_option(coap_writer_t *w, unsigned int number,
+                                  const char *str, size_t len, char separator);
+
+/**
+ * \brief      Returns where the payload goes, so that it can be rendered
+ *             in place.
+ * \param size Set to the room left for the payload
+ */
+uint8_t *coap_writer_payload(coap_writer_t *w, uint16_t *size);
+
+/**
+ * \brief      Appends the payload and completes the message. A payload
+ *             already rendered at coap_writer_payload() is not copied.
+ * \return     The length of the message, or 0 if anything did not fit
+ */
+size_t coap_writer_finish(coap_writer_t *w, const void *payload,
+                          uint16_t payload_len);
+/*---------------------------------------------------------------------------*/
+
 int coap_get_query_variable(coap_message_t *message, const char *name,
                             const char **output);
 int coap_get_post_variable(coap_message_t *message, const char *name,
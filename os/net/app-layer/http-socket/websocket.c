@@ -99,20 +99,40 @@ parse_url(const char *url, char *host, uint16_t *portptr, char *path)
   }
 
   /* Find host part of the URL. */
-  for(i = 0; i < MAX_HOSTLEN; ++i) {
-    if(*urlptr == 0 ||
-       *urlptr == '/' ||
-       *urlptr == ' ' ||
-       *urlptr == ':') {
+  if(*urlptr == '[') {
+    /* Handle IPv6 addresses - scan for matching ']' */
+    urlptr++;
+    for(i = 0; i < MAX_HOSTLEN; ++i) {
+      if(*urlptr == 0 || *urlptr == ']') {
+        if(host != NULL) {
+          host[i] = 0;
+        }
+        if(*urlptr == ']') {
+          urlptr++;
+        }
+        break;
+      }
       if(host != NULL) {
-	host[i] = 0;
+        host[i] = *urlptr;
       }
-      break;
+      ++urlptr;
     }
-    if(host != NULL) {
-      host[i] = *urlptr;
+  } else {
+    for(i = 0; i < MAX_HOSTLEN; ++i) {
+      if(*urlptr == 0 ||
+         *urlptr == '/' ||
+         *urlptr == ' ' ||
+         *urlptr == ':') {
+        if(host != NULL) {
+          host[i] = 0;
+        }
+        break;
+      }
+      if(host != NULL) {
+        host[i] = *urlptr;
+      }
+      ++urlptr;
     }
-    ++urlptr;
   }
 
   /* Find the port. Default is 0, which lets the underlying transport
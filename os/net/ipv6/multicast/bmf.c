@@ -0,0 +1,577 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup bmf-multicast
+ * @{
+ */
+/**
+ * \file
+ *    This file implements 'Bloom-filter Multicast Forwarding' (BMF)
+ *
+ *    The root keeps the group memberships advertised in non-storing DAOs.
+ *    For every datagram it sends to a group, it adds the interface
+ *    identifiers of the routers between itself and the group's members to
+ *    a Bloom filter and carries the filter in a hop-by-hop option. Routers
+ *    forward a datagram from their preferred parent if the filter contains
+ *    their own interface identifier.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "net/ipv6/uip-sr.h"
+#include "net/ipv6/multicast/uip-mcast6.h"
+#include "net/ipv6/multicast/uip-mcast6-stats.h"
+#include "net/ipv6/multicast/bmf.h"
+#include "net/routing/routing.h"
+#include "net/routing/rpl-classic/rpl.h"
+#include "net/packetbuf.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+#include "lib/random.h"
+#include <string.h>
+
+#include "sys/log.h"
+#define LOG_MODULE "BMF"
+#define LOG_LEVEL LOG_LEVEL_NONE
+
+#if !ROUTING_CONF_RPL_CLASSIC
+#error "BMF needs the group memberships from RPL classic non-storing DAOs"
+#endif
+/*---------------------------------------------------------------------------*/
+/* Macros */
+/*---------------------------------------------------------------------------*/
+/* CCI */
+#define BMF_FWD_DELAY()  (CLOCK_SECOND / 8)
+/* Number of slots in the next 500ms */
+#define BMF_INTERVAL_COUNT  ((CLOCK_SECOND >> 2) / fwd_delay)
+
+#define BMF_FILTER_MIN        8
+#define BMF_HASHES_MAX        8
+#define BMF_INFINITE_LIFETIME 0
+
+/* Members are found in the source routing graph through a small filter */
+#define MEMBER_FILTER_LEN     32
+#define MEMBER_FILTER_HASHES  2
+
+/* Hop-by-hop header, option, filter, then a 3-byte PadN */
+#define HBHO_TOTAL_LEN(l)     ((l) + 8)
+
+#define UIP_EXT_BUF           ((struct uip_ext_hdr *)UIP_IP_PAYLOAD(0))
+#define UIP_EXT_OPT_FIRST     ((uint8_t *)UIP_IP_PAYLOAD(0) + 2)
+/*---------------------------------------------------------------------------*/
+/* Internal Data Structures */
+/*---------------------------------------------------------------------------*/
+/* A group membership, as learnt by the root */
+struct bmf_member {
+  struct bmf_member *next;
+  uip_ipaddr_t group;
+  uint8_t iid[8];
+  unsigned long expires;
+};
+/*---------------------------------------------------------------------------*/
+/* Internal Data */
+/*---------------------------------------------------------------------------*/
+MEMB(member_memb, struct bmf_member, BMF_MEMBERS_NUM);
+LIST(member_list);
+
+static uint8_t member_filter[MEMBER_FILTER_LEN];
+static uint8_t scratch_filter[BMF_FILTER_MAX];
+static rpl_dag_t *walk_dag;
+static uip_sr_node_t *walk_root;
+
+static struct ctimer mcast_periodic;
+static uint16_t mcast_len;
+static uip_buf_t mcast_buf;
+static uint8_t fwd_delay;
+static uint8_t fwd_spread;
+/*---------------------------------------------------------------------------*/
+/* Bloom filters */
+/*---------------------------------------------------------------------------*/
+/*
+ * All positions derive from one 32-bit FNV-1a hash of the interface
+ * identifier (Kirsch and Mitzenmacher double hashing). Filters are a power
+ * of two bits long.
+ */
+static uint32_t
+iid_hash(const uint8_t *iid)
+{
+  uint32_t h = 2166136261UL;
+  int i;
+
+  for(i = 0; i < 8; i++) {
+    h = (h ^ iid[i]) * 16777619UL;
+  }
+  return h;
+}
+/*---------------------------------------------------------------------------*/
+/* Set the bits for iid, return 1 if they were all set already */
+static int
+filter_add(uint8_t *filter, uint16_t bits, uint8_t k, const uint8_t *iid)
+{
+  uint32_t h = iid_hash(iid);
+  uint16_t h1 = h & 0xFFFF;
+  uint16_t h2 = (h >> 16) | 1;
+  uint16_t pos;
+  int seen = 1;
+
+  while(k--) {
+    pos = h1 & (bits - 1);
+    if(!(filter[pos >> 3] & (1 << (pos & 7)))) {
+      filter[pos >> 3] |= 1 << (pos & 7);
+      seen = 0;
+    }
+    h1 += h2;
+  }
+  return seen;
+}
+/*---------------------------------------------------------------------------*/
+static int
+filter_test(const uint8_t *filter, uint16_t bits, uint8_t k, const uint8_t *iid)
+{
+  uint32_t h = iid_hash(iid);
+  uint16_t h1 = h & 0xFFFF;
+  uint16_t h2 = (h >> 16) | 1;
+  uint16_t pos;
+
+  while(k--) {
+    pos = h1 & (bits - 1);
+    if(!(filter[pos >> 3] & (1 << (pos & 7)))) {
+      return 0;
+    }
+    h1 += h2;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Group memberships */
+/*---------------------------------------------------------------------------*/
+static int
+member_expired(const struct bmf_member *m)
+{
+  return m->expires != BMF_INFINITE_LIFETIME && m->expires <= clock_seconds();
+}
+/*---------------------------------------------------------------------------*/
+static void
+member_purge(void)
+{
+  struct bmf_member *m;
+  struct bmf_member *next;
+
+  for(m = list_head(member_list); m != NULL; m = next) {
+    next = list_item_next(m);
+    if(member_expired(m)) {
+      list_remove(member_list, m);
+      memb_free(&member_memb, m);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+bmf_member_update(const uip_ipaddr_t *group, const uip_ipaddr_t *member,
+                  uint32_t lifetime)
+{
+  struct bmf_member *m;
+
+  for(m = list_head(member_list); m != NULL; m = list_item_next(m)) {
+    if(uip_ipaddr_cmp(&m->group, group) &&
+       memcmp(m->iid, &member->u8[8], sizeof(m->iid)) == 0) {
+      break;
+    }
+  }
+
+  if(lifetime == 0) {
+    if(m != NULL) {
+      list_remove(member_list, m);
+      memb_free(&member_memb, m);
+    }
+    return 1;
+  }
+
+  if(m == NULL) {
+    m = memb_alloc(&member_memb);
+    if(m == NULL) {
+      member_purge();
+      m = memb_alloc(&member_memb);
+      if(m == NULL) {
+        LOG_ERR("No space for a membership of ");
+        LOG_ERR_6ADDR(member);
+        LOG_ERR_("\n");
+        return 0;
+      }
+    }
+    uip_ipaddr_copy(&m->group, group);
+    memcpy(m->iid, &member->u8[8], sizeof(m->iid));
+    list_add(member_list, m);
+  }
+
+  if(lifetime >= 0xFFFFFFFF - clock_seconds()) {
+    m->expires = BMF_INFINITE_LIFETIME;
+  } else {
+    m->expires = clock_seconds() + lifetime;
+  }
+
+  LOG_INFO("Member ");
+  LOG_INFO_6ADDR(member);
+  LOG_INFO_(" of ");
+  LOG_INFO_6ADDR(group);
+  LOG_INFO_(", lifetime %lu\n", (unsigned long)lifetime);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Filter construction at the root */
+/*---------------------------------------------------------------------------*/
+static int
+is_member(const uip_ipaddr_t *group, const uint8_t *iid)
+{
+  struct bmf_member *m;
+
+  for(m = list_head(member_list); m != NULL; m = list_item_next(m)) {
+    if(memcmp(m->iid, iid, sizeof(m->iid)) == 0 &&
+       uip_ipaddr_cmp(&m->group, group)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Add the routers between the root and every member of the group to the
+ * filter and return how many of them were not in it yet. With 'dedup' set,
+ * a walk stops at the first router that is already in the filter, since
+ * the routers above it are as well. This is only good enough to count
+ * forwarders: a false positive would cut the walk short.
+ */
+static uint16_t
+members_walk(const uip_ipaddr_t *group, uint8_t *filter, uint16_t bits,
+             uint8_t k, int dedup)
+{
+  uip_sr_node_t *node;
+  uip_sr_node_t *p;
+  uint16_t added = 0;
+  int depth;
+
+  for(node = uip_sr_node_head(); node != NULL; node = uip_sr_node_next(node)) {
+    if(node->graph != walk_dag || node == walk_root ||
+       !filter_test(member_filter, MEMBER_FILTER_LEN * 8, MEMBER_FILTER_HASHES,
+                    node->link_identifier) ||
+       !is_member(group, node->link_identifier)) {
+      continue;
+    }
+    for(p = node->parent, depth = 0; p != NULL && p != walk_root &&
+        depth < UIP_SR_LINK_NUM; p = p->parent, depth++) {
+      if(!filter_add(filter, bits, k, p->link_identifier)) {
+        added++;
+      } else if(dedup) {
+        break;
+      }
+    }
+  }
+  return added;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Size the filter for the datagram's group: return its length in bytes and
+ * the number of hashes, or 0 if the group has no members
+ */
+static uint8_t
+filter_size(uint8_t *k)
+{
+  struct bmf_member *m;
+  uint16_t members = 0;
+  uint16_t forwarders;
+  uint8_t len;
+
+  walk_dag = rpl_get_any_dag();
+  if(walk_dag == NULL) {
+    return 0;
+  }
+  walk_root = uip_sr_get_node(walk_dag, &walk_dag->dag_id);
+
+  member_purge();
+  memset(member_filter, 0, sizeof(member_filter));
+  for(m = list_head(member_list); m != NULL; m = list_item_next(m)) {
+    if(uip_ipaddr_cmp(&m->group, &UIP_IP_BUF->destipaddr)) {
+      filter_add(member_filter, MEMBER_FILTER_LEN * 8, MEMBER_FILTER_HASHES,
+                 m->iid);
+      members++;
+    }
+  }
+  if(members == 0) {
+    return 0;
+  }
+
+  memset(scratch_filter, 0, sizeof(scratch_filter));
+  forwarders = members_walk(&UIP_IP_BUF->destipaddr, scratch_filter,
+                            BMF_FILTER_MAX * 8, 2, 1);
+
+  len = BMF_FILTER_MIN;
+  while(len < BMF_FILTER_MAX &&
+        (uint32_t)len * 8 < (uint32_t)forwarders * BMF_BITS_PER_FORWARDER) {
+    len <<= 1;
+  }
+
+  /* k = ln 2 * bits per forwarder minimises false positives */
+  *k = forwarders == 0 ? 1 : ((uint32_t)len * 8 * 69) / (forwarders * 100UL);
+  if(*k < 1) {
+    *k = 1;
+  } else if(*k > BMF_HASHES_MAX) {
+    *k = BMF_HASHES_MAX;
+  }
+
+  LOG_INFO("%u members, %u forwarders, %u-byte filter, k=%u\n",
+           members, forwarders, len, *k);
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+/* Return the BMF option of the datagram in uip_buf, or NULL */
+static const uint8_t *
+option_find(uint8_t *len)
+{
+  const uint8_t *opt;
+  uint16_t hdr_len;
+
+  if(UIP_IP_BUF->proto != UIP_PROTO_HBHO) {
+    return NULL;
+  }
+  opt = UIP_EXT_OPT_FIRST;
+  hdr_len = (UIP_EXT_BUF->len + 1) * 8;
+  if(opt[0] != HBHO_OPT_TYPE_BMF || opt[1] < 1 + BMF_FILTER_MIN ||
+     2 + 2 + opt[1] > hdr_len || uip_len < UIP_IPH_LEN + hdr_len) {
+    return NULL;
+  }
+  *len = opt[1] - 1;
+  /* The filter length must be a power of two and k within limits */
+  if((*len & (*len - 1)) != 0 || opt[2] < 1 || opt[2] > BMF_HASHES_MAX) {
+    return NULL;
+  }
+  return opt;
+}
+/*---------------------------------------------------------------------------*/
+int
+bmf_filter_match(const uip_ipaddr_t *addr)
+{
+  const uint8_t *opt;
+  uint8_t len;
+
+  opt = option_find(&len);
+  if(opt == NULL) {
+    return 0;
+  }
+  return filter_test(opt + BMF_OPT_HDR_LEN, len * 8, opt[2], &addr->u8[8]);
+}
+/*---------------------------------------------------------------------------*/
+static void
+mcast_fwd(void *p)
+{
+  memcpy(uip_buf, &mcast_buf, mcast_len);
+  uip_len = mcast_len;
+  UIP_IP_BUF->ttl--;
+  tcpip_output(NULL);
+  uipbuf_clear();
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+in()
+{
+  rpl_dag_t *d;                 /* Our DODAG */
+  uip_ipaddr_t *parent_ipaddr;  /* Our pref. parent's IPv6 address */
+  const uip_lladdr_t *parent_lladdr;  /* Our pref. parent's LL address */
+  uip_ds6_addr_t *own;
+
+  d = rpl_get_any_dag();
+  if(!d) {
+    LOG_WARN("No DODAG\n");
+    UIP_MCAST6_STATS_ADD(mcast_dropped);
+    return UIP_MCAST6_DROP;
+  }
+
+  /* Retrieve our preferred parent's LL address */
+  parent_ipaddr = rpl_parent_get_ipaddr(d->preferred_parent);
+  parent_lladdr = uip_ds6_nbr_lladdr_from_ipaddr(parent_ipaddr);
+
+  if(parent_lladdr == NULL) {
+    LOG_WARN("No Parent found\n");
+    UIP_MCAST6_STATS_ADD(mcast_dropped);
+    return UIP_MCAST6_DROP;
+  }
+
+  /*
+   * We accept a datagram if it arrived from our preferred parent, discard
+   * otherwise.
+   */
+  if(memcmp(parent_lladdr, packetbuf_addr(PACKETBUF_ADDR_SENDER),
+            UIP_LLADDR_LEN)) {
+    LOG_DBG("Routable in but BMF ignored it\n");
+    UIP_MCAST6_STATS_ADD(mcast_dropped);
+    return UIP_MCAST6_DROP;
+  }
+
+  if(UIP_IP_BUF->ttl <= 1) {
+    UIP_MCAST6_STATS_ADD(mcast_dropped);
+    LOG_DBG("TTL too low\n");
+    return UIP_MCAST6_DROP;
+  }
+
+  UIP_MCAST6_STATS_ADD(mcast_in_all);
+  UIP_MCAST6_STATS_ADD(mcast_in_unique);
+
+  /* Forward if the root listed us on the way to a member */
+  own = uip_ds6_get_global(ADDR_PREFERRED);
+  if(own != NULL && bmf_filter_match(&own->ipaddr)) {
+    UIP_MCAST6_STATS_ADD(mcast_fwd);
+
+    /*
+     * Add a delay (D) of at least BMF_FWD_DELAY() to compensate for how
+     * contikimac handles broadcasts. We can't start our TX before the sender
+     * has finished its own.
+     */
+    fwd_delay = BMF_FWD_DELAY();
+
+    /* Finalise D: D = min(BMF_FWD_DELAY(), BMF_MIN_FWD_DELAY) */
+#if BMF_MIN_FWD_DELAY
+    if(fwd_delay < BMF_MIN_FWD_DELAY) {
+      fwd_delay = BMF_MIN_FWD_DELAY;
+    }
+#endif
+
+    if(fwd_delay == 0) {
+      /* No delay required, send it, do it now, why wait? */
+      UIP_IP_BUF->ttl--;
+      tcpip_output(NULL);
+      UIP_IP_BUF->ttl++;        /* Restore before potential upstack delivery */
+    } else {
+      /* Randomise final delay in [D , D*Spread], step D */
+      fwd_spread = BMF_INTERVAL_COUNT;
+      if(fwd_spread > BMF_MAX_SPREAD) {
+        fwd_spread = BMF_MAX_SPREAD;
+      }
+      if(fwd_spread) {
+        fwd_delay = fwd_delay * (1 + ((random_rand() >> 11) % fwd_spread));
+      }
+
+      memcpy(&mcast_buf, uip_buf, uip_len);
+      mcast_len = uip_len;
+      ctimer_set(&mcast_periodic, fwd_delay, mcast_fwd, NULL);
+    }
+    LOG_DBG("%u bytes: fwd in %u [%u]\n", uip_len, fwd_delay, fwd_spread);
+  } else {
+    LOG_DBG("Not a forwarder for this datagram\n");
+  }
+
+  /* Done with this packet unless we are a member of the mcast group */
+  if(!uip_ds6_is_my_maddr(&UIP_IP_BUF->destipaddr)) {
+    LOG_DBG("Not a group member. No further processing\n");
+    return UIP_MCAST6_DROP;
+  } else {
+    LOG_DBG("Ours. Deliver to upper layers\n");
+    UIP_MCAST6_STATS_ADD(mcast_in_ours);
+    return UIP_MCAST6_ACCEPT;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+init()
+{
+  UIP_MCAST6_STATS_INIT(NULL);
+
+  memb_init(&member_memb);
+  list_init(member_list);
+}
+/*---------------------------------------------------------------------------*/
+static void
+out()
+{
+  uint8_t *opt;
+  uint8_t len;
+  uint8_t k;
+
+  /* Only the root knows the memberships to build a filter from */
+  if(!NETSTACK_ROUTING.node_is_root()) {
+    LOG_ERR("Only the root can send to a group\n");
+    goto drop;
+  }
+
+  if(uip_len + HBHO_TOTAL_LEN(BMF_FILTER_MAX) > UIP_BUFSIZE) {
+    LOG_ERR("Multicast Out can not add HBHO. Packet too long\n");
+    goto drop;
+  }
+
+  len = filter_size(&k);
+  if(len == 0) {
+    LOG_INFO("No members of ");
+    LOG_INFO_6ADDR(&UIP_IP_BUF->destipaddr);
+    LOG_INFO_("\n");
+    goto drop;
+  }
+
+  /* Slide 'right' by the options header */
+  memmove(UIP_IP_PAYLOAD(HBHO_TOTAL_LEN(len)), UIP_EXT_BUF,
+          uip_len - UIP_IPH_LEN);
+
+  UIP_EXT_BUF->next = UIP_IP_BUF->proto;
+  UIP_EXT_BUF->len = len / 8;
+
+  opt = UIP_EXT_OPT_FIRST;
+  opt[0] = HBHO_OPT_TYPE_BMF;
+  opt[1] = 1 + len;
+  opt[2] = k;
+  memset(opt + BMF_OPT_HDR_LEN, 0, len);
+  members_walk(&UIP_IP_BUF->destipaddr, opt + BMF_OPT_HDR_LEN, len * 8, k, 0);
+  opt[BMF_OPT_HDR_LEN + len] = UIP_EXT_HDR_OPT_PADN;
+  opt[BMF_OPT_HDR_LEN + len + 1] = 1;
+  opt[BMF_OPT_HDR_LEN + len + 2] = 0;
+
+  uip_ext_len += HBHO_TOTAL_LEN(len);
+  uip_len += HBHO_TOTAL_LEN(len);
+
+  /* Update the proto and length field in the v6 header */
+  UIP_IP_BUF->proto = UIP_PROTO_HBHO;
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+
+  UIP_MCAST6_STATS_ADD(mcast_out);
+  return;
+
+drop:
+  UIP_MCAST6_STATS_ADD(mcast_dropped);
+  uipbuf_clear();
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief The BMF engine driver
+ */
+const struct uip_mcast6_driver bmf_driver = {
+  "BMF",
+  init,
+  out,
+  in,
+};
+/*---------------------------------------------------------------------------*/
+/** @} */
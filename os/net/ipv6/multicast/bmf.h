@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup uip-multicast
+ * @{
+ */
+/**
+ * \defgroup bmf-multicast 'Bloom-filter Multicast Forwarding' (BMF)
+ *
+ * BMF is a stateless downward multicast engine for RPL networks in MOP 1
+ * "Non-Storing". Nodes advertise their group memberships to the root in
+ * DAOs. When the root sends to a group, it walks the source routing graph
+ * from every member towards itself and adds the routers on those paths to
+ * a Bloom filter. The filter is carried in a hop-by-hop option. A router
+ * rebroadcasts a datagram from its preferred parent only if its own
+ * interface identifier is in the filter.
+ *
+ * Routers keep no per-group state. False positives of the filter cost
+ * extra transmissions but never lose datagrams.
+ * @{
+ */
+/**
+ * \file
+ *    Header file for the BMF forwarding engine
+ */
+
+#ifndef BMF_H_
+#define BMF_H_
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+
+#include <stdint.h>
+/*---------------------------------------------------------------------------*/
+/* Configuration */
+/*---------------------------------------------------------------------------*/
+/**
+ * Group memberships the root can hold, one per (group, member) pair.
+ * Only the root uses this table.
+ */
+#ifdef BMF_CONF_MEMBERS_NUM
+#define BMF_MEMBERS_NUM BMF_CONF_MEMBERS_NUM
+#else
+#define BMF_MEMBERS_NUM 32
+#endif
+
+/**
+ * Largest filter in bytes: 8, 16, 32 or 64. The root picks the smallest
+ * of these that gives every forwarder BMF_BITS_PER_FORWARDER bits.
+ */
+#ifdef BMF_CONF_FILTER_MAX
+#define BMF_FILTER_MAX BMF_CONF_FILTER_MAX
+#else
+#define BMF_FILTER_MAX 32
+#endif
+
+/** Filter bits per forwarder, 10 keeps false positives near 1% */
+#ifdef BMF_CONF_BITS_PER_FORWARDER
+#define BMF_BITS_PER_FORWARDER BMF_CONF_BITS_PER_FORWARDER
+#else
+#define BMF_BITS_PER_FORWARDER 10
+#endif
+
+/* Fmin */
+#ifdef BMF_CONF_MIN_FWD_DELAY
+#define BMF_MIN_FWD_DELAY BMF_CONF_MIN_FWD_DELAY
+#else
+#define BMF_MIN_FWD_DELAY 4
+#endif
+
+/* Max Spread */
+#ifdef BMF_CONF_MAX_SPREAD
+#define BMF_MAX_SPREAD BMF_CONF_MAX_SPREAD
+#else
+#define BMF_MAX_SPREAD 4
+#endif
+/*---------------------------------------------------------------------------*/
+/* Protocol Constants */
+/*---------------------------------------------------------------------------*/
+/**
+ * The BMF option uses an experimental option type (RFC 4727). Its two
+ * high-order bits are 00, so nodes that do not know it skip it.
+ */
+#define HBHO_OPT_TYPE_BMF    0x1E
+
+/* Option type, length, hash count. The filter follows */
+#define BMF_OPT_HDR_LEN      3
+/*---------------------------------------------------------------------------*/
+/* Public API */
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Update a group membership at the root
+ * \param group The multicast group
+ * \param member The global address of the member
+ * \param lifetime Lifetime in seconds, 0 removes the membership
+ * \return 1 on success, 0 if the membership table is full
+ *
+ * The RPL non-storing DAO input calls this for DAO targets that are
+ * multicast addresses.
+ */
+int bmf_member_update(const uip_ipaddr_t *group, const uip_ipaddr_t *member,
+                      uint32_t lifetime);
+
+/**
+ * \brief Check whether the datagram in uip_buf lists a router as forwarder
+ * \param addr The address of the router, only its interface identifier is
+ *        used
+ * \return 1 if the BMF option's filter contains addr, 0 if not or if the
+ *         datagram has no BMF option
+ */
+int bmf_filter_match(const uip_ipaddr_t *addr);
+/*---------------------------------------------------------------------------*/
+#endif /* BMF_H_ */
+/*---------------------------------------------------------------------------*/
+/** @} */
+/** @} */
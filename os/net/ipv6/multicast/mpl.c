@@ -146,17 +146,22 @@ typedef struct seed_id_s {
 #define seed_id_clr(a) (memset((a), 0, sizeof(seed_id_t)))
 /*---------------------------------------------------------------------------*/
 /* Buffered message set
- *  This is implemented as a linked list since the majority of operations
- *  involve finding the minimum sequence number and iterating up the list.
+ *  Each seed keeps its messages in a ring ordered by sequence number, since
+ *  the majority of operations involve finding the minimum sequence number
+ *  and iterating up the set. Unused buffers are kept on a free list.
+ *  Messages do not have trickle timers of their own: the messages of a
+ *  domain are forwarded together when the domain's data timer fires.
  */
 struct mpl_msg {
-  struct mpl_msg *next; /* Next message in the set, or NULL if this is largest */
+  struct mpl_msg *next; /* Next free buffer */
   struct mpl_seed *seed; /* The seed set this message belongs to */
-  struct trickle_timer tt; /* The trickle timer associated with this msg */
   uip_ip6addr_t srcipaddr; /* The original ip this message was sent from */
   uint16_t size; /* Side of the data stored above */
   uint8_t seq; /* The sequence number of the message */
   uint8_t e; /* Expiration count for trickle timer */
+  uint8_t c; /* Copies of this message heard in the current interval */
+  uint8_t active; /* Forwarded when the domain's data timer fires */
+  uint8_t pending; /* Waiting for its turn in a paced transmission */
   uint8_t data[UIP_BUFSIZE]; /* Message payload */
 };
 /**
@@ -202,13 +207,22 @@ struct mpl_msg {
 /*---------------------------------------------------------------------------*/
 /* Seed Set */
 struct mpl_seed {
+  struct mpl_seed *next; /* Next seed of the same domain */
+  struct mpl_seed *next_hash; /* Next seed in the same lookup bucket */
   seed_id_t seed_id;
   uint8_t min_seqno; /* Used when the seed set is empty */
   uint8_t lifetime; /* Decrements by one every minute */
-  uint8_t count; /* Only used for determining largest msg set during reclaim */
-  LIST_STRUCT(min_seq); /* Pointer to the first msg in this seed's set */
+  uint8_t count; /* Number of messages in the ring */
+  uint8_t head; /* Ring position of the message with the smallest seq */
+  uint8_t seen; /* Listed in the control message being processed */
+  struct mpl_msg *ring[MPL_SEED_RING_SIZE]; /* Messages in sequence order */
   struct mpl_domain *domain; /* The domain this seed belongs to */
 };
+/**
+ * \brief The i-th message of a seed in sequence order, starting at 0
+ * s: pointer to the seed set entry
+ */
+#define SEED_MSG(s, i) ((s)->ring[((s)->head + (i)) % MPL_SEED_RING_SIZE])
 /**
  * \brief Get the state of the used flag in the buffered message set entry
  * h: pointer to the message set entry
@@ -222,9 +236,14 @@ struct mpl_seed {
 /*---------------------------------------------------------------------------*/
 /* Domain Set */
 struct mpl_domain {
+  struct mpl_domain *next_hash; /* Next domain in the same lookup bucket */
   uip_ip6addr_t data_addr; /* Data address for this MPL domain */
   uip_ip6addr_t ctrl_addr; /* Link-local scoped version of data address */
-  struct trickle_timer tt;
+  struct trickle_timer tt; /* Control messages */
+  struct trickle_timer data_tt; /* Data messages of all seeds */
+  struct ctimer tx_timer; /* Paces the data messages sent at data_tt expiry */
+  clock_time_t tx_i_start; /* Start of the last data interval that expired */
+  LIST_STRUCT(seeds); /* The seeds in this domain */
   uint8_t e; /* Expiration count for trickle timer */
 };
 /**
@@ -399,6 +418,9 @@ static struct mpl_stats stats;
 static struct mpl_msg buffered_message_set[MPL_BUFFERED_MESSAGE_SET_SIZE];
 static struct mpl_seed seed_set[MPL_SEED_SET_SIZE];
 static struct mpl_domain domain_set[MPL_DOMAIN_SET_SIZE];
+static struct mpl_msg *free_messages;
+static struct mpl_seed *seed_hash[MPL_SEED_HASH_SIZE];
+static struct mpl_domain *domain_hash[MPL_DOMAIN_HASH_SIZE];
 static uint16_t last_seq;
 static seed_id_t local_seed_id;
 #if MPL_SUB_TO_ALL_FORWARDERS
@@ -428,11 +450,6 @@ extern uint16_t uip_slen;
  * t: Pointer to set that should be reset
  */
 #define mpl_control_trickle_timer_start(t) { (t)->e = 0; trickle_timer_set(&(t)->tt, control_message_expiration, (t)); }
-/**
- * \brief Start the trickle timer for a data message
- * t: Pointer to set that should be reset
- */
-#define mpl_data_trickle_timer_start(t) { (t)->e = 0; trickle_timer_set(&(t)->tt, data_message_expiration, (t)); }
 /**
  * \brief Call inconsistency on the provided timer
  * t: Pointer to set that should be reset
@@ -463,61 +480,222 @@ extern uint16_t uip_slen;
 /*---------------------------------------------------------------------------*/
 /* Local function prototypes */
 /*---------------------------------------------------------------------------*/
+static void data_message_expiration(void *ptr, uint8_t suppress);
+static void control_message_expiration(void *ptr, uint8_t suppress);
 static void icmp_in(void);
 UIP_ICMP6_HANDLER(mpl_icmp_handler, ICMP6_MPL, 0, icmp_in);
 
 static struct mpl_msg *
 buffer_allocate(void)
 {
-  for(locmmptr = &buffered_message_set[MPL_BUFFERED_MESSAGE_SET_SIZE - 1]; locmmptr >= buffered_message_set; locmmptr--) {
-    if(!MSG_SET_IS_USED(locmmptr)) {
-      memset(locmmptr, 0, sizeof(struct mpl_msg));
-      return locmmptr;
-    }
+  locmmptr = free_messages;
+  if(locmmptr != NULL) {
+    free_messages = locmmptr->next;
+    memset(locmmptr, 0, sizeof(struct mpl_msg));
   }
-  return NULL;
+  return locmmptr;
 }
 static void
 buffer_free(struct mpl_msg *msg)
 {
-  if(trickle_timer_is_running(&msg->tt)) {
-    trickle_timer_stop(&msg->tt);
-  }
   MSG_SET_CLEAR_USED(msg);
+  msg->active = 0;
+  msg->pending = 0;
+  msg->next = free_messages;
+  free_messages = msg;
+}
+/*---------------------------------------------------------------------------*/
+/* Data message timers */
+/*---------------------------------------------------------------------------*/
+/* Schedule a message for forwarding on its domain's data timer */
+static void
+data_timer_start(struct mpl_msg *msg)
+{
+  msg->e = 0;
+  msg->c = 0;
+  msg->active = 1;
+  if(!trickle_timer_is_running(&msg->seed->domain->data_tt)) {
+    trickle_timer_set(&msg->seed->domain->data_tt, data_message_expiration,
+                      msg->seed->domain);
+  } else {
+    trickle_timer_inconsistency(&msg->seed->domain->data_tt);
+  }
+}
+static void
+data_timer_inconsistency(struct mpl_msg *msg)
+{
+  if(msg->active) {
+    msg->e = 0;
+    msg->c = 0;
+    trickle_timer_inconsistency(&msg->seed->domain->data_tt);
+  }
+}
+/*
+ * The data timer is shared by all messages of a domain, so consistency is
+ * counted per message rather than on the timer. Copies heard after t has
+ * passed in an interval don't count towards the next one.
+ */
+static void
+data_timer_consistency(struct mpl_msg *msg)
+{
+  if(msg->active
+     && msg->seed->domain->data_tt.i_start != msg->seed->domain->tx_i_start
+     && msg->c < 0xFF) {
+    msg->c++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Seed message rings */
+/*---------------------------------------------------------------------------*/
+/**
+ * Find the position of seq in the seed's ring. Returns the index of the
+ * message with that sequence number, or the index it should be inserted at
+ * with *found cleared.
+ */
+static uint8_t
+seed_msg_index(struct mpl_seed *s, uint8_t seq, uint8_t *found)
+{
+  uint8_t lo = 0;
+  uint8_t hi = s->count;
+  uint8_t mid;
+
+  *found = 0;
+  while(lo < hi) {
+    mid = (lo + hi) / 2;
+    if(SEQ_VAL_IS_EQ(SEED_MSG(s, mid)->seq, seq)) {
+      *found = 1;
+      return mid;
+    }
+    if(SEQ_VAL_IS_LT(SEED_MSG(s, mid)->seq, seq)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+static void
+seed_msg_insert(struct mpl_seed *s, uint8_t index, struct mpl_msg *msg)
+{
+  uint8_t i;
+
+  for(i = s->count; i > index; i--) {
+    SEED_MSG(s, i) = SEED_MSG(s, i - 1);
+  }
+  SEED_MSG(s, index) = msg;
+  s->count++;
+}
+static struct mpl_msg *
+seed_msg_pop(struct mpl_seed *s)
+{
+  struct mpl_msg *msg;
+
+  if(s->count == 0) {
+    return NULL;
+  }
+  msg = SEED_MSG(s, 0);
+  s->head = (s->head + 1) % MPL_SEED_RING_SIZE;
+  s->count--;
+  return msg;
+}
+/**
+ * Drop the message with min_seq from a seed set and hand its buffer back.
+ * To reclaim this, we need to increment the min seq number to the next
+ * largest sequence number in the set. This won't necessarily be
+ * min_seq + 1 because MPL does not require or ensure that sequence number
+ * are sequential, it just denotes the order messages are sent.
+ */
+static struct mpl_msg *
+seed_reclaim(struct mpl_seed *s)
+{
+  struct mpl_msg *reclaim;
+
+  reclaim = seed_msg_pop(s);
+  if(reclaim != NULL) {
+    s->min_seqno = s->count == 0 ? reclaim->seq : SEED_MSG(s, 0)->seq;
+    reclaim->active = 0;
+    reclaim->pending = 0;
+    mpl_trickle_timer_reset(s->domain);
+    memset(reclaim, 0, sizeof(struct mpl_msg));
+  }
+  return reclaim;
 }
 static struct mpl_msg *
 buffer_reclaim(void)
 {
   static struct mpl_seed *ssptr; /* Can't use locssptr since it's used by calling function */
   static struct mpl_seed *largest;
-  static struct mpl_msg *reclaim;
 
   /* Reclaim the message with min_seq in the largest seed set */
   largest = NULL;
-  reclaim = NULL;
-  for(ssptr = &seed_set[MPL_SEED_SET_SIZE]; ssptr >= seed_set; ssptr--) {
+  for(ssptr = &seed_set[MPL_SEED_SET_SIZE - 1]; ssptr >= seed_set; ssptr--) {
     if(SEED_SET_IS_USED(ssptr) && (largest == NULL || ssptr->count > largest->count)) {
       largest = ssptr;
     }
   }
-  /**
-   * To reclaim this, we need to increment the min seq number to
-   *   the next largest sequence number in the set.
-   * This won't necessarily be min_seq + 1 because MPL does not require or
-   *   ensure that sequence number are sequential, it just denotes the
-   *   order messages are sent.
-   * We've already worked out what this new value is.
-   */
-  if(largest != NULL) {
-    reclaim = list_pop(largest->min_seq);
-    largest->min_seqno = list_item_next(reclaim) == NULL ? reclaim->seq : ((struct mpl_msg *)list_item_next(reclaim))->seq;
-    largest->count--;
-    trickle_timer_stop(&reclaim->tt);
-    mpl_trickle_timer_reset(reclaim->seed->domain);
-    memset(reclaim, 0, sizeof(struct mpl_msg));
+  if(largest == NULL) {
+    return NULL;
   }
-  return reclaim;
+  return seed_reclaim(largest);
+}
+/*---------------------------------------------------------------------------*/
+/* Seed and domain hash tables */
+/*---------------------------------------------------------------------------*/
+/**
+ * Only the group ID is hashed, so that the data and control addresses of a
+ * domain share a bucket.
+ */
+static uint8_t
+domain_hash_key(const uip_ip6addr_t *addr)
+{
+  uint8_t i;
+  uint16_t h = 0;
+
+  for(i = 12; i < 16; i++) {
+    h = (h * 31) + addr->u8[i];
+  }
+  return h % MPL_DOMAIN_HASH_SIZE;
+}
+/**
+ * Seed IDs are stored least significant byte first, so the first bytes are
+ * the ones that tell seeds apart for all values of S.
+ */
+static uint8_t
+seed_hash_key(const seed_id_t *seed_id, const struct mpl_domain *domain)
+{
+  uint8_t i;
+  uint16_t h = domain - domain_set;
+
+  for(i = 0; i < 4; i++) {
+    h = (h * 31) + seed_id->id[i];
+  }
+  return h % MPL_SEED_HASH_SIZE;
 }
+static void
+seed_hash_remove(struct mpl_seed *s)
+{
+  struct mpl_seed **sp;
+
+  for(sp = &seed_hash[seed_hash_key(&s->seed_id, s->domain)]; *sp != NULL; sp = &(*sp)->next_hash) {
+    if(*sp == s) {
+      *sp = s->next_hash;
+      return;
+    }
+  }
+}
+static void
+domain_hash_remove(struct mpl_domain *d)
+{
+  struct mpl_domain **dp;
+
+  for(dp = &domain_hash[domain_hash_key(&d->data_addr)]; *dp != NULL; dp = &(*dp)->next_hash) {
+    if(*dp == d) {
+      *dp = d->next_hash;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
 static struct mpl_domain *
 domain_set_allocate(uip_ip6addr_t *address)
 {
@@ -556,14 +734,21 @@ domain_set_allocate(uip_ip6addr_t *address)
       memset(locdsptr, 0, sizeof(struct mpl_domain));
       memcpy(&locdsptr->data_addr, &data_addr, sizeof(uip_ip6addr_t));
       memcpy(&locdsptr->ctrl_addr, &ctrl_addr, sizeof(uip_ip6addr_t));
+      LIST_STRUCT_INIT(locdsptr, seeds);
       if(!trickle_timer_config(&locdsptr->tt,
                                MPL_CONTROL_MESSAGE_IMIN,
                                MPL_CONTROL_MESSAGE_IMAX,
-                               MPL_CONTROL_MESSAGE_K)) {
+                               MPL_CONTROL_MESSAGE_K)
+         || !trickle_timer_config(&locdsptr->data_tt,
+                                  MPL_DATA_MESSAGE_IMIN,
+                                  MPL_DATA_MESSAGE_IMAX,
+                                  MPL_DATA_MESSAGE_K)) {
         LOG_ERR("Unable to configure trickle timer for domain. Dropping,...\n");
         DOMAIN_SET_CLEAR_USED(locdsptr);
         return NULL;
       }
+      locdsptr->next_hash = domain_hash[domain_hash_key(&data_addr)];
+      domain_hash[domain_hash_key(&data_addr)] = locdsptr;
       return locdsptr;
     }
   }
@@ -573,20 +758,24 @@ domain_set_allocate(uip_ip6addr_t *address)
 static struct mpl_seed *
 seed_set_lookup(seed_id_t *seed_id, struct mpl_domain *domain)
 {
-  for(locssptr = &seed_set[MPL_SEED_SET_SIZE - 1]; locssptr >= seed_set; locssptr--) {
-    if(SEED_SET_IS_USED(locssptr) && seed_id_cmp(seed_id, &locssptr->seed_id) && locssptr->domain == domain) {
+  for(locssptr = seed_hash[seed_hash_key(seed_id, domain)]; locssptr != NULL; locssptr = locssptr->next_hash) {
+    if(locssptr->domain == domain && seed_id_cmp(seed_id, &locssptr->seed_id)) {
       return locssptr;
     }
   }
   return NULL;
 }
 static struct mpl_seed *
-seed_set_allocate(void)
+seed_set_allocate(seed_id_t *seed_id, struct mpl_domain *domain)
 {
   for(locssptr = &seed_set[MPL_SEED_SET_SIZE - 1]; locssptr >= seed_set; locssptr--) {
     if(!SEED_SET_IS_USED(locssptr)) {
-      locssptr->count = 0;
-      LIST_STRUCT_INIT(locssptr, min_seq);
+      memset(locssptr, 0, sizeof(struct mpl_seed));
+      seed_id_cpy(&locssptr->seed_id, seed_id);
+      locssptr->domain = domain;
+      locssptr->next_hash = seed_hash[seed_hash_key(seed_id, domain)];
+      seed_hash[seed_hash_key(seed_id, domain)] = locssptr;
+      list_add(domain->seeds, locssptr);
       return locssptr;
     }
   }
@@ -595,20 +784,20 @@ seed_set_allocate(void)
 static void
 seed_set_free(struct mpl_seed *s)
 {
-  while((locmmptr = list_pop(s->min_seq)) != NULL) {
+  while((locmmptr = seed_msg_pop(s)) != NULL) {
     buffer_free(locmmptr);
   }
+  seed_hash_remove(s);
+  list_remove(s->domain->seeds, s);
   SEED_SET_CLEAR_USED(s);
 }
 static struct mpl_domain *
 domain_set_lookup(uip_ip6addr_t *domain)
 {
-  for(locdsptr = &domain_set[MPL_DOMAIN_SET_SIZE - 1]; locdsptr >= domain_set; locdsptr--) {
-    if(DOMAIN_SET_IS_USED(locdsptr)) {
-      if(uip_ip6addr_cmp(domain, &locdsptr->data_addr)
-         || uip_ip6addr_cmp(domain, &locdsptr->ctrl_addr)) {
-        return locdsptr;
-      }
+  for(locdsptr = domain_hash[domain_hash_key(domain)]; locdsptr != NULL; locdsptr = locdsptr->next_hash) {
+    if(uip_ip6addr_cmp(domain, &locdsptr->data_addr)
+       || uip_ip6addr_cmp(domain, &locdsptr->ctrl_addr)) {
+      return locdsptr;
     }
   }
   return NULL;
@@ -618,10 +807,8 @@ domain_set_free(struct mpl_domain *domain)
 {
   uip_ds6_maddr_t *addr;
   /* Must include freeing seeds otherwise we leak memory */
-  for(locssptr = &seed_set[MPL_SEED_SET_SIZE]; locssptr >= seed_set; locssptr--) {
-    if(SEED_SET_IS_USED(locssptr) && locssptr->domain == domain) {
-      seed_set_free(locssptr);
-    }
+  while((locssptr = list_head(domain->seeds)) != NULL) {
+    seed_set_free(locssptr);
   }
   addr = uip_ds6_maddr_lookup(&domain->data_addr);
   if(addr != NULL) {
@@ -634,6 +821,11 @@ domain_set_free(struct mpl_domain *domain)
   if(trickle_timer_is_running(&domain->tt)) {
     trickle_timer_stop(&domain->tt);
   }
+  if(trickle_timer_is_running(&domain->data_tt)) {
+    trickle_timer_stop(&domain->data_tt);
+  }
+  ctimer_stop(&domain->tx_timer);
+  domain_hash_remove(domain);
   DOMAIN_SET_CLEAR_USED(domain);
 }
 static void
@@ -756,6 +948,7 @@ update_seed_id(void)
 void
 icmp_out(struct mpl_domain *dom)
 {
+  uint8_t i;
   uint8_t vector[32];
   uint8_t vec_size;
   uint8_t vec_len;
@@ -780,102 +973,101 @@ icmp_out(struct mpl_domain *dom)
   uip_ds6_select_src(&UIP_IP_BUF->srcipaddr, &UIP_IP_BUF->destipaddr);
 
   /* Iterate over seed set to create payload */
-  for(locssptr = &seed_set[MPL_SEED_SET_SIZE - 1]; locssptr >= seed_set; locssptr--) {
-    if(SEED_SET_IS_USED(locssptr) && locssptr->domain == dom) {
-      locsiptr->min_seqno = locssptr->min_seqno;
-      SEED_INFO_CLR_LEN(locsiptr);
-      SEED_INFO_CLR_S(locsiptr);
-
-      /* Try setting our source address to global */
-      addr = uip_ds6_get_global(ADDR_PREFERRED);
-      if(addr) {
-        uip_ip6addr_copy(&UIP_IP_BUF->srcipaddr, &addr->ipaddr);
-      } else {
-        /* Failed setting a global ip address, fallback to link local */
-        uip_ds6_select_src(&UIP_IP_BUF->srcipaddr, &UIP_IP_BUF->destipaddr);
-        if(uip_is_addr_unspecified(&UIP_IP_BUF->srcipaddr)) {
-          LOG_ERR("icmp out: Cannot set src ip\n");
-          uipbuf_clear();
-          return;
-        }
+  for(locssptr = list_head(dom->seeds); locssptr != NULL; locssptr = list_item_next(locssptr)) {
+    locsiptr->min_seqno = locssptr->min_seqno;
+    SEED_INFO_CLR_LEN(locsiptr);
+    SEED_INFO_CLR_S(locsiptr);
+
+    /* Try setting our source address to global */
+    addr = uip_ds6_get_global(ADDR_PREFERRED);
+    if(addr) {
+      uip_ip6addr_copy(&UIP_IP_BUF->srcipaddr, &addr->ipaddr);
+    } else {
+      /* Failed setting a global ip address, fallback to link local */
+      uip_ds6_select_src(&UIP_IP_BUF->srcipaddr, &UIP_IP_BUF->destipaddr);
+      if(uip_is_addr_unspecified(&UIP_IP_BUF->srcipaddr)) {
+        LOG_ERR("icmp out: Cannot set src ip\n");
+        uipbuf_clear();
+        return;
       }
+    }
 
-      /* Set the Seed ID */
-      switch(locssptr->seed_id.s) {
-      case 0:
-        if(uip_ip6addr_cmp((uip_ip6addr_t *)&locssptr->seed_id.id, &UIP_IP_BUF->srcipaddr)) {
-          /* We can use an S=0 Seed ID */
-          SEED_INFO_SET_LEN(locsiptr, 0);
-          break;
-        } /* Else fall down into the S = 3 case */
-      case 3:
-        seed_id_host_to_net(&((struct seed_info_s3 *)locsiptr)->seed_id, &locssptr->seed_id);
-        SEED_INFO_SET_S(locsiptr, 3);
-        break;
-      case 1:
-        seed_id_host_to_net(&((struct seed_info_s1 *)locsiptr)->seed_id, &locssptr->seed_id);
-        SEED_INFO_SET_S(locsiptr, 1);
-        break;
-      case 2:
-        seed_id_host_to_net(&((struct seed_info_s2 *)locsiptr)->seed_id, &locssptr->seed_id);
-        SEED_INFO_SET_S(locsiptr, 2);
+    /* Set the Seed ID */
+    switch(locssptr->seed_id.s) {
+    case 0:
+      if(uip_ip6addr_cmp((uip_ip6addr_t *)&locssptr->seed_id.id, &UIP_IP_BUF->srcipaddr)) {
+        /* We can use an S=0 Seed ID */
+        SEED_INFO_SET_LEN(locsiptr, 0);
         break;
-      }
+      } /* Else fall down into the S = 3 case */
+    case 3:
+      seed_id_host_to_net(&((struct seed_info_s3 *)locsiptr)->seed_id, &locssptr->seed_id);
+      SEED_INFO_SET_S(locsiptr, 3);
+      break;
+    case 1:
+      seed_id_host_to_net(&((struct seed_info_s1 *)locsiptr)->seed_id, &locssptr->seed_id);
+      SEED_INFO_SET_S(locsiptr, 1);
+      break;
+    case 2:
+      seed_id_host_to_net(&((struct seed_info_s2 *)locsiptr)->seed_id, &locssptr->seed_id);
+      SEED_INFO_SET_S(locsiptr, 2);
+      break;
+    }
 
-      /* Populate the seed info message vector */
-      memset(vector, 0, sizeof(vector));
-      vec_len = 0;
-      cur_seq = 0;
-      LOG_INFO("\nBuffer for seed: ");
-      LOG_INFO_SEED(locssptr->seed_id);
-      LOG_INFO_("\n");
-      for(locmmptr = list_head(locssptr->min_seq); locmmptr != NULL; locmmptr = list_item_next(locmmptr)) {
-        LOG_INFO("%d -- %x\n", locmmptr->seq, locmmptr->data[locmmptr->size - 1]);
-        cur_seq = SEQ_VAL_ADD(locssptr->min_seqno, vec_len);
-        if(locmmptr->seq == SEQ_VAL_ADD(locssptr->min_seqno, vec_len)) {
-          BIT_VECTOR_SET_BIT(vector, vec_len);
-          vec_len++;
-        } else {
-          /* Insert enough zeros to get to the next message */
-          vec_len += locmmptr->seq - cur_seq;
-          BIT_VECTOR_SET_BIT(vector, vec_len);
-          vec_len++;
-        }
+    /* Populate the seed info message vector */
+    memset(vector, 0, sizeof(vector));
+    vec_len = 0;
+    cur_seq = 0;
+    LOG_INFO("\nBuffer for seed: ");
+    LOG_INFO_SEED(locssptr->seed_id);
+    LOG_INFO_("\n");
+    for(i = 0; i < locssptr->count; i++) {
+      locmmptr = SEED_MSG(locssptr, i);
+      LOG_INFO("%d -- %x\n", locmmptr->seq, locmmptr->data[locmmptr->size - 1]);
+      cur_seq = SEQ_VAL_ADD(locssptr->min_seqno, vec_len);
+      if(locmmptr->seq == SEQ_VAL_ADD(locssptr->min_seqno, vec_len)) {
+        BIT_VECTOR_SET_BIT(vector, vec_len);
+        vec_len++;
+      } else {
+        /* Insert enough zeros to get to the next message */
+        vec_len += locmmptr->seq - cur_seq;
+        BIT_VECTOR_SET_BIT(vector, vec_len);
+        vec_len++;
       }
+    }
 
-      /* Convert vector length from bits to bytes */
-      vec_size = (vec_len - 1) / 8 + 1;
+    /* Convert vector length from bits to bytes */
+    vec_size = (vec_len - 1) / 8 + 1;
 
-      SEED_INFO_SET_LEN(locsiptr, vec_size);
+    SEED_INFO_SET_LEN(locsiptr, vec_size);
 
-      LOG_DBG("--- Control Message Entry ---\n");
-      LOG_DBG("Seed ID: ");
-      LOG_DBG_SEED(locssptr->seed_id);
-      LOG_DBG_("\n");
-      LOG_DBG("S=%u\n", locssptr->seed_id.s);
-      LOG_DBG("Min Sequence Number: %u\n", locssptr->min_seqno);
-      LOG_DBG("Size of message set: %u\n", vec_len);
-      LOG_DBG("Vector is %u bytes\n", vec_size);
-
-      /* Copy vector into payload and point ptr to next location */
-      switch(SEED_INFO_GET_S(locsiptr)) {
-      case 0:
-        seed_info_len = sizeof(struct seed_info);
-        break;
-      case 1:
-        seed_info_len = sizeof(struct seed_info_s1);
-        break;
-      case 2:
-        seed_info_len = sizeof(struct seed_info_s2);
-        break;
-      case 3:
-        seed_info_len = sizeof(struct seed_info_s3);
-        break;
-      }
-      memcpy(((void *)locsiptr) + seed_info_len, vector, vec_size);
-      locsiptr = ((void *)locsiptr) + seed_info_len + vec_size;
-      payload_len += seed_info_len + vec_size;
+    LOG_DBG("--- Control Message Entry ---\n");
+    LOG_DBG("Seed ID: ");
+    LOG_DBG_SEED(locssptr->seed_id);
+    LOG_DBG_("\n");
+    LOG_DBG("S=%u\n", locssptr->seed_id.s);
+    LOG_DBG("Min Sequence Number: %u\n", locssptr->min_seqno);
+    LOG_DBG("Size of message set: %u\n", vec_len);
+    LOG_DBG("Vector is %u bytes\n", vec_size);
+
+    /* Copy vector into payload and point ptr to next location */
+    switch(SEED_INFO_GET_S(locsiptr)) {
+    case 0:
+      seed_info_len = sizeof(struct seed_info);
+      break;
+    case 1:
+      seed_info_len = sizeof(struct seed_info_s1);
+      break;
+    case 2:
+      seed_info_len = sizeof(struct seed_info_s2);
+      break;
+    case 3:
+      seed_info_len = sizeof(struct seed_info_s3);
+      break;
     }
+    memcpy(((void *)locsiptr) + seed_info_len, vector, vec_size);
+    locsiptr = ((void *)locsiptr) + seed_info_len + vec_size;
+    payload_len += seed_info_len + vec_size;
     /* Now go to next seed in set */
   }
   LOG_DBG("--- End of Messages --\n");
@@ -902,91 +1094,161 @@ icmp_out(struct mpl_domain *dom)
   return;
 }
 static void
-data_message_expiration(void *ptr, uint8_t suppress)
+data_message_send(struct mpl_msg *msg, uint8_t last)
 {
-  /* Callback for data message trickle timers */
-  locmmptr = ((struct mpl_msg *)ptr);
-  if(locmmptr->e > MPL_DATA_MESSAGE_TIMER_EXPIRATIONS) {
-    /* Terminate the trickle timer here if we've already expired enough times */
-    trickle_timer_stop(&locmmptr->tt);
-    return;
+  LOG_DBG("Data message TX\n");
+  LOG_DBG("Seed ID=");
+  LOG_DBG_SEED(msg->seed->seed_id);
+  LOG_DBG_(", S=%u, Seq=%u\n", msg->seed->seed_id.s, msg->seq);
+  /* Setup the IP Header */
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->tcflow = 0;
+  UIP_IP_BUF->flow = 0;
+  UIP_IP_BUF->proto = UIP_PROTO_HBHO;
+  /*UIP_IP_BUF->ttl = MPL_IP_HOP_LIMIT; */
+  uip_ip6addr_copy(&UIP_IP_BUF->destipaddr, &msg->seed->domain->data_addr);
+  uip_len = UIP_IPH_LEN;
+  /* Setup the HBHO Header */
+  UIP_EXT_BUF->next = UIP_PROTO_UDP;
+  lochbhmptr = UIP_EXT_OPT_FIRST;
+  lochbhmptr->type = HBHO_OPT_TYPE_MPL;
+  lochbhmptr->flags = 0x00;
+  switch(msg->seed->seed_id.s) {
+  case 0:
+    UIP_EXT_BUF->len = HBHO_S0_LEN / 8;
+    lochbhmptr->len = MPL_OPT_LEN_S0;
+    HBH_CLR_S(lochbhmptr);
+    HBH_SET_S(lochbhmptr, 0);
+    uip_len += HBHO_BASE_LEN + HBHO_S0_LEN;
+    uip_ext_len += HBHO_BASE_LEN + HBHO_S0_LEN;
+    lochbhmptr->padn.opt_type = UIP_EXT_HDR_OPT_PADN;
+    lochbhmptr->padn.opt_len = 0x00;
+    break;
+  case 1:
+    UIP_EXT_BUF->len = HBHO_S1_LEN / 8;
+    lochbhmptr->len = MPL_OPT_LEN_S1;
+    HBH_CLR_S(lochbhmptr);
+    HBH_SET_S(lochbhmptr, 1);
+    seed_id_host_to_net(&((struct mpl_hbho_s1 *)lochbhmptr)->seed_id, &msg->seed->seed_id);
+    uip_len += HBHO_BASE_LEN + HBHO_S1_LEN;
+    uip_ext_len += HBHO_BASE_LEN + HBHO_S1_LEN;
+    break;
+  case 2:
+    UIP_EXT_BUF->len = HBHO_S2_LEN / 8;
+    lochbhmptr->len = MPL_OPT_LEN_S2;
+    HBH_CLR_S(lochbhmptr);
+    HBH_SET_S(lochbhmptr, 2);
+    seed_id_host_to_net(&((struct mpl_hbho_s2 *)lochbhmptr)->seed_id, &msg->seed->seed_id);
+    uip_len += HBHO_BASE_LEN + HBHO_S2_LEN;
+    uip_ext_len += HBHO_BASE_LEN + HBHO_S2_LEN;
+    ((struct mpl_hbho_s2 *)lochbhmptr)->padn.opt_type = UIP_EXT_HDR_OPT_PADN;
+    ((struct mpl_hbho_s2 *)lochbhmptr)->padn.opt_len = 0x00;
+    break;
+  case 3:
+    UIP_EXT_BUF->len = HBHO_S3_LEN / 8;
+    lochbhmptr->len = MPL_OPT_LEN_S3;
+    HBH_CLR_S(lochbhmptr);
+    HBH_SET_S(lochbhmptr, 3);
+    seed_id_host_to_net(&((struct mpl_hbho_s3 *)lochbhmptr)->seed_id, &msg->seed->seed_id);
+    uip_len += HBHO_BASE_LEN + HBHO_S3_LEN;
+    uip_ext_len += HBHO_BASE_LEN + HBHO_S3_LEN;
+    ((struct mpl_hbho_s3 *)lochbhmptr)->padn.opt_type = UIP_EXT_HDR_OPT_PADN;
+    ((struct mpl_hbho_s3 *)lochbhmptr)->padn.opt_len = 0x00;
+    break;
   }
-  if(suppress == TRICKLE_TIMER_TX_OK) { /* Only transmit if not suppressed */
-    LOG_DBG("Data message TX\n");
-    LOG_DBG("Seed ID=");
-    LOG_DBG_SEED(locmmptr->seed->seed_id);
-    LOG_DBG_(", S=%u, Seq=%u\n", locmmptr->seed->seed_id.s, locmmptr->seq);
-    /* Setup the IP Header */
-    UIP_IP_BUF->vtc = 0x60;
-    UIP_IP_BUF->tcflow = 0;
-    UIP_IP_BUF->flow = 0;
-    UIP_IP_BUF->proto = UIP_PROTO_HBHO;
-    /*UIP_IP_BUF->ttl = MPL_IP_HOP_LIMIT; */
-    uip_ip6addr_copy(&UIP_IP_BUF->destipaddr, &locmmptr->seed->domain->data_addr);
-    uip_len = UIP_IPH_LEN;
-    /* Setup the HBHO Header */
-    UIP_EXT_BUF->next = UIP_PROTO_UDP;
-    lochbhmptr = UIP_EXT_OPT_FIRST;
-    lochbhmptr->type = HBHO_OPT_TYPE_MPL;
-    lochbhmptr->flags = 0x00;
-    switch(locmmptr->seed->seed_id.s) {
-    case 0:
-      UIP_EXT_BUF->len = HBHO_S0_LEN / 8;
-      lochbhmptr->len = MPL_OPT_LEN_S0;
-      HBH_CLR_S(lochbhmptr);
-      HBH_SET_S(lochbhmptr, 0);
-      uip_len += HBHO_BASE_LEN + HBHO_S0_LEN;
-      uip_ext_len += HBHO_BASE_LEN + HBHO_S0_LEN;
-      lochbhmptr->padn.opt_type = UIP_EXT_HDR_OPT_PADN;
-      lochbhmptr->padn.opt_len = 0x00;
-      break;
-    case 1:
-      UIP_EXT_BUF->len = HBHO_S1_LEN / 8;
-      lochbhmptr->len = MPL_OPT_LEN_S1;
-      HBH_CLR_S(lochbhmptr);
-      HBH_SET_S(lochbhmptr, 1);
-      seed_id_host_to_net(&((struct mpl_hbho_s1 *)lochbhmptr)->seed_id, &locmmptr->seed->seed_id);
-      uip_len += HBHO_BASE_LEN + HBHO_S1_LEN;
-      uip_ext_len += HBHO_BASE_LEN + HBHO_S1_LEN;
-      break;
-    case 2:
-      UIP_EXT_BUF->len = HBHO_S2_LEN / 8;
-      lochbhmptr->len = MPL_OPT_LEN_S2;
-      HBH_CLR_S(lochbhmptr);
-      HBH_SET_S(lochbhmptr, 2);
-      seed_id_host_to_net(&((struct mpl_hbho_s2 *)lochbhmptr)->seed_id, &locmmptr->seed->seed_id);
-      uip_len += HBHO_BASE_LEN + HBHO_S2_LEN;
-      uip_ext_len += HBHO_BASE_LEN + HBHO_S2_LEN;
-      ((struct mpl_hbho_s2 *)lochbhmptr)->padn.opt_type = UIP_EXT_HDR_OPT_PADN;
-      ((struct mpl_hbho_s2 *)lochbhmptr)->padn.opt_len = 0x00;
-      break;
-    case 3:
-      UIP_EXT_BUF->len = HBHO_S3_LEN / 8;
-      lochbhmptr->len = MPL_OPT_LEN_S3;
-      HBH_CLR_S(lochbhmptr);
-      HBH_SET_S(lochbhmptr, 3);
-      seed_id_host_to_net(&((struct mpl_hbho_s3 *)lochbhmptr)->seed_id, &locmmptr->seed->seed_id);
-      uip_len += HBHO_BASE_LEN + HBHO_S3_LEN;
-      uip_ext_len += HBHO_BASE_LEN + HBHO_S3_LEN;
-      ((struct mpl_hbho_s3 *)lochbhmptr)->padn.opt_type = UIP_EXT_HDR_OPT_PADN;
-      ((struct mpl_hbho_s3 *)lochbhmptr)->padn.opt_len = 0x00;
-      break;
-    }
-    lochbhmptr->seq = locmmptr->seq;
-    if(list_item_next(locmmptr) == NULL) {
-      HBH_SET_M(lochbhmptr);
+  lochbhmptr->seq = msg->seq;
+  if(last) {
+    HBH_SET_M(lochbhmptr);
+  }
+  /* Now insert payload */
+  memcpy(((void *)UIP_EXT_BUF) + 8 + UIP_EXT_BUF->len * 8, &msg->data, msg->size);
+  uip_len += msg->size;
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+  uip_ip6addr_copy(&UIP_IP_BUF->srcipaddr, &msg->srcipaddr);
+  tcpip_output(NULL);
+  uipbuf_clear();
+  UIP_MCAST6_STATS_ADD(mcast_out);
+}
+static void
+data_message_tx(void *ptr)
+{
+  /* Send the next pending data message of a domain, then pace the rest */
+  static struct mpl_domain *domain;
+  static struct mpl_seed *ssptr;
+  static struct mpl_msg *msg;
+  static uint8_t i;
+  static uint8_t sent;
+
+  domain = ((struct mpl_domain *)ptr);
+  sent = 0;
+  for(ssptr = list_head(domain->seeds); ssptr != NULL; ssptr = list_item_next(ssptr)) {
+    for(i = 0; i < ssptr->count; i++) {
+      msg = SEED_MSG(ssptr, i);
+      if(!msg->pending) {
+        continue;
+      }
+      if(sent) {
+        /* More to send: leave it for the next slot */
+        ctimer_set(&domain->tx_timer, MPL_DATA_MESSAGE_TX_SPACING,
+                   data_message_tx, domain);
+        return;
+      }
+      msg->pending = 0;
+      data_message_send(msg, i == ssptr->count - 1);
+      sent = 1;
     }
-    /* Now insert payload */
-    memcpy(((void *)UIP_EXT_BUF) + 8 + UIP_EXT_BUF->len * 8, &locmmptr->data, locmmptr->size);
-    uip_len += locmmptr->size;
-    uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
-    uip_ip6addr_copy(&UIP_IP_BUF->srcipaddr, &locmmptr->srcipaddr);
-    tcpip_output(NULL);
-    uipbuf_clear();
-    UIP_MCAST6_STATS_ADD(mcast_out);
   }
+}
+static void
+data_message_expiration(void *ptr, uint8_t suppress)
+{
+  /*
+   * Callback for the data message trickle timer of a domain. Consistency is
+   * never counted on the timer itself, suppression is decided per message.
+   */
+  static struct mpl_seed *ssptr;
+  static uint8_t i;
+  static uint8_t active;
+  static uint8_t pending;
 
-  locmmptr->e++;
+  locdsptr = ((struct mpl_domain *)ptr);
+  locdsptr->tx_i_start = locdsptr->data_tt.i_start;
+  active = 0;
+  pending = 0;
+  for(ssptr = list_head(locdsptr->seeds); ssptr != NULL; ssptr = list_item_next(ssptr)) {
+    for(i = 0; i < ssptr->count; i++) {
+      locmmptr = SEED_MSG(ssptr, i);
+      if(!locmmptr->active) {
+        continue;
+      }
+      if(locmmptr->pending) {
+        /* Still waiting for its slot from the last expiration */
+        locmmptr->c = 0;
+        active = 1;
+        continue;
+      }
+      if(locmmptr->e > MPL_DATA_MESSAGE_TIMER_EXPIRATIONS) {
+        /* Stop forwarding this message if it has expired enough times */
+        locmmptr->active = 0;
+        continue;
+      }
+      if(locmmptr->c < MPL_DATA_MESSAGE_K) {
+        /* Only transmit if not suppressed by copies of this same message */
+        locmmptr->pending = 1;
+        pending = 1;
+      }
+      locmmptr->c = 0;
+      locmmptr->e++;
+      active = 1;
+    }
+  }
+  if(pending && ctimer_expired(&locdsptr->tx_timer)) {
+    data_message_tx(locdsptr);
+  }
+  if(!active) {
+    /* Terminate the trickle timer once no message is left to forward */
+    trickle_timer_stop(&locdsptr->data_tt);
+  }
 }
 static void
 control_message_expiration(void *ptr, uint8_t suppress)
@@ -1032,19 +1294,19 @@ mpl_maddr_check(void)
 static void
 lifetime_timer_expiration(void *ptr)
 {
+  static uint8_t i;
+
   /* Called once per minute to decrement seed lifetime counters */
   for(locssptr = &seed_set[MPL_SEED_SET_SIZE - 1]; seed_set <= locssptr; locssptr--) {
     if(SEED_SET_IS_USED(locssptr) && locssptr->lifetime == 0) {
-      /* Check no timers are running */
-      locmmptr = list_head(locssptr->min_seq);
-      while(locmmptr != NULL) {
-        if(trickle_timer_is_running(&locmmptr->tt)) {
+      /* Check no messages are still being forwarded */
+      for(i = 0; i < locssptr->count; i++) {
+        if(SEED_MSG(locssptr, i)->active) {
           /* We must keep this seed */
           break;
         }
-        locmmptr = list_item_next(locmmptr);
       }
-      if(locmmptr == NULL) {
+      if(i == locssptr->count) {
         /* We can now free this seed set */
         LOG_INFO("Seed ");
         LOG_INFO_SEED(locssptr->seed_id);
@@ -1068,6 +1330,8 @@ icmp_in(void)
   static uint8_t vector_len;
   static uint8_t r_missing;
   static uint8_t l_missing;
+  static uint8_t i;
+  static uint8_t found;
 
   LOG_INFO("MPL ICMP Control Message In\n");
 
@@ -1123,65 +1387,9 @@ icmp_in(void)
   l_missing = 0;
   r_missing = 0;
 
-  /* Iterate over our seed set and check all are present in the remote seed sed */
-  locsiptr = (struct seed_info *)UIP_ICMP_PAYLOAD;
-  for(locssptr = &seed_set[MPL_SEED_SET_SIZE - 1]; locssptr >= seed_set; locssptr--) {
-    if(SEED_SET_IS_USED(locssptr) && locssptr->domain == locdsptr) {
-      LOG_DBG("Checking remote for seed ");
-      LOG_DBG_SEED(locssptr->seed_id);
-      LOG_DBG_("\n");
-      while(locsiptr <
-            (struct seed_info *)((void *)UIP_ICMP_PAYLOAD + uip_len - uip_l3_icmp_hdr_len)) {
-        switch(SEED_INFO_GET_S(locsiptr)) {
-        case 0:
-          seed_id_net_to_host(&seed_id, &UIP_IP_BUF->srcipaddr, 0);
-          locsiptr = ((void *)locsiptr) + sizeof(struct seed_info) + SEED_INFO_GET_LEN(locsiptr);
-          if(seed_id_cmp(&seed_id, &locssptr->seed_id)) {
-            goto seed_present;
-          }
-          break;
-        case 1:
-          seed_id_net_to_host(&seed_id, &((struct seed_info_s1 *)locsiptr)->seed_id, 1);
-          locsiptr = ((void *)locsiptr) + sizeof(struct seed_info_s1) + SEED_INFO_GET_LEN(locsiptr);
-          if(seed_id_cmp(&seed_id, &locssptr->seed_id)) {
-            goto seed_present;
-          }
-          break;
-        case 2:
-          seed_id_net_to_host(&seed_id, &((struct seed_info_s2 *)locsiptr)->seed_id, 2);
-          locsiptr = ((void *)locsiptr) + sizeof(struct seed_info_s2) + SEED_INFO_GET_LEN(locsiptr);
-          if(seed_id_cmp(&seed_id, &locssptr->seed_id)) {
-            goto seed_present;
-          }
-          break;
-        case 3:
-          seed_id_net_to_host(&seed_id, &((struct seed_info_s3 *)locsiptr)->seed_id, 3);
-          locsiptr = ((void *)locsiptr) + sizeof(struct seed_info_s3) + SEED_INFO_GET_LEN(locsiptr);
-          if(seed_id_cmp(&seed_id, &locssptr->seed_id)) {
-            goto seed_present;
-          }
-          break;
-        }
-      }
-      /* If we made it this far, the seed is missing from the remote. Reset all message timers */
-      LOG_DBG("Remote is missing seed ");
-      LOG_DBG_SEED(locssptr->seed_id);
-      LOG_DBG_("\n");
-      r_missing = 1;
-      if(list_head(locssptr->min_seq) != NULL) {
-        for(locmmptr = list_head(locssptr->min_seq); locmmptr != NULL; locmmptr = list_item_next(locmmptr)) {
-          LOG_DBG("Resetting timer for messages\n");
-          if(!trickle_timer_is_running(&locmmptr->tt)) {
-            LOG_DBG("Starting timer for messages\n");
-            mpl_data_trickle_timer_start(locmmptr);
-          }
-          mpl_trickle_timer_inconsistency(locmmptr);
-        }
-      }
-      /* Otherwise we jump here and continute */
-seed_present:
-      continue;
-    }
+  /* Local seeds that are not listed in the remote seed info are missing there */
+  for(locssptr = list_head(locdsptr->seeds); locssptr != NULL; locssptr = list_item_next(locssptr)) {
+    locssptr->seen = 0;
   }
 
   /* Iterate over remote seed info and they're present locally. Additionally check messages match */
@@ -1208,6 +1416,7 @@ seed_present:
       l_missing = 1;
       goto next;
     }
+    locssptr->seen = 1;
 
     /* Work out where remote bit vector starts */
     vector_len = SEED_INFO_GET_LEN(locsiptr) * 8;
@@ -1227,8 +1436,7 @@ seed_present:
     }
 
     /* Potential quick resolution here */
-    locmmptr = list_head(locssptr->min_seq);
-    if(locmmptr == NULL) {
+    if(locssptr->count == 0) {
       /* We have nothing! */
       if(vector[0] > 0) {
         /* They have something! */
@@ -1241,25 +1449,23 @@ seed_present:
      * sequence numbers match up
      */
     r = 0;
+    i = 0;
+    locmmptr = SEED_MSG(locssptr, 0);
     if(locmmptr->seq != locsiptr->min_seqno) {
       if(SEQ_VAL_IS_GT(locmmptr->seq, locsiptr->min_seqno)) {
         while(locmmptr->seq != SEQ_VAL_ADD(locsiptr->min_seqno, r) && r <= vector_len) {
           r++;
         }
       } else {
-        while(locmmptr != NULL && locmmptr->seq != locsiptr->min_seqno) {
-          locmmptr = list_item_next(locmmptr);
-        }
+        i = seed_msg_index(locssptr, locsiptr->min_seqno, &found);
+        locmmptr = found ? SEED_MSG(locssptr, i) : NULL;
       }
 
       /* There is no overlap in message sets */
       if(r > vector_len || locmmptr == NULL) {
         LOG_WARN("Seed sets of local and remote have no overlap.\n");
         /* Work out who is behind who */
-        locmmptr = list_head(locssptr->min_seq);
-        while(list_item_next(locmmptr) != NULL) {
-          locmmptr = list_item_next(locmmptr);
-        }
+        locmmptr = SEED_MSG(locssptr, locssptr->count - 1);
         r = vector_len;
         while(!BIT_VECTOR_GET_BIT(vector, r)) {
           r--;
@@ -1269,13 +1475,8 @@ seed_present:
           LOG_DBG("Our max sequence number is greater than their max sequence number\n");
           r_missing = 1;
           /* Additionally all data message timers in set if r is behind us */
-          if(list_head(locssptr->min_seq) != NULL) {
-            for(locmmptr = list_head(locssptr->min_seq); locmmptr != NULL; locmmptr = list_item_next(locmmptr)) {
-              if(!trickle_timer_is_running(&locmmptr->tt)) {
-                mpl_data_trickle_timer_start(locmmptr);
-              }
-              mpl_trickle_timer_inconsistency(locmmptr);
-            }
+          for(i = 0; i < locssptr->count; i++) {
+            data_timer_start(SEED_MSG(locssptr, i));
           }
         } else {
           l_missing = 1;
@@ -1310,15 +1511,13 @@ seed_present:
         /* Local message is missing from remote set. Reset control and data timers */
         LOG_DBG("Remote is missing seq=%u\n", locmmptr->seq);
         r_missing = 1;
-        if(!trickle_timer_is_running(&locmmptr->tt)) {
-          mpl_data_trickle_timer_start(locmmptr);
-        }
-        mpl_trickle_timer_inconsistency(locmmptr);
+        data_timer_start(locmmptr);
       }
 
       /* Now increment our pointers */
       r++;
-      locmmptr = list_item_next(locmmptr);
+      i++;
+      locmmptr = i < locssptr->count ? SEED_MSG(locssptr, i) : NULL;
       /* These are then resyncronised at the top of the loop */
     } while(locmmptr != NULL && r <= vector_len);
 
@@ -1342,12 +1541,10 @@ seed_present:
        */
       while(locmmptr != NULL) {
         LOG_DBG("Remote is missing all above seq=%u\n", locmmptr->seq);
-        if(!trickle_timer_is_running(&locmmptr->tt)) {
-          mpl_data_trickle_timer_start(locmmptr);
-        }
-        mpl_trickle_timer_inconsistency(locmmptr);
+        data_timer_start(locmmptr);
         r_missing = 1;
-        locmmptr = list_item_next(locmmptr);
+        i++;
+        locmmptr = i < locssptr->count ? SEED_MSG(locssptr, i) : NULL;
       }
     }
     /* Now point to next seed info */
@@ -1368,6 +1565,19 @@ next:
     }
   }
 
+  /* Restart forwarding for all messages of seeds the remote does not know */
+  for(locssptr = list_head(locdsptr->seeds); locssptr != NULL; locssptr = list_item_next(locssptr)) {
+    if(!locssptr->seen) {
+      LOG_DBG("Remote is missing seed ");
+      LOG_DBG_SEED(locssptr->seed_id);
+      LOG_DBG_("\n");
+      r_missing = 1;
+      for(i = 0; i < locssptr->count; i++) {
+        data_timer_start(SEED_MSG(locssptr, i));
+      }
+    }
+  }
+
   /* Now sort out control message timers */
   if(l_missing && !trickle_timer_is_running(&locdsptr->tt)) {
     mpl_control_trickle_timer_start(locdsptr);
@@ -1393,7 +1603,8 @@ accept(uint8_t in)
   static seed_id_t seed_id;
   static uint16_t seq_val;
   static uint8_t S;
-  static struct mpl_msg *mmiterptr;
+  static uint8_t index;
+  static uint8_t found;
   static struct uip_ext_hdr *hptr;
 
   LOG_INFO("Multicast I/O\n");
@@ -1509,27 +1720,34 @@ accept(uint8_t in)
       UIP_MCAST6_STATS_ADD(mcast_dropped);
       return UIP_MCAST6_DROP;
     }
-    if(list_head(locssptr->min_seq) != NULL) {
-      for(locmmptr = list_head(locssptr->min_seq); locmmptr != NULL; locmmptr = list_item_next(locmmptr)) {
-        if(SEQ_VAL_IS_EQ(seq_val, locmmptr->seq)) {
-          /* Seen before , drop */
-          LOG_INFO("Seen before\n");
-          if(HBH_GET_M(lochbhmptr) && list_item_next(locmmptr) != NULL) {
-            mpl_trickle_timer_inconsistency(locmmptr);
-          } else {
-            trickle_timer_consistency(&locmmptr->tt);
-          }
-          UIP_MCAST6_STATS_ADD(mcast_dropped);
-          return UIP_MCAST6_DROP;
-        }
+    index = seed_msg_index(locssptr, seq_val, &found);
+    if(found) {
+      /* Seen before , drop */
+      LOG_INFO("Seen before\n");
+      locmmptr = SEED_MSG(locssptr, index);
+      if(HBH_GET_M(lochbhmptr) && index < locssptr->count - 1) {
+        data_timer_inconsistency(locmmptr);
+      } else {
+        data_timer_consistency(locmmptr);
       }
+      UIP_MCAST6_STATS_ADD(mcast_dropped);
+      return UIP_MCAST6_DROP;
+    }
+    if(locssptr->count == MPL_SEED_RING_SIZE) {
+      /* This seed's ring is full: make room by dropping its oldest message */
+      if(index == 0) {
+        LOG_INFO("Too old\n");
+        UIP_MCAST6_STATS_ADD(mcast_dropped);
+        return UIP_MCAST6_DROP;
+      }
+      buffer_free(seed_reclaim(locssptr));
     }
   }
   /* We have not seen this message before */
 
   /* Allocate a seed set if we have to */
   if(!locssptr) {
-    locssptr = seed_set_allocate();
+    locssptr = seed_set_allocate(&seed_id, locdsptr);
     LOG_INFO("New seed\n");
     if(!locssptr) {
       /* Couldn't allocate seed set, drop */
@@ -1537,10 +1755,6 @@ accept(uint8_t in)
       UIP_MCAST6_STATS_ADD(mcast_dropped);
       return UIP_MCAST6_DROP;
     }
-    memset(locssptr, 0, sizeof(struct mpl_seed));
-    LIST_STRUCT_INIT(locssptr, min_seq);
-    seed_id_cpy(&locssptr->seed_id, &seed_id);
-    locssptr->domain = locdsptr;
   }
 
   /* Allocate a buffer */
@@ -1579,33 +1793,20 @@ accept(uint8_t in)
   memcpy(&locmmptr->data, hptr, locmmptr->size);
   locmmptr->seq = seq_val;
   locmmptr->seed = locssptr;
-  if(!trickle_timer_config(&locmmptr->tt,
-                           MPL_DATA_MESSAGE_IMIN,
-                           MPL_DATA_MESSAGE_IMAX,
-                           MPL_DATA_MESSAGE_K)) {
-    LOG_ERR("Failed to configure timer for message. Dropping...\n");
-    buffer_free(locmmptr);
-    return UIP_MCAST6_DROP;
-  }
 
-  /* Place the message into the buffered message linked list */
-  if(list_head(locssptr->min_seq) == NULL) {
-    list_push(locssptr->min_seq, locmmptr);
+  /*
+   * Place the message into the seed's ring. A reclaim above may have shifted
+   * the ring, so find the position again.
+   */
+  index = seed_msg_index(locssptr, locmmptr->seq, &found);
+  seed_msg_insert(locssptr, index, locmmptr);
+  if(index == 0) {
     locssptr->min_seqno = locmmptr->seq;
-  } else {
-    for(mmiterptr = list_head(locssptr->min_seq); mmiterptr != NULL; mmiterptr = list_item_next(mmiterptr)) {
-      if(list_item_next(mmiterptr) == NULL
-         || (SEQ_VAL_IS_GT(locmmptr->seq, mmiterptr->seq) && SEQ_VAL_IS_LT(locmmptr->seq, ((struct mpl_msg *)list_item_next(mmiterptr))->seq))) {
-        list_insert(locssptr->min_seq, mmiterptr, locmmptr);
-        break;
-      }
-    }
   }
-  locssptr->count++;
 
 #if MPL_PROACTIVE_FORWARDING
   /* Start Forwarding the message */
-  mpl_data_trickle_timer_start(locmmptr);
+  data_timer_start(locmmptr);
 #endif
 
   LOG_INFO("Min Seq Number=%u, %u values\n", locssptr->min_seqno, locssptr->count);
@@ -1630,12 +1831,9 @@ accept(uint8_t in)
    *  now check the rest.
    */
 #if MPL_PROACTIVE_FORWARDING
-  if(HBH_GET_M(lochbhmptr) == 1 && list_item_next(locmmptr) != NULL) {
+  if(HBH_GET_M(lochbhmptr) == 1 && index < locssptr->count - 1) {
     LOG_DBG("MPL Domain is inconsistent\n");
-    mpl_trickle_timer_inconsistency(locmmptr);
-  } else {
-    LOG_DBG("MPL Domain is consistent\n");
-    trickle_timer_consistency(&locmmptr->tt);
+    data_timer_inconsistency(locmmptr);
   }
 #endif
 
@@ -1772,6 +1970,12 @@ init(void)
   memset(domain_set, 0, sizeof(struct mpl_domain) * MPL_DOMAIN_SET_SIZE);
   memset(seed_set, 0, sizeof(struct mpl_seed) * MPL_SEED_SET_SIZE);
   memset(buffered_message_set, 0, sizeof(struct mpl_msg) * MPL_BUFFERED_MESSAGE_SET_SIZE);
+  memset(seed_hash, 0, sizeof(seed_hash));
+  memset(domain_hash, 0, sizeof(domain_hash));
+  free_messages = NULL;
+  for(locmmptr = &buffered_message_set[MPL_BUFFERED_MESSAGE_SET_SIZE - 1]; locmmptr >= buffered_message_set; locmmptr--) {
+    buffer_free(locmmptr);
+  }
 
   /* Register the ICMPv6 input handler */
   uip_icmp6_register_input_handler(&mpl_icmp_handler);
@@ -90,7 +90,7 @@
 #ifndef MPL_CONF_DATA_MESSAGE_K
 #define MPL_DATA_MESSAGE_K                  1
 #else
-#define MPL_CONF_DATA_MESSAGE_K MPL_DATA_MESSAGE_K
+#define MPL_DATA_MESSAGE_K MPL_CONF_DATA_MESSAGE_K
 #endif
 
 #ifndef MPL_CONF_CONTROL_MESSAGE_IMIN
@@ -216,6 +216,36 @@
 #define MPL_BUFFERED_MESSAGE_SET_SIZE MPL_CONF_BUFFERED_MESSAGE_SET_SIZE
 #endif
 /*---------------------------------------------------------------------------*/
+/**
+ * Seed Ring Size
+ * Each seed keeps its buffered messages in a ring ordered by sequence number.
+ * This is the largest number of messages a single seed can hold; when it is
+ * full the oldest message of that seed is reclaimed. It must not exceed 255.
+ */
+#ifndef MPL_CONF_SEED_RING_SIZE
+#define MPL_SEED_RING_SIZE                  MPL_BUFFERED_MESSAGE_SET_SIZE
+#else
+#define MPL_SEED_RING_SIZE MPL_CONF_SEED_RING_SIZE
+#endif
+/*---------------------------------------------------------------------------*/
+/**
+ * Seed and Domain Hash Sizes
+ * Seed and domain set entries are found through small hash tables so that
+ * lookups on every received message do not scan the whole set. These set the
+ * number of buckets in each table.
+ */
+#ifndef MPL_CONF_SEED_HASH_SIZE
+#define MPL_SEED_HASH_SIZE                  8
+#else
+#define MPL_SEED_HASH_SIZE MPL_CONF_SEED_HASH_SIZE
+#endif
+
+#ifndef MPL_CONF_DOMAIN_HASH_SIZE
+#define MPL_DOMAIN_HASH_SIZE                4
+#else
+#define MPL_DOMAIN_HASH_SIZE MPL_CONF_DOMAIN_HASH_SIZE
+#endif
+/*---------------------------------------------------------------------------*/
 /**
  * MPL Forwarding Strategy
  * Two forwarding strategies are defined for MPL. With Proactive forwarding
@@ -245,10 +275,26 @@
 #define MPL_SEED_SET_ENTRY_LIFETIME MPL_CONF_SEED_SET_ENTRY_LIFETIME
 #endif
 /*---------------------------------------------------------------------------*/
+/**
+ * Data Message Transmission Spacing
+ * When the data message trickle timer of a domain expires, the messages due
+ * for forwarding are sent one at a time, this many clock ticks apart, rather
+ * than in a single burst.
+ */
+#ifndef MPL_CONF_DATA_MESSAGE_TX_SPACING
+#define MPL_DATA_MESSAGE_TX_SPACING         (CLOCK_SECOND / 128)
+#else
+#define MPL_DATA_MESSAGE_TX_SPACING MPL_CONF_DATA_MESSAGE_TX_SPACING
+#endif
+/*---------------------------------------------------------------------------*/
 /**
  * Data Message Timer Expirations
- * MPL data message trickle timers are stopped after they expire a set number
- * of times. The number of times they expire before being stopped is set below.
+ * Buffered data messages are considered for forwarding each time their
+ * domain's data message trickle timer expires, and stop being forwarded after
+ * they have done so a set number of times. Each message keeps its own
+ * consistency counter: it is only sent if fewer than MPL_DATA_MESSAGE_K
+ * copies of it were heard during the current interval. The timer stops once
+ * no message is left to forward.
  */
 #ifndef MPL_CONF_DATA_MESSAGE_TIMER_EXPIRATIONS
 #define MPL_DATA_MESSAGE_TIMER_EXPIRATIONS  5
@@ -273,7 +319,9 @@
 /*---------------------------------------------------------------------------*/
 
 /* Configure the correct number of multicast addresses for MPL */
+#ifndef UIP_CONF_DS6_MADDR_NBU
 #define UIP_CONF_DS6_MADDR_NBU MPL_DOMAIN_SET_SIZE * 2
+#endif
 
 /*---------------------------------------------------------------------------*/
 /* Stats datatype */
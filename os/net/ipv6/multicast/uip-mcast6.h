@@ -66,6 +66,7 @@
 #include "net/ipv6/multicast/esmrf.h"
 #include "net/ipv6/multicast/roll-tm.h"
 #include "net/ipv6/multicast/mpl.h"
+#include "net/ipv6/multicast/bmf.h"
 
 #include <string.h>
 /*---------------------------------------------------------------------------*/
@@ -170,6 +171,11 @@ struct uip_mcast6_driver {
 #define RPL_WITH_MULTICAST     0
 #define UIP_MCAST6             mpl_driver
 
+#elif UIP_MCAST6_ENGINE == UIP_MCAST6_ENGINE_BMF
+#define RPL_WITH_MULTICAST     0        /* Memberships go to the root */
+#define RPL_WITH_NON_STORING_MULTICAST 1
+#define UIP_MCAST6             bmf_driver
+
 #else
 #error "Multicast Enabled with an Unknown Engine."
 #error "Check the value of UIP_MCAST6_CONF_ENGINE in conf files."
@@ -184,6 +190,11 @@ extern const struct uip_mcast6_driver UIP_MCAST6;
 #error "The selected Multicast mode requires UIP_CONF_IPV6_RPL != 0"
 #error "Check the value of UIP_CONF_IPV6_RPL in conf files."
 #endif
+
+#if RPL_WITH_NON_STORING_MULTICAST && (!UIP_CONF_IPV6_RPL)
+#error "The selected Multicast mode requires UIP_CONF_IPV6_RPL != 0"
+#error "Check the value of UIP_CONF_IPV6_RPL in conf files."
+#endif
 /*---------------------------------------------------------------------------*/
 #endif /* UIP_MCAST6_H_ */
 /*---------------------------------------------------------------------------*/
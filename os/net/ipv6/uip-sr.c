@@ -126,6 +126,18 @@ uip_sr_update_node(void *graph, const uip_ipaddr_t *child, const uip_ipaddr_t *p
   uip_sr_node_t *parent_node = uip_sr_get_node(graph, parent);
   uip_sr_node_t *old_parent_node;
 
+  /* Refresh of a known link: only the lifetime changes. This is the
+   * common case on a stable network and needs no reachability check. */
+  if(child_node != NULL && child_node->graph == graph
+     && child_node->parent == parent_node
+     && (parent == NULL || parent_node != NULL)) {
+    child_node->lifetime = lifetime;
+    LOG_DBG("NS: refreshing link, child ");
+    LOG_DBG_6ADDR(child);
+    LOG_DBG_(", lifetime %u\n", (unsigned)lifetime);
+    return child_node;
+  }
+
   if(parent != NULL) {
     /* No node for the parent, add one with infinite lifetime */
     if(parent_node == NULL) {
@@ -248,6 +260,21 @@ uip_sr_free_all(void)
   }
 }
 /*---------------------------------------------------------------------------*/
+void
+uip_sr_free_graph(void *graph)
+{
+  uip_sr_node_t *l;
+  uip_sr_node_t *next;
+  for(l = list_head(nodelist); l != NULL; l = next) {
+    next = list_item_next(l);
+    if(l->graph == graph) {
+      list_remove(nodelist, l);
+      memb_free(&nodememb, l);
+      num_nodes--;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
 int
 uip_sr_link_snprint(char *buf, int buflen, uip_sr_node_t *link)
 {
@@ -180,6 +180,13 @@ void uip_sr_init(void);
 */
 void uip_sr_free_all(void);
 
+/**
+ * Deallocate all neighbors of a graph
+ *
+ * \param graph The graph
+*/
+void uip_sr_free_graph(void *graph);
+
 /**
 * Print a textual description of a source routing link
 *
@@ -54,7 +54,10 @@ uip_udp_packet_send(struct uip_udp_conn *c, const void *data, int len)
   if(data != NULL && len <= (UIP_BUFSIZE - UIP_IPUDPH_LEN)) {
     uip_udp_conn = c;
     uip_slen = len;
-    memmove(&uip_buf[UIP_IPUDPH_LEN], data, len);
+    /* Data may have been written in place, e.g. by the CoAP writer */
+    if(data != &uip_buf[UIP_IPUDPH_LEN]) {
+      memmove(&uip_buf[UIP_IPUDPH_LEN], data, len);
+    }
     uip_process(UIP_UDP_SEND_CONN);
 
 #if UIP_IPV6_MULTICAST
@@ -190,6 +190,9 @@ void uipbuf_init(void);
 /* MAC will set the default for this packet */
 #define UIPBUF_ATTR_LLSEC_LEVEL_MAC_DEFAULT               0xffff
 
+/* The routing protocol will pick its default instance for this packet */
+#define UIPBUF_ATTR_RPL_INSTANCE_DEFAULT                  0xffff
+
 /**
  * \brief The attributes defined for uipbuf attributes function.
  *
@@ -201,6 +204,7 @@ enum {
   UIPBUF_ATTR_PHYSICAL_NETWORK_ID, /**< Physical network ID (mapped to PAN ID)*/
   UIPBUF_ATTR_MAX_MAC_TRANSMISSIONS, /**< MAX transmissions of the packet MAC */
   UIPBUF_ATTR_FLAGS,   /**< Flags that can control lower layers.  see above. */
+  UIPBUF_ATTR_RPL_INSTANCE, /**< RPL instance to send the packet in */
   UIPBUF_ATTR_MAX
 };
 
@@ -72,6 +72,9 @@ NBR_TABLE(struct link_stats, link_stats);
 /* Called at a period of FRESHNESS_HALF_LIFE */
 struct ctimer periodic_timer;
 
+/* Called whenever the ETX of a link changes */
+static link_stats_callback_t etx_callback;
+
 /*---------------------------------------------------------------------------*/
 /* Returns the neighbor's link stats */
 const struct link_stats *
@@ -127,15 +130,54 @@ guess_etx_from_rssi(const struct link_stats *stats)
 }
 #endif /* LINK_STATS_INIT_ETX_FROM_RSSI */
 /*---------------------------------------------------------------------------*/
+/* The ETX of a link before any transmission */
+static uint16_t
+initial_etx(const struct link_stats *stats)
+{
+#if LINK_STATS_INIT_ETX_FROM_RSSI
+  return guess_etx_from_rssi(stats);
+#else /* LINK_STATS_INIT_ETX_FROM_RSSI */
+  return ETX_DEFAULT * ETX_DIVISOR;
+#endif /* LINK_STATS_INIT_ETX_FROM_RSSI */
+}
+/*---------------------------------------------------------------------------*/
+#if LINK_STATS_ETX_ESTIMATOR == LINK_STATS_ETX_BAYES
+/* Posterior mean of the ETX, with a Beta prior on the PRR centered on the
+ * initial ETX and worth LINK_STATS_BAYES_PRIOR_WEIGHT attempts. Unlike the
+ * EWMA, the first few samples quickly outweigh the RSSI-based guess. */
+static uint16_t
+bayes_etx(const struct link_stats *stats)
+{
+  uint32_t attempts;
+  uint32_t successes;
+
+  attempts = ((uint32_t)LINK_STATS_BAYES_PRIOR_WEIGHT + stats->tx_count) * ETX_DIVISOR;
+  successes = (uint32_t)LINK_STATS_BAYES_PRIOR_WEIGHT * ETX_DIVISOR * ETX_DIVISOR
+    / initial_etx(stats) + (uint32_t)stats->ack_count * ETX_DIVISOR;
+  if(successes == 0) {
+    return 0xffff;
+  }
+  return MIN(attempts * ETX_DIVISOR / successes, 0xffff);
+}
+#endif /* LINK_STATS_ETX_ESTIMATOR == LINK_STATS_ETX_BAYES */
+/*---------------------------------------------------------------------------*/
+static void
+etx_changed(const linkaddr_t *lladdr)
+{
+  if(etx_callback != NULL) {
+    etx_callback(lladdr);
+  }
+}
+/*---------------------------------------------------------------------------*/
 /* Packet sent callback. Updates stats for transmissions to lladdr */
 void
 link_stats_packet_sent(const linkaddr_t *lladdr, int status, int numtx)
 {
   struct link_stats *stats;
-#if !LINK_STATS_ETX_FROM_PACKET_COUNT
+#if LINK_STATS_ETX_ESTIMATOR == LINK_STATS_ETX_EWMA
   uint16_t packet_etx;
   uint8_t ewma_alpha;
-#endif /* !LINK_STATS_ETX_FROM_PACKET_COUNT */
+#endif /* LINK_STATS_ETX_ESTIMATOR == LINK_STATS_ETX_EWMA */
 
   if(status != MAC_TX_OK && status != MAC_TX_NOACK) {
     /* Do not penalize the ETX when collisions or transmission errors occur. */
@@ -147,11 +189,7 @@ link_stats_packet_sent(const linkaddr_t *lladdr, int status, int numtx)
     /* Add the neighbor */
     stats = nbr_table_add_lladdr(link_stats, lladdr, NBR_TABLE_REASON_LINK_STATS, NULL);
     if(stats != NULL) {
-#if LINK_STATS_INIT_ETX_FROM_RSSI
-      stats->etx = guess_etx_from_rssi(stats);
-#else /* LINK_STATS_INIT_ETX_FROM_RSSI */
-      stats->etx = ETX_DEFAULT * ETX_DIVISOR;
-#endif /* LINK_STATS_INIT_ETX_FROM_RSSI */
+      stats->etx = initial_etx(stats);
     } else {
       return; /* No space left, return */
     }
@@ -160,6 +198,10 @@ link_stats_packet_sent(const linkaddr_t *lladdr, int status, int numtx)
   /* Update last timestamp and freshness */
   stats->last_tx_time = clock_time();
   stats->freshness = MIN(stats->freshness + numtx, FRESHNESS_MAX);
+#if LINK_STATS_ETX_ESTIMATOR == LINK_STATS_ETX_EWMA
+  /* Unlike freshness, this never decays: it tells if the link was ever used */
+  stats->tx_count = MIN(stats->tx_count + numtx, 0xff);
+#endif /* LINK_STATS_ETX_ESTIMATOR == LINK_STATS_ETX_EWMA */
 
 #if LINK_STATS_PACKET_COUNTERS
   /* Update paket counters */
@@ -169,6 +211,19 @@ link_stats_packet_sent(const linkaddr_t *lladdr, int status, int numtx)
   }
 #endif
 
+#if LINK_STATS_ETX_ESTIMATOR == LINK_STATS_ETX_BAYES
+  /* Count attempts and successes. No penalty in case of no-ACK: the
+   * estimate is the ratio of the two, which already accounts for losses. */
+  if(stats->tx_count + numtx > TX_COUNT_MAX) {
+    stats->tx_count /= 2;
+    stats->ack_count /= 2;
+  }
+  stats->tx_count += numtx;
+  if(status == MAC_TX_OK) {
+    stats->ack_count++;
+  }
+  stats->etx = bayes_etx(stats);
+#else /* LINK_STATS_ETX_ESTIMATOR == LINK_STATS_ETX_BAYES */
   /* Add penalty in case of no-ACK */
   if(status == MAC_TX_NOACK) {
     numtx += ETX_NOACK_PENALTY;
@@ -204,6 +259,9 @@ link_stats_packet_sent(const linkaddr_t *lladdr, int status, int numtx)
   stats->etx = ((uint32_t)stats->etx * (EWMA_SCALE - ewma_alpha) +
       (uint32_t)packet_etx * ewma_alpha) / EWMA_SCALE;
 #endif /* LINK_STATS_ETX_FROM_PACKET_COUNT */
+#endif /* LINK_STATS_ETX_ESTIMATOR == LINK_STATS_ETX_BAYES */
+
+  etx_changed(lladdr);
 }
 /*---------------------------------------------------------------------------*/
 /* Packet input callback. Updates statistics for receptions on a given link */
@@ -220,14 +278,11 @@ link_stats_input_callback(const linkaddr_t *lladdr)
     if(stats != NULL) {
       /* Initialize */
       stats->rssi = packet_rssi;
-#if LINK_STATS_INIT_ETX_FROM_RSSI
-      stats->etx = guess_etx_from_rssi(stats);
-#else /* LINK_STATS_INIT_ETX_FROM_RSSI */
-      stats->etx = ETX_DEFAULT * ETX_DIVISOR;
-#endif /* LINK_STATS_INIT_ETX_FROM_RSSI */
+      stats->etx = initial_etx(stats);
 #if LINK_STATS_PACKET_COUNTERS
       stats->cnt_current.num_packets_rx = 1;
 #endif
+      etx_changed(lladdr);
     }
     return;
   }
@@ -241,6 +296,111 @@ link_stats_input_callback(const linkaddr_t *lladdr)
 #endif
 }
 /*---------------------------------------------------------------------------*/
+/* Number of Tx attempts the current ETX estimate is based on */
+uint8_t
+link_stats_num_samples(const struct link_stats *stats)
+{
+  if(stats == NULL) {
+    return 0;
+  }
+  return stats->tx_count;
+}
+/*---------------------------------------------------------------------------*/
+#if LINK_STATS_PER_CHANNEL
+static uint8_t
+count_acked(uint16_t window)
+{
+  uint8_t count = 0;
+  while(window) {
+    window &= window - 1;
+    count++;
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+/* Records the outcome of a single Tx attempt to lladdr on a given channel */
+void
+link_stats_channel_tx(const linkaddr_t *lladdr, uint8_t channel, int acked)
+{
+  struct link_stats *stats;
+  struct link_stats_channel *c;
+
+  if(channel < LINK_STATS_FIRST_CHANNEL
+     || channel >= LINK_STATS_FIRST_CHANNEL + LINK_STATS_NUM_CHANNELS
+     || linkaddr_cmp(lladdr, &linkaddr_null)) {
+    return;
+  }
+
+  stats = nbr_table_get_from_lladdr(link_stats, lladdr);
+  if(stats == NULL) {
+    stats = nbr_table_add_lladdr(link_stats, lladdr, NBR_TABLE_REASON_LINK_STATS, NULL);
+    if(stats == NULL) {
+      return; /* No space left, return */
+    }
+    stats->etx = initial_etx(stats);
+    etx_changed(lladdr);
+  }
+
+  c = &stats->channels[channel - LINK_STATS_FIRST_CHANNEL];
+  c->window = (c->window << 1) | (acked ? 1 : 0);
+  if(c->count < 16) {
+    c->count++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the ETX of a link on a given channel */
+uint16_t
+link_stats_channel_etx(const struct link_stats *stats, uint8_t channel)
+{
+  const struct link_stats_channel *c;
+  uint16_t mask;
+
+  if(stats == NULL) {
+    return 0xffff;
+  }
+  if(channel < LINK_STATS_FIRST_CHANNEL
+     || channel >= LINK_STATS_FIRST_CHANNEL + LINK_STATS_NUM_CHANNELS) {
+    return stats->etx;
+  }
+  c = &stats->channels[channel - LINK_STATS_FIRST_CHANNEL];
+  if(c->count == 0) {
+    return stats->etx;
+  }
+  mask = c->count >= 16 ? 0xffff : (1 << c->count) - 1;
+  /* Laplace smoothing: one success and one failure as a prior */
+  return ((uint32_t)c->count + 2) * ETX_DIVISOR / (count_acked(c->window & mask) + 1);
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the PDR of a channel, averaged over all neighbors */
+uint16_t
+link_stats_channel_pdr(uint8_t channel)
+{
+  struct link_stats *stats;
+  const struct link_stats_channel *c;
+  uint32_t attempts = 0;
+  uint32_t acked = 0;
+  uint16_t mask;
+
+  if(channel < LINK_STATS_FIRST_CHANNEL
+     || channel >= LINK_STATS_FIRST_CHANNEL + LINK_STATS_NUM_CHANNELS) {
+    return LINK_STATS_PDR_SCALE;
+  }
+
+  for(stats = nbr_table_head(link_stats); stats != NULL;
+      stats = nbr_table_next(link_stats, stats)) {
+    c = &stats->channels[channel - LINK_STATS_FIRST_CHANNEL];
+    mask = c->count >= 16 ? 0xffff : (1 << c->count) - 1;
+    attempts += c->count;
+    acked += count_acked(c->window & mask);
+  }
+
+  if(attempts == 0) {
+    return LINK_STATS_PDR_SCALE;
+  }
+  return acked * LINK_STATS_PDR_SCALE / attempts;
+}
+#endif /* LINK_STATS_PER_CHANNEL */
+/*---------------------------------------------------------------------------*/
 #if LINK_STATS_PACKET_COUNTERS
 /*---------------------------------------------------------------------------*/
 static void
@@ -271,7 +431,8 @@ print_and_update_counters(void)
 static void
 periodic(void *ptr)
 {
-  /* Age (by halving) freshness counter of all neighbors */
+  /* Age (by halving) freshness counter of all neighbors. This leaves the
+   * ETX untouched: users check freshness when they need it. */
   struct link_stats *stats;
   ctimer_reset(&periodic_timer);
   for(stats = nbr_table_head(link_stats); stats != NULL; stats = nbr_table_next(link_stats, stats)) {
@@ -293,6 +454,13 @@ link_stats_reset(void)
     nbr_table_remove(link_stats, stats);
     stats = nbr_table_next(link_stats, stats);
   }
+  etx_changed(NULL);
+}
+/*---------------------------------------------------------------------------*/
+void
+link_stats_set_callback(link_stats_callback_t callback)
+{
+  etx_callback = callback;
 }
 /*---------------------------------------------------------------------------*/
 /* Initializes link-stats module */
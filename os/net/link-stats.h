@@ -49,12 +49,55 @@
 #define LINK_STATS_INIT_ETX_FROM_RSSI              1
 #endif /* LINK_STATS_CONF_INIT_ETX_FROM_RSSI */
 
+/* ETX estimators */
+#define LINK_STATS_ETX_EWMA                        0 /* EWMA of the Tx count */
+#define LINK_STATS_ETX_PACKET_COUNT                1 /* Ratio of Tx and ACK counts */
+#define LINK_STATS_ETX_BAYES                       2 /* Beta-Bernoulli estimate, with
+                                                        the initial ETX as a prior */
+
+/* The ETX estimator in use. LINK_STATS_CONF_ETX_FROM_PACKET_COUNT is kept
+ * as a shorthand for LINK_STATS_ETX_PACKET_COUNT. */
+#ifdef LINK_STATS_CONF_ETX_ESTIMATOR
+#define LINK_STATS_ETX_ESTIMATOR LINK_STATS_CONF_ETX_ESTIMATOR
+#elif LINK_STATS_CONF_ETX_FROM_PACKET_COUNT
+#define LINK_STATS_ETX_ESTIMATOR LINK_STATS_ETX_PACKET_COUNT
+#else /* LINK_STATS_CONF_ETX_ESTIMATOR */
+#define LINK_STATS_ETX_ESTIMATOR LINK_STATS_ETX_EWMA
+#endif /* LINK_STATS_CONF_ETX_ESTIMATOR */
+
 /* Option to use packet and ACK count for ETX estimation, instead of EWMA */
-#ifdef LINK_STATS_CONF_ETX_FROM_PACKET_COUNT
-#define LINK_STATS_ETX_FROM_PACKET_COUNT LINK_STATS_CONF_ETX_FROM_PACKET_COUNT
-#else /* LINK_STATS_CONF_ETX_FROM_PACKET_COUNT */
-#define LINK_STATS_ETX_FROM_PACKET_COUNT           0
-#endif /* LINK_STATS_ETX_FROM_PACKET_COUNT */
+#define LINK_STATS_ETX_FROM_PACKET_COUNT (LINK_STATS_ETX_ESTIMATOR == LINK_STATS_ETX_PACKET_COUNT)
+
+/* With LINK_STATS_ETX_BAYES: the weight of the initial ETX, in Tx attempts.
+ * Lower values converge faster but are noisier on the first packets. */
+#ifdef LINK_STATS_CONF_BAYES_PRIOR_WEIGHT
+#define LINK_STATS_BAYES_PRIOR_WEIGHT LINK_STATS_CONF_BAYES_PRIOR_WEIGHT
+#else /* LINK_STATS_CONF_BAYES_PRIOR_WEIGHT */
+#define LINK_STATS_BAYES_PRIOR_WEIGHT              2
+#endif /* LINK_STATS_CONF_BAYES_PRIOR_WEIGHT */
+
+/* Keep a window of recent Tx outcomes per neighbor and channel? Fed by TSCH. */
+#ifdef LINK_STATS_CONF_PER_CHANNEL
+#define LINK_STATS_PER_CHANNEL LINK_STATS_CONF_PER_CHANNEL
+#else /* LINK_STATS_CONF_PER_CHANNEL */
+#define LINK_STATS_PER_CHANNEL                     0
+#endif /* LINK_STATS_CONF_PER_CHANNEL */
+
+/* The channels covered by the per-channel statistics */
+#ifdef LINK_STATS_CONF_NUM_CHANNELS
+#define LINK_STATS_NUM_CHANNELS LINK_STATS_CONF_NUM_CHANNELS
+#else /* LINK_STATS_CONF_NUM_CHANNELS */
+#define LINK_STATS_NUM_CHANNELS                   16
+#endif /* LINK_STATS_CONF_NUM_CHANNELS */
+
+#ifdef LINK_STATS_CONF_FIRST_CHANNEL
+#define LINK_STATS_FIRST_CHANNEL LINK_STATS_CONF_FIRST_CHANNEL
+#else /* LINK_STATS_CONF_FIRST_CHANNEL */
+#define LINK_STATS_FIRST_CHANNEL                  11
+#endif /* LINK_STATS_CONF_FIRST_CHANNEL */
+
+/* Fixed point divisor of packet delivery ratios */
+#define LINK_STATS_PDR_SCALE                     256
 
 /* Store and periodically print packet counters? */
 #ifdef LINK_STATS_CONF_PACKET_COUNTERS
@@ -75,16 +118,28 @@ struct link_packet_counter {
 };
 
 
+#if LINK_STATS_PER_CHANNEL
+/* Recent Tx outcomes on a given channel */
+struct link_stats_channel {
+  uint16_t window;            /* One bit per attempt, 1 if ACKed, LSB is the latest */
+  uint8_t count;              /* Number of attempts in the window, up to 16 */
+};
+#endif /* LINK_STATS_PER_CHANNEL */
+
 /* All statistics of a given link */
 struct link_stats {
   clock_time_t last_tx_time;  /* Last Tx timestamp */
   uint16_t etx;               /* ETX using ETX_DIVISOR as fixed point divisor */
   int16_t rssi;               /* RSSI (received signal strength) */
   uint8_t freshness;          /* Freshness of the statistics */
-#if LINK_STATS_ETX_FROM_PACKET_COUNT
-  uint8_t tx_count;           /* Tx count, used for ETX calculation */
+  uint8_t tx_count;           /* Tx count, used for ETX calculation. With
+                                 EWMA, only counts up to 255 */
+#if LINK_STATS_ETX_ESTIMATOR != LINK_STATS_ETX_EWMA
   uint8_t ack_count;          /* ACK count, used for ETX calculation */
-#endif /* LINK_STATS_ETX_FROM_PACKET_COUNT */
+#endif /* LINK_STATS_ETX_ESTIMATOR != LINK_STATS_ETX_EWMA */
+#if LINK_STATS_PER_CHANNEL
+  struct link_stats_channel channels[LINK_STATS_NUM_CHANNELS];
+#endif /* LINK_STATS_PER_CHANNEL */
 
 #if LINK_STATS_PACKET_COUNTERS
   struct link_packet_counter cnt_current; /* packets in the current period */
@@ -106,5 +161,23 @@ void link_stats_init(void);
 void link_stats_packet_sent(const linkaddr_t *lladdr, int status, int numtx);
 /* Packet input callback. Updates statistics for receptions on a given link */
 void link_stats_input_callback(const linkaddr_t *lladdr);
+/* Number of Tx attempts the current ETX estimate is based on */
+uint8_t link_stats_num_samples(const struct link_stats *stats);
+/* Called with the neighbor's address after its ETX changed or its entry was
+ * created, or with NULL after all entries were removed */
+typedef void (* link_stats_callback_t)(const linkaddr_t *lladdr);
+/* Sets the function called on ETX changes, letting modules that cache values
+ * derived from link statistics (e.g. path costs) update them */
+void link_stats_set_callback(link_stats_callback_t callback);
+#if LINK_STATS_PER_CHANNEL
+/* Records the outcome of a single Tx attempt to lladdr on a given channel */
+void link_stats_channel_tx(const linkaddr_t *lladdr, uint8_t channel, int acked);
+/* Returns the ETX of a link on a given channel, or the link's ETX if the
+ * channel has not been used yet */
+uint16_t link_stats_channel_etx(const struct link_stats *stats, uint8_t channel);
+/* Returns the PDR of a channel, averaged over all neighbors, using
+ * LINK_STATS_PDR_SCALE as fixed point divisor. LINK_STATS_PDR_SCALE if unknown. */
+uint16_t link_stats_channel_pdr(uint8_t channel);
+#endif /* LINK_STATS_PER_CHANNEL */
 
 #endif /* LINK_STATS_H_ */
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2014, Hasso-Plattner-Institut.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Protects against replay attacks by comparing with the last
+ *         unicast or broadcast frame counters of the sender.
+ * \author
+ *         Konrad Krentz <konrad.krentz@gmail.com>
+ */
+
+/**
+ * \addtogroup llsec802154
+ * @{
+ */
+
+#include "net/mac/anti-replay.h"
+#include "net/packetbuf.h"
+#include "net/mac/llsec802154.h"
+#include <string.h>
+
+#define WORD_OF(counter) (((counter) / 32) & (ANTI_REPLAY_WORDS - 1))
+
+static struct anti_replay_stats stats;
+
+/*---------------------------------------------------------------------------*/
+static void
+window_init(struct anti_replay_window *w, uint32_t counter)
+{
+  w->last_counter = counter;
+#if ANTI_REPLAY_WINDOW
+  memset(w->seen, 0, sizeof(w->seen));
+  w->seen[WORD_OF(counter)] = 1UL << (counter % 32);
+#endif /* ANTI_REPLAY_WINDOW */
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_newer(uint32_t counter, uint32_t last, uint8_t wrapping)
+{
+  return wrapping ? (int32_t)(counter - last) > 0 : counter > last;
+}
+/*---------------------------------------------------------------------------*/
+static int
+window_check(struct anti_replay_window *w, uint32_t counter, uint8_t wrapping)
+{
+#if ANTI_REPLAY_WINDOW
+  uint32_t block;
+  uint32_t blocks;
+  uint32_t *word;
+  uint32_t bit;
+
+  if(is_newer(counter, w->last_counter, wrapping)) {
+    /*
+     * Slide the window: clear the words of the blocks we skip over. The
+     * difference is taken modulo 2^32 so that it holds across a wrap.
+     */
+    block = w->last_counter / 32;
+    blocks = (uint32_t)(counter / 32 - block) % (UINT32_MAX / 32 + 1);
+    if(blocks > ANTI_REPLAY_WORDS) {
+      blocks = ANTI_REPLAY_WORDS;
+    }
+    while(blocks-- > 0) {
+      w->seen[++block & (ANTI_REPLAY_WORDS - 1)] = 0;
+    }
+    w->last_counter = counter;
+  } else if(w->last_counter - counter >= ANTI_REPLAY_WINDOW) {
+    return ANTI_REPLAY_TOO_OLD;
+  }
+
+  word = &w->seen[WORD_OF(counter)];
+  bit = 1UL << (counter % 32);
+  if(*word & bit) {
+    return ANTI_REPLAY_DUPLICATE;
+  }
+  *word |= bit;
+  return ANTI_REPLAY_ACCEPTED;
+#else /* ANTI_REPLAY_WINDOW */
+  if(is_newer(counter, w->last_counter, wrapping)) {
+    w->last_counter = counter;
+    return ANTI_REPLAY_ACCEPTED;
+  }
+  return counter == w->last_counter ?
+    ANTI_REPLAY_DUPLICATE : ANTI_REPLAY_TOO_OLD;
+#endif /* ANTI_REPLAY_WINDOW */
+}
+/*---------------------------------------------------------------------------*/
+void
+anti_replay_init(struct anti_replay_info *info, uint32_t counter)
+{
+  int i;
+
+  for(i = 0; i < ANTI_REPLAY_KEYS; i++) {
+    window_init(&info->broadcast[i], counter);
+    window_init(&info->unicast[i], counter);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+anti_replay_check(struct anti_replay_info *info, uint8_t key_index,
+                  uint8_t flags, uint32_t counter)
+{
+  struct anti_replay_window *w;
+  int ret;
+
+  w = (flags & ANTI_REPLAY_BROADCAST)
+    ? &info->broadcast[key_index % ANTI_REPLAY_KEYS]
+    : &info->unicast[key_index % ANTI_REPLAY_KEYS];
+  ret = window_check(w, counter, flags & ANTI_REPLAY_WRAPPING);
+  switch(ret) {
+  case ANTI_REPLAY_ACCEPTED:
+    stats.accepted++;
+    break;
+  case ANTI_REPLAY_DUPLICATE:
+    stats.duplicates++;
+    break;
+  default:
+    stats.too_old++;
+    break;
+  }
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
+const struct anti_replay_stats *
+anti_replay_get_stats(void)
+{
+  return &stats;
+}
+/*---------------------------------------------------------------------------*/
+#if LLSEC802154_USES_FRAME_COUNTER
+
+/* This node's current frame counter value */
+static uint32_t counter;
+
+/*---------------------------------------------------------------------------*/
+void
+anti_replay_set_counter(void)
+{
+  frame802154_frame_counter_t reordered_counter;
+
+  ++counter;
+  reordered_counter.u32 = LLSEC802154_HTONL(counter);
+  
+  packetbuf_set_attr(PACKETBUF_ATTR_FRAME_COUNTER_BYTES_0_1, reordered_counter.u16[0]);
+  packetbuf_set_attr(PACKETBUF_ATTR_FRAME_COUNTER_BYTES_2_3, reordered_counter.u16[1]);
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+anti_replay_get_counter(void)
+{
+  frame802154_frame_counter_t disordered_counter;
+  
+  disordered_counter.u16[0] = packetbuf_attr(PACKETBUF_ATTR_FRAME_COUNTER_BYTES_0_1);
+  disordered_counter.u16[1] = packetbuf_attr(PACKETBUF_ATTR_FRAME_COUNTER_BYTES_2_3);
+  
+  return LLSEC802154_HTONL(disordered_counter.u32); 
+}
+/*---------------------------------------------------------------------------*/
+void
+anti_replay_init_info(struct anti_replay_info *info)
+{
+  anti_replay_init(info, anti_replay_get_counter());
+}
+/*---------------------------------------------------------------------------*/
+int
+anti_replay_was_replayed(struct anti_replay_info *info)
+{
+  uint8_t key_index = 0;
+
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  if(packetbuf_attr(PACKETBUF_ATTR_KEY_ID_MODE) != FRAME802154_IMPLICIT_KEY) {
+    key_index = packetbuf_attr(PACKETBUF_ATTR_KEY_INDEX);
+  }
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+
+  return anti_replay_check(info, key_index,
+                           packetbuf_holds_broadcast() ? ANTI_REPLAY_BROADCAST : 0,
+                           anti_replay_get_counter()) != ANTI_REPLAY_ACCEPTED;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* LLSEC802154_USES_FRAME_COUNTER */
+
+/** @} */
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2014, Hasso-Plattner-Institut.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Interface to anti-replay mechanisms.
+ * \author
+ *         Konrad Krentz <konrad.krentz@gmail.com>
+ */
+
+/**
+ * \addtogroup llsec802154
+ * @{
+ */
+
+#ifndef ANTI_REPLAY_H
+#define ANTI_REPLAY_H
+
+#include "contiki.h"
+
+/*
+ * Number of frame counters below the highest one received that are still
+ * accepted, provided they were not seen before (as in IPsec, RFC 6479).
+ * This lets frames that were legitimately reordered through. Must be a
+ * multiple of 32. With 0, only strictly increasing counters are accepted.
+ */
+#ifdef ANTI_REPLAY_CONF_WINDOW
+#define ANTI_REPLAY_WINDOW ANTI_REPLAY_CONF_WINDOW
+#else /* ANTI_REPLAY_CONF_WINDOW */
+#define ANTI_REPLAY_WINDOW 32
+#endif /* ANTI_REPLAY_CONF_WINDOW */
+
+#if ANTI_REPLAY_WINDOW % 32
+#error "ANTI_REPLAY_WINDOW must be a multiple of 32"
+#endif
+
+/*
+ * Words of the bitmap: one more than the window spans, rounded up to a
+ * power of two so that the word of a counter stays the same when 32-bit
+ * counters wrap around (see ANTI_REPLAY_WRAPPING).
+ */
+#if ANTI_REPLAY_WINDOW <= 32
+#define ANTI_REPLAY_WORDS 2
+#elif ANTI_REPLAY_WINDOW <= 96
+#define ANTI_REPLAY_WORDS 4
+#elif ANTI_REPLAY_WINDOW <= 224
+#define ANTI_REPLAY_WORDS 8
+#elif ANTI_REPLAY_WINDOW <= 480
+#define ANTI_REPLAY_WORDS 16
+#else
+#error "ANTI_REPLAY_WINDOW must not exceed 480"
+#endif
+
+/* Number of key indices with their own counters. Key index i uses the
+ * counters of slot i % ANTI_REPLAY_KEYS. */
+#ifdef ANTI_REPLAY_CONF_KEYS
+#define ANTI_REPLAY_KEYS ANTI_REPLAY_CONF_KEYS
+#else /* ANTI_REPLAY_CONF_KEYS */
+#define ANTI_REPLAY_KEYS 1
+#endif /* ANTI_REPLAY_CONF_KEYS */
+
+/* Return values of anti_replay_check() */
+#define ANTI_REPLAY_ACCEPTED   0 /**< New frame counter */
+#define ANTI_REPLAY_DUPLICATE  1 /**< Frame counter already seen */
+#define ANTI_REPLAY_TOO_OLD    2 /**< Frame counter left of the window */
+
+/* Flags of anti_replay_check() */
+#define ANTI_REPLAY_BROADCAST  0x01 /**< The frame was a broadcast */
+/**
+ * Counters wrap around and are compared in serial number arithmetic
+ * (RFC 1982): a counter is newer if it is less than 2^31 ahead of the
+ * highest one received. Meant for counters that legitimately wrap, such
+ * as the 32 low bits of the TSCH ASN, not for 802.15.4 frame counters.
+ */
+#define ANTI_REPLAY_WRAPPING   0x02
+
+struct anti_replay_window {
+  uint32_t last_counter;
+#if ANTI_REPLAY_WINDOW
+  /* Bit n % 32 of word (n / 32) % length is set once counter n was seen */
+  uint32_t seen[ANTI_REPLAY_WORDS];
+#endif /* ANTI_REPLAY_WINDOW */
+};
+
+struct anti_replay_info {
+  struct anti_replay_window broadcast[ANTI_REPLAY_KEYS];
+  struct anti_replay_window unicast[ANTI_REPLAY_KEYS];
+};
+
+struct anti_replay_stats {
+  unsigned long accepted;
+  unsigned long duplicates; /**< Replayed frames, within the window */
+  unsigned long too_old;    /**< Frames older than the window */
+};
+
+/**
+ * \brief Sets the frame counter packetbuf attributes.
+ */
+void anti_replay_set_counter(void);
+
+/**
+ * \brief Gets the frame counter from packetbuf.
+ */
+uint32_t anti_replay_get_counter(void);
+
+/**
+ * \brief Initializes the anti-replay information about the sender
+ * \param info Anti-replay information about the sender
+ */
+void anti_replay_init_info(struct anti_replay_info *info);
+
+/**
+ * \brief               Checks if received frame was replayed
+ * \param info          Anti-replay information about the sender
+ * \retval 0            <-> received frame was not replayed
+ */
+int anti_replay_was_replayed(struct anti_replay_info *info);
+
+/**
+ * \brief               Initializes all counters of a sender, marking
+ *                      a first frame counter as seen
+ * \param info          Anti-replay information about the sender
+ * \param counter       Frame counter of the first frame from the sender
+ */
+void anti_replay_init(struct anti_replay_info *info, uint32_t counter);
+
+/**
+ * \brief               Checks a frame counter and records it if new.
+ *                      Only to be called for authenticated frames.
+ * \param info          Anti-replay information about the sender
+ * \param key_index     Key index the frame was secured with
+ * \param flags         ANTI_REPLAY_BROADCAST if the frame was a broadcast,
+ *                      ANTI_REPLAY_WRAPPING if counters wrap around
+ * \param counter       Frame counter of the frame
+ * \return              ANTI_REPLAY_ACCEPTED, ANTI_REPLAY_DUPLICATE or
+ *                      ANTI_REPLAY_TOO_OLD
+ */
+int anti_replay_check(struct anti_replay_info *info, uint8_t key_index,
+                      uint8_t flags, uint32_t counter);
+
+/**
+ * \brief Gets the counts of accepted and dropped frames
+ */
+const struct anti_replay_stats *anti_replay_get_stats(void);
+
+#endif /* ANTI_REPLAY_H */
+
+/** @} */
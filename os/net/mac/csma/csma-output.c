@@ -537,3 +537,9 @@ csma_output_init(void)
   memb_init(&metadata_memb);
   memb_init(&neighbor_memb);
 }
+/*---------------------------------------------------------------------------*/
+int
+csma_output_packet_count(void)
+{
+  return MAX_QUEUED_PACKETS - memb_numfree(&packet_memb);
+}
@@ -47,5 +47,7 @@
 
 void csma_output_packet(mac_callback_t sent, void *ptr);
 void csma_output_init(void);
+/* Number of packets currently queued for transmission, all neighbors */
+int csma_output_packet_count(void);
 
 #endif /* CSMA_OUTPUT_H_ */
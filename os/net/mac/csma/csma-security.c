@@ -44,12 +44,13 @@
 
 #include "contiki.h"
 #include "net/mac/csma/csma.h"
-#include "net/mac/csma/anti-replay.h"
+#include "net/mac/anti-replay.h"
 #include "net/mac/csma/csma-security.h"
 #include "net/mac/framer/frame802154.h"
 #include "net/mac/framer/framer-802154.h"
 #include "net/mac/llsec802154.h"
 #include "net/netstack.h"
+#include "net/nbr-table.h"
 #include "net/packetbuf.h"
 #include "lib/ccm-star.h"
 #include "lib/aes-128.h"
@@ -99,6 +100,57 @@ csma_security_set_key(uint8_t index, const uint8_t *key)
 }
 
 #define N_KEYS (sizeof(keys) / sizeof(aes_key))
+
+#if CSMA_LLSEC_ANTI_REPLAY
+/* Frame counters received from each neighbor */
+NBR_TABLE(struct anti_replay_info, anti_replay_table);
+#endif /* CSMA_LLSEC_ANTI_REPLAY */
+/*---------------------------------------------------------------------------*/
+void
+csma_security_init(void)
+{
+#if CSMA_LLSEC_ANTI_REPLAY
+  nbr_table_register(anti_replay_table, NULL);
+#endif /* CSMA_LLSEC_ANTI_REPLAY */
+}
+/*---------------------------------------------------------------------------*/
+#if CSMA_LLSEC_ANTI_REPLAY
+static int
+anti_replay_accept(void)
+{
+  const linkaddr_t *sender = packetbuf_addr(PACKETBUF_ADDR_SENDER);
+  struct anti_replay_info *info;
+
+  info = nbr_table_get_from_lladdr(anti_replay_table, sender);
+  if(info == NULL) {
+    /* First frame from this neighbor: trust its counter */
+    info = nbr_table_add_lladdr(anti_replay_table, sender,
+                                NBR_TABLE_REASON_LLSEC, NULL);
+    if(info != NULL) {
+      anti_replay_init_info(info);
+    }
+    return 1;
+  }
+
+  switch(anti_replay_check(info, LLSEC_KEY_INDEX,
+                           packetbuf_holds_broadcast() ? ANTI_REPLAY_BROADCAST : 0,
+                           anti_replay_get_counter())) {
+  case ANTI_REPLAY_ACCEPTED:
+    return 1;
+  case ANTI_REPLAY_DUPLICATE:
+    LOG_INFO("replayed frame %lu from ",
+             (unsigned long)anti_replay_get_counter());
+    break;
+  default:
+    LOG_INFO("frame %lu out of the replay window from ",
+             (unsigned long)anti_replay_get_counter());
+    break;
+  }
+  LOG_INFO_LLADDR(sender);
+  LOG_INFO_("\n");
+  return 0;
+}
+#endif /* CSMA_LLSEC_ANTI_REPLAY */
 /*---------------------------------------------------------------------------*/
 static int
 aead(uint8_t hdrlen, int forward)
@@ -285,12 +337,20 @@ csma_security_parse_frame(void)
     return FRAMER_FAILED;
   }
 
-  /* TODO anti-reply protection */
+#if CSMA_LLSEC_ANTI_REPLAY
+  if(!anti_replay_accept()) {
+    return FRAMER_FAILED;
+  }
+#endif /* CSMA_LLSEC_ANTI_REPLAY */
   return hdr_len;
 }
 /*---------------------------------------------------------------------------*/
 #else
 /* The "unsecure" version of the create frame / parse frame */
+void
+csma_security_init(void)
+{
+}
 int
 csma_security_create_frame(void)
 {
@@ -71,4 +71,12 @@
 #define CSMA_LLSEC_MAXKEYS 1
 #endif
 
+/* Drop replayed frames, based on the frame counters received from each
+ * neighbor. Requires frame counters to persist across reboots. */
+#ifdef CSMA_CONF_LLSEC_ANTI_REPLAY
+#define CSMA_LLSEC_ANTI_REPLAY CSMA_CONF_LLSEC_ANTI_REPLAY
+#else
+#define CSMA_LLSEC_ANTI_REPLAY 0
+#endif
+
 #endif /* CSMA_SECURITY_H_ */
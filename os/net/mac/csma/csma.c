@@ -149,6 +149,7 @@ init(void)
   csma_security_set_key(0, key);
 #endif
 #endif /* LLSEC802154_USES_AUX_HEADER */
+  csma_security_init();
   csma_output_init();
   on();
 }
@@ -81,6 +81,7 @@
 extern const struct mac_driver csma_driver;
 
 /* CSMA security framer functions */
+void csma_security_init(void);
 int csma_security_create_frame(void);
 int csma_security_parse_frame(void);
 
@@ -102,6 +102,83 @@ addr_len(uint8_t mode)
   }
 }
 /*----------------------------------------------------------------------------*/
+/**
+ *  \brief Position of the addressing fields of a frame, as offsets from
+ *  the first byte after the sequence number.
+ */
+typedef struct {
+  uint8_t panid;           /**<  Bit 0: has dest PAN ID, bit 1: has source PAN ID */
+  uint8_t dest_addr;       /**<  Offset of the destination address */
+  uint8_t src_pid;         /**<  Offset of the source PAN ID */
+  uint8_t src_addr;        /**<  Offset of the source address */
+  uint8_t end;             /**<  Total length of the addressing fields */
+} field_layout_t;
+
+#define LAYOUT_HAS_DEST_PANID 0x01
+#define LAYOUT_HAS_SRC_PANID  0x02
+
+#if FRAME802154_LAYOUT_TABLE
+/*
+ * The layout only depends on the address modes, the frame version, the
+ * PAN ID compression bit and whether the frame is an ACK. These are
+ * packed into an 8-bit key, in the same bit positions as in the second
+ * FCF byte for the first three.
+ */
+#define LAYOUT_KEY(fcf) \
+  ((((fcf)->src_addr_mode & 3) << 6) | (((fcf)->frame_version & 3) << 4) | \
+   (((fcf)->dest_addr_mode & 3) << 2) | (((fcf)->panid_compression & 1) << 1) | \
+   ((fcf)->frame_type == FRAME802154_ACKFRAME))
+
+/* Decode a key back into its FCF fields */
+#define K_ACK(k)  ((k) & 1)
+#define K_PC(k)   (((k) >> 1) & 1)
+#define K_DST(k)  (((k) >> 2) & 3)
+#define K_VER(k)  (((k) >> 4) & 3)
+#define K_SRC(k)  (((k) >> 6) & 3)
+#define K_ADDR_LEN(mode) ((mode) == FRAME802154_SHORTADDRMODE ? 2 : \
+                          ((mode) == FRAME802154_LONGADDRMODE ? 8 : 0))
+
+/* Same rules as frame802154_has_panid(), see that function for details */
+#define K_DEST_PANID_2015(k) \
+  ((K_DST(k) == 0 && K_SRC(k) == 0 && K_PC(k) == 1) || \
+   (K_DST(k) != 0 && K_SRC(k) == 0 && K_PC(k) == 0) || \
+   (K_DST(k) == 3 && K_SRC(k) == 3 && K_PC(k) == 0) || \
+   (K_DST(k) == 2 && K_SRC(k) != 0) || \
+   (K_DST(k) != 0 && K_SRC(k) == 2))
+#define K_SRC_PANID_2015(k) \
+  (K_PC(k) == 0 && \
+   ((K_DST(k) == 0 && K_SRC(k) == 3) || \
+    (K_DST(k) == 0 && K_SRC(k) == 2) || \
+    (K_DST(k) == 2 && K_SRC(k) == 2) || \
+    (K_DST(k) == 2 && K_SRC(k) == 3) || \
+    (K_DST(k) == 3 && K_SRC(k) == 2)))
+#define K_DEST_PANID(k) (K_VER(k) == FRAME802154_IEEE802154_2015 ? \
+                         K_DEST_PANID_2015(k) : (!K_ACK(k) && K_DST(k) != 0))
+#define K_SRC_PANID(k) (K_VER(k) == FRAME802154_IEEE802154_2015 ? \
+                        K_SRC_PANID_2015(k) : \
+                        (!K_ACK(k) && !K_PC(k) && K_SRC(k) != 0))
+
+/* A PAN ID is only present on the air along with its address */
+#define K_DEST_ADDR(k) ((K_DST(k) != 0 && K_DEST_PANID(k)) ? 2 : 0)
+#define K_SRC_PID(k)   (K_DEST_ADDR(k) + K_ADDR_LEN(K_DST(k)))
+#define K_SRC_ADDR(k)  (K_SRC_PID(k) + \
+                        ((K_SRC(k) != 0 && K_SRC_PANID(k)) ? 2 : 0))
+#define K_END(k)       (K_SRC_ADDR(k) + K_ADDR_LEN(K_SRC(k)))
+
+#define LAYOUT(k) { \
+    (K_DEST_PANID(k) ? LAYOUT_HAS_DEST_PANID : 0) | \
+    (K_SRC_PANID(k) ? LAYOUT_HAS_SRC_PANID : 0), \
+    K_DEST_ADDR(k), K_SRC_PID(k), K_SRC_ADDR(k), K_END(k) }
+#define LAYOUT4(k)   LAYOUT(k), LAYOUT(k + 1), LAYOUT(k + 2), LAYOUT(k + 3)
+#define LAYOUT16(k)  LAYOUT4(k), LAYOUT4(k + 4), LAYOUT4(k + 8), LAYOUT4(k + 12)
+#define LAYOUT64(k)  LAYOUT16(k), LAYOUT16(k + 16), LAYOUT16(k + 32), \
+                     LAYOUT16(k + 48)
+
+static const field_layout_t layouts[256] = {
+  LAYOUT64(0), LAYOUT64(64), LAYOUT64(128), LAYOUT64(192)
+};
+#endif /* FRAME802154_LAYOUT_TABLE */
+/*----------------------------------------------------------------------------*/
 #if LLSEC802154_USES_AUX_HEADER && LLSEC802154_USES_EXPLICIT_KEYS
 static uint8_t
 get_key_id_len(uint8_t key_id_mode)
@@ -145,6 +222,11 @@ frame802154_has_panid(frame802154_fcf_t *fcf, int *has_src_pan_id, int *has_dest
     return;
   }
 
+#if FRAME802154_LAYOUT_TABLE
+  src_pan_id = layouts[LAYOUT_KEY(fcf)].panid;
+  dest_pan_id = src_pan_id & LAYOUT_HAS_DEST_PANID;
+  src_pan_id = (src_pan_id & LAYOUT_HAS_SRC_PANID) != 0;
+#else /* FRAME802154_LAYOUT_TABLE */
   if(fcf->frame_version == FRAME802154_IEEE802154_2015) {
     /*
      * IEEE 802.15.4-2015
@@ -192,6 +274,7 @@ frame802154_has_panid(frame802154_fcf_t *fcf, int *has_src_pan_id, int *has_dest
       }
     }
   }
+#endif /* FRAME802154_LAYOUT_TABLE */
 
   if(has_src_pan_id != NULL) {
     *has_src_pan_id = src_pan_id;
@@ -201,6 +284,30 @@ frame802154_has_panid(frame802154_fcf_t *fcf, int *has_src_pan_id, int *has_dest
   }
 }
 /*---------------------------------------------------------------------------*/
+/* Returns the position of the addressing fields for a given FCF. Uses
+ * the precomputed table if enabled, and fills in buf otherwise. */
+static const field_layout_t *
+get_layout(frame802154_fcf_t *fcf, field_layout_t *buf)
+{
+#if FRAME802154_LAYOUT_TABLE
+  (void)buf;
+  return &layouts[LAYOUT_KEY(fcf)];
+#else /* FRAME802154_LAYOUT_TABLE */
+  int has_src_panid;
+  int has_dest_panid;
+
+  frame802154_has_panid(fcf, &has_src_panid, &has_dest_panid);
+  buf->panid = (has_dest_panid ? LAYOUT_HAS_DEST_PANID : 0) |
+    (has_src_panid ? LAYOUT_HAS_SRC_PANID : 0);
+  /* A PAN ID is only present on the air along with its address */
+  buf->dest_addr = (fcf->dest_addr_mode && has_dest_panid) ? 2 : 0;
+  buf->src_pid = buf->dest_addr + addr_len(fcf->dest_addr_mode);
+  buf->src_addr = buf->src_pid + ((fcf->src_addr_mode && has_src_panid) ? 2 : 0);
+  buf->end = buf->src_addr + addr_len(fcf->src_addr_mode);
+  return buf;
+#endif /* FRAME802154_LAYOUT_TABLE */
+}
+/*---------------------------------------------------------------------------*/
 /* Check if the destination PAN ID, if any, matches ours */
 int
 frame802154_check_dest_panid(frame802154_t *frame)
@@ -288,8 +395,8 @@ frame802154_extract_linkaddr(frame802154_t *frame,
 static void
 field_len(frame802154_t *p, field_length_t *flen)
 {
-  int has_src_panid;
-  int has_dest_panid;
+  field_layout_t layout_buf;
+  const field_layout_t *layout;
 
   /* init flen to zeros */
   memset(flen, 0, sizeof(field_length_t));
@@ -312,13 +419,13 @@ field_len(frame802154_t *p, field_length_t *flen)
     }
   }
 
-  frame802154_has_panid(&p->fcf, &has_src_panid, &has_dest_panid);
+  layout = get_layout(&p->fcf, &layout_buf);
 
-  if(has_src_panid) {
+  if(layout->panid & LAYOUT_HAS_SRC_PANID) {
     flen->src_pid_len = 2;
   }
 
-  if(has_dest_panid) {
+  if(layout->panid & LAYOUT_HAS_DEST_PANID) {
     flen->dest_pid_len = 2;
   }
 
@@ -500,10 +607,11 @@ int
 frame802154_parse(uint8_t *data, int len, frame802154_t *pf)
 {
   uint8_t *p;
+  uint8_t *q;
   frame802154_fcf_t fcf;
   int c;
-  int has_src_panid;
-  int has_dest_panid;
+  field_layout_t layout_buf;
+  const field_layout_t *layout;
 #if LLSEC802154_USES_EXPLICIT_KEYS
   uint8_t key_id_mode;
 #endif /* LLSEC802154_USES_EXPLICIT_KEYS */
@@ -524,34 +632,31 @@ frame802154_parse(uint8_t *data, int len, frame802154_t *pf)
     p++;
   }
 
-  frame802154_has_panid(&fcf, &has_src_panid, &has_dest_panid);
+  /* All addressing fields are at fixed offsets given the FCF */
+  layout = get_layout(&fcf, &layout_buf);
+  if(p - data + layout->end > len) {
+    return 0;
+  }
 
   /* Destination address, if any */
   if(fcf.dest_addr_mode) {
-    if(has_dest_panid) {
+    if(layout->panid & LAYOUT_HAS_DEST_PANID) {
       /* Destination PAN */
       pf->dest_pid = p[0] + (p[1] << 8);
-      p += 2;
     } else {
       pf->dest_pid = 0;
     }
 
     /* Destination address */
-/*     l = addr_len(fcf.dest_addr_mode); */
-/*     for(c = 0; c < l; c++) { */
-/*       pf->dest_addr.u8[c] = p[l - c - 1]; */
-/*     } */
-/*     p += l; */
+    q = p + layout->dest_addr;
     if(fcf.dest_addr_mode == FRAME802154_SHORTADDRMODE) {
       linkaddr_copy((linkaddr_t *)&(pf->dest_addr), &linkaddr_null);
-      pf->dest_addr[0] = p[1];
-      pf->dest_addr[1] = p[0];
-      p += 2;
+      pf->dest_addr[0] = q[1];
+      pf->dest_addr[1] = q[0];
     } else if(fcf.dest_addr_mode == FRAME802154_LONGADDRMODE) {
       for(c = 0; c < 8; c++) {
-        pf->dest_addr[c] = p[7 - c];
+        pf->dest_addr[c] = q[7 - c];
       }
-      p += 8;
     }
   } else {
     linkaddr_copy((linkaddr_t *)&(pf->dest_addr), &linkaddr_null);
@@ -561,10 +666,10 @@ frame802154_parse(uint8_t *data, int len, frame802154_t *pf)
   /* Source address, if any */
   if(fcf.src_addr_mode) {
     /* Source PAN */
-    if(has_src_panid) {
-      pf->src_pid = p[0] + (p[1] << 8);
-      p += 2;
-      if(!has_dest_panid) {
+    if(layout->panid & LAYOUT_HAS_SRC_PANID) {
+      q = p + layout->src_pid;
+      pf->src_pid = q[0] + (q[1] << 8);
+      if(!(layout->panid & LAYOUT_HAS_DEST_PANID)) {
         pf->dest_pid = pf->src_pid;
       }
     } else {
@@ -572,26 +677,21 @@ frame802154_parse(uint8_t *data, int len, frame802154_t *pf)
     }
 
     /* Source address */
-/*     l = addr_len(fcf.src_addr_mode); */
-/*     for(c = 0; c < l; c++) { */
-/*       pf->src_addr.u8[c] = p[l - c - 1]; */
-/*     } */
-/*     p += l; */
+    q = p + layout->src_addr;
     if(fcf.src_addr_mode == FRAME802154_SHORTADDRMODE) {
       linkaddr_copy((linkaddr_t *)&(pf->src_addr), &linkaddr_null);
-      pf->src_addr[0] = p[1];
-      pf->src_addr[1] = p[0];
-      p += 2;
+      pf->src_addr[0] = q[1];
+      pf->src_addr[1] = q[0];
     } else if(fcf.src_addr_mode == FRAME802154_LONGADDRMODE) {
       for(c = 0; c < 8; c++) {
-        pf->src_addr[c] = p[7 - c];
+        pf->src_addr[c] = q[7 - c];
       }
-      p += 8;
     }
   } else {
     linkaddr_copy((linkaddr_t *)&(pf->src_addr), &linkaddr_null);
     pf->src_pid = 0;
   }
+  p += layout->end;
 
 #if LLSEC802154_USES_AUX_HEADER
   if(fcf.security_enabled) {
@@ -92,6 +92,14 @@ frame-filtering-friendly on some platforms) */
 #define FRAME802154_SUPPR_SEQNO 0
 #endif /* FRAME802154_CONF_SUPPR_SEQNO */
 
+/* Look up the addressing field layout of each frame in a 256-entry
+table (1280 bytes of ROM) instead of deriving it from the FCF */
+#ifdef FRAME802154_CONF_LAYOUT_TABLE
+#define FRAME802154_LAYOUT_TABLE FRAME802154_CONF_LAYOUT_TABLE
+#else /* FRAME802154_CONF_LAYOUT_TABLE */
+#define FRAME802154_LAYOUT_TABLE 0
+#endif /* FRAME802154_CONF_LAYOUT_TABLE */
+
 /* Macros & Defines */
 
 /** \brief These are some definitions of values used in the FCF.  See the 802.15.4 spec for details.
@@ -463,39 +463,45 @@ frame802154e_parse_mlme_long_ie(const uint8_t *buf, int len,
   return -1;
 }
 
-/* Parse all IEEE 802.15.4e Information Elements (IE) from a frame */
-int
-frame802154e_parse_information_elements(const uint8_t *buf, uint8_t buf_size,
-    struct ieee802154_ies *ies)
+enum {PARSING_HEADER_IE, PARSING_PAYLOAD_IE, PARSING_MLME_SUBIE};
+
+/* Start iterating over the IEs found in buf */
+void
+frame802154e_ie_iterator_init(struct frame802154e_ie_iterator *it,
+    const uint8_t *buf, uint8_t buf_size)
+{
+  it->start = buf;
+  it->buf = buf;
+  it->buf_size = buf_size;
+  /* Always look for a header IE first (at least "list termination 1") */
+  it->state = PARSING_HEADER_IE;
+  it->header_only = 0;
+  it->nested_mlme_len = 0;
+  it->payload_ie_offset = 0;
+}
+
+/* Locate the next IE, without decoding its content */
+static inline int
+ie_next(struct frame802154e_ie_iterator *it, struct frame802154e_ie *ie)
 {
-  const uint8_t *start = buf;
   uint16_t ie_desc;
   uint8_t type;
-  uint8_t id;
-  uint16_t len = 0;
-  int nested_mlme_len = 0;
-  enum {PARSING_HEADER_IE, PARSING_PAYLOAD_IE, PARSING_MLME_SUBIE} parsing_state;
+  uint16_t len;
 
-  if(ies == NULL) {
-    return -1;
-  }
-
-  /* Always look for a header IE first (at least "list termination 1") */
-  parsing_state = PARSING_HEADER_IE;
-  ies->ie_payload_ie_offset = 0;
-
-  /* Loop over all IEs */
-  while(buf_size > 0) {
-    if(buf_size < 2) { /* Not enough space for IE descriptor */
+  while(it->buf_size > 0) {
+    if(it->header_only && it->state != PARSING_HEADER_IE) {
+      return 0;
+    }
+    if(it->buf_size < 2) { /* Not enough space for IE descriptor */
       return -1;
     }
-    READ16(buf, ie_desc);
-    buf_size -= 2;
-    buf += 2;
+    READ16(it->buf, ie_desc);
+    it->buf_size -= 2;
+    it->buf += 2;
     type = ie_desc & 0x8000 ? 1 : 0; /* b15 */
-    LOG_DBG("ie type %u, current state %u\n", type, parsing_state);
+    LOG_DBG("ie type %u, current state %u\n", type, it->state);
 
-    switch(parsing_state) {
+    switch(it->state) {
       case PARSING_HEADER_IE:
         if(type != 0) {
           LOG_ERR("header ie: wrong type %04x\n", ie_desc);
@@ -503,36 +509,25 @@ frame802154e_parse_information_elements(const uint8_t *buf, uint8_t buf_size,
         }
         /* Header IE: 2 bytes descriptor, c.f. fig 48n in IEEE 802.15.4e */
         len = ie_desc & 0x007f; /* b0-b6 */
-        id = (ie_desc & 0x7f80) >> 7; /* b7-b14 */
-        LOG_DBG("header ie: len %u id %x\n", len, id);
-        switch(id) {
-          case HEADER_IE_LIST_TERMINATION_1:
-            if(len == 0) {
-              /* End of payload IE list, now expect payload IEs */
-              parsing_state = PARSING_PAYLOAD_IE;
-              ies->ie_payload_ie_offset = buf - start; /* Save IE header len */
-              LOG_DBG("list termination 1, look for payload IEs\n");
-            } else {
-              LOG_ERR("list termination 1, wrong len %u\n", len);
-              return -1;
-            }
-            break;
-          case HEADER_IE_LIST_TERMINATION_2:
+        ie->kind = FRAME802154E_IE_HEADER;
+        ie->id = (ie_desc & 0x7f80) >> 7; /* b7-b14 */
+        LOG_DBG("header ie: len %u id %x\n", len, ie->id);
+        if(ie->id == HEADER_IE_LIST_TERMINATION_1 ||
+           ie->id == HEADER_IE_LIST_TERMINATION_2) {
+          if(len != 0) {
+            LOG_ERR("list termination, wrong len %u\n", len);
+            return -1;
+          }
+          it->payload_ie_offset = it->buf - it->start; /* Save IE header len */
+          if(ie->id == HEADER_IE_LIST_TERMINATION_2) {
             /* End of IE parsing */
-            if(len == 0) {
-              ies->ie_payload_ie_offset = buf - start; /* Save IE header len */
-              LOG_DBG("list termination 2\n");
-              return buf + len - start;
-            } else {
-              LOG_ERR("list termination 2, wrong len %u\n", len);
-              return -1;
-            }
-          default:
-            if(len > buf_size || frame802154e_parse_header_ie(buf, len, id, ies) == -1) {
-              LOG_ERR("failed to parse\n");
-              return -1;
-            }
-            break;
+            LOG_DBG("list termination 2\n");
+            return 0;
+          }
+          /* End of header IE list, now expect payload IEs */
+          it->state = PARSING_PAYLOAD_IE;
+          LOG_DBG("list termination 1, look for payload IEs\n");
+          continue;
         }
         break;
       case PARSING_PAYLOAD_IE:
@@ -542,90 +537,172 @@ frame802154e_parse_information_elements(const uint8_t *buf, uint8_t buf_size,
         }
         /* Payload IE: 2 bytes descriptor, c.f. fig 48o in IEEE 802.15.4e */
         len = ie_desc & 0x7ff; /* b0-b10 */
-        id = (ie_desc & 0x7800) >> 11; /* b11-b14 */
-        LOG_DBG("payload ie: len %u id %x\n", len, id);
-        switch(id) {
-          case PAYLOAD_IE_MLME:
-            /* Now expect 'len' bytes of MLME sub-IEs */
-            parsing_state = PARSING_MLME_SUBIE;
-            nested_mlme_len = len;
-            len = 0; /* Reset len as we want to read subIEs and not jump over them */
-            LOG_DBG("entering MLME ie with len %u\n", nested_mlme_len);
-            break;
-#if TSCH_WITH_SIXTOP
-          case PAYLOAD_IE_IETF:
-            switch(*buf) {
-              case IETF_IE_6TOP:
-                /*
-                 * buf points to the Sub-ID field, a one-octet field, now;
-                 * advance it by one and use the result as the head pointer of
-                 * 6top IE Content.
-                 */
-                ies->sixtop_ie_content_ptr = buf + 1;
-                /*
-                 * Similarly as above, subtract 1 (one octet) from len, which
-                 * includes the length of Sub-ID field, and use the result as
-                 * the length of 6top IE Content.
-                 */
-                ies->sixtop_ie_content_len = len - 1;
-                break;
-              default:
-                LOG_ERR("frame802154e: unsupported IETF sub-IE %u\n", *buf);
-                break;
-            }
-            break;
-#endif /* TSCH_WITH_SIXTOP */
-          case PAYLOAD_IE_LIST_TERMINATION:
-            LOG_DBG("payload ie list termination %u\n", len);
-            return (len == 0) ? buf + len - start : -1;
-          default:
-            LOG_ERR("non-supported payload ie\n");
-            return -1;
+        ie->kind = FRAME802154E_IE_PAYLOAD;
+        ie->id = (ie_desc & 0x7800) >> 11; /* b11-b14 */
+        LOG_DBG("payload ie: len %u id %x\n", len, ie->id);
+        if(ie->id == PAYLOAD_IE_MLME) {
+          /* Now expect 'len' bytes of MLME sub-IEs */
+          it->state = PARSING_MLME_SUBIE;
+          it->nested_mlme_len = len;
+          LOG_DBG("entering MLME ie with len %u\n", len);
+          continue;
+        }
+        if(ie->id == PAYLOAD_IE_LIST_TERMINATION) {
+          LOG_DBG("payload ie list termination %u\n", len);
+          return len == 0 ? 0 : -1;
         }
         break;
-      case PARSING_MLME_SUBIE:
+      default: /* PARSING_MLME_SUBIE */
         /* MLME sub-IE: 2 bytes descriptor, c.f. fig 48q in IEEE 802.15.4e */
         /* type == 0 means short sub-IE, type == 1 means long sub-IE */
         if(type == 0) {
           /* Short sub-IE, c.f. fig 48r in IEEE 802.15.4e */
           len = ie_desc & 0x00ff; /* b0-b7 */
-          id = (ie_desc & 0x7f00) >> 8; /* b8-b14 */
-          LOG_DBG("short mlme ie len %u id %x\n", len, id);
-          if(len > buf_size || frame802154e_parse_mlme_short_ie(buf, len, id, ies) == -1) {
-            LOG_ERR("failed to parse ie\n");
-            return -1;
-          }
+          ie->kind = FRAME802154E_IE_MLME_SHORT;
+          ie->id = (ie_desc & 0x7f00) >> 8; /* b8-b14 */
         } else {
           /* Long sub-IE, c.f. fig 48s in IEEE 802.15.4e */
           len = ie_desc & 0x7ff; /* b0-b10 */
-          id = (ie_desc & 0x7800) >> 11; /* b11-b14 */
-          LOG_DBG("long mlme ie len %u id %x\n", len, id);
-          if(len > buf_size || frame802154e_parse_mlme_long_ie(buf, len, id, ies) == -1) {
-            LOG_ERR("failed to parse ie\n");
-            return -1;
-          }
+          ie->kind = FRAME802154E_IE_MLME_LONG;
+          ie->id = (ie_desc & 0x7800) >> 11; /* b11-b14 */
         }
+        LOG_DBG("mlme ie len %u id %x\n", len, ie->id);
         /* Update remaining nested MLME len */
-        nested_mlme_len -= 2 + len;
-        if(nested_mlme_len < 0) {
-          LOG_ERR("found more sub-IEs than initially advertised\n");
+        it->nested_mlme_len -= 2 + len;
+        if(it->nested_mlme_len < 0) {
           /* We found more sub-IEs than initially advertised */
+          LOG_ERR("found more sub-IEs than initially advertised\n");
           return -1;
         }
-        if(nested_mlme_len == 0) {
+        if(it->nested_mlme_len == 0) {
+          /* End of MLME IE, look for another payload IE */
           LOG_DBG("end of MLME IE parsing\n");
-          /* End of IE parsing, look for another payload IE */
-          parsing_state = PARSING_PAYLOAD_IE;
+          it->state = PARSING_PAYLOAD_IE;
         }
         break;
     }
-    buf += len;
-    buf_size -= len;
+
+    if(len > it->buf_size) {
+      LOG_ERR("ie longer than frame\n");
+      return -1;
+    }
+    ie->len = len;
+    ie->content = it->buf;
+    it->buf += len;
+    it->buf_size -= len;
+    return 1;
+  }
+
+  if(it->state == PARSING_HEADER_IE) {
+    it->payload_ie_offset = it->buf - it->start; /* Save IE header len */
+  }
+  return 0;
+}
+
+int
+frame802154e_ie_next(struct frame802154e_ie_iterator *it,
+    struct frame802154e_ie *ie)
+{
+  return ie_next(it, ie);
+}
+
+/* Skip to the next IE of a given kind and ID */
+int
+frame802154e_ie_find(struct frame802154e_ie_iterator *it,
+    uint8_t kind, uint8_t id, struct frame802154e_ie *ie)
+{
+  int ret;
+
+  while((ret = ie_next(it, ie)) > 0) {
+    if(ie->kind == kind && ie->id == id) {
+      return 1;
+    }
+  }
+  return ret;
+}
+
+/* Decode a single IE located by the iterator */
+static inline int
+ie_decode(const struct frame802154e_ie *ie, struct ieee802154_ies *ies)
+{
+  switch(ie->kind) {
+    case FRAME802154E_IE_HEADER:
+      return frame802154e_parse_header_ie(ie->content, ie->len, ie->id, ies);
+    case FRAME802154E_IE_MLME_SHORT:
+      return frame802154e_parse_mlme_short_ie(ie->content, ie->len, ie->id, ies);
+    case FRAME802154E_IE_MLME_LONG:
+      return frame802154e_parse_mlme_long_ie(ie->content, ie->len, ie->id, ies);
+    case FRAME802154E_IE_PAYLOAD:
+#if TSCH_WITH_SIXTOP
+      if(ie->id == PAYLOAD_IE_IETF) {
+        if(ie->len > 0 && ie->content[0] == IETF_IE_6TOP) {
+          /*
+           * The content starts with the one-octet Sub-ID field; the 6top
+           * IE Content follows it.
+           */
+          if(ies != NULL) {
+            ies->sixtop_ie_content_ptr = ie->content + 1;
+            ies->sixtop_ie_content_len = ie->len - 1;
+          }
+        } else {
+          LOG_ERR("frame802154e: unsupported IETF sub-IE\n");
+        }
+        return ie->len;
+      }
+#endif /* TSCH_WITH_SIXTOP */
+      LOG_ERR("non-supported payload ie\n");
+      break;
+  }
+  return -1;
+}
+
+int
+frame802154e_ie_decode(const struct frame802154e_ie *ie,
+    struct ieee802154_ies *ies)
+{
+  return ie_decode(ie, ies);
+}
+
+/* Length of the header IEs, without looking at the payload IEs */
+int
+frame802154e_ie_header_len(const uint8_t *buf, uint8_t buf_size)
+{
+  struct frame802154e_ie_iterator it;
+  struct frame802154e_ie ie;
+  int ret;
+
+  frame802154e_ie_iterator_init(&it, buf, buf_size);
+  it.header_only = 1;
+  do {
+    ret = ie_next(&it, &ie);
+  } while(ret > 0);
+  return ret < 0 ? -1 : it.payload_ie_offset;
+}
+
+/* Parse all IEEE 802.15.4e Information Elements (IE) from a frame */
+int
+frame802154e_parse_information_elements(const uint8_t *buf, uint8_t buf_size,
+    struct ieee802154_ies *ies)
+{
+  struct frame802154e_ie_iterator it;
+  struct frame802154e_ie ie;
+  int ret;
+
+  if(ies == NULL) {
+    return -1;
   }
 
-  if(parsing_state == PARSING_HEADER_IE) {
-    ies->ie_payload_ie_offset = buf - start; /* Save IE header len */
+  frame802154e_ie_iterator_init(&it, buf, buf_size);
+  while((ret = ie_next(&it, &ie)) > 0) {
+    if(ie_decode(&ie, ies) == -1) {
+      LOG_ERR("failed to parse ie\n");
+      ret = -1;
+      break;
+    }
   }
 
-  return buf - start;
+  /* The header IE length is reported even on error: callers use it to
+   * skip header IEs in front of (encrypted) payload IEs */
+  ies->ie_payload_ie_offset = it.payload_ie_offset;
+  return ret < 0 ? -1 : it.buf - it.start;
 }
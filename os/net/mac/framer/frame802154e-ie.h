@@ -92,6 +92,34 @@ struct ieee802154_ies {
 #endif /* TSCH_WITH_SIXTOP */
 };
 
+/* Kinds of Information Elements returned by the IE iterator */
+enum frame802154e_ie_kind {
+  FRAME802154E_IE_HEADER,
+  FRAME802154E_IE_PAYLOAD,
+  FRAME802154E_IE_MLME_SHORT,
+  FRAME802154E_IE_MLME_LONG,
+};
+
+/* A single IE as located by the iterator. The content is not decoded. */
+struct frame802154e_ie {
+  uint8_t kind;          /* enum frame802154e_ie_kind */
+  uint8_t id;            /* Element ID, group ID or sub-ID depending on kind */
+  uint16_t len;          /* Length of the content */
+  const uint8_t *content;
+};
+
+/* Lazy iterator over the IEs of a frame. List terminations and the
+ * nesting of MLME sub-IEs are handled internally. */
+struct frame802154e_ie_iterator {
+  const uint8_t *start;
+  const uint8_t *buf;
+  uint8_t buf_size;
+  uint8_t state;
+  uint8_t header_only;
+  int16_t nested_mlme_len;
+  uint8_t payload_ie_offset; /* Length of the header IEs, once known */
+};
+
 /** Insert various Information Elements **/
 /* Header IE. ACK/NACK time correction. Used in enhanced ACKs */
 int frame80215e_create_ie_header_ack_nack_time_correction(uint8_t *buf, int len,
@@ -132,4 +160,22 @@ int frame80215e_create_ie_tsch_channel_hopping_sequence(uint8_t *buf, int len,
 int frame802154e_parse_information_elements(const uint8_t *buf, uint8_t buf_size,
     struct ieee802154_ies *ies);
 
+/* Start iterating over the IEs found in buf */
+void frame802154e_ie_iterator_init(struct frame802154e_ie_iterator *it,
+    const uint8_t *buf, uint8_t buf_size);
+/* Locate the next IE. Returns 1 if one was found, 0 at the end of the IE
+ * list and -1 if the list is malformed */
+int frame802154e_ie_next(struct frame802154e_ie_iterator *it,
+    struct frame802154e_ie *ie);
+/* Skip to the next IE of a given kind and ID. Returns 1 if found, 0 if
+ * not and -1 if the list is malformed */
+int frame802154e_ie_find(struct frame802154e_ie_iterator *it,
+    uint8_t kind, uint8_t id, struct frame802154e_ie *ie);
+/* Decode a single IE located by the iterator into ies */
+int frame802154e_ie_decode(const struct frame802154e_ie *ie,
+    struct ieee802154_ies *ies);
+/* Length of the header IEs, i.e. offset of the payload IEs if any,
+ * without looking at the payload IEs. Returns -1 on error. */
+int frame802154e_ie_header_len(const uint8_t *buf, uint8_t buf_size);
+
 #endif /* FRAME_802154E_H */
@@ -181,6 +181,15 @@
 #define TSCH_JOIN_SECURED_ONLY LLSEC802154_ENABLED
 #endif
 
+/* Drop secured frames whose ASN was already seen from the same neighbor.
+ * The ASN is the frame counter of TSCH (see net/mac/anti-replay.h). Only
+ * neighbors that have a TSCH queue are tracked. */
+#ifdef TSCH_CONF_SECURITY_ANTI_REPLAY
+#define TSCH_SECURITY_ANTI_REPLAY TSCH_CONF_SECURITY_ANTI_REPLAY
+#else
+#define TSCH_SECURITY_ANTI_REPLAY 0
+#endif
+
 /* By default, join any PAN ID. Otherwise, wait for an EB from IEEE802154_PANID */
 #ifdef TSCH_CONF_JOIN_MY_PANID_ONLY
 #define TSCH_JOIN_MY_PANID_ONLY TSCH_CONF_JOIN_MY_PANID_ONLY
@@ -67,6 +67,38 @@ static aes_key keys[] = {
 };
 #define N_KEYS (sizeof(keys) / sizeof(aes_key))
 
+/*---------------------------------------------------------------------------*/
+#if TSCH_SECURITY_ANTI_REPLAY
+/* The ASN serves as frame counter: it is part of the nonce, hence
+ * authenticated, and a given neighbor sends at most one frame per ASN.
+ * Only its 32 low bits are kept, compared modulo 2^32 (TSCH_ASN_DIFF
+ * semantics) so that tracked neighbors survive the wrap of ls4b. */
+static int
+anti_replay_accept(const frame802154_t *frame, const linkaddr_t *sender,
+                   uint8_t key_index, const struct tsch_asn_t *asn)
+{
+  struct tsch_neighbor *n;
+  uint8_t flags = ANTI_REPLAY_WRAPPING;
+
+  n = tsch_queue_get_nbr(sender);
+  if(n == NULL) {
+    /* No state for this neighbor */
+    return 1;
+  }
+  if(!n->anti_replay_initialized) {
+    anti_replay_init(&n->anti_replay, asn->ls4b);
+    n->anti_replay_initialized = 1;
+    return 1;
+  }
+  if(frame->fcf.dest_addr_mode != FRAME802154_NOADDR &&
+     frame802154_is_broadcast_addr(frame->fcf.dest_addr_mode,
+                                   (uint8_t *)frame->dest_addr)) {
+    flags |= ANTI_REPLAY_BROADCAST;
+  }
+  return anti_replay_check(&n->anti_replay, key_index, flags, asn->ls4b)
+    == ANTI_REPLAY_ACCEPTED;
+}
+#endif /* TSCH_SECURITY_ANTI_REPLAY */
 /*---------------------------------------------------------------------------*/
 static void
 tsch_security_init_nonce(uint8_t *nonce,
@@ -142,7 +174,7 @@ tsch_security_secure_frame(uint8_t *hdr, uint8_t *outbuf,
   uint8_t with_encryption;
   uint8_t mic_len;
   uint8_t nonce[16];
-  struct ieee802154_ies ies;
+  int ie_offset;
 
   uint8_t a_len;
   uint8_t m_len;
@@ -156,11 +188,11 @@ tsch_security_secure_frame(uint8_t *hdr, uint8_t *outbuf,
     return 0;
   }
 
-  memset(&ies, 0, sizeof(ies));
-  if(frame802154e_parse_information_elements(hdr + hdrlen, datalen, &ies) > 0) {
-    /* put Header IEs into the header part which is not encrypted */
-    hdrlen += ies.ie_payload_ie_offset;
-    datalen -= ies.ie_payload_ie_offset;
+  /* put Header IEs into the header part which is not encrypted */
+  ie_offset = frame802154e_ie_header_len(hdr + hdrlen, datalen);
+  if(ie_offset > 0) {
+    hdrlen += ie_offset;
+    datalen -= ie_offset;
   }
 
   if(!frame.fcf.security_enabled) {
@@ -216,7 +248,7 @@ tsch_security_parse_frame(const uint8_t *hdr, int hdrlen, int datalen,
   uint8_t nonce[16];
   uint8_t a_len;
   uint8_t m_len;
-  struct ieee802154_ies ies;
+  int ie_offset;
 
   if(frame == NULL || hdr == NULL || hdrlen < 0 || datalen < 0) {
     return 0;
@@ -242,11 +274,13 @@ tsch_security_parse_frame(const uint8_t *hdr, int hdrlen, int datalen,
     return 0;
   }
 
-  memset(&ies, 0, sizeof(ies));
-  (void)frame802154e_parse_information_elements(hdr + hdrlen, datalen, &ies);
-  /* put Header IEs into the header part which is not encrypted */
-  hdrlen += ies.ie_payload_ie_offset;
-  datalen -= ies.ie_payload_ie_offset;
+  /* put Header IEs into the header part which is not encrypted. Only the
+   * header IEs are walked: payload IEs are still encrypted at this point. */
+  ie_offset = frame802154e_ie_header_len(hdr + hdrlen, datalen);
+  if(ie_offset > 0) {
+    hdrlen += ie_offset;
+    datalen -= ie_offset;
+  }
 
   tsch_security_init_nonce(nonce, sender, asn);
 
@@ -267,9 +301,13 @@ tsch_security_parse_frame(const uint8_t *hdr, int hdrlen, int datalen,
 
   if(mic_len > 0 && memcmp(generated_mic, hdr + hdrlen + datalen, mic_len) != 0) {
     return 0;
-  } else {
-    return 1;
   }
+#if TSCH_SECURITY_ANTI_REPLAY
+  if(!anti_replay_accept(frame, sender, key_index, asn)) {
+    return 0;
+  }
+#endif /* TSCH_SECURITY_ANTI_REPLAY */
+  return 1;
 }
 /*---------------------------------------------------------------------------*/
 void
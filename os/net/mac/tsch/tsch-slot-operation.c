@@ -688,6 +688,12 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 
     current_packet->transmissions++;
     current_packet->ret = mac_tx_status;
+#if LINK_STATS_PER_CHANNEL
+    if(current_packet->transmissions <= sizeof(current_packet->tx_channels)) {
+      current_packet->tx_channels[current_packet->transmissions - 1] =
+        (mac_tx_status == MAC_TX_OK || mac_tx_status == MAC_TX_NOACK) ? tsch_current_channel : 0xff;
+    }
+#endif /* LINK_STATS_PER_CHANNEL */
 
     /* Post TX: Update neighbor queue state */
     in_queue = tsch_queue_packet_sent(current_neighbor, current_packet, current_link, mac_tx_status);
@@ -44,7 +44,10 @@
 
 /********** Includes **********/
 
+#include "net/mac/tsch/tsch-conf.h"
 #include "net/mac/tsch/tsch-asn.h"
+#include "net/mac/anti-replay.h"
+#include "net/link-stats.h"
 #include "lib/list.h"
 #include "lib/ringbufindex.h"
 
@@ -103,6 +106,10 @@ struct tsch_packet {
   uint8_t ret; /* status -- MAC return code */
   uint8_t header_len; /* length of header and header IEs (needed for link-layer security) */
   uint8_t tsch_sync_ie_offset; /* Offset within the frame used for quick update of EB ASN and join priority */
+#if LINK_STATS_PER_CHANNEL
+  /* Channel of each Tx attempt, 0xff for attempts that got no ACK/NACK verdict */
+  uint8_t tx_channels[TSCH_MAC_MAX_FRAME_RETRIES + 1];
+#endif /* LINK_STATS_PER_CHANNEL */
 };
 
 /** \brief TSCH neighbor information */
@@ -122,6 +129,10 @@ struct tsch_neighbor {
   struct tsch_packet *tx_array[TSCH_QUEUE_NUM_PER_NEIGHBOR];
   /* Circular buffer of pointers to packet. */
   struct ringbufindex tx_ringbuf;
+#if TSCH_SECURITY_ANTI_REPLAY
+  uint8_t anti_replay_initialized;
+  struct anti_replay_info anti_replay; /* ASNs received from this neighbor */
+#endif /* TSCH_SECURITY_ANTI_REPLAY */
 };
 
 /** \brief TSCH timeslot timing elements. Used to index timeslot timing
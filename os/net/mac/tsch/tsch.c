@@ -523,12 +523,24 @@ tsch_tx_process_pending(void)
   /* Loop on accessing (without removing) a pending input packet */
   while((dequeued_index = ringbufindex_peek_get(&dequeued_ringbuf)) != -1) {
     struct tsch_packet *p = dequeued_array[dequeued_index];
+#if LINK_STATS_PER_CHANNEL
+    int i;
+#endif /* LINK_STATS_PER_CHANNEL */
     /* Put packet into packetbuf for packet_sent callback */
     queuebuf_to_packetbuf(p->qb);
     LOG_INFO("packet sent to ");
     LOG_INFO_LLADDR(packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
     LOG_INFO_(", seqno %u, status %d, tx %d\n",
       packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO), p->ret, p->transmissions);
+#if LINK_STATS_PER_CHANNEL
+    /* Per-channel link statistics: all attempts but the last one failed */
+    for(i = 0; i < p->transmissions && i < sizeof(p->tx_channels); i++) {
+      if(p->tx_channels[i] != 0xff) {
+        link_stats_channel_tx(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), p->tx_channels[i],
+                              i == p->transmissions - 1 && p->ret == MAC_TX_OK);
+      }
+    }
+#endif /* LINK_STATS_PER_CHANNEL */
     /* Call packet_sent callback */
     mac_call_sent_callback(p->sent, p->ptr, p->ret, p->transmissions);
     /* Free packet queuebuf */
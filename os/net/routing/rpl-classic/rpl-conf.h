@@ -53,6 +53,8 @@
 #else /* RPL_CONF_MOP */
 #if RPL_WITH_MULTICAST
 #define RPL_MOP_DEFAULT                 RPL_MOP_STORING_MULTICAST
+#elif RPL_WITH_NON_STORING_MULTICAST
+#define RPL_MOP_DEFAULT                 RPL_MOP_NON_STORING
 #else
 #define RPL_MOP_DEFAULT                 RPL_MOP_STORING_NO_MULTICAST
 #endif /* RPL_WITH_MULTICAST */
@@ -85,6 +87,9 @@
 #if RPL_WITH_MULTICAST && (RPL_MOP_DEFAULT != RPL_MOP_STORING_MULTICAST)
 #error "RPL Multicast requires RPL_MOP_DEFAULT==3. Check contiki-conf.h"
 #endif
+#if RPL_WITH_NON_STORING_MULTICAST && !RPL_WITH_NON_STORING
+#error "RPL Non-Storing Multicast requires RPL_WITH_NON_STORING. Check contiki-conf.h"
+#endif
 
 /* Set to 1 to enable RPL statistics */
 #ifndef RPL_CONF_STATS
@@ -94,7 +99,7 @@
 /*
  * The objective function (OF) used by a RPL root is configurable through
  * the RPL_CONF_OF_OCP parameter. This is defined as the objective code
- * point (OCP) of the OF, RPL_OCP_OF0 or RPL_OCP_MRHOF. This flag is of
+ * point (OCP) of the OF, RPL_OCP_OF0, RPL_OCP_MRHOF or RPL_OCP_LEOF. This flag is of
  * no relevance to non-root nodes, which run the OF advertised in the
  * instance they join.
  * Make sure the selected of is inRPL_SUPPORTED_OFS.
@@ -108,7 +113,8 @@
 /*
  * The set of objective functions supported at runtime. Nodes are only
  * able to join instances that advertise an OF in this set. To include
- * both OF0 and MRHOF, use {&rpl_of0, &rpl_mrhof}.
+ * both OF0 and MRHOF, use {&rpl_of0, &rpl_mrhof}. The latency and
+ * energy-aware OF is rpl_leof; it requires RPL_CONF_WITH_MC.
  */
 #ifdef RPL_CONF_SUPPORTED_OFS
 #define RPL_SUPPORTED_OFS RPL_CONF_SUPPORTED_OFS
@@ -130,7 +136,8 @@
 #define RPL_WITH_MC 0
 #endif /* RPL_CONF_WITH_MC */
 
-/* The MC advertised in DIOs and propagating from the root */
+/* The MC advertised in DIOs and propagating from the root. With
+ * RPL_OCP_LEOF, use RPL_DAG_MC_LATENCY. */
 #ifdef RPL_CONF_DAG_MC
 #define RPL_DAG_MC RPL_CONF_DAG_MC
 #else
@@ -302,6 +309,32 @@
 #define RPL_REPAIR_ON_DAO_NACK 0
 #endif /* RPL_CONF_RPL_REPAIR_ON_DAO_NACK */
 
+/*
+ * RPL DAO aggregation (storing mode). When enabled, routers collect the
+ * targets of the DAOs received from their children for
+ * RPL_DAO_AGGREGATION_DELAY and advertise them to their parent in DAOs
+ * of up to RPL_DAO_AGGREGATION_MAX_TARGETS targets, instead of forwarding
+ * every DAO. Multi-target DAOs are only understood by nodes that enable
+ * this, so enable it on all nodes of a storing-mode network.
+ * */
+#ifdef RPL_CONF_DAO_AGGREGATION
+#define RPL_DAO_AGGREGATION RPL_CONF_DAO_AGGREGATION
+#else
+#define RPL_DAO_AGGREGATION 0
+#endif /* RPL_CONF_DAO_AGGREGATION */
+
+#ifdef RPL_CONF_DAO_AGGREGATION_DELAY
+#define RPL_DAO_AGGREGATION_DELAY RPL_CONF_DAO_AGGREGATION_DELAY
+#else
+#define RPL_DAO_AGGREGATION_DELAY CLOCK_SECOND
+#endif /* RPL_CONF_DAO_AGGREGATION_DELAY */
+
+#ifdef RPL_CONF_DAO_AGGREGATION_MAX_TARGETS
+#define RPL_DAO_AGGREGATION_MAX_TARGETS RPL_CONF_DAO_AGGREGATION_MAX_TARGETS
+#else
+#define RPL_DAO_AGGREGATION_MAX_TARGETS 4
+#endif /* RPL_CONF_DAO_AGGREGATION_MAX_TARGETS */
+
 /*
  * Setting the DIO_REFRESH_DAO_ROUTES will make the RPL root always
  * increase the DTSN (Destination Advertisement Trigger Sequence Number)
@@ -70,7 +70,7 @@ void RPL_CALLBACK_PARENT_SWITCH(rpl_parent_t *old, rpl_parent_t *new);
 #endif /* RPL_CALLBACK_PARENT_SWITCH */
 
 /*---------------------------------------------------------------------------*/
-extern rpl_of_t rpl_of0, rpl_mrhof;
+extern rpl_of_t rpl_of0, rpl_mrhof, rpl_leof;
 static rpl_of_t * const objective_functions[] = RPL_SUPPORTED_OFS;
 
 /*---------------------------------------------------------------------------*/
@@ -1165,6 +1165,7 @@ rpl_join_instance(uip_ipaddr_t *from, rpl_dio_t *dio)
   instance->mc.flags = dio->mc.flags;
   instance->mc.aggr = dio->mc.aggr;
   instance->mc.prec = dio->mc.prec;
+  instance->mc.with_energy = dio->mc.with_energy;
   instance->current_dag = dag;
   instance->dtsn_out = RPL_LOLLIPOP_INIT;
 
@@ -134,6 +134,342 @@ prepare_for_dao_fwd(uint8_t sequence, uip_ds6_route_t *rep)
 }
 #endif /* RPL_WITH_STORING */
 /*---------------------------------------------------------------------------*/
+#if RPL_WITH_STORING && RPL_DAO_AGGREGATION
+static struct ctimer dao_aggregation_timer;
+/*---------------------------------------------------------------------------*/
+/* The lifetime to advertise upwards for a route learned from a DAO */
+static uint8_t
+route_dao_lifetime(rpl_instance_t *instance, uip_ds6_route_t *rep)
+{
+  if(RPL_ROUTE_IS_NOPATH_RECEIVED(rep)) {
+    return RPL_ZERO_LIFETIME;
+  }
+  if(rep->state.lifetime == RPL_ROUTE_INFINITE_LIFETIME) {
+    return RPL_INFINITE_LIFETIME;
+  }
+  return MIN((rep->state.lifetime + instance->lifetime_unit - 1) /
+             instance->lifetime_unit, RPL_INFINITE_LIFETIME - 1);
+}
+/*---------------------------------------------------------------------------*/
+/* Send the queued targets to the preferred parent of their DAG, in DAOs of
+   up to RPL_DAO_AGGREGATION_MAX_TARGETS targets */
+static void
+dao_aggregation_output(void *ptr)
+{
+  uip_ds6_route_t *rep;
+  uip_ds6_route_t *next;
+  rpl_dag_t *dag;
+  rpl_instance_t *instance;
+  uip_ipaddr_t *parent_ipaddr;
+  unsigned char *buffer;
+  uint8_t lifetime;
+  uint8_t prefixlen;
+  int count;
+  int pos;
+
+  rep = uip_ds6_route_head();
+  while(rep != NULL) {
+    if(!RPL_ROUTE_IS_DAO_QUEUED(rep)) {
+      rep = uip_ds6_route_next(rep);
+      continue;
+    }
+
+    dag = rep->state.dag;
+    instance = dag->instance;
+    parent_ipaddr = dag->preferred_parent != NULL ?
+      rpl_parent_get_ipaddr(dag->preferred_parent) : NULL;
+
+    buffer = UIP_ICMP_PAYLOAD;
+    pos = 0;
+    if(parent_ipaddr != NULL) {
+      RPL_LOLLIPOP_INCREMENT(dao_sequence);
+      buffer[pos++] = instance->instance_id;
+      buffer[pos] = 0;
+#if RPL_DAO_SPECIFY_DAG
+      buffer[pos] |= RPL_DAO_D_FLAG;
+#endif /* RPL_DAO_SPECIFY_DAG */
+      ++pos;
+      buffer[pos++] = 0; /* reserved */
+      buffer[pos++] = dao_sequence;
+#if RPL_DAO_SPECIFY_DAG
+      memcpy(buffer + pos, &dag->dag_id, sizeof(dag->dag_id));
+      pos += sizeof(dag->dag_id);
+#endif /* RPL_DAO_SPECIFY_DAG */
+    }
+
+    /* Add the queued targets of this DAG, each with its own transit */
+    count = 0;
+    for(; rep != NULL && count < RPL_DAO_AGGREGATION_MAX_TARGETS
+          && pos + 4 + 16 + 6 <= UIP_LINK_MTU - UIP_IPH_LEN - UIP_ICMPH_LEN; rep = next) {
+      next = uip_ds6_route_next(rep);
+      if(!RPL_ROUTE_IS_DAO_QUEUED(rep) || rep->state.dag != dag) {
+        continue;
+      }
+      RPL_ROUTE_CLEAR_DAO_QUEUED(rep);
+      if(parent_ipaddr == NULL) {
+        /* No parent: the children will register again with our next one */
+        continue;
+      }
+
+      lifetime = route_dao_lifetime(instance, rep);
+      prefixlen = rep->length;
+      buffer[pos++] = RPL_OPTION_TARGET;
+      buffer[pos++] = 2 + ((prefixlen + 7) / CHAR_BIT);
+      buffer[pos++] = 0; /* reserved */
+      buffer[pos++] = prefixlen;
+      memcpy(buffer + pos, &rep->ipaddr, (prefixlen + 7) / CHAR_BIT);
+      pos += ((prefixlen + 7) / CHAR_BIT);
+
+      buffer[pos++] = RPL_OPTION_TRANSIT;
+      buffer[pos++] = 4;
+      buffer[pos++] = 0; /* flags - ignored */
+      buffer[pos++] = 0; /* path control - ignored */
+      buffer[pos++] = 0; /* path seq - ignored */
+      buffer[pos++] = lifetime;
+
+#if RPL_WITH_DAO_ACK
+      if(lifetime != RPL_ZERO_LIFETIME) {
+        /* The ACK for this DAO is relayed to the child */
+        buffer[1] |= RPL_DAO_K_FLAG;
+        rep->state.dao_seqno_out = dao_sequence;
+        RPL_ROUTE_SET_DAO_PENDING(rep);
+      }
+#endif /* RPL_WITH_DAO_ACK */
+      count++;
+    }
+
+    if(count > 0) {
+      LOG_INFO("Sending an aggregated DAO with sequence number %u, %u targets, to ",
+               dao_sequence, count);
+      LOG_INFO_6ADDR(parent_ipaddr);
+      LOG_INFO_("\n");
+      RPL_STAT(rpl_stats.dao_out++);
+      RPL_STAT(rpl_stats.dao_aggregated += count);
+      uip_icmp6_send(parent_ipaddr, ICMP6_RPL, RPL_CODE_DAO, pos);
+    }
+
+    /* Continue with the remaining queued targets, if any */
+    rep = uip_ds6_route_head();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+dao_aggregation_queue(uip_ds6_route_t *rep)
+{
+  RPL_ROUTE_SET_DAO_QUEUED(rep);
+  if(ctimer_expired(&dao_aggregation_timer)) {
+    ctimer_set(&dao_aggregation_timer, RPL_DAO_AGGREGATION_DELAY,
+               dao_aggregation_output, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Install or expire the route to one target of a DAO. Returns 1 if the
+   target was queued for advertisement to our parent and the DAO should
+   therefore be acknowledged only once our parent acknowledges it. */
+static int
+dao_aggregation_target(rpl_dag_t *dag, uip_ipaddr_t *from,
+                       uip_ipaddr_t *prefix, uint8_t prefixlen,
+                       uint8_t lifetime, uint8_t sequence, uint8_t *status)
+{
+  uip_ds6_route_t *rep;
+  int is_root;
+
+  is_root = dag->rank == ROOT_RANK(dag->instance);
+
+  LOG_INFO("DAO lifetime: %u, prefix length: %u prefix: ",
+           (unsigned)lifetime, (unsigned)prefixlen);
+  LOG_INFO_6ADDR(prefix);
+  LOG_INFO_("\n");
+
+#if RPL_WITH_MULTICAST
+  if(uip_is_addr_mcast_global(prefix)) {
+    /* Multicast registrations are not aggregated, the caller forwards them */
+    mcast_group = uip_mcast6_route_add(prefix);
+    if(mcast_group) {
+      mcast_group->dag = dag;
+      mcast_group->lifetime = RPL_LIFETIME(dag->instance, lifetime);
+    }
+    return 0;
+  }
+#endif /* RPL_WITH_MULTICAST */
+
+  rep = uip_ds6_route_lookup(prefix);
+
+  if(lifetime == RPL_ZERO_LIFETIME) {
+    /* No-Path DAO: expire the route, and advertise the removal upwards */
+    if(rep != NULL &&
+       !RPL_ROUTE_IS_NOPATH_RECEIVED(rep) &&
+       rep->length == prefixlen &&
+       uip_ds6_route_nexthop(rep) != NULL &&
+       uip_ipaddr_cmp(uip_ds6_route_nexthop(rep), from)) {
+      RPL_ROUTE_SET_NOPATH_RECEIVED(rep);
+      rep->state.lifetime = RPL_NOPATH_REMOVAL_DELAY;
+      if(!is_root) {
+        dao_aggregation_queue(rep);
+      }
+    }
+    return 0;
+  }
+
+  if(rep != NULL && !RPL_ROUTE_IS_NOPATH_RECEIVED(rep) &&
+     !RPL_ROUTE_IS_DAO_PENDING(rep) && !RPL_ROUTE_IS_DAO_QUEUED(rep) &&
+     rep->state.dao_seqno_in == sequence &&
+     uip_ds6_route_nexthop(rep) != NULL &&
+     uip_ipaddr_cmp(uip_ds6_route_nexthop(rep), from)) {
+    /* Retransmission of a DAO that our parent already acknowledged */
+    rep->state.lifetime = RPL_LIFETIME(dag->instance, lifetime);
+    return 0;
+  }
+
+  rep = rpl_add_route(dag, prefix, prefixlen, from);
+  if(rep == NULL) {
+    RPL_STAT(rpl_stats.mem_overflows++);
+    LOG_ERR("Could not add a route after receiving a DAO\n");
+    *status = is_root ? RPL_DAO_ACK_UNABLE_TO_ADD_ROUTE_AT_ROOT :
+      RPL_DAO_ACK_UNABLE_TO_ACCEPT;
+    return 0;
+  }
+
+  /* set lifetime and clear NOPATH bit */
+  rep->state.lifetime = RPL_LIFETIME(dag->instance, lifetime);
+  RPL_ROUTE_CLEAR_NOPATH_RECEIVED(rep);
+  rep->state.dao_seqno_in = sequence;
+
+  if(is_root) {
+    return 0;
+  }
+  if(dag->preferred_parent != NULL) {
+    dao_aggregation_queue(rep);
+  }
+  /* Without parent, do not ACK: the child will retransmit */
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Handle a unicast DAO with any number of targets. A transit option applies
+   to all targets since the previous transit option (RFC 6550, 9.4). */
+static void
+dao_aggregation_input(rpl_instance_t *instance, rpl_dag_t *dag,
+                      uip_ipaddr_t *from, unsigned char *buffer,
+                      int pos, int buffer_length, uint8_t flags,
+                      uint8_t sequence)
+{
+  uip_ipaddr_t prefix;
+  uint8_t prefixlen;
+  uint8_t lifetime;
+  uint8_t status;
+  int group;
+  int group_mcast;
+  int fwd_len;
+  int pending;
+  int opt_len;
+  int len;
+  int i;
+  int j;
+
+  /* Check the length of every option before acting on any of them: the
+     loops below rely on it, and a DAO is applied as a whole or not at all */
+  for(i = pos; i < buffer_length; i += len) {
+    if(buffer[i] == RPL_OPTION_PAD1) {
+      len = 1;
+      continue;
+    }
+    len = i + 1 < buffer_length ? 2 + buffer[i + 1] : 0;
+    if(len == 0 || len + i > buffer_length
+       || (buffer[i] == RPL_OPTION_TARGET
+           && (len < 4 || buffer[i + 3] > 128
+               || 4 + (buffer[i + 3] + 7) / CHAR_BIT > len))
+       || (buffer[i] == RPL_OPTION_TRANSIT && len < 6)) {
+      LOG_WARN("Invalid DAO packet\n");
+      RPL_STAT(rpl_stats.malformed_msgs++);
+      return;
+    }
+  }
+
+  /* Update and add neighbor - if no room - fail. */
+  if(rpl_icmp6_update_nbr_table(from, NBR_TABLE_REASON_RPL_DAO, instance) == NULL) {
+    LOG_ERR("Out of Memory, dropping DAO from ");
+    LOG_ERR_6ADDR(from);
+    LOG_ERR_("\n");
+    if(flags & RPL_DAO_K_FLAG) {
+      dao_ack_output(instance, from, sequence,
+                     dag->rank == ROOT_RANK(instance) ?
+                     RPL_DAO_ACK_UNABLE_TO_ADD_ROUTE_AT_ROOT :
+                     RPL_DAO_ACK_UNABLE_TO_ACCEPT);
+    }
+    return;
+  }
+
+  status = RPL_DAO_ACK_UNCONDITIONAL_ACCEPT;
+  pending = 0;
+  group = pos;
+  fwd_len = pos;
+  for(i = pos; i <= buffer_length; i += len) {
+    if(i == buffer_length) {
+      /* Targets without transit get the default lifetime */
+      lifetime = instance->default_lifetime;
+      len = 1;
+    } else if(buffer[i] == RPL_OPTION_PAD1) {
+      len = 1;
+      continue;
+    } else {
+      len = 2 + buffer[i + 1];
+      if(buffer[i] != RPL_OPTION_TRANSIT) {
+        continue;
+      }
+      lifetime = buffer[i + 5];
+    }
+
+    /* Apply the transit to the targets of its group. Multicast targets
+       are moved to the front of the buffer, with their transit, to be
+       forwarded to our parent as they are. Moving never overwrites an
+       option that was not read yet. */
+    group_mcast = 0;
+    for(j = group; j < i; j += opt_len) {
+      opt_len = buffer[j] == RPL_OPTION_PAD1 ? 1 : 2 + buffer[j + 1];
+      if(buffer[j] != RPL_OPTION_TARGET) {
+        continue;
+      }
+      prefixlen = buffer[j + 3];
+      memset(&prefix, 0, sizeof(prefix));
+      memcpy(&prefix, buffer + j + 4, (prefixlen + 7) / CHAR_BIT);
+      pending |= dao_aggregation_target(dag, from, &prefix, prefixlen,
+                                        lifetime, sequence, &status);
+#if RPL_WITH_MULTICAST
+      if(uip_is_addr_mcast_global(&prefix)) {
+        memmove(buffer + fwd_len, buffer + j, opt_len);
+        fwd_len += opt_len;
+        group_mcast = 1;
+      }
+#endif /* RPL_WITH_MULTICAST */
+    }
+    if(group_mcast && i < buffer_length) {
+      memmove(buffer + fwd_len, buffer + i, len);
+      fwd_len += len;
+    }
+    group = i + len;
+  }
+
+#if RPL_WITH_MULTICAST
+  if(fwd_len > pos && dag->preferred_parent != NULL &&
+     rpl_parent_get_ipaddr(dag->preferred_parent) != NULL) {
+    /* The aggregated DAOs only carry unicast routes: forward the multicast
+       targets in a DAO of their own, which nobody acknowledges */
+    buffer[1] &= ~RPL_DAO_K_FLAG;
+    buffer[3] = 0;
+    RPL_STAT(rpl_stats.dao_out++);
+    uip_icmp6_send(rpl_parent_get_ipaddr(dag->preferred_parent),
+                   ICMP6_RPL, RPL_CODE_DAO, fwd_len);
+  }
+#endif /* RPL_WITH_MULTICAST */
+
+  /* ACK now unless waiting for our parent's ACK */
+  if((flags & RPL_DAO_K_FLAG) &&
+     (!pending || status != RPL_DAO_ACK_UNCONDITIONAL_ACCEPT)) {
+    dao_ack_output(instance, from, sequence, status);
+  }
+}
+#endif /* RPL_WITH_STORING && RPL_DAO_AGGREGATION */
+/*---------------------------------------------------------------------------*/
 static int
 get_global_addr(uip_ipaddr_t *addr)
 {
@@ -373,6 +709,11 @@ dio_input(void)
         dio.mc.aggr = (buffer[i + 4] >> 4) & 0x3;
         dio.mc.prec = buffer[i + 4] & 0xf;
         dio.mc.length = buffer[i + 5];
+        if(6 + dio.mc.length > len) {
+          LOG_WARN("Invalid DAG MC object length %u\n", dio.mc.length);
+          RPL_STAT(rpl_stats.malformed_msgs++);
+          goto discard;
+        }
 
         if(dio.mc.type == RPL_DAG_MC_NONE) {
           /* No metric container: do nothing */
@@ -389,10 +730,23 @@ dio_input(void)
         } else if(dio.mc.type == RPL_DAG_MC_ENERGY) {
           dio.mc.obj.energy.flags = buffer[i + 6];
           dio.mc.obj.energy.energy_est = buffer[i + 7];
+        } else if(dio.mc.type == RPL_DAG_MC_LATENCY && dio.mc.length >= 4) {
+          dio.mc.obj.latency = get32(buffer, i + 6);
+          LOG_DBG("DAG MC: latency %lu us\n", (unsigned long)dio.mc.obj.latency);
         } else {
           LOG_WARN("Unhandled DAG MC type: %u\n", (unsigned)dio.mc.type);
           goto discard;
         }
+
+        /* An optional node energy object may follow the first object */
+        dio.mc.with_energy = 0;
+        if(dio.mc.type != RPL_DAG_MC_ENERGY
+           && 6 + dio.mc.length + 6 <= len
+           && buffer[i + 6 + dio.mc.length] == RPL_DAG_MC_ENERGY) {
+          dio.mc.with_energy = 1;
+          dio.mc.energy.flags = buffer[i + 6 + dio.mc.length + 4];
+          dio.mc.energy.energy_est = buffer[i + 6 + dio.mc.length + 5];
+        }
         break;
       case RPL_OPTION_ROUTE_INFO:
         if(len < 9) {
@@ -480,6 +834,7 @@ dio_output(rpl_instance_t *instance, uip_ipaddr_t *uc_addr)
   rpl_dag_t *dag = instance->current_dag;
 #if !RPL_LEAF_ONLY
   uip_ipaddr_t addr;
+  int mc_len_pos;
 #endif /* !RPL_LEAF_ONLY */
 
 #if RPL_LEAF_ONLY
@@ -537,7 +892,7 @@ dio_output(rpl_instance_t *instance, uip_ipaddr_t *uc_addr)
     instance->of->update_metric_container(instance);
 
     buffer[pos++] = RPL_OPTION_DAG_METRIC_CONTAINER;
-    buffer[pos++] = 6;
+    mc_len_pos = pos++;
     buffer[pos++] = instance->mc.type;
     buffer[pos++] = instance->mc.flags >> 1;
     buffer[pos] = (instance->mc.flags & 1) << 7;
@@ -550,11 +905,25 @@ dio_output(rpl_instance_t *instance, uip_ipaddr_t *uc_addr)
       buffer[pos++] = 2;
       buffer[pos++] = instance->mc.obj.energy.flags;
       buffer[pos++] = instance->mc.obj.energy.energy_est;
+    } else if(instance->mc.type == RPL_DAG_MC_LATENCY) {
+      buffer[pos++] = 4;
+      set32(buffer, pos, instance->mc.obj.latency);
+      pos += 4;
     } else {
       LOG_ERR("Unable to send DIO because of unhandled DAG MC type %u\n",
              (unsigned)instance->mc.type);
       return;
     }
+    if(instance->mc.with_energy && instance->mc.type != RPL_DAG_MC_ENERGY) {
+      /* Node energy object, aggregated as a path minimum */
+      buffer[pos++] = RPL_DAG_MC_ENERGY;
+      buffer[pos++] = 0;
+      buffer[pos++] = RPL_DAG_MC_AGGR_MINIMUM << 4;
+      buffer[pos++] = 2;
+      buffer[pos++] = instance->mc.energy.flags;
+      buffer[pos++] = instance->mc.energy.energy_est;
+    }
+    buffer[mc_len_pos] = pos - mc_len_pos - 1;
   }
 #endif /* !RPL_LEAF_ONLY */
 
@@ -722,6 +1091,17 @@ dao_input_storing(void)
     }
   }
 
+#if RPL_DAO_AGGREGATION
+  /* Unicast DAOs are aggregated. Multicast targets among them are
+     recognized and forwarded target by target. The option lengths
+     are checked there. */
+  if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
+    dao_aggregation_input(instance, dag, &dao_sender_addr, buffer, pos,
+                          buffer_length, flags, sequence);
+    return;
+  }
+#endif /* RPL_DAO_AGGREGATION */
+
   /* Check if there are any RPL options present. */
   for(i = pos; i < buffer_length; i += len) {
     subopt_type = buffer[i];
@@ -800,6 +1180,7 @@ dao_input_storing(void)
 
         buffer = UIP_ICMP_PAYLOAD;
         buffer[3] = out_seq; /* add an outgoing seq no before fwd */
+        RPL_STAT(rpl_stats.dao_out++);
         uip_icmp6_send(rpl_parent_get_ipaddr(dag->preferred_parent),
                        ICMP6_RPL, RPL_CODE_DAO, buffer_length);
       }
@@ -892,6 +1273,7 @@ fwd_dao:
 
       buffer = UIP_ICMP_PAYLOAD;
       buffer[3] = out_seq; /* add an outgoing seq no before fwd */
+      RPL_STAT(rpl_stats.dao_out++);
       uip_icmp6_send(rpl_parent_get_ipaddr(dag->preferred_parent),
                      ICMP6_RPL, RPL_CODE_DAO, buffer_length);
     }
@@ -995,6 +1377,19 @@ dao_input_nonstoring(void)
   LOG_INFO_6ADDR(&dao_parent_addr);
   LOG_INFO_("\n");
 
+#if RPL_WITH_NON_STORING_MULTICAST
+  if(uip_is_addr_mcast_global(&prefix)) {
+    /* A group membership of the DAO's sender, not a link */
+    if(!bmf_member_update(&prefix, &dao_sender_addr,
+                          lifetime == RPL_ZERO_LIFETIME ? 0 :
+                          RPL_LIFETIME(instance, lifetime))) {
+      LOG_WARN("DAO failed to add group membership: ");
+      LOG_WARN_6ADDR(&prefix);
+      LOG_WARN_("\n");
+      return;
+    }
+  } else
+#endif /* RPL_WITH_NON_STORING_MULTICAST */
   if(lifetime == RPL_ZERO_LIFETIME) {
     LOG_DBG("No-Path DAO received\n");
     uip_sr_expire_parent(dag, &prefix, &dao_parent_addr);
@@ -1259,6 +1654,7 @@ dao_output_target_seq(rpl_parent_t *parent, uip_ipaddr_t *prefix,
   LOG_INFO_("\n");
 
   if(dest_ipaddr != NULL) {
+    RPL_STAT(rpl_stats.dao_out++);
     uip_icmp6_send(dest_ipaddr, ICMP6_RPL, RPL_CODE_DAO, pos);
   }
 }
@@ -1335,6 +1731,25 @@ dao_ack_input(void)
     /* this DAO ACK should be forwarded to another recently registered route */
     uip_ds6_route_t *re;
     uip_ipaddr_t *nexthop;
+#if RPL_DAO_AGGREGATION
+    /* An aggregated DAO: relay the ACK to the child of each of its targets */
+    if(find_route_entry_by_dao_ack(sequence) == NULL) {
+      LOG_WARN("No route entry found to forward DAO ACK (seqno %u)\n", sequence);
+    }
+    while((re = find_route_entry_by_dao_ack(sequence)) != NULL) {
+      RPL_ROUTE_CLEAR_DAO_PENDING(re);
+      nexthop = (uip_ipaddr_t *)uip_ds6_route_nexthop(re);
+      if(nexthop == NULL) {
+        LOG_WARN("No next hop to fwd DAO ACK to\n");
+      } else {
+        dao_ack_output(instance, nexthop, re->state.dao_seqno_in, status);
+      }
+      if(status >= RPL_DAO_ACK_UNABLE_TO_ACCEPT) {
+        /* this node did not get in to the routing tables above... - remove */
+        uip_ds6_route_rm(re);
+      }
+    }
+#else /* RPL_DAO_AGGREGATION */
     if((re = find_route_entry_by_dao_ack(sequence)) != NULL) {
       /* pick the recorded seq no from that node and forward DAO ACK - and
          clear the pending flag*/
@@ -1358,6 +1773,7 @@ dao_ack_input(void)
     } else {
       LOG_WARN("No route entry found to forward DAO ACK (seqno %u)\n", sequence);
     }
+#endif /* RPL_DAO_AGGREGATION */
   }
 #endif /* RPL_WITH_DAO_ACK */
   uipbuf_clear();
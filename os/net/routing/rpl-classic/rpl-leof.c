@@ -0,0 +1,452 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup uip
+ * @{
+ */
+
+/**
+ * \file
+ *         A latency and energy-aware objective function for RPL.
+ *
+ *         The routing metric is the path latency, carried in a RFC6551
+ *         latency object and aggregated additively. Each hop adds the
+ *         expected time to get a packet through the link to the parent,
+ *         plus the time the packet waits behind the local queue. An
+ *         optional RFC6551 node energy object carries the lowest residual
+ *         energy along the path, which is added to the path cost as a
+ *         penalty so that traffic avoids depleted relays.
+ *
+ *         Latency is converted to rank in units of RPL_LEOF_HOP_DELAY_US:
+ *         a perfect link with an empty queue costs one MIN_HOPRANKINC,
+ *         which makes the OF behave like MRHOF on a uniform network.
+ */
+
+#include "net/routing/rpl-classic/rpl.h"
+#include "net/routing/rpl-classic/rpl-private.h"
+#include "net/nbr-table.h"
+#include "net/link-stats.h"
+#include "sys/energest.h"
+#if MAC_CONF_WITH_TSCH
+#include "net/mac/tsch/tsch.h"
+#elif MAC_CONF_WITH_CSMA
+#include "net/mac/csma/csma-output.h"
+#endif /* MAC_CONF_WITH_TSCH */
+
+#include "sys/log.h"
+
+#define LOG_MODULE "RPL"
+#define LOG_LEVEL LOG_LEVEL_RPL
+
+/* The latency of a perfect single hop with an empty queue. By default,
+ * the mean wait for a cell in the default TSCH slotframe, computed at
+ * runtime from the timeslot length in use, or the time of one CSMA
+ * transmission attempt. */
+#ifdef RPL_LEOF_CONF_HOP_DELAY_US
+#define RPL_LEOF_HOP_DELAY_US RPL_LEOF_CONF_HOP_DELAY_US
+#elif MAC_CONF_WITH_TSCH
+#define RPL_LEOF_HOP_DELAY_US \
+  mean_cell_wait_us(TSCH_SCHEDULE_DEFAULT_LENGTH * tsch_timing_us[tsch_ts_timeslot_length])
+#else
+#define RPL_LEOF_HOP_DELAY_US 8000UL
+#endif /* RPL_LEOF_CONF_HOP_DELAY_US */
+
+/* Include the node energy object in the metric container */
+#ifdef RPL_LEOF_CONF_WITH_ENERGY
+#define RPL_LEOF_WITH_ENERGY RPL_LEOF_CONF_WITH_ENERGY
+#else
+#define RPL_LEOF_WITH_ENERGY 1
+#endif /* RPL_LEOF_CONF_WITH_ENERGY */
+
+/* The rank penalty of a path through a fully depleted node */
+#ifdef RPL_LEOF_CONF_ENERGY_WEIGHT
+#define RPL_LEOF_ENERGY_WEIGHT RPL_LEOF_CONF_ENERGY_WEIGHT
+#else
+#define RPL_LEOF_ENERGY_WEIGHT 256
+#endif /* RPL_LEOF_CONF_ENERGY_WEIGHT */
+
+/* Platforms with a battery gauge define RPL_LEOF_CONF_ENERGY_LEVEL() to
+ * return the residual energy, from 0 (depleted) to 255 (full or mains).
+ * Otherwise, the level is estimated from the radio duty cycle measured by
+ * energest: a node whose radio is always on looks depleted. */
+
+/* Reject links with an ETX above 8, as MRHOF */
+#define MAX_LINK_ETX            (8 * LINK_STATS_ETX_DIVISOR)
+/* Hysteresis, in rank units: 0.75 nominal hop */
+#define PARENT_SWITCH_THRESHOLD 96
+/* Reject parents that have a higher path cost than the following. */
+#define MAX_PATH_COST           32768
+
+#if RPL_WITH_MC
+/* EWMA of the local queue occupancy, in 1/16th of packets */
+static uint16_t queue_ewma;
+/* Estimated residual energy of this node */
+static uint8_t energy_level = 255;
+#if ENERGEST_CONF_ON && !defined(RPL_LEOF_CONF_ENERGY_LEVEL)
+static uint64_t last_radio_time;
+static uint64_t last_total_time;
+#endif /* ENERGEST_CONF_ON && !defined(RPL_LEOF_CONF_ENERGY_LEVEL) */
+#endif /* RPL_WITH_MC */
+
+/*---------------------------------------------------------------------------*/
+static void
+reset(rpl_dag_t *dag)
+{
+  LOG_INFO("Reset LEOF\n");
+#if RPL_WITH_MC
+  queue_ewma = 0;
+#endif /* RPL_WITH_MC */
+}
+/*---------------------------------------------------------------------------*/
+#if RPL_WITH_DAO_ACK
+static void
+dao_ack_callback(rpl_parent_t *p, int status)
+{
+  if(status == RPL_DAO_ACK_UNABLE_TO_ADD_ROUTE_AT_ROOT) {
+    return;
+  }
+  if(status >= RPL_DAO_ACK_UNABLE_TO_ACCEPT || status == RPL_DAO_ACK_TIMEOUT) {
+    /* Punish the ETX as if 10 packets were lost, as MRHOF */
+    link_stats_packet_sent(rpl_get_parent_lladdr(p), MAC_TX_OK, 10);
+  }
+}
+#endif /* RPL_WITH_DAO_ACK */
+/*---------------------------------------------------------------------------*/
+static uint16_t
+parent_etx(rpl_parent_t *p)
+{
+  const struct link_stats *stats = rpl_get_parent_link_stats(p);
+  return stats != NULL ? stats->etx : 0xffff;
+}
+/*---------------------------------------------------------------------------*/
+#if MAC_CONF_WITH_TSCH
+/* Mean wait for the next transmit cell of a packet that arrives at a
+ * random time, given the period between two cells */
+static uint32_t
+mean_cell_wait_us(uint64_t period_us)
+{
+  return (uint32_t)(period_us / 2);
+}
+#endif /* MAC_CONF_WITH_TSCH */
+/*---------------------------------------------------------------------------*/
+/* Time until a transmission opportunity towards the parent, on average */
+static uint32_t
+tx_attempt_delay_us(rpl_parent_t *p)
+{
+#if MAC_CONF_WITH_TSCH
+  const linkaddr_t *addr = rpl_get_parent_lladdr(p);
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+  uint64_t rate = 0; /* Transmit cells per 1024 seconds */
+  uint32_t cells;
+
+  for(sf = tsch_schedule_slotframe_head(); sf != NULL;
+      sf = tsch_schedule_slotframe_next(sf)) {
+    cells = 0;
+    for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+      if((l->link_options & LINK_OPTION_TX)
+         && (linkaddr_cmp(&l->addr, &tsch_broadcast_address)
+             || (addr != NULL && linkaddr_cmp(&l->addr, addr)))) {
+        cells++;
+      }
+    }
+    if(cells > 0 && sf->size.val > 0) {
+      rate += (uint64_t)cells * 1000000UL * 1024
+        / ((uint64_t)sf->size.val * tsch_timing_us[tsch_ts_timeslot_length]);
+    }
+  }
+  if(rate == 0) {
+    /* No schedule yet */
+    return RPL_LEOF_HOP_DELAY_US;
+  }
+  return mean_cell_wait_us(1000000ULL * 1024 / rate);
+#else /* MAC_CONF_WITH_TSCH */
+  return RPL_LEOF_HOP_DELAY_US;
+#endif /* MAC_CONF_WITH_TSCH */
+}
+/*---------------------------------------------------------------------------*/
+/* Expected latency of the link to the parent, with retransmissions */
+static uint32_t
+link_latency_us(rpl_parent_t *p)
+{
+  uint16_t etx = parent_etx(p);
+  if(etx == 0xffff) {
+    etx = MAX_LINK_ETX;
+  }
+  return (uint32_t)((uint64_t)tx_attempt_delay_us(p) * etx / LINK_STATS_ETX_DIVISOR);
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+latency_to_rank(rpl_instance_t *instance, uint32_t latency_us)
+{
+  uint64_t rank = (uint64_t)latency_us * instance->min_hoprankinc / RPL_LEOF_HOP_DELAY_US;
+  return (uint16_t)MIN(rank, 0xffff);
+}
+/*---------------------------------------------------------------------------*/
+#if RPL_WITH_MC
+/* Time spent behind the local queue before reaching the link */
+static uint32_t
+queue_delay_us(rpl_parent_t *p)
+{
+  return (uint32_t)((uint64_t)link_latency_us(p) * queue_ewma / 16);
+}
+/*---------------------------------------------------------------------------*/
+static void
+sample_node_state(void)
+{
+  int queued = 0;
+#if ENERGEST_CONF_ON && !defined(RPL_LEOF_CONF_ENERGY_LEVEL)
+  uint64_t radio_time;
+  uint64_t total_time;
+  uint8_t level;
+#endif /* ENERGEST_CONF_ON && !defined(RPL_LEOF_CONF_ENERGY_LEVEL) */
+
+#if MAC_CONF_WITH_TSCH
+  queued = tsch_queue_global_packet_count();
+#elif MAC_CONF_WITH_CSMA
+  queued = csma_output_packet_count();
+#endif /* MAC_CONF_WITH_TSCH */
+  /* EWMA with alpha 1/4 */
+  queue_ewma = (queue_ewma * 3 + queued * 16) / 4;
+
+#ifdef RPL_LEOF_CONF_ENERGY_LEVEL
+  energy_level = RPL_LEOF_CONF_ENERGY_LEVEL();
+#elif ENERGEST_CONF_ON
+  energest_flush();
+  radio_time = energest_type_time(ENERGEST_TYPE_LISTEN)
+    + energest_type_time(ENERGEST_TYPE_TRANSMIT);
+  total_time = ENERGEST_GET_TOTAL_TIME();
+  if(total_time > last_total_time) {
+    level = 255 - MIN(255, (radio_time - last_radio_time) * 255
+                      / (total_time - last_total_time));
+    energy_level = (energy_level * 3 + level) / 4;
+  }
+  last_radio_time = radio_time;
+  last_total_time = total_time;
+#endif /* RPL_LEOF_CONF_ENERGY_LEVEL */
+}
+#endif /* RPL_WITH_MC */
+/*---------------------------------------------------------------------------*/
+static uint16_t
+parent_link_metric(rpl_parent_t *p)
+{
+  if(p == NULL || p->dag == NULL || p->dag->instance == NULL) {
+    return 0xffff;
+  }
+  return latency_to_rank(p->dag->instance, link_latency_us(p));
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+parent_path_cost(rpl_parent_t *p)
+{
+  uint32_t cost;
+
+  if(p == NULL || p->dag == NULL || p->dag->instance == NULL) {
+    return 0xffff;
+  }
+
+#if RPL_WITH_MC
+  if(p->dag->instance->mc.type == RPL_DAG_MC_LATENCY) {
+    cost = latency_to_rank(p->dag->instance, p->mc.obj.latency + link_latency_us(p));
+  } else {
+    cost = p->rank + parent_link_metric(p);
+  }
+  if(p->mc.with_energy) {
+    cost += (uint32_t)(255 - p->mc.energy.energy_est) * RPL_LEOF_ENERGY_WEIGHT / 255;
+  }
+#else /* RPL_WITH_MC */
+  cost = p->rank + parent_link_metric(p);
+#endif /* RPL_WITH_MC */
+
+  /* path cost upper bound: 0xffff */
+  return MIN(cost, 0xffff);
+}
+/*---------------------------------------------------------------------------*/
+static rpl_rank_t
+rank_via_parent(rpl_parent_t *p)
+{
+  uint16_t min_hoprankinc;
+  uint16_t path_cost;
+
+  if(p == NULL || p->dag == NULL || p->dag->instance == NULL) {
+    return RPL_INFINITE_RANK;
+  }
+
+  min_hoprankinc = p->dag->instance->min_hoprankinc;
+  path_cost = parent_path_cost(p);
+
+  /* Rank lower-bound: parent rank + min_hoprankinc */
+  return MAX(MIN((uint32_t)p->rank + min_hoprankinc, 0xffff), path_cost);
+}
+/*---------------------------------------------------------------------------*/
+static int
+parent_has_usable_link(rpl_parent_t *p)
+{
+  return parent_etx(p) <= MAX_LINK_ETX;
+}
+/*---------------------------------------------------------------------------*/
+static int
+parent_is_acceptable(rpl_parent_t *p)
+{
+  return parent_has_usable_link(p) && parent_path_cost(p) <= MAX_PATH_COST;
+}
+/*---------------------------------------------------------------------------*/
+static rpl_parent_t *
+best_parent(rpl_parent_t *p1, rpl_parent_t *p2)
+{
+  rpl_dag_t *dag;
+  uint16_t p1_cost;
+  uint16_t p2_cost;
+  int p1_is_acceptable;
+  int p2_is_acceptable;
+
+  p1_is_acceptable = p1 != NULL && parent_is_acceptable(p1);
+  p2_is_acceptable = p2 != NULL && parent_is_acceptable(p2);
+
+  if(!p1_is_acceptable) {
+    return p2_is_acceptable ? p2 : NULL;
+  }
+  if(!p2_is_acceptable) {
+    return p1;
+  }
+
+  dag = p1->dag; /* Both parents are in the same DAG. */
+  p1_cost = parent_path_cost(p1);
+  p2_cost = parent_path_cost(p2);
+
+  /* Maintain stability of the preferred parent in case of similar costs. */
+  if(p1 == dag->preferred_parent || p2 == dag->preferred_parent) {
+    if(p1_cost < p2_cost + PARENT_SWITCH_THRESHOLD &&
+       p1_cost > p2_cost - PARENT_SWITCH_THRESHOLD) {
+      return dag->preferred_parent;
+    }
+  }
+
+  return p1_cost < p2_cost ? p1 : p2;
+}
+/*---------------------------------------------------------------------------*/
+static rpl_dag_t *
+best_dag(rpl_dag_t *d1, rpl_dag_t *d2)
+{
+  if(d1->grounded != d2->grounded) {
+    return d1->grounded ? d1 : d2;
+  }
+
+  if(d1->preference != d2->preference) {
+    return d1->preference > d2->preference ? d1 : d2;
+  }
+
+  return d1->rank < d2->rank ? d1 : d2;
+}
+/*---------------------------------------------------------------------------*/
+#if !RPL_WITH_MC
+static void
+update_metric_container(rpl_instance_t *instance)
+{
+  instance->mc.type = RPL_DAG_MC_NONE;
+}
+#else /* RPL_WITH_MC */
+static void
+update_metric_container(rpl_instance_t *instance)
+{
+  rpl_dag_t *dag;
+  rpl_parent_t *p;
+  uint32_t latency;
+  uint8_t energy;
+  uint8_t type;
+
+  dag = instance->current_dag;
+  if(dag == NULL || !dag->joined) {
+    LOG_WARN("Cannot update the metric container when not joined\n");
+    return;
+  }
+
+  sample_node_state();
+
+  if(dag->rank == ROOT_RANK(instance)) {
+    /* Configure MC at root only, other nodes are auto-configured when joining */
+    instance->mc.type = RPL_DAG_MC;
+    instance->mc.flags = 0;
+    instance->mc.aggr = RPL_DAG_MC_AGGR_ADDITIVE;
+    instance->mc.prec = 0;
+    instance->mc.with_energy = RPL_LEOF_WITH_ENERGY;
+    latency = 0;
+    energy = 255;
+    type = RPL_DAG_MC_ENERGY_TYPE_MAINS;
+  } else {
+    p = dag->preferred_parent;
+    if(p == NULL) {
+      return;
+    }
+    latency = p->mc.obj.latency + link_latency_us(p) + queue_delay_us(p);
+    energy = p->mc.with_energy ? MIN(p->mc.energy.energy_est, energy_level) : energy_level;
+    type = RPL_DAG_MC_ENERGY_TYPE_BATTERY;
+  }
+
+  switch(instance->mc.type) {
+    case RPL_DAG_MC_NONE:
+      break;
+    case RPL_DAG_MC_LATENCY:
+      instance->mc.length = sizeof(instance->mc.obj.latency);
+      instance->mc.obj.latency = latency;
+      break;
+    default:
+      LOG_WARN("LEOF, non-supported MC %u\n", instance->mc.type);
+      break;
+  }
+
+  if(instance->mc.with_energy) {
+    instance->mc.energy.flags = (type << RPL_DAG_MC_ENERGY_TYPE)
+      | (1 << RPL_DAG_MC_ENERGY_ESTIMATION);
+    instance->mc.energy.energy_est = energy;
+  }
+
+  LOG_DBG("LEOF: latency %lu us, queue %u/16, energy %u\n",
+          (unsigned long)latency, queue_ewma, energy);
+}
+#endif /* RPL_WITH_MC */
+/*---------------------------------------------------------------------------*/
+rpl_of_t rpl_leof = {
+  reset,
+#if RPL_WITH_DAO_ACK
+  dao_ack_callback,
+#endif
+  parent_link_metric,
+  parent_has_usable_link,
+  parent_path_cost,
+  rank_via_parent,
+  best_parent,
+  best_dag,
+  update_metric_container,
+  RPL_OCP_LEOF
+};
+
+/** @}*/
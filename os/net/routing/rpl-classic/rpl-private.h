@@ -162,11 +162,11 @@
  * use 128 for RPL_MIN_HOPRANKINC, resulting in a rank equal to the
  * ETX path cost. Larger values may also be desirable, as discussed
  * in section 6.1 of RFC6719. */
-#if RPL_OF_OCP == RPL_OCP_MRHOF
+#if RPL_OF_OCP == RPL_OCP_MRHOF || RPL_OF_OCP == RPL_OCP_LEOF
 #define RPL_MIN_HOPRANKINC          128
-#else /* RPL_OF_OCP == RPL_OCP_MRHOF */
+#else /* RPL_OF_OCP == RPL_OCP_MRHOF || RPL_OF_OCP == RPL_OCP_LEOF */
 #define RPL_MIN_HOPRANKINC          256
-#endif /* RPL_OF_OCP == RPL_OCP_MRHOF */
+#endif /* RPL_OF_OCP == RPL_OCP_MRHOF || RPL_OF_OCP == RPL_OCP_LEOF */
 #else /* RPL_CONF_MIN_HOPRANKINC */
 #define RPL_MIN_HOPRANKINC          RPL_CONF_MIN_HOPRANKINC
 #endif /* RPL_CONF_MIN_HOPRANKINC */
@@ -257,6 +257,8 @@ struct rpl_stats {
   uint16_t loop_errors;
   uint16_t loop_warnings;
   uint16_t root_repairs;
+  uint16_t dao_out;        /* DAOs sent or forwarded */
+  uint16_t dao_aggregated; /* Child targets sent in aggregated DAOs */
 };
 typedef struct rpl_stats rpl_stats_t;
 
@@ -259,6 +259,8 @@ handle_dao_timer(void *ptr)
   rpl_instance_t *instance;
 #if RPL_WITH_MULTICAST
   uip_mcast6_route_t *mcast_route;
+#endif
+#if RPL_WITH_MULTICAST || RPL_WITH_NON_STORING_MULTICAST
   uint8_t i;
 #endif
 
@@ -299,6 +301,18 @@ handle_dao_timer(void *ptr)
         mcast_route = list_item_next(mcast_route);
       }
     }
+#endif
+#if RPL_WITH_NON_STORING_MULTICAST
+    /* In MOP 1 the DAOs for own multicast addresses go to the root */
+    if(RPL_IS_NON_STORING(instance)) {
+      for(i = 0; i < UIP_DS6_MADDR_NB; i++) {
+        if(uip_ds6_if.maddr_list[i].isused
+            && uip_is_addr_mcast_global(&uip_ds6_if.maddr_list[i].ipaddr)) {
+          dao_output_target(instance->current_dag->preferred_parent,
+              &uip_ds6_if.maddr_list[i].ipaddr, instance->default_lifetime);
+        }
+      }
+    }
 #endif
   } else {
     LOG_INFO("No suitable DAO parent\n");
@@ -85,6 +85,13 @@ typedef uint16_t rpl_ocp_t;
 /* IANA Objective Code Point as defined in RFC6550 */
 #define RPL_OCP_OF0     0
 #define RPL_OCP_MRHOF   1
+/* Latency and energy-aware OF (rpl-leof.c). Not IANA-assigned: all nodes
+ * of a DODAG must agree on the value. */
+#ifdef RPL_CONF_OCP_LEOF
+#define RPL_OCP_LEOF    RPL_CONF_OCP_LEOF
+#else /* RPL_CONF_OCP_LEOF */
+#define RPL_OCP_LEOF    0xfe
+#endif /* RPL_CONF_OCP_LEOF */
 
 struct rpl_metric_object_energy {
   uint8_t flags;
@@ -101,7 +108,12 @@ struct rpl_metric_container {
   union metric_object {
     struct rpl_metric_object_energy energy;
     uint16_t etx;
+    uint32_t latency; /* In microseconds (RFC6551, 3.4) */
   } obj;
+  /* Optional node energy object following the first object, for OFs that
+   * combine energy with another metric. Aggregated as a path minimum. */
+  uint8_t with_energy;
+  struct rpl_metric_object_energy energy;
 };
 typedef struct rpl_metric_container rpl_metric_container_t;
 /*---------------------------------------------------------------------------*/
@@ -158,11 +158,45 @@
 #define RPL_WITH_PROBING 1
 #endif
 
+/*
+ * Probing driven by the uncertainty of link estimates. Only neighbors that
+ * could become a better parent are probed, those with the fewest and the
+ * oldest link samples first. A probe is sent as soon as such a candidate
+ * appears, within a budget of RPL_PROBING_BUDGET non-urgent probes per
+ * RPL_PROBING_BUDGET_WINDOW. Neighbors that unicast traffic has measured
+ * within RPL_PROBING_PIGGYBACK_TIME are not probed.
+ */
+#ifdef RPL_CONF_PROBING_BY_UNCERTAINTY
+#define RPL_PROBING_BY_UNCERTAINTY RPL_CONF_PROBING_BY_UNCERTAINTY
+#else
+#define RPL_PROBING_BY_UNCERTAINTY 0
+#endif
+
+#ifdef RPL_CONF_PROBING_BUDGET
+#define RPL_PROBING_BUDGET RPL_CONF_PROBING_BUDGET
+#else
+#define RPL_PROBING_BUDGET 6
+#endif
+
+#ifdef RPL_CONF_PROBING_BUDGET_WINDOW
+#define RPL_PROBING_BUDGET_WINDOW RPL_CONF_PROBING_BUDGET_WINDOW
+#else
+#define RPL_PROBING_BUDGET_WINDOW (10 * 60 * CLOCK_SECOND)
+#endif
+
+#ifdef RPL_CONF_PROBING_PIGGYBACK_TIME
+#define RPL_PROBING_PIGGYBACK_TIME RPL_CONF_PROBING_PIGGYBACK_TIME
+#else
+#define RPL_PROBING_PIGGYBACK_TIME (RPL_PROBING_INTERVAL / 2)
+#endif
+
 /*
  * Function used to select the next neighbor to be probed.
  */
 #ifdef RPL_CONF_PROBING_SELECT_FUNC
 #define RPL_PROBING_SELECT_FUNC RPL_CONF_PROBING_SELECT_FUNC
+#elif RPL_PROBING_BY_UNCERTAINTY
+#define RPL_PROBING_SELECT_FUNC get_probing_target_by_uncertainty
 #else
 #define RPL_PROBING_SELECT_FUNC get_probing_target
 #endif
@@ -314,6 +348,43 @@
 #define RPL_DAO_DELAY                 (CLOCK_SECOND * 4)
 #endif /* RPL_CONF_DAO_DELAY */
 
+/* Maximum number of targets processed from a single DAO. DAOs from RPL Lite
+ * nodes only have one, but other implementations may advertise several
+ * targets, e.g. on behalf of their RPL-unaware leaves. Extra targets are
+ * ignored. */
+#ifdef RPL_CONF_DAO_MAX_TARGETS
+#define RPL_DAO_MAX_TARGETS RPL_CONF_DAO_MAX_TARGETS
+#else
+#define RPL_DAO_MAX_TARGETS 4
+#endif /* RPL_CONF_DAO_MAX_TARGETS */
+
+/* Batched DAO processing at the root. Incoming DAOs are queued (one entry
+ * per target, a newer DAO for a queued target replaces it) and applied to
+ * the source routing table every RPL_DAO_BATCH_DELAY, or as soon as the
+ * queue holds RPL_DAO_BATCH_SIZE targets. Each sender then gets one
+ * DAO-ACK for its latest DAO. */
+#ifdef RPL_CONF_DAO_BATCH
+#define RPL_DAO_BATCH RPL_CONF_DAO_BATCH
+#else
+#define RPL_DAO_BATCH 0
+#endif /* RPL_CONF_DAO_BATCH */
+
+#ifdef RPL_CONF_DAO_BATCH_SIZE
+#define RPL_DAO_BATCH_SIZE RPL_CONF_DAO_BATCH_SIZE
+#else
+#define RPL_DAO_BATCH_SIZE 16
+#endif /* RPL_CONF_DAO_BATCH_SIZE */
+
+#if RPL_DAO_BATCH && RPL_DAO_BATCH_SIZE < RPL_DAO_MAX_TARGETS
+#error "RPL_DAO_BATCH_SIZE must be able to hold all targets of a DAO"
+#endif
+
+#ifdef RPL_CONF_DAO_BATCH_DELAY
+#define RPL_DAO_BATCH_DELAY RPL_CONF_DAO_BATCH_DELAY
+#else
+#define RPL_DAO_BATCH_DELAY (CLOCK_SECOND / 4)
+#endif /* RPL_CONF_DAO_BATCH_DELAY */
+
 #ifdef RPL_CONF_DAO_MAX_RETRANSMISSIONS
 #define RPL_DAO_MAX_RETRANSMISSIONS RPL_CONF_DAO_MAX_RETRANSMISSIONS
 #else
@@ -367,6 +438,22 @@
 #define RPL_DEFAULT_INSTANCE	          0 /* Default of 0 for compression */
 #endif /* RPL_CONF_DEFAULT_INSTANCE */
 
+/*
+ * The maximum number of RPL instances a node takes part in at the same
+ * time, each with its own DAG, OF and neighbor set. Every instance costs
+ * a neighbor table, of which nbr-table supports at most 8 overall, and
+ * at most 4 instances are supported.
+ * Packets are sent in the instance set with UIPBUF_ATTR_RPL_INSTANCE, or
+ * else in the default instance: the one in the first instance slot, which
+ * the first instance joined takes. The routing driver API (node_has_joined,
+ * global_repair, etc.) also refers to the default instance.
+ */
+#ifdef RPL_CONF_MAX_INSTANCES
+#define RPL_MAX_INSTANCES RPL_CONF_MAX_INSTANCES
+#else
+#define RPL_MAX_INSTANCES 1
+#endif /* RPL_CONF_MAX_INSTANCES */
+
 /* Set to have the root advertise a grounded DAG */
 #ifndef RPL_CONF_GROUNDED
 #define RPL_GROUNDED                    0
@@ -44,11 +44,39 @@
 #include "net/ipv6/uip-ds6-route.h"
 #include "net/ipv6/uip-sr.h"
 
+#include <limits.h>
+#include <string.h>
+
 /* Log configuration */
 #include "sys/log.h"
 #define LOG_MODULE "RPL"
 #define LOG_LEVEL LOG_LEVEL_RPL
 
+static struct rpl_dag_root_dao_stats dao_stats;
+
+#if RPL_DAO_BATCH
+/* A queued DAO target */
+struct dao_entry {
+  uip_ipaddr_t prefix;
+  uip_ipaddr_t child;
+  uip_ipaddr_t parent;
+  uip_ipaddr_t from;
+  uint16_t sequence;
+  uint8_t prefixlen;
+  uint8_t lifetime;
+  uint8_t flags;
+};
+#define DAO_ENTRY_ACK     0x01 /* The DAO requested an ACK */
+#define DAO_ENTRY_FAILED  0x02 /* The target could not be applied */
+#define DAO_ENTRY_DONE    0x04 /* Processed along with its DAO */
+
+static struct dao_entry dao_queue[RPL_DAO_BATCH_SIZE];
+static uint8_t dao_queue_len;
+/* The instance of the queued DAOs */
+static rpl_instance_t *dao_queue_instance;
+static struct ctimer dao_batch_timer;
+#endif /* RPL_DAO_BATCH */
+
 /*---------------------------------------------------------------------------*/
 void
 rpl_dag_root_print_links(const char *str)
@@ -122,11 +150,19 @@ rpl_dag_root_set_prefix(uip_ipaddr_t *prefix, uip_ipaddr_t *iid)
 /*---------------------------------------------------------------------------*/
 int
 rpl_dag_root_start(void)
+{
+  return rpl_dag_root_start_instance(RPL_DEFAULT_INSTANCE, RPL_OF_OCP);
+}
+/*---------------------------------------------------------------------------*/
+int
+rpl_dag_root_start_instance(uint8_t instance_id, rpl_ocp_t ocp)
 {
   struct uip_ds6_addr *root_if;
   int i;
   uint8_t state;
   uip_ipaddr_t *ipaddr = NULL;
+  rpl_instance_t *instance = NULL;
+  rpl_instance_t *prev_instance;
 
   rpl_dag_root_set_prefix(NULL, NULL);
 
@@ -141,10 +177,15 @@ rpl_dag_root_start(void)
 
   root_if = uip_ds6_addr_lookup(ipaddr);
   if(ipaddr != NULL || root_if != NULL) {
-
-    rpl_dag_init_root(RPL_DEFAULT_INSTANCE, ipaddr,
+    instance = rpl_dag_init_root(instance_id, ocp, ipaddr,
       (uip_ipaddr_t *)rpl_get_global_address(), 64, UIP_ND6_RA_FLAG_AUTONOMOUS);
+  }
+
+  if(instance != NULL) {
+    prev_instance = rpl_set_curr_instance(instance);
     rpl_dag_update_state();
+    rpl_set_curr_instance(prev_instance);
+    rpl_dag_root_reset_dao_stats();
 
     LOG_INFO("created a new RPL DAG\n");
     return 0;
@@ -160,4 +201,318 @@ rpl_dag_root_is_root(void)
   return curr_instance.used && curr_instance.dag.rank == ROOT_RANK;
 }
 /*---------------------------------------------------------------------------*/
+/*
+ * Whether the graph has room for all the given child and parent addresses,
+ * i.e. whether the targets they come from can all be applied. Addresses
+ * already in the graph or counted before need no new node.
+ */
+static int
+graph_has_room(const uip_ipaddr_t **addrs, int count)
+{
+  int new_nodes = 0;
+  int i;
+  int j;
+
+  for(i = 0; i < count; i++) {
+    if(uip_sr_get_node(RPL_SR_GRAPH, addrs[i]) != NULL) {
+      continue;
+    }
+    for(j = 0; j < i; j++) {
+      if(uip_ipaddr_cmp(addrs[j], addrs[i])) {
+        break;
+      }
+    }
+    if(j == i) {
+      new_nodes++;
+    }
+  }
+  return uip_sr_num_nodes() + new_nodes <= UIP_SR_LINK_NUM;
+}
+/*---------------------------------------------------------------------------*/
+#if RPL_DAO_BATCH
+static void
+handle_dao_batch_timer(void *ptr)
+{
+  rpl_dag_root_flush_daos();
+}
+/*---------------------------------------------------------------------------*/
+/* Whether a queued entry is for the same target prefix. Only the first
+   prefixlen bits of the prefixes are significant. */
+static int
+same_target(const struct dao_entry *e, const rpl_dao_target_t *target)
+{
+  uint8_t bytes;
+  uint8_t bits;
+
+  if(e->prefixlen != target->prefixlen) {
+    return 0;
+  }
+  bytes = target->prefixlen / CHAR_BIT;
+  bits = target->prefixlen % CHAR_BIT;
+  if(memcmp(&e->prefix, &target->prefix, bytes) != 0) {
+    return 0;
+  }
+  return bits == 0 ||
+    ((e->prefix.u8[bytes] ^ target->prefix.u8[bytes]) & (0xff << (CHAR_BIT - bits) & 0xff)) == 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_dag_root_process_dao(uip_ipaddr_t *from, rpl_dao_t *dao)
+{
+  rpl_dao_target_t *target;
+  struct dao_entry *e;
+  uip_ipaddr_t *child;
+  int i;
+  int j;
+
+  dao_stats.daos++;
+  if(dao->target_count == 0) {
+    /* Nothing to apply, hence nothing to acknowledge */
+    LOG_WARN("DAO without target or transit, ignoring\n");
+    return;
+  }
+
+  if(dao_queue_len > 0 && (dao_queue_instance != &curr_instance ||
+     dao_queue_len + dao->target_count > RPL_DAO_BATCH_SIZE)) {
+    /* The queue holds the DAOs of one instance at a time, and all targets
+    of a DAO are queued together so that they are applied and ACKed in the
+    same batch */
+    rpl_dag_root_flush_daos();
+  }
+  dao_queue_instance = &curr_instance;
+
+  for(i = 0; i < dao->target_count; i++) {
+    target = &dao->targets[i];
+    child = target->prefixlen == 128 ? &target->prefix : from;
+    dao_stats.targets++;
+
+    /* A newer DAO for a queued target replaces it */
+    for(j = 0; j < dao_queue_len; j++) {
+      if(same_target(&dao_queue[j], target)) {
+        dao_stats.merged++;
+        break;
+      }
+    }
+    if(j == dao_queue_len) {
+      j = dao_queue_len++;
+    }
+
+    e = &dao_queue[j];
+    uip_ipaddr_copy(&e->prefix, &target->prefix);
+    e->prefixlen = target->prefixlen;
+    uip_ipaddr_copy(&e->child, child);
+    uip_ipaddr_copy(&e->parent, &target->parent_addr);
+    uip_ipaddr_copy(&e->from, from);
+    e->sequence = dao->sequence;
+    e->lifetime = target->lifetime;
+    e->flags = (dao->flags & RPL_DAO_K_FLAG) ? DAO_ENTRY_ACK : 0;
+  }
+
+  dao_stats.backlog = dao_queue_len;
+  if(dao_queue_len > dao_stats.max_backlog) {
+    dao_stats.max_backlog = dao_queue_len;
+  }
+  if(dao_queue_len > 0 && ctimer_expired(&dao_batch_timer)) {
+    ctimer_set(&dao_batch_timer, RPL_DAO_BATCH_DELAY, handle_dao_batch_timer, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+same_dao(const struct dao_entry *e1, const struct dao_entry *e2)
+{
+  return e1->sequence == e2->sequence && uip_ipaddr_cmp(&e1->from, &e2->from);
+}
+/*---------------------------------------------------------------------------*/
+static void
+apply_dao_queue(void)
+{
+  const uip_ipaddr_t *addrs[2 * RPL_DAO_BATCH_SIZE];
+  struct dao_entry *e;
+  struct dao_entry *f;
+  int count;
+  int fits;
+  int i;
+  int j;
+
+  /* Apply all targets, DAO by DAO: either all targets of a DAO are
+  applied, or none is */
+  for(i = 0; i < dao_queue_len; i++) {
+    e = &dao_queue[i];
+    if(e->flags & DAO_ENTRY_DONE) {
+      continue;
+    }
+
+    count = 0;
+    for(j = i; j < dao_queue_len; j++) {
+      f = &dao_queue[j];
+      if(same_dao(e, f) && f->lifetime != 0) {
+        addrs[count++] = &f->child;
+        addrs[count++] = &f->parent;
+      }
+    }
+    fits = graph_has_room(addrs, count);
+    if(!fits) {
+      LOG_ERR("no room for the targets of the DAO from ");
+      LOG_ERR_6ADDR(&e->from);
+      LOG_ERR_(", seqno %u\n", e->sequence);
+    }
+
+    for(j = i; j < dao_queue_len; j++) {
+      f = &dao_queue[j];
+      if(!same_dao(e, f)) {
+        continue;
+      }
+      f->flags |= DAO_ENTRY_DONE;
+      if(!fits) {
+        f->flags |= DAO_ENTRY_FAILED;
+        dao_stats.failed++;
+      } else if(f->lifetime == 0) {
+        uip_sr_expire_parent(RPL_SR_GRAPH, &f->child, &f->parent);
+        dao_stats.applied++;
+      } else if(!uip_sr_update_node(RPL_SR_GRAPH, &f->child, &f->parent,
+                                    RPL_LIFETIME(f->lifetime))) {
+        f->flags |= DAO_ENTRY_FAILED;
+        dao_stats.failed++;
+      } else {
+        dao_stats.applied++;
+      }
+    }
+  }
+
+#if RPL_WITH_DAO_ACK
+  /* One ACK per DAO, and only if all its targets were applied */
+  for(i = 0; i < dao_queue_len; i++) {
+    e = &dao_queue[i];
+    if(!(e->flags & DAO_ENTRY_ACK)) {
+      continue;
+    }
+    for(j = 0; j < dao_queue_len; j++) {
+      if(j != i && dao_queue[j].sequence == e->sequence
+         && uip_ipaddr_cmp(&dao_queue[j].from, &e->from)) {
+        if(dao_queue[j].flags & DAO_ENTRY_FAILED) {
+          e->flags |= DAO_ENTRY_FAILED;
+        }
+        /* Sent once, for the first entry of the DAO */
+        dao_queue[j].flags &= ~DAO_ENTRY_ACK;
+      }
+    }
+    if(!(e->flags & DAO_ENTRY_FAILED)) {
+      rpl_icmp6_dao_ack_output(&e->from, e->sequence, RPL_DAO_ACK_UNCONDITIONAL_ACCEPT);
+      dao_stats.acks++;
+    }
+  }
+#endif /* RPL_WITH_DAO_ACK */
+
+  LOG_INFO("applied a batch of %u DAO targets, %u routing links in total\n",
+           dao_queue_len, uip_sr_num_nodes());
+  dao_stats.batches++;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_dag_root_flush_daos(void)
+{
+  rpl_instance_t *prev_instance;
+
+  ctimer_stop(&dao_batch_timer);
+  if(dao_queue_len == 0) {
+    return;
+  }
+
+  prev_instance = rpl_set_curr_instance(dao_queue_instance);
+  /* Unless we left the DAG in the meantime */
+  if(rpl_dag_root_is_root()) {
+    apply_dao_queue();
+  }
+  dao_queue_len = 0;
+  dao_stats.backlog = 0;
+  rpl_set_curr_instance(prev_instance);
+}
+#else /* RPL_DAO_BATCH */
+void
+rpl_dag_root_process_dao(uip_ipaddr_t *from, rpl_dao_t *dao)
+{
+  const uip_ipaddr_t *addrs[2 * RPL_DAO_MAX_TARGETS];
+  rpl_dao_target_t *target;
+  uip_ipaddr_t *child;
+  int failed = 0;
+  int count;
+  int i;
+
+  dao_stats.daos++;
+  if(dao->target_count == 0) {
+    /* Nothing to apply, hence nothing to acknowledge */
+    LOG_WARN("DAO without target or transit, ignoring\n");
+    return;
+  }
+
+  /* Check that all targets can be applied before applying any: a DAO is
+  either installed and acknowledged as a whole, or not at all. In
+  non-storing mode, the target of a node's own DAO is its address, i.e.
+  the source of the DAO. */
+  count = 0;
+  for(i = 0; i < dao->target_count; i++) {
+    target = &dao->targets[i];
+    if(target->lifetime != 0) {
+      addrs[count++] = target->prefixlen == 128 ? &target->prefix : from;
+      addrs[count++] = &target->parent_addr;
+    }
+  }
+  dao_stats.targets += dao->target_count;
+  if(!graph_has_room(addrs, count)) {
+    LOG_ERR("no room for the %u targets of incoming DAO\n", dao->target_count);
+    /* Do not acknowledge, the sender will retransmit */
+    dao_stats.failed += dao->target_count;
+    return;
+  }
+
+  for(i = 0; i < dao->target_count; i++) {
+    target = &dao->targets[i];
+    child = target->prefixlen == 128 ? &target->prefix : from;
+    if(target->lifetime == 0) {
+      uip_sr_expire_parent(RPL_SR_GRAPH, child, &target->parent_addr);
+    } else if(!uip_sr_update_node(RPL_SR_GRAPH, child, &target->parent_addr,
+                                  RPL_LIFETIME(target->lifetime))) {
+      LOG_ERR("failed to add link on incoming DAO\n");
+      dao_stats.failed++;
+      failed = 1;
+      continue;
+    }
+    dao_stats.applied++;
+  }
+
+  if(failed) {
+    /* Do not acknowledge, the sender will retransmit */
+    return;
+  }
+
+#if RPL_WITH_DAO_ACK
+  if(dao->flags & RPL_DAO_K_FLAG) {
+    rpl_timers_schedule_dao_ack(from, dao->sequence);
+    dao_stats.acks++;
+  }
+#endif /* RPL_WITH_DAO_ACK */
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_dag_root_flush_daos(void)
+{
+}
+#endif /* RPL_DAO_BATCH */
+/*---------------------------------------------------------------------------*/
+const struct rpl_dag_root_dao_stats *
+rpl_dag_root_get_dao_stats(void)
+{
+  return &dao_stats;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_dag_root_reset_dao_stats(void)
+{
+  memset(&dao_stats, 0, sizeof(dao_stats));
+#if RPL_DAO_BATCH
+  dao_stats.backlog = dao_queue_len;
+#endif /* RPL_DAO_BATCH */
+  dao_stats.since = clock_time();
+}
+/*---------------------------------------------------------------------------*/
 /** @} */
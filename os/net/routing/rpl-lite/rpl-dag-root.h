@@ -57,6 +57,16 @@ void rpl_dag_root_set_prefix(uip_ipaddr_t *prefix, uip_ipaddr_t *iid);
 */
 int rpl_dag_root_start(void);
 
+/**
+ * Set the node as root of a given instance and start its DAG. With
+ * RPL_MAX_INSTANCES > 1, other instances are left untouched.
+ *
+ * \param instance_id The instance ID
+ * \param ocp The objective code point, of an OF in RPL_SUPPORTED_OFS
+ * \return 0 in case of success, -1 otherwise
+*/
+int rpl_dag_root_start_instance(uint8_t instance_id, rpl_ocp_t ocp);
+
 /**
  * Tells whether we are DAG root or not
  *
@@ -70,6 +80,46 @@ int rpl_dag_root_is_root(void);
 */
 void rpl_dag_root_print_links(const char *str);
 
+/** \brief Statistics of the root's DAO processing */
+struct rpl_dag_root_dao_stats {
+  uint32_t daos;          /**< DAOs received */
+  uint32_t targets;       /**< Targets received */
+  uint32_t merged;        /**< Targets that replaced a queued one */
+  uint32_t applied;       /**< Targets applied to the routing table */
+  uint32_t failed;        /**< Targets that could not be applied */
+  uint32_t acks;          /**< DAO-ACKs sent */
+  uint32_t batches;       /**< Batches applied */
+  uint16_t backlog;       /**< Targets currently queued */
+  uint16_t max_backlog;   /**< Highest backlog seen */
+  clock_time_t since;     /**< Time the statistics were reset */
+};
+
+/**
+ * Process a DAO at the root: apply its targets to the source routing table
+ * and acknowledge it, or queue it for the next batch if RPL_DAO_BATCH is set.
+ *
+ * \param from The source of the DAO
+ * \param dao The DAO
+*/
+void rpl_dag_root_process_dao(uip_ipaddr_t *from, rpl_dao_t *dao);
+
+/**
+ * Apply all queued DAOs now. Does nothing unless RPL_DAO_BATCH is set.
+*/
+void rpl_dag_root_flush_daos(void);
+
+/**
+ * Returns the statistics of the root's DAO processing
+ *
+ * \return The statistics
+*/
+const struct rpl_dag_root_dao_stats *rpl_dag_root_get_dao_stats(void);
+
+/**
+ * Reset the statistics of the root's DAO processing
+*/
+void rpl_dag_root_reset_dao_stats(void);
+
  /** @} */
 
 #endif /* RPL_DAG_ROOT_H_ */
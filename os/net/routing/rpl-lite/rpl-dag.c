@@ -59,7 +59,10 @@ static int process_dio_init_dag(rpl_dio_t *dio);
 
 /*---------------------------------------------------------------------------*/
 /* Allocate instance table. */
-rpl_instance_t curr_instance;
+rpl_instance_t rpl_instances[RPL_MAX_INSTANCES];
+#if RPL_MAX_INSTANCES > 1
+rpl_instance_t *rpl_curr_instance = &rpl_instances[0];
+#endif /* RPL_MAX_INSTANCES > 1 */
 
 /*---------------------------------------------------------------------------*/
 
@@ -95,6 +98,27 @@ rpl_dag_get_root_ipaddr(uip_ipaddr_t *ipaddr)
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+/* Whether an instance other than the current one is used. If prefix is not
+ * NULL, only instances with this same prefix are considered. */
+static int
+other_instance_used(const rpl_prefix_t *prefix)
+{
+  const rpl_instance_t *instance;
+  int i;
+
+  for(i = 0; i < RPL_MAX_INSTANCES; i++) {
+    instance = &rpl_instances[i];
+    if(instance != &curr_instance && instance->used
+       && (prefix == NULL
+           || (instance->dag.prefix_info.length == prefix->length
+               && uip_ipaddr_prefixcmp(&instance->dag.prefix_info.prefix,
+                                       &prefix->prefix, prefix->length)))) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
 void
 rpl_dag_leave(void)
 {
@@ -108,18 +132,21 @@ rpl_dag_leave(void)
     rpl_icmp6_dao_output(0);
   }
 
-  /* Forget past link statistics */
-  link_stats_reset();
+  /* Forget past link statistics, unless other instances still use them */
+  if(!other_instance_used(NULL)) {
+    link_stats_reset();
+  }
 
   /* Remove all neighbors, links and default route */
   rpl_neighbor_remove_all();
-  uip_sr_free_all();
+  uip_sr_free_graph(RPL_SR_GRAPH);
 
   /* Stop all timers */
   rpl_timers_stop_dag_timers();
 
   /* Remove autoconfigured address */
-  if((curr_instance.dag.prefix_info.flags & UIP_ND6_RA_FLAG_AUTONOMOUS)) {
+  if((curr_instance.dag.prefix_info.flags & UIP_ND6_RA_FLAG_AUTONOMOUS)
+     && !other_instance_used(&curr_instance.dag.prefix_info)) {
     rpl_reset_prefix(&curr_instance.dag.prefix_info);
   }
 
@@ -164,15 +191,55 @@ rpl_is_addr_in_our_dag(const uip_ipaddr_t *addr)
 rpl_instance_t *
 rpl_get_default_instance(void)
 {
-  return curr_instance.used ? &curr_instance : NULL;
+  return rpl_instances[0].used ? &rpl_instances[0] : NULL;
 }
 /*---------------------------------------------------------------------------*/
 rpl_dag_t *
 rpl_get_any_dag(void)
 {
-  return curr_instance.used ? &curr_instance.dag : NULL;
+  int i;
+  for(i = 0; i < RPL_MAX_INSTANCES; i++) {
+    if(rpl_instances[i].used) {
+      return &rpl_instances[i].dag;
+    }
+  }
+  return NULL;
 }
 /*---------------------------------------------------------------------------*/
+rpl_instance_t *
+rpl_get_instance(uint8_t instance_id)
+{
+  int i;
+  for(i = 0; i < RPL_MAX_INSTANCES; i++) {
+    if(rpl_instances[i].used && rpl_instances[i].instance_id == instance_id) {
+      return &rpl_instances[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static rpl_instance_t *
+get_free_instance(void)
+{
+  int i;
+  for(i = 0; i < RPL_MAX_INSTANCES; i++) {
+    if(!rpl_instances[i].used) {
+      return &rpl_instances[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+#if RPL_MAX_INSTANCES > 1
+rpl_instance_t *
+rpl_set_curr_instance(rpl_instance_t *instance)
+{
+  rpl_instance_t *prev_instance = rpl_curr_instance;
+  rpl_curr_instance = instance;
+  return prev_instance;
+}
+#endif /* RPL_MAX_INSTANCES > 1 */
+/*---------------------------------------------------------------------------*/
 static rpl_of_t *
 find_objective_function(rpl_ocp_t ocp)
 {
@@ -367,6 +434,7 @@ update_nbr_from_dio(uip_ipaddr_t *from, rpl_dio_t *dio)
 {
   rpl_nbr_t *nbr = NULL;
   const uip_lladdr_t *lladdr;
+  int is_new = 0;
 
   nbr = rpl_neighbor_get_from_ipaddr(from);
   /* Neighbor not in RPL neighbor table, add it */
@@ -385,6 +453,7 @@ update_nbr_from_dio(uip_ipaddr_t *from, rpl_dio_t *dio)
       LOG_ERR("failed to add neighbor\n");
       return NULL;
     }
+    is_new = 1;
   }
 
   /* Update neighbor info from DIO */
@@ -393,6 +462,10 @@ update_nbr_from_dio(uip_ipaddr_t *from, rpl_dio_t *dio)
 #if RPL_WITH_MC
   memcpy(&nbr->mc, &dio->mc, sizeof(nbr->mc));
 #endif /* RPL_WITH_MC */
+  rpl_neighbor_update(nbr);
+  if(is_new) {
+    rpl_timers_probing_new_candidate(nbr);
+  }
 
   return nbr;
 }
@@ -575,6 +648,7 @@ process_dio_init_dag(rpl_dio_t *dio)
 
   /* Init OF and timers */
   curr_instance.of->reset();
+  rpl_neighbor_update_all();
   rpl_timers_dio_reset("Join");
 #if RPL_WITH_PROBING
   rpl_schedule_probing();
@@ -599,11 +673,23 @@ process_dio_init_dag(rpl_dio_t *dio)
 void
 rpl_process_dio(uip_ipaddr_t *from, rpl_dio_t *dio)
 {
+  rpl_instance_t *instance;
+  rpl_instance_t *prev_instance;
+
+  instance = rpl_get_instance(dio->instance_id);
+  if(instance == NULL) {
+    /* Not part of this instance, join it if there is room */
+    instance = get_free_instance();
+    if(instance == NULL) {
+      return;
+    }
+  }
+  prev_instance = rpl_set_curr_instance(instance);
+
   if(!curr_instance.used && !rpl_dag_root_is_root()) {
     /* Attempt to init our DAG from this DIO */
     if(!process_dio_init_dag(dio)) {
       LOG_WARN("failed to init DAG\n");
-      return;
     }
   }
 
@@ -613,39 +699,43 @@ rpl_process_dio(uip_ipaddr_t *from, rpl_dio_t *dio)
     process_dio_from_current_dag(from, dio);
     rpl_dag_update_state();
   }
+
+  rpl_set_curr_instance(prev_instance);
 }
 /*---------------------------------------------------------------------------*/
 void
 rpl_process_dis(uip_ipaddr_t *from, int is_multicast)
 {
-  if(is_multicast) {
-    rpl_timers_dio_reset("Multicast DIS");
-  } else {
-    /* Add neighbor to cache and reply to the unicast DIS with a unicast DIO*/
-    if(rpl_icmp6_update_nbr_table(from, NBR_TABLE_REASON_RPL_DIS, NULL) != NULL) {
+  rpl_instance_t *prev_instance;
+  int i;
+
+  /* Add neighbor to cache before replying to the unicast DIS */
+  if(!is_multicast
+     && rpl_icmp6_update_nbr_table(from, NBR_TABLE_REASON_RPL_DIS, NULL) == NULL) {
+    return;
+  }
+
+  /* Answer for every instance we are part of */
+  for(i = 0; i < RPL_MAX_INSTANCES; i++) {
+    if(!rpl_instances[i].used) {
+      continue;
+    }
+    prev_instance = rpl_set_curr_instance(&rpl_instances[i]);
+    if(is_multicast) {
+      rpl_timers_dio_reset("Multicast DIS");
+    } else {
+      /* Reply to the unicast DIS with a unicast DIO */
       LOG_INFO("unicast DIS, reply to sender\n");
       rpl_icmp6_dio_output(from);
     }
+    rpl_set_curr_instance(prev_instance);
   }
 }
 /*---------------------------------------------------------------------------*/
 void
 rpl_process_dao(uip_ipaddr_t *from, rpl_dao_t *dao)
 {
-  if(dao->lifetime == 0) {
-    uip_sr_expire_parent(NULL, from, &dao->parent_addr);
-  } else {
-    if(!uip_sr_update_node(NULL, from, &dao->parent_addr, RPL_LIFETIME(dao->lifetime))) {
-      LOG_ERR("failed to add link on incoming DAO\n");
-      return;
-    }
-  }
-
-#if RPL_WITH_DAO_ACK
-  if(dao->flags & RPL_DAO_K_FLAG) {
-    rpl_timers_schedule_dao_ack(from, dao->sequence);
-  }
-#endif /* RPL_WITH_DAO_ACK */
+  rpl_dag_root_process_dao(from, dao);
 }
 /*---------------------------------------------------------------------------*/
 #if RPL_WITH_DAO_ACK
@@ -700,6 +790,7 @@ rpl_process_hbh(rpl_nbr_t *sender, uint16_t sender_rank, int loop_detected, int
      * the sender's rank from ext header */
     if(sender != NULL) {
       sender->rank = sender_rank;
+      rpl_neighbor_update(sender);
       /* Select DAG and preferred parent. In case of a parent switch,
       the new parent will be used to forward the current packet. */
       rpl_dag_update_state();
@@ -709,11 +800,27 @@ rpl_process_hbh(rpl_nbr_t *sender, uint16_t sender_rank, int loop_detected, int
   return !drop;
 }
 /*---------------------------------------------------------------------------*/
-void
-rpl_dag_init_root(uint8_t instance_id, uip_ipaddr_t *dag_id,
+rpl_instance_t *
+rpl_dag_init_root(uint8_t instance_id, rpl_ocp_t ocp, uip_ipaddr_t *dag_id,
             uip_ipaddr_t *prefix, unsigned prefix_len, uint8_t prefix_flags)
 {
   uint8_t version = RPL_LOLLIPOP_INIT;
+  rpl_instance_t *instance;
+  rpl_instance_t *prev_instance;
+
+#if RPL_MAX_INSTANCES > 1
+  instance = rpl_get_instance(instance_id);
+  if(instance == NULL) {
+    instance = get_free_instance();
+    if(instance == NULL) {
+      LOG_ERR("no room for instance %u\n", instance_id);
+      return NULL;
+    }
+  }
+#else /* RPL_MAX_INSTANCES > 1 */
+  instance = &curr_instance;
+#endif /* RPL_MAX_INSTANCES > 1 */
+  prev_instance = rpl_set_curr_instance(instance);
 
   /* If we're in an instance, first leave it */
   if(curr_instance.used) {
@@ -726,7 +833,10 @@ rpl_dag_init_root(uint8_t instance_id, uip_ipaddr_t *dag_id,
   }
 
   /* Init DAG and instance */
-  init_dag(instance_id, dag_id, RPL_OF_OCP, prefix, prefix_len, prefix_flags);
+  if(!init_dag(instance_id, dag_id, ocp, prefix, prefix_len, prefix_flags)) {
+    rpl_set_curr_instance(prev_instance);
+    return NULL;
+  }
 
   /* Instance */
   curr_instance.mop = RPL_MOP_DEFAULT;
@@ -756,12 +866,15 @@ rpl_dag_init_root(uint8_t instance_id, uip_ipaddr_t *dag_id,
   LOG_INFO_(", rank %u\n", curr_instance.dag.rank);
 
   LOG_ANNOTATE("#A root=%u\n", curr_instance.dag.dag_id.u8[sizeof(curr_instance.dag.dag_id) - 1]);
+
+  rpl_set_curr_instance(prev_instance);
+  return instance;
 }
 /*---------------------------------------------------------------------------*/
 void
 rpl_dag_init(void)
 {
-  memset(&curr_instance, 0, sizeof(curr_instance));
+  memset(rpl_instances, 0, sizeof(rpl_instances));
 }
 /*---------------------------------------------------------------------------*/
 /** @} */
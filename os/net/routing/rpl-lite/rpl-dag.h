@@ -106,31 +106,44 @@ void rpl_local_repair(const char *str);
 int rpl_is_addr_in_our_dag(const uip_ipaddr_t *addr);
 
 /**
- * Initializes DAG internal structure for a root node
+ * Initializes DAG internal structure for a root node. The instance is
+ * re-initialized if it exists. Else, with RPL_MAX_INSTANCES > 1, it is
+ * created in a free instance slot; with a single instance, the node
+ * leaves its current instance.
  *
  * \param instance_id The instance ID
+ * \param ocp The objective code point of the instance's OF
  * \param dag_id The DAG ID
  * \param prefix The prefix
  * \param prefix_len The prefix length
  * \param flags The prefix flags (from DIO)
+ * \return The instance, NULL if it could not be initialized
 */
-void rpl_dag_init_root(uint8_t instance_id, uip_ipaddr_t *dag_id,
-  uip_ipaddr_t *prefix, unsigned prefix_len, uint8_t flags);
+rpl_instance_t *rpl_dag_init_root(uint8_t instance_id, rpl_ocp_t ocp,
+  uip_ipaddr_t *dag_id, uip_ipaddr_t *prefix, unsigned prefix_len, uint8_t flags);
 
 /**
  * Returns pointer to the default instance (for compatibility with legagy RPL code)
  *
- * \return A pointer to the only supported instance
+ * \return A pointer to the default instance, NULL if not used
 */
 rpl_instance_t *rpl_get_default_instance(void);
 
 /**
  * Returns pointer to any DAG (for compatibility with legagy RPL code)
  *
- * \return A pointer to the only supported DAG
+ * \return A pointer to a DAG, NULL if the node is in no instance
 */
 rpl_dag_t *rpl_get_any_dag(void);
 
+/**
+ * Returns the instance with a given ID
+ *
+ * \param instance_id The instance ID
+ * \return A pointer to the instance, NULL if the node is not part of it
+*/
+rpl_instance_t *rpl_get_instance(uint8_t instance_id);
+
 /**
  * Processes Hop-by-Hop (HBH) Extension Header of a packet currently being forwrded.
  *
@@ -54,8 +54,52 @@
 #define LOG_LEVEL LOG_LEVEL_RPL
 
 /*---------------------------------------------------------------------------*/
-int
-rpl_ext_header_srh_get_next_hop(uip_ipaddr_t *ipaddr)
+#if RPL_MAX_INSTANCES > 1
+/* The instance of the packet in uip_buf: the one of its RPL HBH option if
+ * any, else the one requested with UIPBUF_ATTR_RPL_INSTANCE, else the
+ * current one. Falls back to the current instance if the node is not part
+ * of the instance. */
+static rpl_instance_t *
+packet_instance(void)
+{
+  struct uip_ext_hdr_opt_rpl *rpl_opt = (struct uip_ext_hdr_opt_rpl *)(UIP_IP_PAYLOAD(2));
+  rpl_instance_t *instance = NULL;
+
+  if(UIP_IP_BUF->proto == UIP_PROTO_HBHO && rpl_opt->opt_type == UIP_EXT_HDR_OPT_RPL) {
+    instance = rpl_get_instance(rpl_opt->instance);
+  } else if(uipbuf_get_attr(UIPBUF_ATTR_RPL_INSTANCE) != UIPBUF_ATTR_RPL_INSTANCE_DEFAULT) {
+    instance = rpl_get_instance(uipbuf_get_attr(UIPBUF_ATTR_RPL_INSTANCE));
+  }
+
+  return instance != NULL ? instance : &curr_instance;
+}
+/*---------------------------------------------------------------------------*/
+/* Packets going up follow the preferred parent of their instance rather
+ * than the default route, which is shared by all instances */
+static int
+parent_get_next_hop(uip_ipaddr_t *ipaddr)
+{
+  uip_ipaddr_t *parent_ipaddr;
+
+  if(!curr_instance.used || rpl_dag_root_is_root()
+     || uip_ds6_is_addr_onlink(&UIP_IP_BUF->destipaddr)) {
+    return 0;
+  }
+
+  parent_ipaddr = rpl_neighbor_get_ipaddr(curr_instance.dag.preferred_parent);
+  if(parent_ipaddr == NULL) {
+    return 0;
+  }
+
+  uip_ipaddr_copy(ipaddr, parent_ipaddr);
+  return 1;
+}
+#else /* RPL_MAX_INSTANCES > 1 */
+#define packet_instance() (&curr_instance)
+#endif /* RPL_MAX_INSTANCES > 1 */
+/*---------------------------------------------------------------------------*/
+static int
+srh_get_next_hop(uip_ipaddr_t *ipaddr)
 {
   struct uip_routing_hdr *rh_header;
   uip_sr_node_t *dest_node;
@@ -68,8 +112,8 @@ rpl_ext_header_srh_get_next_hop(uip_ipaddr_t *ipaddr)
     return 0;
   }
 
-  root_node = uip_sr_get_node(NULL, &curr_instance.dag.dag_id);
-  dest_node = uip_sr_get_node(NULL, &UIP_IP_BUF->destipaddr);
+  root_node = uip_sr_get_node(RPL_SR_GRAPH, &curr_instance.dag.dag_id);
+  dest_node = uip_sr_get_node(RPL_SR_GRAPH, &UIP_IP_BUF->destipaddr);
 
   if((rh_header != NULL && rh_header->routing_type == RPL_RH_TYPE_SRH) ||
      (dest_node != NULL && root_node != NULL &&
@@ -88,6 +132,22 @@ rpl_ext_header_srh_get_next_hop(uip_ipaddr_t *ipaddr)
 }
 /*---------------------------------------------------------------------------*/
 int
+rpl_ext_header_srh_get_next_hop(uip_ipaddr_t *ipaddr)
+{
+  rpl_instance_t *prev_instance = rpl_set_curr_instance(packet_instance());
+  int ret = srh_get_next_hop(ipaddr);
+
+#if RPL_MAX_INSTANCES > 1
+  if(!ret) {
+    ret = parent_get_next_hop(ipaddr);
+  }
+#endif /* RPL_MAX_INSTANCES > 1 */
+
+  rpl_set_curr_instance(prev_instance);
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
+int
 rpl_ext_header_srh_update(void)
 {
   struct uip_routing_hdr *rh_header;
@@ -198,20 +258,20 @@ insert_srh_header(void)
     return 1;
   }
 
-  dest_node = uip_sr_get_node(NULL, &UIP_IP_BUF->destipaddr);
+  dest_node = uip_sr_get_node(RPL_SR_GRAPH, &UIP_IP_BUF->destipaddr);
   if(dest_node == NULL) {
     /* The destination is not found, skip SRH insertion */
     LOG_INFO("SRH node not found, skip SRH insertion\n");
     return 1;
   }
 
-  root_node = uip_sr_get_node(NULL, &curr_instance.dag.dag_id);
+  root_node = uip_sr_get_node(RPL_SR_GRAPH, &curr_instance.dag.dag_id);
   if(root_node == NULL) {
     LOG_ERR("SRH root node not found\n");
     return 0;
   }
 
-  if(!uip_sr_is_addr_reachable(NULL, &UIP_IP_BUF->destipaddr)) {
+  if(!uip_sr_is_addr_reachable(RPL_SR_GRAPH, &UIP_IP_BUF->destipaddr)) {
     LOG_ERR("SRH no path found to destination\n");
     return 0;
   }
@@ -311,6 +371,9 @@ rpl_ext_header_hbh_update(uint8_t *ext_buf, int opt_offset)
   uint16_t sender_rank;
   uint8_t sender_closer;
   rpl_nbr_t *sender;
+  rpl_instance_t *instance;
+  rpl_instance_t *prev_instance;
+  int ret;
   struct uip_hbho_hdr *hbh_hdr = (struct uip_hbho_hdr *)ext_buf;
   struct uip_ext_hdr_opt_rpl *rpl_opt = (struct uip_ext_hdr_opt_rpl *)(ext_buf + opt_offset);
 
@@ -322,7 +385,8 @@ rpl_ext_header_hbh_update(uint8_t *ext_buf, int opt_offset)
     return 0; /* Drop */
   }
 
-  if(!curr_instance.used || curr_instance.instance_id != rpl_opt->instance) {
+  instance = rpl_get_instance(rpl_opt->instance);
+  if(instance == NULL) {
     LOG_ERR("unknown instance: %u\n", rpl_opt->instance);
     return 0; /* Drop */
   }
@@ -332,6 +396,8 @@ rpl_ext_header_hbh_update(uint8_t *ext_buf, int opt_offset)
     return 0; /* Drop */
   }
 
+  prev_instance = rpl_set_curr_instance(instance);
+
   down = (rpl_opt->flags & RPL_HDR_OPT_DOWN) ? 1 : 0;
   sender_rank = UIP_HTONS(rpl_opt->senderrank);
   sender = nbr_table_get_from_lladdr(rpl_neighbors, packetbuf_addr(PACKETBUF_ADDR_SENDER));
@@ -352,7 +418,9 @@ rpl_ext_header_hbh_update(uint8_t *ext_buf, int opt_offset)
     rpl_opt->flags |= RPL_HDR_OPT_RANK_ERR;
   }
 
-  return rpl_process_hbh(sender, sender_rank, loop_detected, rank_error_signaled);
+  ret = rpl_process_hbh(sender, sender_rank, loop_detected, rank_error_signaled);
+  rpl_set_curr_instance(prev_instance);
+  return ret;
 }
 /*---------------------------------------------------------------------------*/
 /* In-place update of the RPL HBH extension header, when already present
@@ -425,8 +493,8 @@ insert_hbh_header(void)
   return update_hbh_header();
 }
 /*---------------------------------------------------------------------------*/
-int
-rpl_ext_header_update(void)
+static int
+update_ext_headers(void)
 {
   if(!curr_instance.used
       || uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr)
@@ -453,6 +521,16 @@ rpl_ext_header_update(void)
   }
 }
 /*---------------------------------------------------------------------------*/
+int
+rpl_ext_header_update(void)
+{
+  rpl_instance_t *prev_instance = rpl_set_curr_instance(packet_instance());
+  int ret = update_ext_headers();
+
+  rpl_set_curr_instance(prev_instance);
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
 bool
 rpl_ext_header_remove(void)
 {
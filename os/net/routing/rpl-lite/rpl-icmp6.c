@@ -131,7 +131,7 @@ rpl_icmp6_update_nbr_table(uip_ipaddr_t *from, nbr_table_reason_t reason, void *
 static void
 dis_input(void)
 {
-  if(!curr_instance.used) {
+  if(rpl_get_any_dag() == NULL) {
     LOG_WARN("dis_input: not in an instance yet, discard\n");
     goto discard;
   }
@@ -455,31 +455,36 @@ static void
 dao_input(void)
 {
   struct rpl_dao dao;
+  rpl_dao_target_t *target;
   uint8_t subopt_type;
   unsigned char *buffer;
   uint8_t buffer_length;
+  uint8_t first_target; /* The first target the next transit applies to */
   int pos;
   int len;
   int i;
+  int j;
   uip_ipaddr_t from;
+  rpl_instance_t *instance;
+  rpl_instance_t *prev_instance = &curr_instance;
 
   memset(&dao, 0, sizeof(dao));
 
   dao.instance_id = UIP_ICMP_PAYLOAD[0];
-  if(!curr_instance.used || curr_instance.instance_id != dao.instance_id) {
+  instance = rpl_get_instance(dao.instance_id);
+  if(instance == NULL) {
     LOG_ERR("dao_input: unknown RPL instance %u, discard\n", dao.instance_id);
     goto discard;
   }
+  prev_instance = rpl_set_curr_instance(instance);
 
   uip_ipaddr_copy(&from, &UIP_IP_BUF->srcipaddr);
-  memset(&dao.parent_addr, 0, 16);
 
   buffer = UIP_ICMP_PAYLOAD;
   buffer_length = uip_len - uip_l3_icmp_hdr_len;
 
   pos = 0;
   pos++; /* instance ID */
-  dao.lifetime = curr_instance.default_lifetime;
   dao.flags = buffer[pos++];
   pos++; /* reserved */
   dao.sequence = buffer[pos++];
@@ -495,7 +500,9 @@ dao_input(void)
     pos += 16;
   }
 
-  /* Check if there are any RPL options present. */
+  /* Check if there are any RPL options present. A transit option applies
+   * to all targets since the previous transit option (RFC 6550, 9.4). */
+  first_target = 0;
   for(i = pos; i < buffer_length; i += len) {
     subopt_type = buffer[i];
     if(subopt_type == RPL_OPTION_PAD1) {
@@ -508,34 +515,64 @@ dao_input(void)
     switch(subopt_type) {
       case RPL_OPTION_TARGET:
         /* Handle the target option. */
-        dao.prefixlen = buffer[i + 3];
-        memset(&dao.prefix, 0, sizeof(dao.prefix));
-        memcpy(&dao.prefix, buffer + i + 4, (dao.prefixlen + 7) / CHAR_BIT);
+        if(buffer[i + 3] > 128) {
+          LOG_WARN("dao_input: invalid target prefix length %u\n", buffer[i + 3]);
+          break;
+        }
+        if(dao.target_count == RPL_DAO_MAX_TARGETS) {
+          LOG_WARN("dao_input: too many targets, ignoring ");
+          LOG_WARN_6ADDR((uip_ipaddr_t *)(buffer + i + 4));
+          LOG_WARN_("\n");
+          break;
+        }
+        target = &dao.targets[dao.target_count++];
+        target->prefixlen = buffer[i + 3];
+        memcpy(&target->prefix, buffer + i + 4, (target->prefixlen + 7) / CHAR_BIT);
+        target->lifetime = curr_instance.default_lifetime;
         break;
       case RPL_OPTION_TRANSIT:
         /* The path sequence and control are ignored. */
         /*      pathcontrol = buffer[i + 3];
                 pathsequence = buffer[i + 4];*/
-        dao.lifetime = buffer[i + 5];
-        if(len >= 20) {
-          memcpy(&dao.parent_addr, buffer + i + 6, 16);
+        if(dao.target_count == 0) {
+          /* No target option: the transit applies to the sender */
+          dao.target_count = 1;
+        }
+        for(j = first_target; j < dao.target_count; j++) {
+          dao.targets[j].lifetime = buffer[i + 5];
+          if(len >= 20) {
+            memcpy(&dao.targets[j].parent_addr, buffer + i + 6, 16);
+          }
         }
+        first_target = dao.target_count;
         break;
     }
   }
 
+  if(first_target < dao.target_count) {
+    /* Targets must be followed by a transit option, which we need for the
+     * parent address */
+    LOG_WARN("dao_input: %u targets without transit information, ignoring\n",
+             dao.target_count - first_target);
+    dao.target_count = first_target;
+  }
+
   /* Destination Advertisement Object */
-  LOG_INFO("received a %sDAO from ", dao.lifetime == 0 ? "No-path " : "");
-  LOG_INFO_6ADDR(&UIP_IP_BUF->srcipaddr);
-  LOG_INFO_(", seqno %u, lifetime %u, prefix ", dao.sequence, dao.lifetime);
-  LOG_INFO_6ADDR(&dao.prefix);
-  LOG_INFO_(", prefix length %u, parent ", dao.prefixlen);
-  LOG_INFO_6ADDR(&dao.parent_addr);
-  LOG_INFO_(" \n");
+  for(j = 0; j < dao.target_count; j++) {
+    target = &dao.targets[j];
+    LOG_INFO("received a %sDAO from ", target->lifetime == 0 ? "No-path " : "");
+    LOG_INFO_6ADDR(&UIP_IP_BUF->srcipaddr);
+    LOG_INFO_(", seqno %u, lifetime %u, prefix ", dao.sequence, target->lifetime);
+    LOG_INFO_6ADDR(&target->prefix);
+    LOG_INFO_(", prefix length %u, parent ", target->prefixlen);
+    LOG_INFO_6ADDR(&target->parent_addr);
+    LOG_INFO_(" \n");
+  }
 
   rpl_process_dao(&from, &dao);
 
   discard:
+    rpl_set_curr_instance(prev_instance);
     uipbuf_clear();
 }
 /*---------------------------------------------------------------------------*/
@@ -626,6 +663,8 @@ dao_ack_input(void)
   uint8_t instance_id;
   uint8_t sequence;
   uint8_t status;
+  rpl_instance_t *instance;
+  rpl_instance_t *prev_instance = &curr_instance;
 
   buffer = UIP_ICMP_PAYLOAD;
 
@@ -633,10 +672,12 @@ dao_ack_input(void)
   sequence = buffer[2];
   status = buffer[3];
 
-  if(!curr_instance.used || curr_instance.instance_id != instance_id) {
+  instance = rpl_get_instance(instance_id);
+  if(instance == NULL) {
     LOG_ERR("dao_ack_input: unknown instance, discard\n");
     goto discard;
   }
+  prev_instance = rpl_set_curr_instance(instance);
 
   LOG_INFO("received a DAO-%s with seqno %d (%d %d) and status %d from ",
          status < RPL_DAO_ACK_UNABLE_TO_ACCEPT ? "ACK" : "NACK", sequence,
@@ -647,6 +688,7 @@ dao_ack_input(void)
   rpl_process_dao_ack(sequence, status);
 
   discard:
+    rpl_set_curr_instance(prev_instance);
     uipbuf_clear();
 }
 /*---------------------------------------------------------------------------*/
@@ -72,15 +72,22 @@ struct rpl_dio {
 };
 typedef struct rpl_dio rpl_dio_t;
 
-/* Logical representation of a Destination Advertisement Object (DAO.) */
-struct rpl_dao {
+/* A DAO target, with the transit information that applies to it */
+struct rpl_dao_target {
   uip_ipaddr_t parent_addr;
   uip_ipaddr_t prefix;
-  uint16_t sequence;
-  uint8_t instance_id;
   uint8_t lifetime;
   uint8_t prefixlen;
+};
+typedef struct rpl_dao_target rpl_dao_target_t;
+
+/* Logical representation of a Destination Advertisement Object (DAO.) */
+struct rpl_dao {
+  rpl_dao_target_t targets[RPL_DAO_MAX_TARGETS];
+  uint16_t sequence;
+  uint8_t instance_id;
   uint8_t flags;
+  uint8_t target_count;
 };
 typedef struct rpl_dao rpl_dao_t;
 
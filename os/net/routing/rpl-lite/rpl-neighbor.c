@@ -47,6 +47,7 @@
 #include "net/link-stats.h"
 #include "net/nbr-table.h"
 #include "net/ipv6/uiplib.h"
+#include "lib/list.h"
 
 /* Log configuration */
 #include "sys/log.h"
@@ -61,8 +62,32 @@ void RPL_CALLBACK_PARENT_SWITCH(rpl_nbr_t *old, rpl_nbr_t *new);
 static rpl_nbr_t * best_parent(int fresh_only);
 
 /*---------------------------------------------------------------------------*/
+#if RPL_MAX_INSTANCES > 1
+#if RPL_MAX_INSTANCES > 4
+#error "RPL Lite supports at most 4 instances"
+#endif /* RPL_MAX_INSTANCES > 4 */
+/* Per-neighbor RPL information, one table per instance */
+NBR_TABLE(rpl_nbr_t, instance_neighbors_0);
+NBR_TABLE(rpl_nbr_t, instance_neighbors_1);
+#if RPL_MAX_INSTANCES > 2
+NBR_TABLE(rpl_nbr_t, instance_neighbors_2);
+#endif /* RPL_MAX_INSTANCES > 2 */
+#if RPL_MAX_INSTANCES > 3
+NBR_TABLE(rpl_nbr_t, instance_neighbors_3);
+#endif /* RPL_MAX_INSTANCES > 3 */
+nbr_table_t *rpl_neighbor_tables[RPL_MAX_INSTANCES];
+/* All neighbors of each instance, sorted by increasing path cost */
+static void *candidates_lists[RPL_MAX_INSTANCES];
+#define candidates ((list_t)&candidates_lists[rpl_curr_instance - rpl_instances])
+#else /* RPL_MAX_INSTANCES > 1 */
 /* Per-neighbor RPL information */
 NBR_TABLE_GLOBAL(rpl_nbr_t, rpl_neighbors);
+/* All neighbors, sorted by increasing path cost. Updated whenever the
+ * path cost via a neighbor changes, so that the best parent is found
+ * at or near the head. */
+LIST(candidates);
+#endif /* RPL_MAX_INSTANCES > 1 */
+static struct rpl_neighbor_stats stats;
 
 /*---------------------------------------------------------------------------*/
 static int
@@ -205,10 +230,33 @@ remove_neighbor(rpl_nbr_t *nbr)
   if(nbr == curr_instance.dag.unicast_dio_target) {
     curr_instance.dag.unicast_dio_target = NULL;
   }
+  list_remove(candidates, nbr);
   nbr_table_remove(rpl_neighbors, nbr);
   rpl_timers_schedule_state_update(); /* Updating from here is unsafe; postpone */
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_MAX_INSTANCES > 1
+/* Called by nbr-table when evicting a neighbor of any instance */
+static void
+evict_neighbor(rpl_nbr_t *nbr)
+{
+  const rpl_nbr_t *mem;
+  rpl_instance_t *prev_instance;
+  int i;
+
+  /* Find the table, hence the instance, the neighbor belongs to */
+  for(i = 0; i < RPL_MAX_INSTANCES; i++) {
+    mem = (const rpl_nbr_t *)rpl_neighbor_tables[i]->data;
+    if(nbr >= mem && nbr < mem + NBR_TABLE_MAX_NEIGHBORS) {
+      prev_instance = rpl_set_curr_instance(&rpl_instances[i]);
+      remove_neighbor(nbr);
+      rpl_set_curr_instance(prev_instance);
+      return;
+    }
+  }
+}
+#endif /* RPL_MAX_INSTANCES > 1 */
+/*---------------------------------------------------------------------------*/
 rpl_nbr_t *
 rpl_neighbor_get_from_lladdr(uip_lladdr_t *addr)
 {
@@ -311,11 +359,17 @@ rpl_neighbor_set_preferred_parent(rpl_nbr_t *nbr)
     nbr_table_unlock(rpl_neighbors, curr_instance.dag.preferred_parent);
     nbr_table_lock(rpl_neighbors, nbr);
 
-    /* Update DS6 default route. Use an infinite lifetime */
-    uip_ds6_defrt_rm(uip_ds6_defrt_lookup(
-      rpl_neighbor_get_ipaddr(curr_instance.dag.preferred_parent)));
-    uip_ds6_defrt_add(rpl_neighbor_get_ipaddr(nbr), 0);
+    /* Update DS6 default route. Use an infinite lifetime. Only the
+     * default instance routes the traffic that is not tied to an instance */
+    if(&curr_instance == &rpl_instances[0]) {
+      uip_ds6_defrt_rm(uip_ds6_defrt_lookup(
+        rpl_neighbor_get_ipaddr(curr_instance.dag.preferred_parent)));
+      uip_ds6_defrt_add(rpl_neighbor_get_ipaddr(nbr), 0);
+    }
 
+    if(curr_instance.dag.preferred_parent != NULL && nbr != NULL) {
+      rpl_timers_notify_parent_switch();
+    }
     curr_instance.dag.preferred_parent = nbr;
     curr_instance.dag.unprocessed_parent_switch = true;
   }
@@ -353,42 +407,131 @@ rpl_neighbor_get_from_ipaddr(uip_ipaddr_t *addr)
   return nbr_table_get_from_lladdr(rpl_neighbors, (linkaddr_t *)lladdr);
 }
 /*---------------------------------------------------------------------------*/
-static rpl_nbr_t *
-best_parent(int fresh_only)
+static void
+insert_candidate(rpl_nbr_t *nbr)
+{
+  rpl_nbr_t *prev = NULL;
+  rpl_nbr_t *n;
+
+  /* Insert after the neighbors with the same path cost */
+  for(n = list_head(candidates);
+      n != NULL && n->path_cost <= nbr->path_cost;
+      n = list_item_next(n)) {
+    prev = n;
+  }
+  list_insert(candidates, prev, nbr);
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_neighbor_update(rpl_nbr_t *nbr)
+{
+  if(nbr == NULL || !curr_instance.used) {
+    return;
+  }
+
+  stats.updates++;
+  list_remove(candidates, nbr);
+  nbr->path_cost = curr_instance.of->nbr_path_cost(nbr);
+  insert_candidate(nbr);
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_neighbor_update_all(void)
 {
   rpl_nbr_t *nbr;
-  rpl_nbr_t *best = NULL;
 
-  if(curr_instance.used == 0) {
-    return NULL;
+  list_init(candidates);
+  if(!curr_instance.used) {
+    return;
   }
 
-  /* Search for the best parent according to the OF */
+  stats.full_updates++;
   for(nbr = nbr_table_head(rpl_neighbors); nbr != NULL; nbr = nbr_table_next(rpl_neighbors, nbr)) {
+    nbr->path_cost = curr_instance.of->nbr_path_cost(nbr);
+    insert_candidate(nbr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Called by link-stats when the ETX of a link changed, from Tx or Rx
+callbacks or probing. Re-positions the neighbor in every instance. */
+static void
+link_stats_changed(const linkaddr_t *lladdr)
+{
+  rpl_instance_t *prev_instance;
+  int i;
 
-    if(!acceptable_rank(rpl_neighbor_rank_via_nbr(nbr))
-      || !curr_instance.of->nbr_is_acceptable_parent(nbr)) {
-      /* Exclude neighbors with a rank that is not acceptable */
-      continue;
+  for(i = 0; i < RPL_MAX_INSTANCES; i++) {
+    prev_instance = rpl_set_curr_instance(&rpl_instances[i]);
+    if(lladdr == NULL) {
+      /* All links were flushed */
+      rpl_neighbor_update_all();
+    } else {
+      rpl_neighbor_update(nbr_table_get_from_lladdr(rpl_neighbors, lladdr));
     }
+    rpl_set_curr_instance(prev_instance);
+  }
+}
+/*---------------------------------------------------------------------------*/
+const struct rpl_neighbor_stats *
+rpl_neighbor_get_stats(void)
+{
+  return &stats;
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_candidate(rpl_nbr_t *nbr, int fresh_only)
+{
+  if(!acceptable_rank(rpl_neighbor_rank_via_nbr(nbr))
+    || !curr_instance.of->nbr_is_acceptable_parent(nbr)) {
+    /* Exclude neighbors with a rank that is not acceptable */
+    return 0;
+  }
 
-    if(fresh_only && !rpl_neighbor_is_fresh(nbr)) {
-      /* Filter out non-fresh nerighbors if fresh_only is set */
-      continue;
-    }
+  if(fresh_only && !rpl_neighbor_is_fresh(nbr)) {
+    /* Filter out non-fresh nerighbors if fresh_only is set */
+    return 0;
+  }
 
 #if UIP_ND6_SEND_NS
-    {
-    uip_ds6_nbr_t *ds6_nbr = rpl_get_ds6_nbr(nbr);
-    /* Exclude links to a neighbor that is not reachable at a NUD level */
-    if(ds6_nbr == NULL || ds6_nbr->state != NBR_REACHABLE) {
-      continue;
+  {
+  uip_ds6_nbr_t *ds6_nbr = rpl_get_ds6_nbr(nbr);
+  /* Exclude links to a neighbor that is not reachable at a NUD level */
+  if(ds6_nbr == NULL || ds6_nbr->state != NBR_REACHABLE) {
+    return 0;
+  }
+  }
+#endif /* UIP_ND6_SEND_NS */
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static rpl_nbr_t *
+best_parent(int fresh_only)
+{
+  rpl_nbr_t *nbr;
+  rpl_nbr_t *best = NULL;
+  rpl_nbr_t *preferred = curr_instance.dag.preferred_parent;
+
+  if(curr_instance.used == 0) {
+    return NULL;
+  }
+
+  /* Candidates are sorted by path cost: the first acceptable one is the
+  best, unless other acceptable ones have the same path cost, in which case
+  the OF breaks the tie */
+  for(nbr = list_head(candidates); nbr != NULL; nbr = list_item_next(nbr)) {
+    if(best != NULL && nbr->path_cost != best->path_cost) {
+      break;
     }
+    if(is_candidate(nbr, fresh_only)) {
+      best = curr_instance.of->best_parent(best, nbr);
     }
-#endif /* UIP_ND6_SEND_NS */
+  }
 
-    /* Now we have an acceptable parent, check if it is the new best */
-    best = curr_instance.of->best_parent(best, nbr);
+  /* Let the OF apply its hysteresis in favor of the preferred parent */
+  if(best != NULL && preferred != NULL && preferred != best
+     && is_candidate(preferred, fresh_only)) {
+    best = curr_instance.of->best_parent(preferred, best);
   }
 
   return best;
@@ -461,6 +604,25 @@ rpl_neighbor_select_best(void)
 void
 rpl_neighbor_init(void)
 {
+#if RPL_MAX_INSTANCES > 1
+  int i;
+
+  rpl_neighbor_tables[0] = instance_neighbors_0;
+  rpl_neighbor_tables[1] = instance_neighbors_1;
+#if RPL_MAX_INSTANCES > 2
+  rpl_neighbor_tables[2] = instance_neighbors_2;
+#endif /* RPL_MAX_INSTANCES > 2 */
+#if RPL_MAX_INSTANCES > 3
+  rpl_neighbor_tables[3] = instance_neighbors_3;
+#endif /* RPL_MAX_INSTANCES > 3 */
+  for(i = 0; i < RPL_MAX_INSTANCES; i++) {
+    list_init((list_t)&candidates_lists[i]);
+    nbr_table_register(rpl_neighbor_tables[i], (nbr_table_callback *)evict_neighbor);
+  }
+#else /* RPL_MAX_INSTANCES > 1 */
+  list_init(candidates);
   nbr_table_register(rpl_neighbors, (nbr_table_callback *)remove_neighbor);
+#endif /* RPL_MAX_INSTANCES > 1 */
+  link_stats_set_callback(link_stats_changed);
 }
 /** @} */
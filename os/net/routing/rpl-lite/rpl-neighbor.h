@@ -61,8 +61,15 @@
  * and OF-specific way. The nodes in rpl_neighbors constitute the candidate neighbor set.
  * - Parent set: the subset of the candidate neighbor set with rank below our rank
  * - Preferred parent: one node of the parent set
+ * With several instances, each has its own table and rpl_neighbors is the
+ * one of the current instance.
  */
+#if RPL_MAX_INSTANCES > 1
+extern nbr_table_t *rpl_neighbor_tables[RPL_MAX_INSTANCES];
+#define rpl_neighbors (rpl_neighbor_tables[rpl_curr_instance - rpl_instances])
+#else /* RPL_MAX_INSTANCES > 1 */
 NBR_TABLE_DECLARE(rpl_neighbors);
+#endif /* RPL_MAX_INSTANCES > 1 */
 
 /********** Public functions **********/
 
@@ -185,6 +192,33 @@ void rpl_neighbor_print_list(const char *str);
 */
 void rpl_neighbor_remove_all(void);
 
+/**
+ * Updates the position of a neighbor in the candidate parent set. To be
+ * called whenever the OF path cost via the neighbor may have changed
+ * because of its rank or metric container. Changes of the link ETX are
+ * reported by link-stats, which triggers the update.
+ * \param nbr The neighbor
+*/
+void rpl_neighbor_update(rpl_nbr_t *nbr);
+
+/**
+ * Re-evaluates the path cost of all neighbors and re-sorts the
+ * candidate parent set. To be called when the OF or its parameters change.
+*/
+void rpl_neighbor_update_all(void);
+
+/** \brief Candidate parent set statistics */
+struct rpl_neighbor_stats {
+  uint32_t updates;      /**< Single-neighbor updates */
+  uint32_t full_updates; /**< Re-evaluations of the whole set */
+};
+
+/**
+ * Returns the candidate parent set statistics
+ * \return The statistics
+*/
+const struct rpl_neighbor_stats *rpl_neighbor_get_stats(void);
+
 /**
  * Returns the best candidate for preferred parent
  *
@@ -89,6 +89,29 @@ static struct ctimer periodic_timer; /* Not part of a DAG because used for gener
 /*---------------------------------------------------------------------------*/
 /*------------------------------- DIS -------------------------------------- */
 /*---------------------------------------------------------------------------*/
+/* DIS are needed when we are in no instance, or have no parent in one of
+ * the instances we are not root of */
+static int
+dis_needed(void)
+{
+  const rpl_instance_t *instance;
+  int used = 0;
+  int i;
+
+  for(i = 0; i < RPL_MAX_INSTANCES; i++) {
+    instance = &rpl_instances[i];
+    if(instance->used) {
+      used = 1;
+      if(instance->dag.rank != ROOT_RANK
+         && (instance->dag.preferred_parent == NULL
+             || instance->dag.rank == RPL_INFINITE_RANK)) {
+        return 1;
+      }
+    }
+  }
+  return !used;
+}
+/*---------------------------------------------------------------------------*/
 void
 rpl_timers_schedule_periodic_dis(void)
 {
@@ -101,10 +124,7 @@ rpl_timers_schedule_periodic_dis(void)
 static void
 handle_dis_timer(void *ptr)
 {
-  if(!rpl_dag_root_is_root() &&
-     (!curr_instance.used ||
-       curr_instance.dag.preferred_parent == NULL ||
-       curr_instance.dag.rank == RPL_INFINITE_RANK)) {
+  if(dis_needed()) {
     /* Send DIS and schedule next */
     rpl_icmp6_dis_output(NULL);
     rpl_timers_schedule_periodic_dis();
@@ -139,7 +159,7 @@ new_dio_interval(void)
   curr_instance.dag.dio_counter = 0;
 
   /* schedule the timer */
-  ctimer_set(&curr_instance.dag.dio_timer, ticks, &handle_dio_timer, NULL);
+  ctimer_set(&curr_instance.dag.dio_timer, ticks, &handle_dio_timer, &curr_instance);
 
 #ifdef RPL_CALLBACK_NEW_DIO_INTERVAL
   RPL_CALLBACK_NEW_DIO_INTERVAL((CLOCK_SECOND * 1UL << curr_instance.dag.dio_intcurrent) / 1000);
@@ -168,11 +188,11 @@ rpl_timers_dio_reset(const char *str)
 static void
 handle_dio_timer(void *ptr)
 {
-  if(!rpl_dag_ready_to_advertise()) {
-    return; /* We will be scheduled again later */
-  }
+  rpl_instance_t *prev_instance = rpl_set_curr_instance(ptr);
 
-  if(curr_instance.dag.dio_send) {
+  if(!rpl_dag_ready_to_advertise()) {
+    /* We will be scheduled again later */
+  } else if(curr_instance.dag.dio_send) {
     /* send DIO if counter is less than desired redundancy, or if dio_redundancy
     is set to 0, or if we are the root */
     if(rpl_dag_root_is_root() || curr_instance.dio_redundancy == 0 ||
@@ -191,7 +211,7 @@ handle_dio_timer(void *ptr)
       rpl_icmp6_dio_output(NULL);
     }
     curr_instance.dag.dio_send = 0;
-    ctimer_set(&curr_instance.dag.dio_timer, curr_instance.dag.dio_next_delay, handle_dio_timer, NULL);
+    ctimer_set(&curr_instance.dag.dio_timer, curr_instance.dag.dio_next_delay, handle_dio_timer, &curr_instance);
   } else {
     /* check if we need to double interval */
     if(curr_instance.dag.dio_intcurrent < curr_instance.dio_intmin + curr_instance.dio_intdoubl) {
@@ -199,6 +219,8 @@ handle_dio_timer(void *ptr)
     }
     new_dio_interval();
   }
+
+  rpl_set_curr_instance(prev_instance);
 }
 /*---------------------------------------------------------------------------*/
 /*------------------------------- Unicast DIO ------------------------------ */
@@ -210,17 +232,20 @@ rpl_timers_schedule_unicast_dio(rpl_nbr_t *target)
   if(curr_instance.used) {
     curr_instance.dag.unicast_dio_target = target;
     ctimer_set(&curr_instance.dag.unicast_dio_timer, 0,
-                  handle_unicast_dio_timer, NULL);
+                  handle_unicast_dio_timer, &curr_instance);
   }
 }
 /*---------------------------------------------------------------------------*/
 static void
 handle_unicast_dio_timer(void *ptr)
 {
+  rpl_instance_t *prev_instance = rpl_set_curr_instance(ptr);
   uip_ipaddr_t *target_ipaddr = rpl_neighbor_get_ipaddr(curr_instance.dag.unicast_dio_target);
   if(target_ipaddr != NULL) {
     rpl_icmp6_dio_output(target_ipaddr);
   }
+
+  rpl_set_curr_instance(prev_instance);
 }
 /*---------------------------------------------------------------------------*/
 /*------------------------------- DAO -------------------------------------- */
@@ -231,7 +256,7 @@ static void
 schedule_dao_retransmission(void)
 {
   clock_time_t expiration_time = RPL_DAO_RETRANSMISSION_TIMEOUT / 2 + (random_rand() % (RPL_DAO_RETRANSMISSION_TIMEOUT));
-  ctimer_set(&curr_instance.dag.dao_timer, expiration_time, resend_dao, NULL);
+  ctimer_set(&curr_instance.dag.dao_timer, expiration_time, resend_dao, &curr_instance);
 }
 #endif /* RPL_WITH_DAO_ACK */
 /*---------------------------------------------------------------------------*/
@@ -255,7 +280,7 @@ schedule_dao_refresh(void)
     }
 
     /* Schedule transmission */
-    ctimer_set(&curr_instance.dag.dao_timer, target_refresh, send_new_dao, NULL);
+    ctimer_set(&curr_instance.dag.dao_timer, target_refresh, send_new_dao, &curr_instance);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -267,13 +292,15 @@ rpl_timers_schedule_dao(void)
     * only serves storing mode. Use simple delay instead, with the only purpose
     * to reduce congestion. */
     clock_time_t expiration_time = RPL_DAO_DELAY / 2 + (random_rand() % (RPL_DAO_DELAY));
-    ctimer_set(&curr_instance.dag.dao_timer, expiration_time, send_new_dao, NULL);
+    ctimer_set(&curr_instance.dag.dao_timer, expiration_time, send_new_dao, &curr_instance);
   }
 }
 /*---------------------------------------------------------------------------*/
 static void
 send_new_dao(void *ptr)
 {
+  rpl_instance_t *prev_instance = rpl_set_curr_instance(ptr);
+
 #if RPL_WITH_DAO_ACK
   /* We are sending a new DAO here. Prepare retransmissions */
   curr_instance.dag.dao_transmissions = 1;
@@ -293,6 +320,8 @@ send_new_dao(void *ptr)
   RPL_LOLLIPOP_INCREMENT(curr_instance.dag.dao_last_seqno);
   /* Send a DAO with own prefix as target and default lifetime */
   rpl_icmp6_dao_output(curr_instance.default_lifetime);
+
+  rpl_set_curr_instance(prev_instance);
 }
 #if RPL_WITH_DAO_ACK
 /*---------------------------------------------------------------------------*/
@@ -305,15 +334,19 @@ rpl_timers_schedule_dao_ack(uip_ipaddr_t *target, uint16_t sequence)
   if(curr_instance.used) {
     uip_ipaddr_copy(&curr_instance.dag.dao_ack_target, target);
     curr_instance.dag.dao_ack_sequence = sequence;
-    ctimer_set(&curr_instance.dag.dao_ack_timer, 0, handle_dao_ack_timer, NULL);
+    ctimer_set(&curr_instance.dag.dao_ack_timer, 0, handle_dao_ack_timer, &curr_instance);
   }
 }
 /*---------------------------------------------------------------------------*/
 static void
 handle_dao_ack_timer(void *ptr)
 {
+  rpl_instance_t *prev_instance = rpl_set_curr_instance(ptr);
+
   rpl_icmp6_dao_ack_output(&curr_instance.dag.dao_ack_target,
     curr_instance.dag.dao_ack_sequence, RPL_DAO_ACK_UNCONDITIONAL_ACCEPT);
+
+  rpl_set_curr_instance(prev_instance);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -327,6 +360,8 @@ rpl_timers_notify_dao_ack(void)
 static void
 resend_dao(void *ptr)
 {
+  rpl_instance_t *prev_instance = rpl_set_curr_instance(ptr);
+
   /* Increment transmission counter before sending */
   curr_instance.dag.dao_transmissions++;
   /* Send a DAO with own prefix as target and default lifetime */
@@ -338,14 +373,39 @@ resend_dao(void *ptr)
   } else {
     /* No more retransmissions. Perform local repair. */
     rpl_local_repair("DAO max rtx");
-    return;
   }
+
+  rpl_set_curr_instance(prev_instance);
 }
 #endif /* RPL_WITH_DAO_ACK */
 /*---------------------------------------------------------------------------*/
 /*------------------------------- Probing----------------------------------- */
 /*---------------------------------------------------------------------------*/
+static struct rpl_probing_stats probing_stats;
+/*---------------------------------------------------------------------------*/
+const struct rpl_probing_stats *
+rpl_timers_get_probing_stats(void)
+{
+  return &probing_stats;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_timers_notify_parent_switch(void)
+{
+  probing_stats.parent_switches++;
+}
+/*---------------------------------------------------------------------------*/
 #if RPL_WITH_PROBING
+#if RPL_PROBING_BY_UNCERTAINTY
+/* Number of link samples after which an estimate is considered known */
+#define PROBING_SAMPLES_TARGET    4
+/* Staleness is counted in minutes, up to this value */
+#define PROBING_MAX_STALENESS    60
+
+static clock_time_t budget_window_start;
+static uint8_t budget_used;
+#endif /* RPL_PROBING_BY_UNCERTAINTY */
+/*---------------------------------------------------------------------------*/
 clock_time_t
 get_probing_delay(void)
 {
@@ -360,6 +420,8 @@ get_probing_target(void)
    * Otherwise, it picks at random between:
    * (1) selecting the best neighbor with non-fresh link statistics
    * (2) selecting the least recently updated neighbor
+   * In (2), neighbors that were never probed come first: with a fast-start
+   * ETX estimator, a single probe is enough to rank them.
    */
 
   rpl_nbr_t *nbr;
@@ -408,6 +470,11 @@ get_probing_target(void)
         /* nbr needs probing */
         const struct link_stats *stats = rpl_neighbor_get_link_stats(nbr);
         if(stats != NULL) {
+          if(link_stats_num_samples(stats) == 0) {
+            /* Never probed */
+            probing_target = nbr;
+            break;
+          }
           if(probing_target == NULL
               || clock_now - stats->last_tx_time > probing_target_age) {
             probing_target = nbr;
@@ -422,11 +489,117 @@ get_probing_target(void)
   return probing_target;
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_PROBING_BY_UNCERTAINTY
+/* How much probing nbr is worth, 0 if not at all. Neighbors are only worth
+ * probing if they could be a better parent than the current one, assuming
+ * a perfect link. Among those, the preferred parent comes first, then
+ * neighbors with the fewest link samples, then the least recently measured. */
+static uint16_t
+probing_score(rpl_nbr_t *nbr)
+{
+  const struct link_stats *stats;
+  uint8_t samples;
+  uint16_t staleness;
+  int is_parent;
+
+  if(nbr == NULL || nbr->rank == RPL_INFINITE_RANK || rpl_neighbor_is_fresh(nbr)) {
+    return 0;
+  }
+
+  is_parent = nbr == curr_instance.dag.preferred_parent;
+  if(!is_parent && curr_instance.dag.rank != RPL_INFINITE_RANK
+     && (uint32_t)nbr->rank + curr_instance.min_hoprankinc >= curr_instance.dag.rank) {
+    /* Cannot become a better parent, whatever its link */
+    return 0;
+  }
+
+  stats = rpl_neighbor_get_link_stats(nbr);
+  samples = link_stats_num_samples(stats);
+  if(stats == NULL) {
+    staleness = PROBING_MAX_STALENESS;
+  } else {
+    staleness = MIN((clock_time() - stats->last_tx_time) / (60 * CLOCK_SECOND),
+                    PROBING_MAX_STALENESS);
+  }
+
+  return 1 + staleness
+    + (samples < PROBING_SAMPLES_TARGET ? (PROBING_SAMPLES_TARGET - samples) : 0)
+      * (PROBING_MAX_STALENESS + 1)
+    + (is_parent ? (PROBING_SAMPLES_TARGET + 1) * (PROBING_MAX_STALENESS + 1) : 0);
+}
+/*---------------------------------------------------------------------------*/
+rpl_nbr_t *
+get_probing_target_by_uncertainty(void)
+{
+  rpl_nbr_t *nbr;
+  rpl_nbr_t *probing_target = NULL;
+  uint16_t probing_target_score = 0;
+  uint16_t score;
+
+  if(curr_instance.used == 0) {
+    return NULL;
+  }
+
+  /* There is an urgent probing target */
+  if(curr_instance.dag.urgent_probing_target != NULL) {
+    return curr_instance.dag.urgent_probing_target;
+  }
+
+  for(nbr = nbr_table_head(rpl_neighbors); nbr != NULL;
+      nbr = nbr_table_next(rpl_neighbors, nbr)) {
+    score = probing_score(nbr);
+    if(score > probing_target_score) {
+      probing_target = nbr;
+      probing_target_score = score;
+    }
+  }
+
+  return probing_target;
+}
+/*---------------------------------------------------------------------------*/
+static int
+probing_budget_available(void)
+{
+  if(clock_time() - budget_window_start >= RPL_PROBING_BUDGET_WINDOW) {
+    budget_window_start = clock_time();
+    budget_used = 0;
+  }
+  return budget_used < RPL_PROBING_BUDGET;
+}
+#endif /* RPL_PROBING_BY_UNCERTAINTY */
+/*---------------------------------------------------------------------------*/
 static void
 handle_probing_timer(void *ptr)
 {
+  rpl_instance_t *prev_instance = rpl_set_curr_instance(ptr);
   rpl_nbr_t *probing_target = RPL_PROBING_SELECT_FUNC();
   uip_ipaddr_t *target_ipaddr = rpl_neighbor_get_ipaddr(probing_target);
+  int is_urgent = probing_target != NULL
+    && probing_target == curr_instance.dag.urgent_probing_target;
+
+#if RPL_PROBING_BY_UNCERTAINTY
+  if(target_ipaddr != NULL && !is_urgent) {
+    const struct link_stats *stats = rpl_neighbor_get_link_stats(probing_target);
+    if(link_stats_num_samples(stats) > 0
+       && clock_time() - stats->last_tx_time < RPL_PROBING_PIGGYBACK_TIME) {
+      /* Unicast traffic is measuring the link already */
+      LOG_INFO("not probing ");
+      LOG_INFO_6ADDR(target_ipaddr);
+      LOG_INFO_(", recent traffic\n");
+      probing_stats.piggybacked++;
+      target_ipaddr = NULL;
+    } else if(!probing_budget_available()) {
+      LOG_INFO("probing budget exhausted\n");
+      probing_stats.over_budget++;
+      target_ipaddr = NULL;
+    }
+  }
+  if(target_ipaddr != NULL) {
+    /* Urgent probes are never held back, but still use up the budget */
+    probing_budget_available();
+    budget_used++;
+  }
+#endif /* RPL_PROBING_BY_UNCERTAINTY */
 
   /* Perform probing */
   if(target_ipaddr != NULL) {
@@ -435,12 +608,16 @@ handle_probing_timer(void *ptr)
     LOG_INFO("probing ");
     LOG_INFO_6ADDR(target_ipaddr);
     LOG_INFO_(" %s last tx %u min ago\n",
-        curr_instance.dag.urgent_probing_target != NULL ? "(urgent)" : "",
+        is_urgent ? "(urgent)" : "",
         stats != NULL ?
         (unsigned)((clock_time() - stats->last_tx_time) / (60 * CLOCK_SECOND)) : 0
         );
     /* Send probe, e.g. unicast DIO or DIS */
     RPL_PROBING_SEND_FUNC(target_ipaddr);
+    probing_stats.sent++;
+    if(is_urgent) {
+      probing_stats.urgent++;
+    }
     /* urgent_probing_target will be NULLed in the packet_sent callback */
   } else {
     LOG_INFO("no neighbor needs probing\n");
@@ -448,6 +625,8 @@ handle_probing_timer(void *ptr)
 
   /* Schedule next probing */
   rpl_schedule_probing();
+
+  rpl_set_curr_instance(prev_instance);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -455,7 +634,7 @@ rpl_schedule_probing(void)
 {
   if(curr_instance.used) {
     ctimer_set(&curr_instance.dag.probing_timer, RPL_PROBING_DELAY_FUNC(),
-                  handle_probing_timer, NULL);
+                  handle_probing_timer, &curr_instance);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -464,19 +643,34 @@ rpl_schedule_probing_now(void)
 {
   if(curr_instance.used) {
     ctimer_set(&curr_instance.dag.probing_timer,
-      random_rand() % (CLOCK_SECOND * 4), handle_probing_timer, NULL);
+      random_rand() % (CLOCK_SECOND * 4), handle_probing_timer, &curr_instance);
   }
 }
 #endif /* RPL_WITH_PROBING */
 /*---------------------------------------------------------------------------*/
+void
+rpl_timers_probing_new_candidate(rpl_nbr_t *nbr)
+{
+#if RPL_WITH_PROBING && RPL_PROBING_BY_UNCERTAINTY
+  if(curr_instance.used && curr_instance.dag.urgent_probing_target == NULL
+     && probing_score(nbr) > 0 && probing_budget_available()) {
+    rpl_schedule_probing_now();
+  }
+#endif /* RPL_WITH_PROBING && RPL_PROBING_BY_UNCERTAINTY */
+}
+/*---------------------------------------------------------------------------*/
 /*------------------------------- Leaving-- -------------------------------- */
 /*---------------------------------------------------------------------------*/
 static void
 handle_leaving_timer(void *ptr)
 {
+  rpl_instance_t *prev_instance = rpl_set_curr_instance(ptr);
+
   if(curr_instance.used) {
     rpl_dag_leave();
   }
+
+  rpl_set_curr_instance(prev_instance);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -494,7 +688,7 @@ rpl_timers_schedule_leaving(void)
 {
   if(curr_instance.used) {
     if(ctimer_expired(&curr_instance.dag.leave)) {
-      ctimer_set(&curr_instance.dag.leave, RPL_DELAY_BEFORE_LEAVING, handle_leaving_timer, NULL);
+      ctimer_set(&curr_instance.dag.leave, RPL_DELAY_BEFORE_LEAVING, handle_leaving_timer, &curr_instance);
     }
   }
 }
@@ -511,23 +705,32 @@ rpl_timers_init(void)
 static void
 handle_periodic_timer(void *ptr)
 {
-  if(curr_instance.used) {
-    rpl_dag_periodic(PERIODIC_DELAY_SECONDS);
+  rpl_instance_t *prev_instance;
+  int i;
+
+  for(i = 0; i < RPL_MAX_INSTANCES; i++) {
+    prev_instance = rpl_set_curr_instance(&rpl_instances[i]);
+    if(curr_instance.used) {
+      rpl_dag_periodic(PERIODIC_DELAY_SECONDS);
+    }
+    /* Useful because part of the state update is time-dependent, e.g.,
+    the meaning of last_advertised_rank changes with time */
+    rpl_dag_update_state();
+    if(LOG_INFO_ENABLED) {
+      rpl_neighbor_print_list("Periodic");
+    }
+    rpl_set_curr_instance(prev_instance);
+  }
+
+  if(rpl_get_any_dag() != NULL) {
     uip_sr_periodic(PERIODIC_DELAY_SECONDS);
   }
 
-  if(!curr_instance.used ||
-      curr_instance.dag.preferred_parent == NULL ||
-      curr_instance.dag.rank == RPL_INFINITE_RANK) {
+  if(dis_needed()) {
     rpl_timers_schedule_periodic_dis(); /* Schedule DIS if needed */
   }
 
-  /* Useful because part of the state update is time-dependent, e.g.,
-  the meaning of last_advertised_rank changes with time */
-  rpl_dag_update_state();
-
   if(LOG_INFO_ENABLED) {
-    rpl_neighbor_print_list("Periodic");
     rpl_dag_root_print_links("Periodic");
   }
 
@@ -563,14 +766,18 @@ void
 rpl_timers_schedule_state_update(void)
 {
   if(curr_instance.used) {
-    ctimer_set(&curr_instance.dag.state_update, 0, handle_state_update, NULL);
+    ctimer_set(&curr_instance.dag.state_update, 0, handle_state_update, &curr_instance);
   }
 }
 /*---------------------------------------------------------------------------*/
 static void
 handle_state_update(void *ptr)
 {
+  rpl_instance_t *prev_instance = rpl_set_curr_instance(ptr);
+
   rpl_dag_update_state();
+
+  rpl_set_curr_instance(prev_instance);
 }
 
 /** @}*/
@@ -114,6 +114,36 @@ void rpl_schedule_probing(void);
 */
 void rpl_schedule_probing_now(void);
 
+/**
+ * Let the rpl-timers module know about a new neighbor. With
+ * RPL_PROBING_BY_UNCERTAINTY, it is probed right away if it could become
+ * a better parent.
+ *
+ * \param nbr The new neighbor
+*/
+void rpl_timers_probing_new_candidate(rpl_nbr_t *nbr);
+
+/** \brief Probing statistics */
+struct rpl_probing_stats {
+  uint32_t sent;            /**< Probes sent */
+  uint32_t urgent;          /**< Probes sent to the urgent probing target */
+  uint32_t piggybacked;     /**< Probes skipped, recent unicast traffic measured the link */
+  uint32_t over_budget;     /**< Probes skipped, budget exhausted */
+  uint32_t parent_switches; /**< Changes of preferred parent */
+};
+
+/**
+ * Returns the probing statistics
+ *
+ * \return The statistics
+*/
+const struct rpl_probing_stats *rpl_timers_get_probing_stats(void);
+
+/**
+ * Let the rpl-timers module know that the preferred parent has changed
+*/
+void rpl_timers_notify_parent_switch(void);
+
 /**
  * Schedule a state update ASAP. Useful to force an update from a context
  * where updating directly would be unsafe.
@@ -134,6 +134,7 @@ typedef struct rpl_prefix rpl_prefix_t;
 
 /** \brief All information related to a RPL neighbor */
 struct rpl_nbr {
+  struct rpl_nbr *next; /* Next candidate parent, by increasing path cost */
   clock_time_t better_parent_since;  /* The neighbor has been a possible
   replacement for our preferred parent consistently since 'parent_since'.
   Currently used by MRHOF only. */
@@ -141,6 +142,7 @@ struct rpl_nbr {
   rpl_metric_container_t mc;
 #endif /* RPL_WITH_MC */
   rpl_rank_t rank;
+  uint16_t path_cost; /* The OF path cost when last updated */
   uint8_t dtsn;
 };
 typedef struct rpl_nbr rpl_nbr_t;
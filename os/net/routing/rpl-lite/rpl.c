@@ -93,8 +93,9 @@ rpl_get_global_address(void)
   return ipaddr;
 }
 /*---------------------------------------------------------------------------*/
-void
-rpl_link_callback(const linkaddr_t *addr, int status, int numtx)
+/* Link callback for the current instance */
+static void
+link_callback(const linkaddr_t *addr, int status, int numtx)
 {
   if(curr_instance.used == 1 ) {
     rpl_nbr_t *nbr = rpl_neighbor_get_from_lladdr((uip_lladdr_t *)addr);
@@ -116,6 +117,20 @@ rpl_link_callback(const linkaddr_t *addr, int status, int numtx)
   }
 }
 /*---------------------------------------------------------------------------*/
+void
+rpl_link_callback(const linkaddr_t *addr, int status, int numtx)
+{
+  rpl_instance_t *prev_instance;
+  int i;
+
+  /* The link is shared by all instances */
+  for(i = 0; i < RPL_MAX_INSTANCES; i++) {
+    prev_instance = rpl_set_curr_instance(&rpl_instances[i]);
+    link_callback(addr, status, numtx);
+    rpl_set_curr_instance(prev_instance);
+  }
+}
+/*---------------------------------------------------------------------------*/
 int
 rpl_has_joined(void)
 {
@@ -211,7 +226,13 @@ static int
 get_sr_node_ipaddr(uip_ipaddr_t *addr, const uip_sr_node_t *node)
 {
   if(addr != NULL && node != NULL) {
-    memcpy(addr, &curr_instance.dag.dag_id, 8);
+#if RPL_MAX_INSTANCES > 1
+    /* The graph of a node is its instance */
+    const rpl_instance_t *instance = node->graph;
+#else /* RPL_MAX_INSTANCES > 1 */
+    const rpl_instance_t *instance = &curr_instance;
+#endif /* RPL_MAX_INSTANCES > 1 */
+    memcpy(addr, &instance->dag.dag_id, 8);
     memcpy(((unsigned char *)addr) + 8, &node->link_identifier, 8);
     return 1;
   } else {
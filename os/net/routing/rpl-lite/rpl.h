@@ -60,13 +60,42 @@
 
 /********** Public symbols **********/
 
+/* The instances. Only the first one exists unless RPL_MAX_INSTANCES > 1 */
+extern rpl_instance_t rpl_instances[RPL_MAX_INSTANCES];
+#if RPL_MAX_INSTANCES > 1
+/* The instance being processed, i.e. the context of all functions below.
+ * Outside of RPL processing, the default instance. */
+extern rpl_instance_t *rpl_curr_instance;
+#define curr_instance (*rpl_curr_instance)
+/* The graph of the source routing nodes of the current instance */
+#define RPL_SR_GRAPH ((void *)rpl_curr_instance)
+#else /* RPL_MAX_INSTANCES > 1 */
 /* The only instance */
-extern rpl_instance_t curr_instance;
+#define curr_instance (rpl_instances[0])
+#define RPL_SR_GRAPH NULL
+#endif /* RPL_MAX_INSTANCES > 1 */
 /* The RPL multicast address (used for DIS and DIO) */
 extern uip_ipaddr_t rpl_multicast_addr;
 
 /********** Public functions **********/
 
+#if RPL_MAX_INSTANCES > 1
+/**
+ * Set the instance all RPL functions work on. Used when processing a
+ * message or a timer of a given instance, and to query an instance.
+ *
+ * \param instance The instance
+ * \return The previous instance, to be restored afterwards
+ */
+rpl_instance_t *rpl_set_curr_instance(rpl_instance_t *instance);
+#else /* RPL_MAX_INSTANCES > 1 */
+static inline rpl_instance_t *
+rpl_set_curr_instance(rpl_instance_t *instance)
+{
+  return &curr_instance;
+}
+#endif /* RPL_MAX_INSTANCES > 1 */
+
 /**
  * Called by lower layers after every packet transmission
  *
@@ -0,0 +1,579 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup mcast-object
+ * @{
+ */
+/**
+ * \file
+ *         Reliable multicast object dissemination with NACK-based repair
+ *
+ *         All messages start with the type, the object ID and the object
+ *         size, so that a node learns about an object from any of them.
+ *         Multi-byte fields are in network byte order.
+ *
+ *         - DATA: page (2), packet (1), object bytes
+ *         - NACK: page (2), bitmap of the missing packets (4)
+ *         - ADV: number of complete pages (2)
+ */
+
+#include "contiki.h"
+#include "mcast-object.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/simple-udp.h"
+#include "cfs/cfs.h"
+#include "lib/random.h"
+
+#include <string.h>
+
+#include "sys/log.h"
+#define LOG_MODULE "McastObj"
+#define LOG_LEVEL LOG_LEVEL_NONE
+/*---------------------------------------------------------------------------*/
+#define FLAG_KNOWN    0x01
+#define FLAG_COMPLETE 0x02
+#define FLAG_PUSH     0x04
+
+/* ID a is newer than ID b */
+#define ID_NEWER(a, b) ((int16_t)((a) - (b)) > 0)
+/*---------------------------------------------------------------------------*/
+static uint8_t msg_buf[MCAST_OBJECT_DATA_LEN + MCAST_OBJECT_PACKET_SIZE];
+
+static struct simple_udp_connection udp_conn;
+static struct mcast_object *udp_object;
+static uip_ipaddr_t udp_group;
+/*---------------------------------------------------------------------------*/
+static void adv_send(void *ptr, uint8_t suppress);
+static void nack_send(void *ptr);
+static void nack_schedule(struct mcast_object *o, int reset);
+/*---------------------------------------------------------------------------*/
+static void
+put16(uint8_t *p, uint16_t v)
+{
+  p[0] = v >> 8;
+  p[1] = v & 0xFF;
+}
+/*---------------------------------------------------------------------------*/
+static void
+put32(uint8_t *p, uint32_t v)
+{
+  put16(p, v >> 16);
+  put16(p + 2, v & 0xFFFF);
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+get16(const uint8_t *p)
+{
+  return ((uint16_t)p[0] << 8) | p[1];
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+get32(const uint8_t *p)
+{
+  return ((uint32_t)get16(p) << 16) | get16(p + 2);
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+packet_count(const struct mcast_object *o, uint16_t page)
+{
+  uint32_t left = o->size - (uint32_t)page * MCAST_OBJECT_PAGE_SIZE;
+
+  if(left >= MCAST_OBJECT_PAGE_SIZE) {
+    return MCAST_OBJECT_PAGE_PACKETS;
+  }
+  return (left + MCAST_OBJECT_PACKET_SIZE - 1) / MCAST_OBJECT_PACKET_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+/* The bits of all packets of a page */
+static uint32_t
+page_mask(const struct mcast_object *o, uint16_t page)
+{
+  uint16_t count = packet_count(o, page);
+
+  return count >= 32 ? 0xFFFFFFFFUL : (1UL << count) - 1;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+header_write(const struct mcast_object *o, uint8_t type)
+{
+  msg_buf[0] = type;
+  put16(&msg_buf[1], o->id);
+  put32(&msg_buf[3], o->size);
+  return MCAST_OBJECT_HDR_LEN;
+}
+/*---------------------------------------------------------------------------*/
+/* Start over with a new object, whose packets we have yet to receive */
+static int
+object_start(struct mcast_object *o, uint16_t id, uint32_t size)
+{
+  if(size == 0 || size > MCAST_OBJECT_MAX_SIZE) {
+    LOG_WARN("Object %u of %lu bytes does not fit\n", id, (unsigned long)size);
+    return 0;
+  }
+
+  if(o->fd >= 0) {
+    cfs_close(o->fd);
+  }
+  /* A smaller object must not keep the previous one's trailing bytes */
+  cfs_remove(o->file);
+  o->fd = cfs_open(o->file, CFS_READ | CFS_WRITE);
+  if(o->fd < 0) {
+    LOG_ERR("Can not open %s\n", o->file);
+    o->flags = 0;
+    return 0;
+  }
+
+  o->id = id;
+  o->size = size;
+  o->pages = (size + MCAST_OBJECT_PAGE_SIZE - 1) / MCAST_OBJECT_PAGE_SIZE;
+  o->pages_complete = 0;
+  memset(o->have, 0, sizeof(o->have));
+  o->flags = FLAG_KNOWN;
+  o->repairs_len = 0;
+  ctimer_stop(&o->tx_timer);
+
+  LOG_INFO("Receiving object %u, %lu bytes in %u pages\n",
+           id, (unsigned long)size, o->pages);
+
+  trickle_timer_config(&o->adv_timer, MCAST_OBJECT_ADV_IMIN,
+                       MCAST_OBJECT_ADV_IMAX, MCAST_OBJECT_ADV_K);
+  trickle_timer_set(&o->adv_timer, adv_send, o);
+  nack_schedule(o, 1);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Accept a message's object: 1 if it is the current one, 0 to ignore it */
+static int
+object_check(struct mcast_object *o, uint16_t id, uint32_t size)
+{
+  if(!(o->flags & FLAG_KNOWN) || ID_NEWER(id, o->id)) {
+    return object_start(o, id, size);
+  }
+  if(id != o->id) {
+    /* Older than ours: tell the sender about ours */
+    trickle_timer_inconsistency(&o->adv_timer);
+    return 0;
+  }
+  return size == o->size;
+}
+/*---------------------------------------------------------------------------*/
+/* NACKs */
+/*---------------------------------------------------------------------------*/
+static void
+nack_schedule(struct mcast_object *o, int reset)
+{
+  if(reset) {
+    o->nack_delay = MCAST_OBJECT_NACK_DELAY;
+  }
+  /* Random in [D/2, D) */
+  ctimer_set(&o->nack_timer, o->nack_delay / 2 +
+             random_rand() % (o->nack_delay / 2 + 1), nack_send, o);
+}
+/*---------------------------------------------------------------------------*/
+static void
+nack_send(void *ptr)
+{
+  struct mcast_object *o = ptr;
+  uint16_t page;
+  uint32_t missing = 0;
+  uint16_t len;
+
+  if(o->flags & FLAG_COMPLETE) {
+    return;
+  }
+
+  for(page = 0; page < o->pages; page++) {
+    missing = page_mask(o, page) & ~o->have[page];
+    if(missing) {
+      break;
+    }
+  }
+
+  len = header_write(o, MCAST_OBJECT_NACK);
+  put16(&msg_buf[len], page);
+  put32(&msg_buf[len + 2], missing);
+  o->output(o, MCAST_OBJECT_TO_NEIGHBOURS, msg_buf, MCAST_OBJECT_NACK_LEN);
+  o->nack_out++;
+
+  LOG_DBG("NACK page %u: 0x%08lx\n", page, (unsigned long)missing);
+
+  /* Until something arrives, back off */
+  o->nack_delay *= 2;
+  if(o->nack_delay > MCAST_OBJECT_NACK_DELAY_MAX) {
+    o->nack_delay = MCAST_OBJECT_NACK_DELAY_MAX;
+  }
+  nack_schedule(o, 0);
+}
+/*---------------------------------------------------------------------------*/
+/* Paced transmissions */
+/*---------------------------------------------------------------------------*/
+static void
+data_send(struct mcast_object *o, uint16_t page, uint8_t packet, uint8_t to)
+{
+  uint32_t offset;
+  uint16_t len;
+  uint16_t hdr_len;
+
+  offset = (uint32_t)page * MCAST_OBJECT_PAGE_SIZE +
+    (uint32_t)packet * MCAST_OBJECT_PACKET_SIZE;
+  len = o->size - offset < MCAST_OBJECT_PACKET_SIZE ?
+    o->size - offset : MCAST_OBJECT_PACKET_SIZE;
+
+  hdr_len = header_write(o, MCAST_OBJECT_DATA);
+  put16(&msg_buf[hdr_len], page);
+  msg_buf[hdr_len + 2] = packet;
+
+  if(cfs_seek(o->fd, offset, CFS_SEEK_SET) != offset ||
+     cfs_read(o->fd, &msg_buf[MCAST_OBJECT_DATA_LEN], len) != len) {
+    LOG_ERR("Can not read page %u packet %u\n", page, packet);
+    return;
+  }
+
+  o->output(o, to, msg_buf, MCAST_OBJECT_DATA_LEN + len);
+  o->data_out++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+repair_remove(struct mcast_object *o, uint8_t i)
+{
+  o->repairs_len--;
+  memmove(&o->repairs[i], &o->repairs[i + 1],
+          (o->repairs_len - i) * sizeof(o->repairs[0]));
+}
+/*---------------------------------------------------------------------------*/
+static void
+tx_next(void *ptr)
+{
+  struct mcast_object *o = ptr;
+  struct mcast_object_repair *r;
+  uint8_t packet;
+
+  if(o->repairs_len > 0) {
+    r = &o->repairs[0];
+    for(packet = 0; !(r->packets & (1UL << packet)); packet++);
+    r->packets &= ~(1UL << packet);
+    data_send(o, r->page, packet, MCAST_OBJECT_TO_NEIGHBOURS);
+    if(r->packets == 0) {
+      repair_remove(o, 0);
+    }
+  } else if(o->flags & FLAG_PUSH) {
+    data_send(o, o->push_page, o->push_packet, MCAST_OBJECT_TO_GROUP);
+    if(++o->push_packet == packet_count(o, o->push_page)) {
+      o->push_packet = 0;
+      if(++o->push_page == o->pages) {
+        o->flags &= ~FLAG_PUSH;
+      }
+    }
+  }
+
+  if(o->repairs_len > 0 || (o->flags & FLAG_PUSH)) {
+    ctimer_set(&o->tx_timer, MCAST_OBJECT_TX_INTERVAL, tx_next, o);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+repair_add(struct mcast_object *o, uint16_t page, uint32_t packets)
+{
+  uint8_t i;
+
+  for(i = 0; i < o->repairs_len; i++) {
+    if(o->repairs[i].page == page) {
+      o->repairs[i].packets |= packets;
+      return;
+    }
+  }
+  if(o->repairs_len == MCAST_OBJECT_REPAIR_QUEUE) {
+    /* The NACK will come again */
+    return;
+  }
+  o->repairs[o->repairs_len].page = page;
+  o->repairs[o->repairs_len].packets = packets;
+  o->repairs_len++;
+
+  /* A random delay, during which other neighbours' repairs suppress ours */
+  if(ctimer_expired(&o->tx_timer)) {
+    ctimer_set(&o->tx_timer, 1 + random_rand() % MCAST_OBJECT_REPAIR_DELAY,
+               tx_next, o);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Advertisements */
+/*---------------------------------------------------------------------------*/
+static void
+adv_send(void *ptr, uint8_t suppress)
+{
+  struct mcast_object *o = ptr;
+  uint16_t len;
+
+  if(suppress == TRICKLE_TIMER_TX_SUPPRESS || !(o->flags & FLAG_KNOWN)) {
+    return;
+  }
+
+  len = header_write(o, MCAST_OBJECT_ADV);
+  put16(&msg_buf[len], o->pages_complete);
+  o->output(o, MCAST_OBJECT_TO_NEIGHBOURS, msg_buf, MCAST_OBJECT_ADV_LEN);
+  o->adv_out++;
+}
+/*---------------------------------------------------------------------------*/
+/* Input */
+/*---------------------------------------------------------------------------*/
+static void
+data_input(struct mcast_object *o, const uint8_t *data, uint16_t len)
+{
+  uint16_t page = get16(&data[MCAST_OBJECT_HDR_LEN]);
+  uint8_t packet = data[MCAST_OBJECT_HDR_LEN + 2];
+  uint32_t bit;
+  uint32_t offset;
+  uint8_t i;
+
+  if(page >= o->pages || packet >= packet_count(o, page)) {
+    return;
+  }
+  bit = 1UL << packet;
+  offset = (uint32_t)page * MCAST_OBJECT_PAGE_SIZE +
+    (uint32_t)packet * MCAST_OBJECT_PACKET_SIZE;
+  len -= MCAST_OBJECT_DATA_LEN;
+  if(len != (o->size - offset < MCAST_OBJECT_PACKET_SIZE ?
+             o->size - offset : MCAST_OBJECT_PACKET_SIZE)) {
+    return;
+  }
+
+  /* A neighbour repaired this packet already */
+  for(i = 0; i < o->repairs_len; i++) {
+    if(o->repairs[i].page == page) {
+      o->repairs[i].packets &= ~bit;
+      if(o->repairs[i].packets == 0) {
+        repair_remove(o, i);
+      }
+      break;
+    }
+  }
+
+  if(o->have[page] & bit) {
+    o->duplicates_in++;
+    return;
+  }
+
+  if(cfs_seek(o->fd, offset, CFS_SEEK_SET) != offset ||
+     cfs_write(o->fd, &data[MCAST_OBJECT_DATA_LEN], len) != len) {
+    LOG_ERR("Can not write page %u packet %u\n", page, packet);
+    return;
+  }
+  o->have[page] |= bit;
+  o->data_in++;
+
+  if(o->have[page] == page_mask(o, page) &&
+     ++o->pages_complete == o->pages) {
+    LOG_INFO("Object %u complete\n", o->id);
+    o->flags |= FLAG_COMPLETE;
+    ctimer_stop(&o->nack_timer);
+    trickle_timer_inconsistency(&o->adv_timer);
+    if(o->complete != NULL) {
+      o->complete(o);
+    }
+  } else if(!(o->flags & FLAG_COMPLETE)) {
+    nack_schedule(o, 1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+nack_input(struct mcast_object *o, const uint8_t *data)
+{
+  uint16_t page = get16(&data[MCAST_OBJECT_HDR_LEN]);
+  uint32_t missing = get32(&data[MCAST_OBJECT_HDR_LEN + 2]);
+  uint32_t ours;
+
+  if(page >= o->pages) {
+    return;
+  }
+  missing &= page_mask(o, page);
+
+  /* Another node asked for everything we miss of this page: wait */
+  ours = page_mask(o, page) & ~o->have[page];
+  if(ours != 0 && (ours & ~missing) == 0) {
+    nack_schedule(o, 0);
+  }
+
+  missing &= o->have[page];
+  if(missing) {
+    repair_add(o, page, missing);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+adv_input(struct mcast_object *o, const uint8_t *data)
+{
+  uint16_t complete = get16(&data[MCAST_OBJECT_HDR_LEN]);
+
+  /*
+   * Progress differs all the time during a push. Only a neighbour that
+   * holds the whole object while we do not, or the other way round, is
+   * worth hearing from sooner.
+   */
+  if((complete == o->pages) == (o->pages_complete == o->pages)) {
+    trickle_timer_consistency(&o->adv_timer);
+  } else {
+    trickle_timer_inconsistency(&o->adv_timer);
+  }
+  if(complete > o->pages_complete && !(o->flags & FLAG_COMPLETE)) {
+    /* The neighbour can help us */
+    nack_schedule(o, 1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+mcast_object_input(struct mcast_object *o, const uint8_t *data, uint16_t len)
+{
+  if(len < MCAST_OBJECT_HDR_LEN ||
+     !object_check(o, get16(&data[1]), get32(&data[3]))) {
+    return;
+  }
+
+  switch(data[0]) {
+  case MCAST_OBJECT_DATA:
+    if(len > MCAST_OBJECT_DATA_LEN) {
+      data_input(o, data, len);
+    }
+    break;
+  case MCAST_OBJECT_NACK:
+    if(len >= MCAST_OBJECT_NACK_LEN) {
+      nack_input(o, data);
+    }
+    break;
+  case MCAST_OBJECT_ADV:
+    if(len >= MCAST_OBJECT_ADV_LEN) {
+      adv_input(o, data);
+    }
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+mcast_object_init(struct mcast_object *o, const char *file,
+                  mcast_object_output_t output,
+                  mcast_object_callback_t complete)
+{
+  memset(o, 0, sizeof(*o));
+  o->file = file;
+  o->output = output;
+  o->complete = complete;
+  o->fd = -1;
+}
+/*---------------------------------------------------------------------------*/
+int
+mcast_object_publish(struct mcast_object *o, uint16_t id, uint32_t size)
+{
+  uint16_t page;
+
+  if(size == 0 || size > MCAST_OBJECT_MAX_SIZE) {
+    return 0;
+  }
+  if(o->fd >= 0) {
+    cfs_close(o->fd);
+  }
+  o->fd = cfs_open(o->file, CFS_READ);
+  if(o->fd < 0) {
+    LOG_ERR("Can not open %s\n", o->file);
+    o->flags = 0;
+    return 0;
+  }
+
+  o->id = id;
+  o->size = size;
+  o->pages = (size + MCAST_OBJECT_PAGE_SIZE - 1) / MCAST_OBJECT_PAGE_SIZE;
+  o->pages_complete = o->pages;
+  for(page = 0; page < o->pages; page++) {
+    o->have[page] = page_mask(o, page);
+  }
+  o->flags = FLAG_KNOWN | FLAG_COMPLETE | FLAG_PUSH;
+  o->push_page = 0;
+  o->push_packet = 0;
+  o->repairs_len = 0;
+  ctimer_stop(&o->nack_timer);
+  ctimer_set(&o->tx_timer, MCAST_OBJECT_TX_INTERVAL, tx_next, o);
+
+  trickle_timer_config(&o->adv_timer, MCAST_OBJECT_ADV_IMIN,
+                       MCAST_OBJECT_ADV_IMAX, MCAST_OBJECT_ADV_K);
+  trickle_timer_set(&o->adv_timer, adv_send, o);
+
+  LOG_INFO("Publishing object %u, %lu bytes in %u pages\n",
+           id, (unsigned long)size, o->pages);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+mcast_object_is_complete(const struct mcast_object *o)
+{
+  return (o->flags & FLAG_COMPLETE) != 0;
+}
+/*---------------------------------------------------------------------------*/
+/* UDP transport */
+/*---------------------------------------------------------------------------*/
+static void
+udp_output(struct mcast_object *o, uint8_t to, const uint8_t *data,
+           uint16_t len)
+{
+  uip_ipaddr_t addr;
+
+  if(to == MCAST_OBJECT_TO_GROUP) {
+    simple_udp_sendto(&udp_conn, data, len, &udp_group);
+  } else {
+    uip_create_linklocal_allnodes_mcast(&addr);
+    simple_udp_sendto(&udp_conn, data, len, &addr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+udp_input(struct simple_udp_connection *c, const uip_ipaddr_t *sender_addr,
+          uint16_t sender_port, const uip_ipaddr_t *receiver_addr,
+          uint16_t receiver_port, const uint8_t *data, uint16_t datalen)
+{
+  if(udp_object != NULL) {
+    mcast_object_input(udp_object, data, datalen);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+mcast_object_udp_init(struct mcast_object *o, const uip_ipaddr_t *group)
+{
+  if(uip_ds6_maddr_lookup(group) == NULL &&
+     uip_ds6_maddr_add(group) == NULL) {
+    LOG_ERR("Can not join the group\n");
+    return 0;
+  }
+  uip_ipaddr_copy(&udp_group, group);
+  udp_object = o;
+  o->output = udp_output;
+  return simple_udp_register(&udp_conn, MCAST_OBJECT_PORT, NULL,
+                             MCAST_OBJECT_PORT, udp_input);
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
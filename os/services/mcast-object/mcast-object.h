@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup lib
+ * @{
+ *
+ * \defgroup mcast-object Reliable multicast object dissemination
+ *
+ * Disseminates a multi-packet object, e.g. a configuration or a firmware
+ * image, from one source to every node of the network.
+ *
+ * The object is split into pages of MCAST_OBJECT_PAGE_PACKETS packets. The
+ * source pushes every packet once to a multicast group, which the
+ * configured multicast engine (uip-mcast6-engines.h) carries through the
+ * network. Every node keeps a bitmap of the packets it holds per page and
+ * writes them to a CFS file as they arrive.
+ *
+ * Losses are repaired locally. A node that stopped receiving while its
+ * object is incomplete sends a NACK with the missing packets of its first
+ * incomplete page to its neighbours. Neighbours that hold any of them send
+ * them back, after a random delay, to their own neighbours. NACKs and
+ * repairs of other nodes suppress redundant ones. Nodes advertise their
+ * progress on a trickle timer, so that nodes that missed the whole push
+ * find out about the object too.
+ * @{
+ */
+/**
+ * \file
+ *         Reliable multicast object dissemination with NACK-based repair
+ */
+
+#ifndef MCAST_OBJECT_H_
+#define MCAST_OBJECT_H_
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "lib/trickle-timer.h"
+#include "sys/ctimer.h"
+
+#include <stdint.h>
+/*---------------------------------------------------------------------------*/
+/* Configuration */
+/*---------------------------------------------------------------------------*/
+/** The UDP port of the service */
+#ifdef MCAST_OBJECT_CONF_PORT
+#define MCAST_OBJECT_PORT MCAST_OBJECT_CONF_PORT
+#else
+#define MCAST_OBJECT_PORT 30001
+#endif
+
+/** Object bytes per packet */
+#ifdef MCAST_OBJECT_CONF_PACKET_SIZE
+#define MCAST_OBJECT_PACKET_SIZE MCAST_OBJECT_CONF_PACKET_SIZE
+#else
+#define MCAST_OBJECT_PACKET_SIZE 64
+#endif
+
+/** Packets per page, at most 32 */
+#ifdef MCAST_OBJECT_CONF_PAGE_PACKETS
+#define MCAST_OBJECT_PAGE_PACKETS MCAST_OBJECT_CONF_PAGE_PACKETS
+#else
+#define MCAST_OBJECT_PAGE_PACKETS 16
+#endif
+
+/** Largest object in pages */
+#ifdef MCAST_OBJECT_CONF_MAX_PAGES
+#define MCAST_OBJECT_MAX_PAGES MCAST_OBJECT_CONF_MAX_PAGES
+#else
+#define MCAST_OBJECT_MAX_PAGES 128
+#endif
+
+/** Pages with pending repairs, per node */
+#ifdef MCAST_OBJECT_CONF_REPAIR_QUEUE
+#define MCAST_OBJECT_REPAIR_QUEUE MCAST_OBJECT_CONF_REPAIR_QUEUE
+#else
+#define MCAST_OBJECT_REPAIR_QUEUE 4
+#endif
+
+/** Time between two packets sent by a node */
+#ifdef MCAST_OBJECT_CONF_TX_INTERVAL
+#define MCAST_OBJECT_TX_INTERVAL MCAST_OBJECT_CONF_TX_INTERVAL
+#else
+#define MCAST_OBJECT_TX_INTERVAL (CLOCK_SECOND / 16)
+#endif
+
+/** Longest random delay before a node answers a NACK */
+#ifdef MCAST_OBJECT_CONF_REPAIR_DELAY
+#define MCAST_OBJECT_REPAIR_DELAY MCAST_OBJECT_CONF_REPAIR_DELAY
+#else
+#define MCAST_OBJECT_REPAIR_DELAY (CLOCK_SECOND / 4)
+#endif
+
+/** Silence after which an incomplete node sends its first NACK */
+#ifdef MCAST_OBJECT_CONF_NACK_DELAY
+#define MCAST_OBJECT_NACK_DELAY MCAST_OBJECT_CONF_NACK_DELAY
+#else
+#define MCAST_OBJECT_NACK_DELAY CLOCK_SECOND
+#endif
+
+/** NACKs that go unanswered are repeated with a backoff up to this */
+#ifdef MCAST_OBJECT_CONF_NACK_DELAY_MAX
+#define MCAST_OBJECT_NACK_DELAY_MAX MCAST_OBJECT_CONF_NACK_DELAY_MAX
+#else
+#define MCAST_OBJECT_NACK_DELAY_MAX (CLOCK_SECOND * 16)
+#endif
+
+/** Advertisement trickle timer: Imin, Imax doublings and k */
+#ifdef MCAST_OBJECT_CONF_ADV_IMIN
+#define MCAST_OBJECT_ADV_IMIN MCAST_OBJECT_CONF_ADV_IMIN
+#else
+#define MCAST_OBJECT_ADV_IMIN CLOCK_SECOND
+#endif
+
+#ifdef MCAST_OBJECT_CONF_ADV_IMAX
+#define MCAST_OBJECT_ADV_IMAX MCAST_OBJECT_CONF_ADV_IMAX
+#else
+#define MCAST_OBJECT_ADV_IMAX 8
+#endif
+
+#ifdef MCAST_OBJECT_CONF_ADV_K
+#define MCAST_OBJECT_ADV_K MCAST_OBJECT_CONF_ADV_K
+#else
+#define MCAST_OBJECT_ADV_K 1
+#endif
+/*---------------------------------------------------------------------------*/
+/* Constants */
+/*---------------------------------------------------------------------------*/
+#define MCAST_OBJECT_PAGE_SIZE (MCAST_OBJECT_PAGE_PACKETS * MCAST_OBJECT_PACKET_SIZE)
+#define MCAST_OBJECT_MAX_SIZE  ((uint32_t)MCAST_OBJECT_MAX_PAGES * MCAST_OBJECT_PAGE_SIZE)
+
+/** Destinations of the service's messages */
+#define MCAST_OBJECT_TO_GROUP      0 /**< Through the multicast engine */
+#define MCAST_OBJECT_TO_NEIGHBOURS 1 /**< Link-local, one hop */
+
+/* Message types */
+#define MCAST_OBJECT_DATA 1
+#define MCAST_OBJECT_NACK 2
+#define MCAST_OBJECT_ADV  3
+
+/* Type, object ID, object size */
+#define MCAST_OBJECT_HDR_LEN  7
+/* Page and packet */
+#define MCAST_OBJECT_DATA_LEN (MCAST_OBJECT_HDR_LEN + 3)
+/* Page and bitmap of missing packets */
+#define MCAST_OBJECT_NACK_LEN (MCAST_OBJECT_HDR_LEN + 6)
+/* Complete pages */
+#define MCAST_OBJECT_ADV_LEN  (MCAST_OBJECT_HDR_LEN + 2)
+
+#if MCAST_OBJECT_PAGE_PACKETS > 32
+#error "MCAST_OBJECT_PAGE_PACKETS must not exceed 32"
+#endif
+/*---------------------------------------------------------------------------*/
+/* Data Structures */
+/*---------------------------------------------------------------------------*/
+struct mcast_object;
+
+/**
+ * \brief Send a message of the service
+ * \param o The object
+ * \param to MCAST_OBJECT_TO_GROUP or MCAST_OBJECT_TO_NEIGHBOURS
+ * \param data The message
+ * \param len The message length
+ */
+typedef void (* mcast_object_output_t)(struct mcast_object *o, uint8_t to,
+                                       const uint8_t *data, uint16_t len);
+
+/** \brief Called once the object is complete in its file */
+typedef void (* mcast_object_callback_t)(struct mcast_object *o);
+
+/** \brief A pending repair: packets of a page that neighbours miss */
+struct mcast_object_repair {
+  uint16_t page;
+  uint32_t packets;
+};
+
+/** \brief The dissemination state of a node */
+struct mcast_object {
+  const char *file;
+  mcast_object_output_t output;
+  mcast_object_callback_t complete;
+
+  uint16_t id;
+  uint32_t size;
+  uint16_t pages;
+  uint16_t pages_complete;
+  uint32_t have[MCAST_OBJECT_MAX_PAGES];
+  int fd;
+  uint8_t flags;
+
+  /* Paced transmissions: repairs first, then the source's push */
+  struct ctimer tx_timer;
+  struct mcast_object_repair repairs[MCAST_OBJECT_REPAIR_QUEUE];
+  uint8_t repairs_len;
+  uint16_t push_page;
+  uint8_t push_packet;
+
+  struct ctimer nack_timer;
+  clock_time_t nack_delay;
+
+  struct trickle_timer adv_timer;
+
+  /* Statistics */
+  uint32_t data_out;
+  uint32_t nack_out;
+  uint32_t adv_out;
+  uint32_t data_in;
+  uint32_t duplicates_in;
+};
+/*---------------------------------------------------------------------------*/
+/* Public API */
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Initialise a node's dissemination state
+ * \param o The state
+ * \param file The CFS file that holds the object
+ * \param output The transport, see mcast_object_udp_init()
+ * \param complete Called when a received object is complete, or NULL
+ */
+void mcast_object_init(struct mcast_object *o, const char *file,
+                       mcast_object_output_t output,
+                       mcast_object_callback_t complete);
+
+/**
+ * \brief Disseminate the object in the node's file
+ * \param o The state
+ * \param id The object's ID, newer objects have higher IDs (mod 2^16)
+ * \param size The object's size in bytes
+ * \return 1 on success, 0 if the object is too large or the file can not
+ *         be read
+ */
+int mcast_object_publish(struct mcast_object *o, uint16_t id, uint32_t size);
+
+/**
+ * \brief Process a message of the service
+ * \param o The state
+ * \param data The message
+ * \param len The message length
+ */
+void mcast_object_input(struct mcast_object *o, const uint8_t *data,
+                        uint16_t len);
+
+/**
+ * \brief Check whether a node holds the whole object
+ * \param o The state
+ * \return 1 if the object is complete
+ */
+int mcast_object_is_complete(const struct mcast_object *o);
+
+/**
+ * \brief Carry the service over UDP on MCAST_OBJECT_PORT
+ * \param o The state, already initialised
+ * \param group The multicast group of the push, which the node joins
+ * \return 1 on success, 0 otherwise
+ *
+ * Group messages are sent to \e group and carried by the multicast engine.
+ * NACKs, repairs and advertisements go to the link-local all-nodes
+ * address. A node can use one UDP transport.
+ */
+int mcast_object_udp_init(struct mcast_object *o, const uip_ipaddr_t *group);
+/*---------------------------------------------------------------------------*/
+#endif /* MCAST_OBJECT_H_ */
+/**
+ * @}
+ * @}
+ */
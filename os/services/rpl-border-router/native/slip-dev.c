@@ -53,6 +53,7 @@
 
 #include "net/netstack.h"
 #include "net/packetbuf.h"
+#include "lib/slip-codec.h"
 #include "cmd.h"
 #include "border-router-cmds.h"
 
@@ -70,9 +71,24 @@ extern speed_t slip_config_b_rate;
 #define SEND_DELAY 0
 #endif
 
+/* Size of the output queue, holding any number of encoded packets */
+#ifdef SLIP_DEV_CONF_BUF_SIZE
+#define SLIP_BUF_SIZE SLIP_DEV_CONF_BUF_SIZE
+#else
+#define SLIP_BUF_SIZE 16384
+#endif
+
+/* How much to read from the SLIP descriptor at a time */
+#ifdef SLIP_DEV_CONF_READ_SIZE
+#define SLIP_READ_SIZE SLIP_DEV_CONF_READ_SIZE
+#else
+#define SLIP_READ_SIZE 4096
+#endif
+
 int devopen(const char *dev, int flags);
 
-static FILE *inslip;
+static struct slip_decoder decoder;
+static uint8_t inbuf[2048];
 
 /* for statistics */
 long slip_sent = 0;
@@ -82,10 +98,7 @@ int slipfd = 0;
 
 #define PROGRESS(s) do { } while(0)
 
-#define SLIP_END     0300
-#define SLIP_ESC     0333
-#define SLIP_ESC_END 0334
-#define SLIP_ESC_ESC 0335
+#define SLIP_END     SLIP_CODEC_END
 
 /*---------------------------------------------------------------------------*/
 static void *
@@ -168,125 +181,111 @@ slip_packet_input(unsigned char *data, int len)
   NETSTACK_MAC.input();
 }
 /*---------------------------------------------------------------------------*/
-/*
- * Read from serial, when we have a packet call slip_packet_input. No output
- * buffering, input buffered by stdio.
- */
-void
-serial_input(FILE *inslip)
+static void
+frame_input(const uint8_t *frame, size_t len, void *ptr)
 {
-  static unsigned char inbuf[2048];
-  static int inbufptr = 0;
-  int ret, i;
-  unsigned char c;
-
-#ifdef linux
-  ret = fread(&c, 1, 1, inslip);
-  if(ret == -1 || ret == 0) {
-    err(1, "serial_input: read");
-  }
-  goto after_fread;
-#endif
+  int i;
 
-read_more:
-  if(inbufptr >= sizeof(inbuf)) {
-    fprintf(stderr, "*** dropping large %d byte packet\n", inbufptr);
-    inbufptr = 0;
-  }
-  ret = fread(&c, 1, 1, inslip);
-#ifdef linux
-after_fread:
-#endif
-  if(ret == -1) {
-    err(1, "serial_input: read");
-  }
-  if(ret == 0) {
-    clearerr(inslip);
-    return;
-  }
-  slip_received++;
-  switch(c) {
-  case SLIP_END:
-    if(inbufptr > 0) {
-      if(inbuf[0] == '!') {
-        command_context = CMD_CONTEXT_RADIO;
-        cmd_input(inbuf, inbufptr);
-      } else if(inbuf[0] == '?') {
+  if(frame[0] == '!') {
+    command_context = CMD_CONTEXT_RADIO;
+    cmd_input(frame, len);
+  } else if(frame[0] == '?') {
 #define DEBUG_LINE_MARKER '\r'
-      } else if(inbuf[0] == DEBUG_LINE_MARKER) {
-        fwrite(inbuf + 1, inbufptr - 1, 1, stdout);
-      } else if(is_sensible_string(inbuf, inbufptr)) {
-        if(slip_config_verbose == 1) {   /* strings already echoed below for verbose>1 */
-          fwrite(inbuf, inbufptr, 1, stdout);
-        }
-      } else {
-        if(slip_config_verbose > 2) {
-          printf("Packet from SLIP of length %d - write TUN\n", inbufptr);
-          if(slip_config_verbose > 4) {
+  } else if(frame[0] == DEBUG_LINE_MARKER) {
+    fwrite(frame + 1, len - 1, 1, stdout);
+  } else if(is_sensible_string(frame, len)) {
+    /* printable characters are already echoed as received for verbose==4,
+       complete lines for verbose=2,3,5+: this is what follows the last one */
+    if(slip_config_verbose > 0 && slip_config_verbose != 4) {
+      fwrite(frame, len, 1, stdout);
+    }
+  } else {
+    if(slip_config_verbose > 2) {
+      printf("Packet from SLIP of length %d - write TUN\n", (int)len);
+      if(slip_config_verbose > 4) {
 #if WIRESHARK_IMPORT_FORMAT
-            printf("0000");
-            for(i = 0; i < inbufptr; i++) {
-              printf(" %02x", inbuf[i]);
-            }
+        printf("0000");
+        for(i = 0; i < len; i++) {
+          printf(" %02x", frame[i]);
+        }
 #else
-            printf("         ");
-            for(i = 0; i < inbufptr; i++) {
-              printf("%02x", inbuf[i]);
-              if((i & 3) == 3) {
-                printf(" ");
-              }
-              if((i & 15) == 15) {
-                printf("\n         ");
-              }
-            }
-#endif
-            printf("\n");
+        printf("         ");
+        for(i = 0; i < len; i++) {
+          printf("%02x", frame[i]);
+          if((i & 3) == 3) {
+            printf(" ");
+          }
+          if((i & 15) == 15) {
+            printf("\n         ");
           }
         }
-        slip_packet_input(inbuf, inbufptr);
+#endif
+        printf("\n");
       }
-      inbufptr = 0;
     }
-    break;
-
-  case SLIP_ESC:
-    if(fread(&c, 1, 1, inslip) != 1) {
-      clearerr(inslip);
-      /* Put ESC back and give up! */
-      ungetc(SLIP_ESC, inslip);
-      return;
+    slip_packet_input((unsigned char *)frame, len);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Read from serial, when we have a packet call slip_packet_input. Reads as
+ * much as is available in one go and decodes it a block at a time.
+ */
+static void
+serial_input(int fd)
+{
+  static uint8_t rxbuf[SLIP_READ_SIZE];
+  unsigned long dropped;
+  const uint8_t *p;
+  const uint8_t *nl;
+  ssize_t n;
+  ssize_t i;
+
+  n = read(fd, rxbuf, sizeof(rxbuf));
+  if(n == -1 && (errno == EAGAIN || errno == EINTR)) {
+    return;
+  }
+  if(n <= 0) {
+    err(1, "serial_input: read");
+  }
+  slip_received += n;
+
+  /* Echo all printable characters for verbose==4 */
+  if(slip_config_verbose == 4) {
+    for(i = 0; i < n; i++) {
+      if(rxbuf[i] == 0 || rxbuf[i] == '\r' || rxbuf[i] == '\n' ||
+         rxbuf[i] == '\t' || (rxbuf[i] >= ' ' && rxbuf[i] <= '~')) {
+        fwrite(&rxbuf[i], 1, 1, stdout);
+      }
     }
+  }
 
-    switch(c) {
-    case SLIP_ESC_END:
-      c = SLIP_END;
-      break;
-    case SLIP_ESC_ESC:
-      c = SLIP_ESC;
-      break;
-    }
-    /* FALLTHROUGH */
-  default:
-    inbuf[inbufptr++] = c;
-
-    /* Echo lines as they are received for verbose=2,3,5+ */
-    /* Echo all printable characters for verbose==4 */
-    if(slip_config_verbose == 4) {
-      if(c == 0 || c == '\r' || c == '\n' || c == '\t' || (c >= ' ' && c <= '~')) {
-        fwrite(&c, 1, 1, stdout);
-      }
-    } else if(slip_config_verbose >= 2) {
-      if(c == '\n' && is_sensible_string(inbuf, inbufptr)) {
-        fwrite(inbuf, inbufptr, 1, stdout);
-        inbufptr = 0;
+  dropped = decoder.dropped;
+  if(slip_config_verbose >= 2 && slip_config_verbose != 4) {
+    /*
+     * Echo lines as they are received for verbose=2,3,5+: debug text from
+     * a node that never sends END would otherwise never show up.
+     */
+    p = rxbuf;
+    while((nl = memchr(p, '\n', rxbuf + n - p)) != NULL) {
+      slip_decode(&decoder, p, nl + 1 - p, frame_input, NULL);
+      if(decoder.len > 0 && !decoder.overflow &&
+         is_sensible_string(decoder.buf, decoder.len)) {
+        fwrite(decoder.buf, decoder.len, 1, stdout);
+        decoder.len = 0;
       }
+      p = nl + 1;
     }
-    break;
+    slip_decode(&decoder, p, rxbuf + n - p, frame_input, NULL);
+  } else {
+    slip_decode(&decoder, rxbuf, n, frame_input, NULL);
+  }
+  if(decoder.dropped != dropped) {
+    fprintf(stderr, "*** dropping %lu large packet(s)\n",
+            decoder.dropped - dropped);
   }
-
-  goto read_more;
 }
-unsigned char slip_buf[2048];
+unsigned char slip_buf[SLIP_BUF_SIZE];
 int slip_end, slip_begin, slip_packet_end, slip_packet_count;
 static struct timer send_delay_timer;
 /* delay between slip packets */
@@ -319,13 +318,19 @@ slip_empty()
 void
 slip_flushbuf(int fd)
 {
+  uint8_t *e;
   int n;
 
   if(slip_empty()) {
     return;
   }
 
-  n = write(fd, slip_buf + slip_begin, slip_packet_end - slip_begin);
+  /*
+   * Unless we have to pace the packets, hand everything that is queued to
+   * the kernel in a single write.
+   */
+  n = write(fd, slip_buf + slip_begin,
+            (send_delay > 0 ? slip_packet_end : slip_end) - slip_begin);
 
   if(n == -1 && errno != EAGAIN) {
     err(1, "slip_flushbuf write failed");
@@ -333,27 +338,30 @@ slip_flushbuf(int fd)
     PROGRESS("Q");		/* Outqueue is full! */
   } else {
     slip_begin += n;
-    if(slip_begin == slip_packet_end) {
+    if(slip_begin < slip_packet_end) {
+      return;
+    }
+
+    /* Retire the packets that have been written completely */
+    while(slip_packet_end > 0 && slip_begin >= slip_packet_end) {
       slip_packet_count--;
-      if(slip_end > slip_packet_end) {
-        memmove(slip_buf, slip_buf + slip_packet_end,
-               slip_end - slip_packet_end);
-      }
-      slip_end -= slip_packet_end;
-      slip_begin = slip_packet_end = 0;
-      if(slip_end > 0) {
-        /* Find end of next slip packet */
-        for(n = 1; n < slip_end; n++) {
-          if(slip_buf[n] == SLIP_END) {
-            slip_packet_end = n + 1;
-            break;
-          }
-        }
-        /* a delay between slip packets to avoid losing data */
-        if(send_delay > 0) {
-          timer_set(&send_delay_timer, send_delay);
-        }
-      }
+      e = memchr(slip_buf + slip_packet_end, SLIP_END,
+                 slip_end - slip_packet_end);
+      slip_packet_end = e != NULL ? e - slip_buf + 1 : 0;
+    }
+
+    if(slip_end > slip_begin) {
+      memmove(slip_buf, slip_buf + slip_begin, slip_end - slip_begin);
+    }
+    slip_end -= slip_begin;
+    if(slip_packet_end > 0) {
+      slip_packet_end -= slip_begin;
+    }
+    slip_begin = 0;
+
+    /* a delay between slip packets to avoid losing data */
+    if(slip_end > 0 && send_delay > 0) {
+      timer_set(&send_delay_timer, send_delay);
     }
   }
 }
@@ -397,22 +405,16 @@ write_to_serial(int outfd, const uint8_t *inbuf, int len)
    */
   /* slip_send(outfd, SLIP_END); */
 
-  for(i = 0; i < len; i++) {
-    switch(p[i]) {
-    case SLIP_END:
-      slip_send(outfd, SLIP_ESC);
-      slip_send(outfd, SLIP_ESC_END);
-      break;
-    case SLIP_ESC:
-      slip_send(outfd, SLIP_ESC);
-      slip_send(outfd, SLIP_ESC_ESC);
-      break;
-    default:
-      slip_send(outfd, p[i]);
-      break;
-    }
+  i = slip_encode(p, len, slip_buf + slip_end, sizeof(slip_buf) - slip_end);
+  if(i == 0) {
+    err(1, "slip_send overflow");
+  }
+  slip_end += i;
+  slip_sent += i;
+  slip_packet_count++;
+  if(slip_packet_end == 0) {
+    slip_packet_end = slip_end;
   }
-  slip_send(outfd, SLIP_END);
   PROGRESS("t");
 }
 /*---------------------------------------------------------------------------*/
@@ -499,7 +501,7 @@ static void
 handle_fd(fd_set *rset, fd_set *wset)
 {
   if(FD_ISSET(slipfd, rset)) {
-    serial_input(inslip);
+    serial_input(slipfd);
   }
 
   if(FD_ISSET(slipfd, wset)) {
@@ -560,9 +562,6 @@ slip_init(void)
 
   timer_set(&send_delay_timer, 0);
   slip_send(slipfd, SLIP_END);
-  inslip = fdopen(slipfd, "r");
-  if(inslip == NULL) {
-    err(1, "slip_init: fdopen");
-  }
+  slip_decoder_init(&decoder, inbuf, sizeof(inbuf));
 }
 /*---------------------------------------------------------------------------*/
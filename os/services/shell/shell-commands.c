@@ -66,10 +66,16 @@
 #endif
 #include "net/routing/routing.h"
 #include "net/mac/llsec802154.h"
+/* The counters of the native platform's tun interface */
+#if CONTIKI_TARGET_NATIVE && NETSTACK_CONF_WITH_IPV6 && !defined(__CYGWIN__)
+#define SHELL_WITH_TUN_STATS 1
+#include "tun6-net.h"
+#endif /* CONTIKI_TARGET_NATIVE && NETSTACK_CONF_WITH_IPV6 */
 
 /* For RPL-specific commands */
 #if ROUTING_CONF_RPL_LITE
 #include "net/routing/rpl-lite/rpl.h"
+#include "net/ipv6/uip-sr.h"
 #elif ROUTING_CONF_RPL_CLASSIC
 #include "net/routing/rpl-classic/rpl.h"
 #endif
@@ -217,70 +223,116 @@ rpl_ocp_to_str(int ocp)
   }
 }
 /*---------------------------------------------------------------------------*/
+static void
+print_rpl_neighbors(shell_output_func output)
+{
+  rpl_nbr_t *nbr = nbr_table_head(rpl_neighbors);
+
+  if(RPL_MAX_INSTANCES > 1) {
+    SHELL_OUTPUT(output, "RPL neighbors, instance %u:\n", curr_instance.instance_id);
+  } else {
+    SHELL_OUTPUT(output, "RPL neighbors:\n");
+  }
+  while(nbr != NULL) {
+    char buf[120];
+    rpl_neighbor_snprint(buf, sizeof(buf), nbr);
+    SHELL_OUTPUT(output, "%s\n", buf);
+    nbr = nbr_table_next(rpl_neighbors, nbr);
+  }
+}
+/*---------------------------------------------------------------------------*/
 static
 PT_THREAD(cmd_rpl_nbr(struct pt *pt, shell_output_func output, char *args))
 {
+  rpl_instance_t *prev_instance;
+  int count = 0;
+  int i;
+
   PT_BEGIN(pt);
 
-  if(!curr_instance.used || rpl_neighbor_count() == 0) {
+  for(i = 0; i < RPL_MAX_INSTANCES; i++) {
+    prev_instance = rpl_set_curr_instance(&rpl_instances[i]);
+    if(curr_instance.used && rpl_neighbor_count() > 0) {
+      print_rpl_neighbors(output);
+      count++;
+    }
+    rpl_set_curr_instance(prev_instance);
+  }
+
+  if(count == 0) {
     SHELL_OUTPUT(output, "RPL neighbors: none\n");
   } else {
-    rpl_nbr_t *nbr = nbr_table_head(rpl_neighbors);
-    SHELL_OUTPUT(output, "RPL neighbors:\n");
-    while(nbr != NULL) {
-      char buf[120];
-      rpl_neighbor_snprint(buf, sizeof(buf), nbr);
-      SHELL_OUTPUT(output, "%s\n", buf);
-      nbr = nbr_table_next(rpl_neighbors, nbr);
-    }
+    SHELL_OUTPUT(output, "-- Parent set updates: %lu, full re-evaluations: %lu\n",
+                 (unsigned long)rpl_neighbor_get_stats()->updates,
+                 (unsigned long)rpl_neighbor_get_stats()->full_updates);
+    SHELL_OUTPUT(output, "-- Probes: %lu sent (%lu urgent), %lu piggybacked, %lu over budget; parent switches: %lu\n",
+                 (unsigned long)rpl_timers_get_probing_stats()->sent,
+                 (unsigned long)rpl_timers_get_probing_stats()->urgent,
+                 (unsigned long)rpl_timers_get_probing_stats()->piggybacked,
+                 (unsigned long)rpl_timers_get_probing_stats()->over_budget,
+                 (unsigned long)rpl_timers_get_probing_stats()->parent_switches);
   }
 
   PT_END(pt);
 }
 /*---------------------------------------------------------------------------*/
+static void
+print_rpl_status(shell_output_func output)
+{
+  SHELL_OUTPUT(output, "-- Instance: %u\n", curr_instance.instance_id);
+  if(rpl_dag_root_is_root()) {
+    SHELL_OUTPUT(output, "-- DAG root\n");
+  } else {
+    SHELL_OUTPUT(output, "-- DAG node\n");
+  }
+  SHELL_OUTPUT(output, "-- DAG: ");
+  shell_output_6addr(output, &curr_instance.dag.dag_id);
+  SHELL_OUTPUT(output, ", version %u\n", curr_instance.dag.version);
+  SHELL_OUTPUT(output, "-- Prefix: ");
+  shell_output_6addr(output, &curr_instance.dag.prefix_info.prefix);
+  SHELL_OUTPUT(output, "/%u\n", curr_instance.dag.prefix_info.length);
+  SHELL_OUTPUT(output, "-- MOP: %s\n", rpl_mop_to_str(curr_instance.mop));
+  SHELL_OUTPUT(output, "-- OF: %s\n", rpl_ocp_to_str(curr_instance.of->ocp));
+  SHELL_OUTPUT(output, "-- Hop rank increment: %u\n", curr_instance.min_hoprankinc);
+  SHELL_OUTPUT(output, "-- Default lifetime: %lu seconds\n", RPL_LIFETIME(curr_instance.default_lifetime));
+
+  SHELL_OUTPUT(output, "-- State: %s\n", rpl_state_to_str(curr_instance.dag.state));
+  SHELL_OUTPUT(output, "-- Preferred parent: ");
+  if(curr_instance.dag.preferred_parent) {
+    shell_output_6addr(output, rpl_neighbor_get_ipaddr(curr_instance.dag.preferred_parent));
+    SHELL_OUTPUT(output, " (last DTSN: %u)\n", curr_instance.dag.preferred_parent->dtsn);
+  } else {
+    SHELL_OUTPUT(output, "None\n");
+  }
+  SHELL_OUTPUT(output, "-- Rank: %u\n", curr_instance.dag.rank);
+  SHELL_OUTPUT(output, "-- Lowest rank: %u (%u)\n", curr_instance.dag.lowest_rank, curr_instance.max_rankinc);
+  SHELL_OUTPUT(output, "-- DTSN out: %u\n", curr_instance.dtsn_out);
+  SHELL_OUTPUT(output, "-- DAO sequence: last sent %u, last acked %u\n",
+      curr_instance.dag.dao_last_seqno, curr_instance.dag.dao_last_acked_seqno);
+  SHELL_OUTPUT(output, "-- Trickle timer: current %u, min %u, max %u, redundancy %u\n",
+    curr_instance.dag.dio_intcurrent, curr_instance.dio_intmin,
+    curr_instance.dio_intmin + curr_instance.dio_intdoubl, curr_instance.dio_redundancy);
+}
+/*---------------------------------------------------------------------------*/
 static
 PT_THREAD(cmd_rpl_status(struct pt *pt, shell_output_func output, char *args))
 {
+  rpl_instance_t *prev_instance;
+  int i;
+
   PT_BEGIN(pt);
 
   SHELL_OUTPUT(output, "RPL status:\n");
-  if(!curr_instance.used) {
+  if(rpl_get_any_dag() == NULL) {
     SHELL_OUTPUT(output, "-- Instance: None\n");
   } else {
-    SHELL_OUTPUT(output, "-- Instance: %u\n", curr_instance.instance_id);
-    if(NETSTACK_ROUTING.node_is_root()) {
-      SHELL_OUTPUT(output, "-- DAG root\n");
-    } else {
-      SHELL_OUTPUT(output, "-- DAG node\n");
-    }
-    SHELL_OUTPUT(output, "-- DAG: ");
-    shell_output_6addr(output, &curr_instance.dag.dag_id);
-    SHELL_OUTPUT(output, ", version %u\n", curr_instance.dag.version);
-    SHELL_OUTPUT(output, "-- Prefix: ");
-    shell_output_6addr(output, &curr_instance.dag.prefix_info.prefix);
-    SHELL_OUTPUT(output, "/%u\n", curr_instance.dag.prefix_info.length);
-    SHELL_OUTPUT(output, "-- MOP: %s\n", rpl_mop_to_str(curr_instance.mop));
-    SHELL_OUTPUT(output, "-- OF: %s\n", rpl_ocp_to_str(curr_instance.of->ocp));
-    SHELL_OUTPUT(output, "-- Hop rank increment: %u\n", curr_instance.min_hoprankinc);
-    SHELL_OUTPUT(output, "-- Default lifetime: %lu seconds\n", RPL_LIFETIME(curr_instance.default_lifetime));
-
-    SHELL_OUTPUT(output, "-- State: %s\n", rpl_state_to_str(curr_instance.dag.state));
-    SHELL_OUTPUT(output, "-- Preferred parent: ");
-    if(curr_instance.dag.preferred_parent) {
-      shell_output_6addr(output, rpl_neighbor_get_ipaddr(curr_instance.dag.preferred_parent));
-      SHELL_OUTPUT(output, " (last DTSN: %u)\n", curr_instance.dag.preferred_parent->dtsn);
-    } else {
-      SHELL_OUTPUT(output, "None\n");
+    for(i = 0; i < RPL_MAX_INSTANCES; i++) {
+      if(rpl_instances[i].used) {
+        prev_instance = rpl_set_curr_instance(&rpl_instances[i]);
+        print_rpl_status(output);
+        rpl_set_curr_instance(prev_instance);
+      }
     }
-    SHELL_OUTPUT(output, "-- Rank: %u\n", curr_instance.dag.rank);
-    SHELL_OUTPUT(output, "-- Lowest rank: %u (%u)\n", curr_instance.dag.lowest_rank, curr_instance.max_rankinc);
-    SHELL_OUTPUT(output, "-- DTSN out: %u\n", curr_instance.dtsn_out);
-    SHELL_OUTPUT(output, "-- DAO sequence: last sent %u, last acked %u\n",
-        curr_instance.dag.dao_last_seqno, curr_instance.dag.dao_last_acked_seqno);
-    SHELL_OUTPUT(output, "-- Trickle timer: current %u, min %u, max %u, redundancy %u\n",
-      curr_instance.dag.dio_intcurrent, curr_instance.dio_intmin,
-      curr_instance.dio_intmin + curr_instance.dio_intdoubl, curr_instance.dio_redundancy);
-
   }
 
   PT_END(pt);
@@ -296,6 +348,39 @@ PT_THREAD(cmd_rpl_refresh_routes(struct pt *pt, shell_output_func output, char *
 
   PT_END(pt);
 }
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_rpl_dao_stats(struct pt *pt, shell_output_func output, char *args))
+{
+  const struct rpl_dag_root_dao_stats *stats;
+  unsigned long seconds;
+
+  PT_BEGIN(pt);
+
+  if(args != NULL && !strcmp(args, "reset")) {
+    rpl_dag_root_reset_dao_stats();
+    SHELL_OUTPUT(output, "DAO statistics reset\n");
+    PT_EXIT(pt);
+  }
+
+  stats = rpl_dag_root_get_dao_stats();
+  seconds = (clock_time() - stats->since) / CLOCK_SECOND;
+  SHELL_OUTPUT(output, "DAO statistics (last %lu seconds):\n", seconds);
+  SHELL_OUTPUT(output, "-- Received: %lu DAOs, %lu targets (%lu.%02lu targets/s)\n",
+               (unsigned long)stats->daos, (unsigned long)stats->targets,
+               seconds ? (unsigned long)stats->targets / seconds : 0,
+               seconds ? ((unsigned long)stats->targets * 100 / seconds) % 100 : 0);
+  SHELL_OUTPUT(output, "-- Applied: %lu, failed: %lu, merged: %lu\n",
+               (unsigned long)stats->applied, (unsigned long)stats->failed,
+               (unsigned long)stats->merged);
+  SHELL_OUTPUT(output, "-- DAO-ACKs sent: %lu\n", (unsigned long)stats->acks);
+  SHELL_OUTPUT(output, "-- Batches: %lu, backlog: %u (max %u, size %u)\n",
+               (unsigned long)stats->batches, stats->backlog, stats->max_backlog,
+               RPL_DAO_BATCH ? RPL_DAO_BATCH_SIZE : 0);
+  SHELL_OUTPUT(output, "-- Routing links: %u\n", uip_sr_num_nodes());
+
+  PT_END(pt);
+}
 #endif /* ROUTING_CONF_RPL_LITE */
 /*---------------------------------------------------------------------------*/
 static void
@@ -479,6 +564,24 @@ PT_THREAD(cmd_macaddr(struct pt *pt, shell_output_func output, char *args))
 
   PT_END(pt);
 }
+#if SHELL_WITH_TUN_STATS
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_tun_stats(struct pt *pt, shell_output_func output, char *args))
+{
+  const struct tun6_net_stats *stats;
+
+  PT_BEGIN(pt);
+
+  stats = tun6_net_get_stats();
+  SHELL_OUTPUT(output, "tun rx: %lu packets, %lu bytes, %lu batches\n",
+               stats->rx_packets, stats->rx_bytes, stats->rx_batches);
+  SHELL_OUTPUT(output, "tun tx: %lu packets, %lu bytes, %lu dropped\n",
+               stats->tx_packets, stats->tx_bytes, stats->tx_dropped);
+
+  PT_END(pt);
+}
+#endif /* SHELL_WITH_TUN_STATS */
 #if NETSTACK_CONF_WITH_IPV6
 /*---------------------------------------------------------------------------*/
 static
@@ -981,6 +1084,9 @@ const struct shell_command_t builtin_shell_commands[] = {
   { "reboot",               cmd_reboot,               "'> reboot': Reboot the board by watchdog_reboot()" },
   { "log",                  cmd_log,                  "'> log module level': Sets log level (0--4) for a given module (or \"all\"). For module \"mac\", level 4 also enables per-slot logging." },
   { "mac-addr",             cmd_macaddr,               "'> mac-addr': Shows the node's MAC address" },
+#if SHELL_WITH_TUN_STATS
+  { "tun-stats",            cmd_tun_stats,            "'> tun-stats': Shows the native tun interface counters" },
+#endif /* SHELL_WITH_TUN_STATS */
 #if NETSTACK_CONF_WITH_IPV6
   { "ip-addr",              cmd_ipaddr,               "'> ip-addr': Shows all IPv6 addresses" },
   { "ip-nbr",               cmd_ip_neighbors,         "'> ip-nbr': Shows all IPv6 neighbors" },
@@ -1000,6 +1106,7 @@ const struct shell_command_t builtin_shell_commands[] = {
   { "rpl-refresh-routes",   cmd_rpl_refresh_routes,   "'> rpl-refresh-routes': Refreshes all routes through a DTSN increment" },
   { "rpl-status",           cmd_rpl_status,           "'> rpl-status': Shows a summary of the current RPL state" },
   { "rpl-nbr",              cmd_rpl_nbr,              "'> rpl-nbr': Shows the RPL neighbor table" },
+  { "rpl-dao-stats",        cmd_rpl_dao_stats,        "'> rpl-dao-stats [reset]': Shows (or resets) the root's DAO processing statistics" },
 #endif /* ROUTING_CONF_RPL_LITE */
   { "rpl-global-repair",    cmd_rpl_global_repair,    "'> rpl-global-repair': Triggers a RPL global repair" },
 #endif /* UIP_CONF_IPV6_RPL */
@@ -37,6 +37,7 @@
 #include "tsch.h"
 #include "tsch-stats.h"
 #include "tsch-cs.h"
+#include "net/link-stats.h"
 
 /* Log configuration */
 #include "sys/log.h"
@@ -104,6 +105,27 @@ tsch_cs_bitmap_calc(void)
   return result;
 }
 /*---------------------------------------------------------------------------*/
+/* The quality of a channel, the higher the better. Without per-channel link
+ * statistics, this is the fraction of time the channel was found free. With
+ * them, it is further scaled by the PDR observed on the channel, so that
+ * channels with lossy links are replaced even if their noise floor is low. */
+static tsch_stat_t
+tsch_cs_quality_from_free_ewma(uint8_t index, tsch_stat_t free_ewma)
+{
+#if LINK_STATS_PER_CHANNEL
+  return (uint32_t)free_ewma
+    * link_stats_channel_pdr(tsch_stats_index_to_channel(index)) / LINK_STATS_PDR_SCALE;
+#else /* LINK_STATS_PER_CHANNEL */
+  return free_ewma;
+#endif /* LINK_STATS_PER_CHANNEL */
+}
+/*---------------------------------------------------------------------------*/
+static tsch_stat_t
+tsch_cs_channel_quality(uint8_t index)
+{
+  return tsch_cs_quality_from_free_ewma(index, tsch_stats.channel_free_ewma[index]);
+}
+/*---------------------------------------------------------------------------*/
 void
 tsch_cs_adaptations_init(void)
 {
@@ -215,7 +237,7 @@ tsch_cs_process(void)
 
   for(i = 0; i < TSCH_STATS_NUM_CHANNELS; ++i) {
     qualities[i].channel = i + TSCH_STATS_FIRST_CHANNEL;
-    qualities[i].metric = tsch_stats.channel_free_ewma[i];
+    qualities[i].metric = tsch_cs_channel_quality(i);
   }
 
   /* bubble sort the channels */
@@ -223,7 +245,7 @@ tsch_cs_process(void)
 
   /* start with the threshold values */
   for(i = 0; i < TSCH_STATS_NUM_CHANNELS; ++i) {
-    is_channel_busy[i] = (tsch_stats.channel_free_ewma[i] < TSCH_CS_FREE_THRESHOLD);
+    is_channel_busy[i] = (tsch_cs_channel_quality(i) < TSCH_CS_FREE_THRESHOLD);
   }
   memset(is_in_sequence, 0xff, sizeof(is_in_sequence));
   for(i = 0; i < tsch_hopping_sequence_length.val; ++i) {
@@ -311,8 +333,10 @@ tsch_cs_channel_stats_updated(uint8_t updated_channel, uint16_t old_busyness_met
 
   index = tsch_stats_channel_to_index(updated_channel);
 
-  old_is_busy = (old_busyness_metric < TSCH_CS_FREE_THRESHOLD);
-  new_is_busy = (tsch_stats.channel_free_ewma[index] < TSCH_CS_FREE_THRESHOLD);
+  /* Compare the qualities before and after the measurement the same way */
+  old_is_busy = (tsch_cs_quality_from_free_ewma(index, old_busyness_metric)
+                 < TSCH_CS_FREE_THRESHOLD);
+  new_is_busy = (tsch_cs_channel_quality(index) < TSCH_CS_FREE_THRESHOLD);
 
   if(old_is_busy != new_is_busy) {
     /* the status of the channel has changed*/
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+BENCH="frame802154" ./benchmark.sh "$@"
\ No newline at end of file
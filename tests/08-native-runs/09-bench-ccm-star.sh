@@ -0,0 +1,3 @@
+#!/bin/bash
+
+BENCH="ccm-star" ./benchmark.sh "$@"
\ No newline at end of file
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+BENCH="crc16" ./benchmark.sh "$@"
\ No newline at end of file
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+BENCH="coap-codec" ./benchmark.sh "$@"
\ No newline at end of file
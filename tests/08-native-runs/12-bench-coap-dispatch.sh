@@ -0,0 +1,3 @@
+#!/bin/bash
+
+BENCH="coap-dispatch" ./benchmark.sh "$@"
\ No newline at end of file
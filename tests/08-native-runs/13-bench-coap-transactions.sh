@@ -0,0 +1,3 @@
+#!/bin/bash
+
+BENCH="coap-transactions" ./benchmark.sh "$@"
\ No newline at end of file
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+BENCH="coap-tcp" ./benchmark.sh "$@"
\ No newline at end of file
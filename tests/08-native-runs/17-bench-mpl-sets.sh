@@ -0,0 +1,3 @@
+#!/bin/bash
+
+BENCH="mpl-sets" ./benchmark.sh "$@"
\ No newline at end of file
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+BENCH="bmf-forwarding" ./benchmark.sh "$@"
\ No newline at end of file
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+BENCH="mcast-object" ./benchmark.sh "$@"
\ No newline at end of file
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+BENCH="native-loop" ./benchmark.sh "$@"
\ No newline at end of file
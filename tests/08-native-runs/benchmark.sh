@@ -0,0 +1,41 @@
+#!/bin/bash
+source ../utils.sh
+
+# Contiki directory
+CONTIKI=$1
+
+# Name of the self-checking benchmark under examples/benchmarks/
+BENCH=${BENCH:?BENCH is not set}
+
+# Benchmark code directory
+CODE_DIR=$CONTIKI/examples/benchmarks/$BENCH
+CODE=$BENCH-bench
+
+# The benchmarks run to completion on their own and print "errors: N"
+echo "Running benchmark $BENCH"
+make -C $CODE_DIR -B TARGET=native > make.log 2> make.err
+timeout 300 $CODE_DIR/$CODE.native > $CODE.log 2> $CODE.err < /dev/null
+STATUS=$?
+
+if [ $STATUS -eq 0 ] && grep -qE "errors: 0$" $CODE.log ; then
+  cp $CODE.log $CODE.testlog
+  printf "%-32s TEST OK\n" "$CODE" | tee $CODE.testlog;
+else
+  echo "==== make.log ====" ; cat make.log;
+  echo "==== make.err ====" ; cat make.err;
+  echo "==== $CODE.log ====" ; cat $CODE.log;
+  echo "==== $CODE.err ====" ; cat $CODE.err;
+
+  printf "%-32s TEST FAIL\n" "$CODE" | tee $CODE.testlog;
+fi
+
+make -C $CODE_DIR TARGET=native clean > /dev/null 2>&1
+
+rm make.log
+rm make.err
+rm $CODE.log
+rm $CODE.err
+
+# We do not want Make to stop -> Return 0
+# The Makefile will check if a log contains FAIL at the end
+exit 0
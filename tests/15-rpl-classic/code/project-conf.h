@@ -28,3 +28,24 @@
  */
 #define TCPIP_CONF_ANNOTATE_TRANSMISSIONS 1
 #define LOG_CONF_LEVEL_RPL LOG_LEVEL_INFO
+
+/* Run the tests with the latency and energy-aware OF, using the latency
+ * metric container, rather than MRHOF/ETX */
+#ifdef RPL_TEST_CONF_LEOF
+#define RPL_TEST_LEOF RPL_TEST_CONF_LEOF
+#else
+#define RPL_TEST_LEOF 0
+#endif /* RPL_TEST_CONF_LEOF */
+
+#if RPL_TEST_LEOF
+#define RPL_CONF_WITH_MC 1
+#define RPL_CONF_OF_OCP RPL_OCP_LEOF
+#define RPL_CONF_SUPPORTED_OFS {&rpl_leof}
+#define RPL_CONF_DAG_MC RPL_DAG_MC_LATENCY
+#endif /* RPL_TEST_LEOF */
+
+/* Run the tests with DAO aggregation: routers advertise the targets of
+ * their sub-DODAG in DAOs of several targets */
+#ifdef RPL_TEST_CONF_DAO_AGGREGATION
+#define RPL_CONF_DAO_AGGREGATION RPL_TEST_CONF_DAO_AGGREGATION
+#endif /* RPL_TEST_CONF_DAO_AGGREGATION */